@@ -0,0 +1,85 @@
+/**
+ * Cell List Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file CellList.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2010-10-22
+ */
+
+
+#ifndef CELL_LIST_INCLUDE_H
+#define CELL_LIST_INCLUDE_H
+//
+
+
+#include <vector>
+
+
+/**
+ * Description: Uniform grid spatial hashing of points. Points are bucketed into cubic cells, so that all points within one cell size
+ *	of a given position are found in the 27 cells around it. With a cell size not smaller than the max neighbor distance, neighbor
+ *	detection costs near-linear time instead of testing every pair.
+ */
+class CCellList
+{
+	/* data: */
+public:
+	/* Error codes. */
+	struct ErrorCodes
+	{
+		static const int nNORMAL;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+private:
+	/* Default values. */
+	struct DefaultValues
+	{
+		// max number of cells along each axis, the cell size is enlarged if exceeded
+		static const int nMAX_CELLS_PER_AXIS;
+
+	private:
+		DefaultValues() {};
+	};
+
+
+	// start position of each cell in _cellPointIds, with an extra element marking the end of the last cell
+	std::vector<int> _cellStarts;
+	// IDs of points grouped by cell, in ascending order within each cell
+	std::vector<int> _cellPointIds;
+	// size of cubic cell
+	double _dCellSize;
+	// min X coordinate of the grid
+	double _dMinX;
+	// min Y coordinate of the grid
+	double _dMinY;
+	// min Z coordinate of the grid
+	double _dMinZ;
+	// number of cells along X axis
+	int _nCellsX;
+	// number of cells along Y axis
+	int _nCellsY;
+	// number of cells along Z axis
+	int _nCellsZ;
+
+	/* method: */
+public:
+	CCellList(const std::vector<double>& xCoordinates, const std::vector<double>& yCoordinates, const std::vector<double>& zCoordinates, const double dCellSize);
+	~CCellList();
+
+	int getCandidatePointIds(const double dX, const double dY, const double dZ, std::vector<int>& candidatePointIds) const;
+	double getCellSize() const;
+private:
+	inline int getCellIndex(const double dCoordinate, const double dMinCoordinate, const int nCells) const;
+};
+
+
+//
+#endif
@@ -45,6 +45,9 @@ private:
 	/* Default values. */
 	struct DefaultValues
 	{
+		// suffix appended to database file name to get self volume cache file name
+		static const std::string sSELF_VOLUME_CACHE_SUFFIX;
+
 	private:
 		DefaultValues() {};
 	};
@@ -106,6 +109,7 @@ private:
 	 */
 	struct SwitchNames
 	{
+		static const std::string sBEST_CONFORMER;
 		static const std::string sDATABASE;
 		static const std::string sDB_RANGE;
 		static const std::string sFIT;
@@ -116,6 +120,8 @@ private:
 		static const std::string sREFERENCE;
 		static const std::string sSH_DESCRIPTOR;
 		static const std::string sUSR_DESCRIPTOR;
+		static const std::string sVOLUME_CACHE;
+		static const std::string sWARM_START;
 
 	private:
 		SwitchNames() {};
@@ -0,0 +1,85 @@
+/**
+ * Cross Neighbor List Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file CrossNeighborList.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-08
+ */
+
+
+#ifndef CROSS_NEIGHBOR_LIST_INCLUDE_H
+#define CROSS_NEIGHBOR_LIST_INCLUDE_H
+//
+
+
+#include "GaussianVolume.h"
+
+#include <vector>
+
+
+/**
+ * Description: Verlet neighbor list of atom pairs between a fixed reference molecule and a moving fit molecule. Pairs are listed
+ *	if closer than their contact distance (sum of radii plus Gaussian cutoff) plus a skin distance. As long as no fit atom has moved
+ *	farther than the skin since the list was built, every pair in contact is still listed, so consecutive poses of an optimization
+ *	reuse the list and only test listed pairs. The list is rebuilt on the first pose moving any fit atom beyond the skin.
+ */
+class CCrossNeighborList
+{
+	/* data: */
+public:
+	/* Error codes. */
+	struct ErrorCodes
+	{
+		static const int nNORMAL;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+private:
+	// a flag indicating whether the list has been built
+	bool _bBuilt;
+	// fit atom X coordinates when the list was built
+	std::vector<double> _builtXCoordinates;
+	// fit atom Y coordinates when the list was built
+	std::vector<double> _builtYCoordinates;
+	// fit atom Z coordinates when the list was built
+	std::vector<double> _builtZCoordinates;
+	// start position of each reference atom in _candidateFitAtomIds, with an extra element marking the end of the last one
+	std::vector<int> _candidateStarts;
+	// listed fit atom IDs grouped by reference atom, in ascending order within each reference atom
+	std::vector<int> _candidateFitAtomIds;
+	// Gaussian cutoff the list was built with
+	double _dGaussianCutoff;
+	// skin distance added to contact distances
+	double _dSkin;
+	// number of times the list was built
+	int _nBuildsCount;
+	// number of poses the list was updated for
+	int _nUpdatesCount;
+
+	/* method: */
+public:
+	CCrossNeighborList(const double dSkin);
+	~CCrossNeighborList();
+
+	int getBuildsCount() const;
+	const std::vector<int>& getCandidateFitAtomIds() const;
+	const std::vector<int>& getCandidateStarts() const;
+	double getSkin() const;
+	int getUpdatesCount() const;
+	void invalidate();
+	bool update(const CGaussianVolume::PreparedMolecule& refMolecule, const CGaussianVolume::PreparedMolecule& fitMolecule, const double dGaussianCutoff);
+private:
+	int build(const CGaussianVolume::PreparedMolecule& refMolecule, const CGaussianVolume::PreparedMolecule& fitMolecule, const double dGaussianCutoff);
+	bool isOutdated(const CGaussianVolume::PreparedMolecule& refMolecule, const CGaussianVolume::PreparedMolecule& fitMolecule, const double dGaussianCutoff) const;
+};
+
+
+//
+#endif
@@ -17,6 +17,9 @@
 
 
 #include "InterfaceFunctionValueEvaluator.h"
+#include "InterfaceGradientEvaluator.h"
+
+#include <string>
 
 
 /**
@@ -38,8 +41,62 @@ public:
 	virtual double getFunctionValue(const std::vector<double>& params);
 };
 
+
+/**
+ * Description: Forward evaluations to another evaluator, counting them.
+ */
+class CCountingGradientEvaluator : public IGradientEvaluator
+{
+private:
+	IGradientEvaluator& _evaluator;
+	long long _nEvaluationsCount;
+
+public:
+	CCountingGradientEvaluator(IGradientEvaluator& evaluator);
+
+	long long getEvaluationsCount() const;
+	virtual double getFunctionValue(const std::vector<double>& params);
+	virtual double getFunctionValueAndGradient(const std::vector<double>& params, std::vector<double>& gradient);
+};
+
 int alignMolecule();
 
+int benchmarkBatchEvaluation(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPointsCount, const int nMaxIntersectionOrder);
+
+int benchmarkCulling(const std::string& sRefFileName, const std::string& sFitFileName, const int nMoleculesCount);
+
+int benchmarkDensityGrid(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPosesCount);
+
+int benchmarkKernelAccuracy(const std::string& sMoleculeFileName, const int nRounds);
+
+int benchmarkKernelPrecision(const std::string& sMoleculeFileName, const int nRounds);
+
+int benchmarkMemeticAlignment(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder, const int nPopulationSize,
+	const int nGenerations, const int nRefinedNumber);
+
+int benchmarkNeighborList(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder);
+
+int benchmarkOverlapGradient(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPosesCount);
+
+int benchmarkOptimizers(const std::string& sMoleculeFileName, const int nMoleculesCount);
+
+int benchmarkOverlapKernels(const std::string& sMoleculeFileName, const int nRounds);
+
+int benchmarkGeneticOptimizer(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPopulationSize, const int nGenerations);
+
+int benchmarkInitialPoses(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPerturbationsNumber);
+
+int benchmarkParallelSimplex(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder);
+
+int benchmarkPoseParameterization(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nOptimizer);
+
+int benchmarkSimplexConvergence(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIteration,
+	const double dAbsoluteValueTolerance, const double dRelativeValueTolerance);
+
+int benchmarkSimplexPruning(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIteration, const double dPruningFraction);
+
+int benchmarkWarmStart(const std::string& sMoleculeFileName, const int nQueriesCount, const int nRandomGroupsNumber);
+
 int debug();
 
 int stabilityTest();
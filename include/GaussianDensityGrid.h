@@ -0,0 +1,94 @@
+/**
+ * Gaussian Density Grid Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file GaussianDensityGrid.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-10
+ */
+
+
+#ifndef GAUSSIAN_DENSITY_GRID_INCLUDE_H
+#define GAUSSIAN_DENSITY_GRID_INCLUDE_H
+//
+
+
+#include "GaussianVolume.h"
+
+#include <vector>
+
+
+/**
+ * Description: First order Gaussian overlap field of a fixed reference molecule, sampled on a regular 3D grid so that the overlap of
+ *	a fit molecule in any pose costs one trilinear interpolation per fit atom instead of one exponential per atom pair.
+ *	As a pair term depends on the alpha value of the fit atom, the field is sampled in one channel per fit atom radius: the value at
+ *	a node is the overlap of all reference atoms with a fit atom of that radius centered at the node, with the same contact test as
+ *	the overlap kernel, so values are exact at nodes. Channels are sampled on first use and kept, for all fit molecules.
+ *	The grid spans the reference atoms plus a padding on each side, fit atoms out of the grid contribute nothing, which is exact
+ *	as long as the padding is no less than the largest contact distance (sum of radii plus Gaussian cutoff).
+ */
+class CGaussianDensityGrid
+{
+	/* data: */
+public:
+	/* Error codes. */
+	struct ErrorCodes
+	{
+		static const int nNORMAL;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+private:
+	// PI constant
+	static const double _dPI;
+
+	// fit atom radius of each channel, indexed by channel ID
+	mutable std::vector<double> _channelRadii;
+	// sampled overlap of each channel, indexed by channel ID, then by node ID ((X index * Y nodes + Y index) * Z nodes + Z index)
+	mutable std::vector<std::vector<double> > _channels;
+	// Gaussian cutoff of the contact test
+	double _dGaussianCutoff;
+	// X coordinate of the first node
+	double _dOriginX;
+	// Y coordinate of the first node
+	double _dOriginY;
+	// Z coordinate of the first node
+	double _dOriginZ;
+	// distance the grid extends beyond reference atom centers on each side
+	double _dPadding;
+	// distance between neighbor nodes
+	double _dSpacing;
+	// number of nodes along X axis
+	int _nXNodesCount;
+	// number of nodes along Y axis
+	int _nYNodesCount;
+	// number of nodes along Z axis
+	int _nZNodesCount;
+	// prepared reference molecule the channels are sampled from
+	CGaussianVolume::PreparedMolecule _refMolecule;
+
+	/* method: */
+public:
+	CGaussianDensityGrid(const CGaussianVolume::PreparedMolecule& refMolecule, const double dSpacing, const double dPadding, const double dGaussianCutoff);
+	~CGaussianDensityGrid();
+
+	double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& fitMolecule, const std::vector<int>& classChannelIds) const;
+	int getChannelId(const double dFitRadius, const double dFitAlpha) const;
+	int getChannelsCount() const;
+	double getGaussianCutoff() const;
+	int getNodesCount() const;
+	double getPadding() const;
+	double getSpacing() const;
+private:
+	int sampleChannel(const double dFitRadius, const double dFitAlpha) const;
+};
+
+
+//
+#endif
@@ -0,0 +1,183 @@
+/**
+ * Gaussian Overlap Kernel Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file GaussianOverlapKernel.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2010-10-20
+ */
+
+
+#ifndef GAUSSIAN_OVERLAP_KERNEL_INCLUDE_H
+#define GAUSSIAN_OVERLAP_KERNEL_INCLUDE_H
+//
+
+
+#include "GaussianVolume.h"
+
+#include <string>
+
+
+class CCrossNeighborList;
+
+
+/**
+ * Description: First order Gaussian overlap kernels working on prepared molecules. Besides the scalar kernel, SSE2 and AVX2 kernels
+ *	are provided on x86 processors with GCC compatible compilers. The best instruction set supported by the running processor is
+ *	selected at startup.
+ *	The SIMD kernels use a vectorized exp() and compute (PI / (a + b))^1.5 as t * sqrt(t) instead of pow(), and sum the terms in a
+ *	different sequence, so their result differs from the scalar one by a relative deviation not greater than dMAX_RELATIVE_DEVIATION.
+ *	Accuracy and precision modes are not process wide: each caller keeps its own CSettings and passes them to each call.
+ *	A fast accuracy mode is selected by a positive max relative error. Then constants of each pair of radius classes are tabulated
+ *	once per call, and exp() of atom pairs in contact is replaced by a truncated Taylor polynomial of the lowest degree meeting
+ *	that error. As all terms are positive, the relative error of the overlap volume is bounded by the same value.
+ *	A single precision mode runs the same arithmetic in float on the float copies of prepared molecules, doubling SIMD width. Terms
+ *	are accumulated in float per reference atom and in double across reference atoms, the fast mode does not apply to it.
+ *	Before any atom pair is tested, the bounding spheres of the whole molecules are tested, and the exact kernels then test each
+ *	reference atom against the bounding sphere of each block of fit atoms. Pairs are skipped only when none of them could be in
+ *	contact, so culling never changes the result.
+ *	The listed kernel tests only the atom pairs of a cross neighbor list instead of all pairs, with the arithmetic of the exact scalar
+ *	kernel. It is scalar only, as gathering listed atoms costs SIMD kernels more than testing all pairs. In fast or single precision
+ *	mode, all pairs are tested by the kernels of that mode.
+ *	Gradient kernels also return the derivatives of overlap with respect to the position of each fit atom, reusing the exp() term of
+ *	each pair. They always run the exact double precision arithmetic, with a scalar and an AVX2 kernel.
+ */
+class CGaussianOverlapKernel
+{
+	/* data: */
+public:
+	/* Error codes. */
+	struct ErrorCodes
+	{
+		static const int nNORMAL;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+	/* Instruction sets. */
+	struct InstructionSets
+	{
+		static const int nSCALAR;
+		static const int nSSE2;
+		static const int nAVX2;
+
+	private:
+		InstructionSets() {};
+	};
+
+
+	/**
+	 * Description: Counters of atom pairs, accumulated over calls, showing the share of work skipped by bounding sphere culling.
+	 */
+	struct CullingCounters
+	{
+		// atom pairs skipped since no pair among them could be in contact
+		long long nCulledPairsCount;
+		// atom pairs of all calls
+		long long nPairsCount;
+	};
+
+
+	/* Floating point precisions. */
+	struct Precisions
+	{
+		static const int nDOUBLE;
+		static const int nFLOAT;
+
+	private:
+		Precisions() {};
+	};
+
+
+	/**
+	 * Description: Accuracy and precision mode of kernels, exact double precision by default.
+	 */
+	class CSettings
+	{
+		/* data: */
+	private:
+		// max relative error of fast mode, 0 for exact mode
+		double _dMaxRelativeError;
+		// degree of exp() polynomial in fast mode, 0 for exact mode
+		int _nExpPolynomialDegree;
+		// floating point precision, one of Precisions
+		int _nPrecision;
+
+		/* method: */
+	public:
+		CSettings();
+
+		int getExpPolynomialDegree() const;
+		double getMaxRelativeError() const;
+		int getPrecision() const;
+		void setMaxRelativeError(const double dMaxRelativeError);
+		void setPrecision(const int nPrecision);
+	};
+
+
+	// max relative deviation of SIMD kernels from the scalar kernel
+	static const double dMAX_RELATIVE_DEVIATION;
+
+private:
+	// max number of radius classes per molecule in fast mode, molecules with more classes use exact kernels
+	static const int _nMAX_TABULATED_CLASSES_COUNT = 16;
+
+	/* Constants of each pair of radius classes, indexed by refClassId * _nMAX_TABULATED_CLASSES_COUNT + fitClassId. Fixed sized to
+	 * live on stack, as tables are built once per call. */
+	struct PairConstants
+	{
+		// alpha_i * alpha_j / (alpha_i + alpha_j)
+		double adAlphaProductOverSums[_nMAX_TABULATED_CLASSES_COUNT * _nMAX_TABULATED_CLASSES_COUNT];
+		// (r_i + r_j + cutoff)^2
+		double adContactSquareDistances[_nMAX_TABULATED_CLASSES_COUNT * _nMAX_TABULATED_CLASSES_COUNT];
+		// 8 * (PI / (alpha_i + alpha_j))^1.5
+		double adPrefactors[_nMAX_TABULATED_CLASSES_COUNT * _nMAX_TABULATED_CLASSES_COUNT];
+	};
+
+	// max degree of exp() polynomial in fast mode
+	static const int _nMAX_EXP_POLYNOMIAL_DEGREE;
+	// PI constant
+	static const double _dPI;
+
+	// instruction set of the kernel in use
+	static int _nInstructionSet;
+
+	/* method: */
+public:
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff);
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CSettings& settings);
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CSettings& settings, const int nInstructionSet);
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CSettings& settings, const CCrossNeighborList& neighborList);
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CSettings& settings, CullingCounters& cullingCounters);
+	static double calculateOverlapVolumeAndGradients(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, double* pXGradients, double* pYGradients, double* pZGradients);
+	static int detectInstructionSet();
+	static int getInstructionSet();
+	static std::string getInstructionSetName(const int nInstructionSet);
+	static std::string getPrecisionName(const int nPrecision);
+	static bool isSupportedInstructionSet(const int nInstructionSet);
+	static void setInstructionSet(const int nInstructionSet);
+private:
+	static double calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CSettings& settings, const int nInstructionSet, CullingCounters* pCullingCounters);
+	static int buildPairConstants(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, PairConstants& pairConstants);
+	static double calculateOverlapVolumeAndGradientsScalar(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, double* pXGradients, double* pYGradients, double* pZGradients);
+	static double calculateOverlapVolumeAndGradientsAvx2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, double* pXGradients, double* pYGradients, double* pZGradients);
+	static double calculateOverlapVolumeFastScalar(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const int nExpPolynomialDegree);
+	static double calculateOverlapVolumeFastSse2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const int nExpPolynomialDegree);
+	static double calculateOverlapVolumeFastAvx2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const int nExpPolynomialDegree);
+	static double calculateOverlapVolumeFloatScalar(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff);
+	static double calculateOverlapVolumeFloatSse2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff);
+	static double calculateOverlapVolumeFloatAvx2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff);
+	static double calculateOverlapVolumeListedScalar(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, const CCrossNeighborList& neighborList);
+	static double calculateOverlapVolumeScalar(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, CullingCounters* pCullingCounters);
+	static double calculateOverlapVolumeSse2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, CullingCounters* pCullingCounters);
+	static double calculateOverlapVolumeAvx2(const CGaussianVolume::PreparedMolecule& refMol, const CGaussianVolume::PreparedMolecule& fitMol, const double dGaussianCutoff, CullingCounters* pCullingCounters);
+};
+
+
+//
+#endif
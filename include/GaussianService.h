@@ -15,12 +15,20 @@
 //
 
 
+#include "GaussianVolume.h"
+
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 
 class CConfigurationArguments;
+class CGaussianDensityGrid;
+class CGaussianVolumeOverlapEvaluator;
+class CSelfVolumeCache;
+class CSimplexOptimizer;
+class IFunctionValueEvaluator;
 class IMolecule;
 
 
@@ -42,20 +50,142 @@ public:
 	};
 
 
+	/* Initial poses of alignment starts. */
+	struct InitialPoses
+	{
+		// random poses, drawn from the global random generator
+		static const int nRANDOM;
+		// deterministic poses superposing the principal axes of the volumes, in the four proper axis flips
+		static const int nPRINCIPAL_AXES;
+
+	private:
+		InitialPoses() {};
+	};
+
+
+	/* Local optimizers of alignment. */
+	struct Optimizers
+	{
+		// Nelder-Mead simplex on function values
+		static const int nSIMPLEX;
+		// L-BFGS on analytic gradients, first order overlap only, rejected with higher order overlap as its gradient has no closed
+		// form; pocket combo similarity, not differentiable, is always optimized by simplex
+		static const int nQUASI_NEWTON;
+		// genetic optimizer exploring poses on first order overlap, on density grid if any, its fittest individuals then refined by
+		// simplex on exact overlap
+		static const int nMEMETIC;
+
+	private:
+		Optimizers() {};
+	};
+
+
+	/**
+	 * Description: Query molecule prepared once for a whole screen. Holds everything about the query which does not depend on
+	 *	database molecules: the centered copy, its centroid, prepared atoms data, precalculation result, self volume, principal axes
+	 *	and optionally its density grid.
+	 */
+	class CPreparedQuery
+	{
+		/* data: */
+	public:
+	private:
+		// centered copy of query molecule
+		std::auto_ptr<IMolecule> _centeredMoleculePtr;
+		// centroid of query molecule before centering
+		std::vector<double> _centroid;
+		// density grid of centered query molecule, could be NULL pointer if disabled
+		std::auto_ptr<CGaussianDensityGrid> _densityGridPtr;
+		// Gaussian self volume of query molecule
+		double _dSelfVolume;
+		// precalculation result of centered query molecule
+		CGaussianVolume::MoleculePrecalculation _precalculation;
+		// prepared atoms data of centered query molecule
+		CGaussianVolume::PreparedMolecule _preparedMolecule;
+		// principal axes of centered query molecule, as rows
+		std::vector<std::vector<double> > _principalAxes;
+		// volume weighted centroid of centered query molecule
+		std::vector<double> _principalCenter;
+
+		/* method: */
+	public:
+		CPreparedQuery(const IMolecule& queryMolecule, const double dGaussianCutoff, const int nMaxIntersectionOrder, const double dIntersectionVolumeEpsilon, const double dDensityGridSpacing, const double dDensityGridPadding);
+		~CPreparedQuery();
+
+		const IMolecule& getCenteredMolecule() const;
+		const std::vector<double>& getCentroid() const;
+		const CGaussianDensityGrid* getDensityGrid() const;
+		const CGaussianVolume::MoleculePrecalculation& getPrecalculation() const;
+		const CGaussianVolume::PreparedMolecule& getPreparedMolecule() const;
+		const std::vector<std::vector<double> >& getPrincipalAxes() const;
+		const std::vector<double>& getPrincipalCenter() const;
+		double getSelfVolume() const;
+	private:
+		CPreparedQuery(const CPreparedQuery& preparedQuery);
+		CPreparedQuery& operator=(const CPreparedQuery& preparedQuery);
+	};
+
+
 private:
 	/* Default values. */
 	struct DefaultValues
 	{
+		// Gaussian cutoff used to prepare query molecule
+		static const double dGAUSSIAN_CUTOFF;
+		// for parameter "dGaussianDensityGridPadding"
+		static const double dGAUSSIAN_DENSITY_GRID_PADDING;
+		// for parameter "dGaussianDensityGridSpacing"
+		static const double dGAUSSIAN_DENSITY_GRID_SPACING;
+		// for parameter "dGaussianIntersectionVolumeEpsilon"
+		static const double dGAUSSIAN_INTERSECTION_VOLUME_EPSILON;
+		// for parameter "dGaussianKernelMaxRelativeError"
+		static const double dGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR;
+		// for parameter "bGaussianKernelSinglePrecision"
+		static const bool bGAUSSIAN_KERNEL_SINGLE_PRECISION;
+		// for parameter "nGaussianMaxIntersectionOrder"
+		static const int nGAUSSIAN_MAX_INTERSECTION_ORDER;
+		// for parameter "dGaussianNeighborListSkin"
+		static const double dGAUSSIAN_NEIGHBOR_LIST_SKIN;
+		// for parameter "nInitialPoses"
+		static const int nINITIAL_POSES;
+		// for parameter "nMemeticGenerationsNumber"
+		static const int nMEMETIC_GENERATIONS_NUMBER;
+		// for parameter "nMemeticPopulationSize"
+		static const int nMEMETIC_POPULATION_SIZE;
+		// for parameter "nMemeticRefinedNumber"
+		static const int nMEMETIC_REFINED_NUMBER;
+		// for parameter "nOptimizer"
+		static const int nOPTIMIZER;
+		// for parameter "nPoseParameterization"
+		static const int nPOSE_PARAMETERIZATION;
+		// for parameter "nPrincipalAxesPerturbationsNumber"
+		static const int nPRINCIPAL_AXES_PERTURBATIONS_NUMBER;
+		// for parameter "nQuasiNewtonMaxIterations"
+		static const int nQUASI_NEWTON_MAX_ITERATIONS;
+		// for parameter "dSimplexAbsoluteValueTolerance"
+		static const double dSIMPLEX_ABSOLUTE_VALUE_TOLERANCE;
 		// for parameter "dSimplexContractionFactor"
 		static const double dSIMPLEX_CONTRACTION_FACTOR;
 		// for parameter "dSimplexExtensionFactor"
 		static const double dSIMPLEX_EXTENSION_FACTOR;
+		// for parameter "dSimplexPruningFraction"
+		static const double dSIMPLEX_PRUNING_FRACTION;
 		// for parameter "dSimplexReflectionFactor"
 		static const double dSIMPLEX_REFLECTION_FACTOR;
+		// for parameter "dSimplexRelativeValueTolerance"
+		static const double dSIMPLEX_RELATIVE_VALUE_TOLERANCE;
+		// for parameter "dSimplexRotationTolerance"
+		static const double dSIMPLEX_ROTATION_TOLERANCE;
+		// for parameter "dSimplexTranslationTolerance"
+		static const double dSIMPLEX_TRANSLATION_TOLERANCE;
 		// for parameter "nSimplexInitialSolutionGroupsNumber"
 		static const int nSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER;
 		// for parameter "nSimplexMaxIterations"
 		static const int nSIMPLEX_MAX_ITERATIONS;
+		// for parameter "nSimplexThreadsCount"
+		static const int nSIMPLEX_THREADS_COUNT;
+		// for parameter "nWarmStartRandomGroupsNumber"
+		static const int nWARM_START_RANDOM_GROUPS_NUMBER;
 
 	private:
 		DefaultValues() {};
@@ -80,16 +210,60 @@ private:
 	 */
 	struct ParametersAggregation
 	{
+		// a flag indicating whether first order overlap kernels run in single precision instead of the reference double precision
+		bool bGaussianKernelSinglePrecision;
+		// distance the query density grid extends beyond query atom centers on each side
+		double dGaussianDensityGridPadding;
+		// spacing of the query density grid used for a first pass of alignment, 0 for aligning with the analytic kernel only
+		double dGaussianDensityGridSpacing;
+		// intersection volume below which a cluster is dropped when expanding higher order overlap
+		double dGaussianIntersectionVolumeEpsilon;
+		// max relative error of first order overlap kernels, 0 for exact kernels, a positive value for fast kernels
+		double dGaussianKernelMaxRelativeError;
+		// skin distance of cross neighbor lists reused across alignment steps, 0 for testing all atom pairs on each step
+		double dGaussianNeighborListSkin;
+		// absolute spread of simplex function values within which a start converges, 0 for no test
+		double dSimplexAbsoluteValueTolerance;
 		// contraction factor for simplex optimization
 		double dSimplexContractionFactor;
 		// extension factor for simplex optimization
 		double dSimplexExtensionFactor;
+		// fraction of the best overlap of an alignment a simplex start must reach not to be pruned, 0 for no pruning
+		double dSimplexPruningFraction;
 		// reflection factor for simplex optimization
 		double dSimplexReflectionFactor;
+		// spread of simplex function values relative to the lowest one within which a start converges, 0 for no test
+		double dSimplexRelativeValueTolerance;
+		// spread of simplex vertices along rotation angles within which a start converges, in radians
+		double dSimplexRotationTolerance;
+		// spread of simplex vertices along translations within which a start converges, in Angstroms
+		double dSimplexTranslationTolerance;
+		// max intersection order to expand when calculating Gaussian volume overlap, 1 for first order overlap
+		int nGaussianMaxIntersectionOrder;
+		// initial poses of alignment starts, one of InitialPoses
+		int nInitialPoses;
+		// number of generations of the genetic optimizer of memetic alignment
+		int nMemeticGenerationsNumber;
+		// population size of the genetic optimizer of memetic alignment
+		int nMemeticPopulationSize;
+		// number of fittest individuals of memetic alignment refined by simplex
+		int nMemeticRefinedNumber;
+		// local optimizer of alignment, one of Optimizers
+		int nOptimizer;
+		// parameterization of rotation in poses being optimized, one of CGaussianVolumeOverlapEvaluator::PoseParameterizations
+		int nPoseParameterization;
+		// number of perturbed copies of each principal axes pose
+		int nPrincipalAxesPerturbationsNumber;
+		// max iterations per start for quasi-Newton optimization
+		int nQuasiNewtonMaxIterations;
 		// number of initial solution group
 		int nSimplexInitialSolutionGroupsNumber;
 		// max iteration for simplex optimization
 		int nSimplexMaxIterations;
+		// number of threads running simplex starts of one alignment, 0 for one per processor
+		int nSimplexThreadsCount;
+		// number of random start groups added to the start around warm start transformations
+		int nWarmStartRandomGroupsNumber;
 	};
 
 
@@ -98,6 +272,38 @@ private:
 	 */
 	struct ParameterNames
 	{
+		// for parameter "dGaussianDensityGridPadding"
+		static const std::string sGAUSSIAN_DENSITY_GRID_PADDING;
+		// for parameter "dGaussianDensityGridSpacing"
+		static const std::string sGAUSSIAN_DENSITY_GRID_SPACING;
+		// for parameter "dGaussianIntersectionVolumeEpsilon"
+		static const std::string sGAUSSIAN_INTERSECTION_VOLUME_EPSILON;
+		// for parameter "dGaussianKernelMaxRelativeError"
+		static const std::string sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR;
+		// for parameter "bGaussianKernelSinglePrecision"
+		static const std::string sGAUSSIAN_KERNEL_SINGLE_PRECISION;
+		// for parameter "nGaussianMaxIntersectionOrder"
+		static const std::string sGAUSSIAN_MAX_INTERSECTION_ORDER;
+		// for parameter "dGaussianNeighborListSkin"
+		static const std::string sGAUSSIAN_NEIGHBOR_LIST_SKIN;
+		// for parameter "nInitialPoses"
+		static const std::string sINITIAL_POSES;
+		// for parameter "nMemeticGenerationsNumber"
+		static const std::string sMEMETIC_GENERATIONS_NUMBER;
+		// for parameter "nMemeticPopulationSize"
+		static const std::string sMEMETIC_POPULATION_SIZE;
+		// for parameter "nMemeticRefinedNumber"
+		static const std::string sMEMETIC_REFINED_NUMBER;
+		// for parameter "nOptimizer"
+		static const std::string sOPTIMIZER;
+		// for parameter "nPoseParameterization"
+		static const std::string sPOSE_PARAMETERIZATION;
+		// for parameter "nPrincipalAxesPerturbationsNumber"
+		static const std::string sPRINCIPAL_AXES_PERTURBATIONS_NUMBER;
+		// for parameter "nQuasiNewtonMaxIterations"
+		static const std::string sQUASI_NEWTON_MAX_ITERATIONS;
+		// for parameter "dSimplexAbsoluteValueTolerance"
+		static const std::string sSIMPLEX_ABSOLUTE_VALUE_TOLERANCE;
 		// for parameter "dSimplexContractionFactor"
 		static const std::string sSIMPLEX_CONTRACTION_FACTOR;
 		// for parameter "dSimplexExtensionFactor"
@@ -106,8 +312,20 @@ private:
 		static const std::string sSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER;
 		// for parameter "nSimplexMaxIterations"
 		static const std::string sSIMPLEX_MAX_ITERATIONS;
+		// for parameter "dSimplexPruningFraction"
+		static const std::string sSIMPLEX_PRUNING_FRACTION;
 		// for parameter "dSimplexReflectionFactor"
 		static const std::string sSIMPLEX_REFLECTION_FACTOR;
+		// for parameter "dSimplexRelativeValueTolerance"
+		static const std::string sSIMPLEX_RELATIVE_VALUE_TOLERANCE;
+		// for parameter "dSimplexRotationTolerance"
+		static const std::string sSIMPLEX_ROTATION_TOLERANCE;
+		// for parameter "nSimplexThreadsCount"
+		static const std::string sSIMPLEX_THREADS_COUNT;
+		// for parameter "dSimplexTranslationTolerance"
+		static const std::string sSIMPLEX_TRANSLATION_TOLERANCE;
+		// for parameter "nWarmStartRandomGroupsNumber"
+		static const std::string sWARM_START_RANDOM_GROUPS_NUMBER;
 
 	private:
 		ParameterNames() {};
@@ -116,6 +334,24 @@ private:
 
 	// dimension for alignment problem (degree of freedom)
 	static const int _nDIMENSIONS;
+	// mutation magnitude of rotation angles in memetic alignment
+	static const double _dMEMETIC_MUTATION_ROTATION;
+	// mutation magnitude of translations in memetic alignment
+	static const double _dMEMETIC_MUTATION_TRANSLATION;
+	// rotation angle of a perturbed copy of a principal axes pose
+	static const double _dPRINCIPAL_AXES_PERTURBATION_ANGLE;
+	// rotation step of the simplex started from a principal axes pose
+	static const double _dPRINCIPAL_AXES_ROTATION_STEP;
+	// translation step of the simplex started from a principal axes pose
+	static const double _dPRINCIPAL_AXES_TRANSLATION_STEP;
+	// rotation step of the simplex refining a pose found on density grid
+	static const double _dREFINEMENT_ROTATION_STEP;
+	// translation step of the simplex refining a pose found on density grid
+	static const double _dREFINEMENT_TRANSLATION_STEP;
+	// rotation step of the simplex started around warm start transformations
+	static const double _dWARM_START_ROTATION_STEP;
+	// translation step of the simplex started around warm start transformations
+	static const double _dWARM_START_TRANSLATION_STEP;
 
 	// aggregation of parameters to be used in this service
 	ParametersAggregation _parameterAggregation;
@@ -128,24 +364,79 @@ public:
 
 	int configure(const CConfigurationArguments& configurationArguments);
 	double evaluateGaussianVolume(const IMolecule& molecule) const;
+	double evaluateGaussianVolume(const IMolecule& molecule, const int nMoleculeId, CSelfVolumeCache& selfVolumeCache) const;
 	double evaluateMaxGaussianVolumeOverlap(const IMolecule& refMol, const IMolecule& fitMol, std::vector<std::vector<double> >* pFitTransformations = NULL) const;
+	double evaluateMaxGaussianVolumeOverlap(const CPreparedQuery& preparedQuery, const IMolecule& fitMol, std::vector<std::vector<double> >* pFitTransformations = NULL, const std::vector<std::vector<double> >* pWarmStartTransformations = NULL) const;
 	double evaluatePocketComboSimilarity(const IMolecule& refPocketVolume, const IMolecule& refPocket, const IMolecule& fitPocketVolume, const IMolecule& fitPocket, std::vector<std::vector<double> >* pFitTransformations = NULL) const;
+	double getGaussianDensityGridPadding() const;
+	double getGaussianDensityGridSpacing() const;
+	double getGaussianIntersectionVolumeEpsilon() const;
+	double getGaussianKernelMaxRelativeError() const;
+	bool getGaussianKernelSinglePrecisionFlag() const;
+	int getGaussianMaxIntersectionOrder() const;
+	double getGaussianNeighborListSkin() const;
+	int getInitialPoses() const;
+	int getMemeticGenerationsNumber() const;
+	int getMemeticPopulationSize() const;
+	int getMemeticRefinedNumber() const;
+	int getOptimizer() const;
 	std::map<std::string, std::string> getParametersMap() const;
+	int getPoseParameterization() const;
+	int getPrincipalAxesPerturbationsNumber() const;
+	int getQuasiNewtonMaxIterations() const;
+	std::string getSelfVolumeParametersKey() const;
+	double getSimplexAbsoluteValueTolerance() const;
 	double getSimplexContractionFactor() const;
 	double getSimplexExtensionFactor() const;
 	int getSimplexInitialSolutionGroupsNumber() const;
 	int getSimplexMaxIterations() const;
+	double getSimplexPruningFraction() const;
 	double getSimplexReflectionFactor() const;
+	double getSimplexRelativeValueTolerance() const;
+	double getSimplexRotationTolerance() const;
+	int getSimplexThreadsCount() const;
+	double getSimplexTranslationTolerance() const;
+	int getWarmStartRandomGroupsNumber() const;
+	std::auto_ptr<CPreparedQuery> prepareQuery(const IMolecule& queryMolecule) const;
+	void setGaussianDensityGridPadding(double dPadding);
+	void setGaussianDensityGridSpacing(double dSpacing);
+	void setGaussianIntersectionVolumeEpsilon(double dEpsilon);
+	void setGaussianKernelMaxRelativeError(double dMaxRelativeError);
+	void setGaussianKernelSinglePrecisionFlag(bool bFlag);
+	void setGaussianMaxIntersectionOrder(int nOrder);
+	void setGaussianNeighborListSkin(double dSkin);
+	void setInitialPoses(int nInitialPoses);
+	void setMemeticGenerationsNumber(int nGenerationsNumber);
+	void setMemeticPopulationSize(int nPopulationSize);
+	void setMemeticRefinedNumber(int nRefinedNumber);
+	void setOptimizer(int nOptimizer);
+	void setPoseParameterization(int nPoseParameterization);
+	void setPrincipalAxesPerturbationsNumber(int nPerturbationsNumber);
+	void setQuasiNewtonMaxIterations(int nMaxIterations);
+	void setSimplexAbsoluteValueTolerance(double dTolerance);
 	void setSimplexContractionFactor(double dContractionFactor);
 	void setSimplexExtensionFactor(double dExtensionFactor);
 	void setSimplexInitialSolutionGroupsNumber(int nGroupsNumber);
 	void setSimplexMaxIterations(int nMaxIterations);
+	void setSimplexPruningFraction(double dFraction);
 	void setSimplexReflectionFactor(double dReflectionFactor);
+	void setSimplexRelativeValueTolerance(double dTolerance);
+	void setSimplexRotationTolerance(double dTolerance);
+	void setSimplexThreadsCount(int nThreadsCount);
+	void setSimplexTranslationTolerance(double dTolerance);
+	void setWarmStartRandomGroupsNumber(int nGroupsNumber);
 private:
+	static double calculateSelfVolume(const CGaussianVolume::PreparedMolecule& preparedMolecule, const CGaussianVolume::MoleculePrecalculation& precalculation, const double dIntersectionVolumeEpsilon);
 	int generateInitialSolutionGroups(int nGroups, int nSolutionsPerGroup, std::vector<std::vector<std::vector<double> > >& initialSolutionGroups) const;
+	int generatePrincipalAxesSolutionGroups(const CPreparedQuery& preparedQuery, const IMolecule& fitMolecule, std::vector<std::vector<std::vector<double> > >& initialSolutionGroups) const;
+	int generateRefinementSolutionGroups(const std::vector<double>& centerPoint, std::vector<std::vector<std::vector<double> > >& refinementSolutionGroups) const;
+	int generateWarmStartSolutionGroups(const CPreparedQuery& preparedQuery, const std::vector<std::vector<double> >& warmStartTransformations, std::vector<std::vector<std::vector<double> > >& initialSolutionGroups) const;
 	int initialize();
+	int initKernelSettings(CGaussianVolumeOverlapEvaluator& overlapEvaluator) const;
 	int initParameters();
 	int initParameters(const CConfigurationArguments& configArguments);
+	int initSimplexOptimizer(CSimplexOptimizer& simplexOptimizer) const;
+	int runMemeticOptimization(const CPreparedQuery& preparedQuery, const IMolecule& fitMolecule, const std::vector<std::vector<std::vector<double> > >& initialSolutionGroups, IFunctionValueEvaluator& overlapEvaluator, std::vector<double>& resultPoint, double& dResultValue) const;
 };
 
 
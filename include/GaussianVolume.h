@@ -18,11 +18,11 @@
 
 #include <list>
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
 
+class CCrossNeighborList;
 class IAtom;
 class IMolecule;
 
@@ -44,52 +44,128 @@ public:
 	};
 
 
+	/**
+	 * Description: Precalculation result of a single molecule, independent of the molecule it will be overlapped with.
+	 */
+	struct MoleculePrecalculation
+	{
+		// alpha values
+		std::vector<double> alphaValues;
+		// specify the Gaussian cutoff value used to calculate this result
+		double dGaussianCutoff;
+		// max number of atoms of this molecule in one intersection cluster
+		int nMaxIntersectionOrder;
+		// neighbor atom IDs list (monotone), in ascending order
+		std::vector<std::vector<int> > neighborAtomIds;
+		// square distances to neighbor atoms, in the same order as neighborAtomIds
+		std::vector<std::vector<double> > neighborSquareDistances;
+	};
+
+
 	/**
 	 * Description:
 	 */
 	struct PrecalculationResult
 	{
-		// alpha values for fit molecule
-		std::vector<double> alphaValuesForFit;
-		// alpha values for reference molecule
-		std::vector<double> alphaValuesForRef;
 		// specify the Gaussian cutoff value used to calculate this result
 		double dGaussianCutoff;
-		// IDs set for pair-wise intersected atoms of fit molecule at each order
-		std::vector<std::vector<std::set<int> > > intersectedAtomIdsForFit;
-		// IDs set for pair-wise intersected atoms of reference molecule at each order
-		std::vector<std::vector<std::set<int> > > intersectedAtomIdsForRef;
-		// square distances matrix for fit molecule
-		std::vector<std::vector<double> > squareDistancesMatrixForFit;
-		// square distances matrix for reference molecule
-		std::vector<std::vector<double> > squareDistancesMatrixForRef;
-		// neighbor atom IDs list (monotone) for fit molecule
-		std::vector<std::set<int> > neighborAtomIdsForFit;
-		// neighbor atom IDs list (monotone) for reference molecule
-		std::vector<std::set<int> > neighborAtomIdsForRef;
+		// precalculation result for fit molecule
+		MoleculePrecalculation fitPrecalculation;
+		// precalculation result for reference molecule
+		MoleculePrecalculation refPrecalculation;
 	};
 
 
-private:
 	/**
-	 * Description:
+	 * Description: Contiguous (structure of arrays) atoms data of a molecule, consumed by the overlap kernel.
 	 */
-	class CIntersectedAtomsFilter
+	struct PreparedMolecule
 	{
-		/* data: */
-	public:
-		CIntersectedAtomsFilter(const std::vector<std::set<int> >* pNeighborAtomIds);
-	private:
-		// neighbor atom IDs list
-		const std::vector<std::set<int> >* _pNeighborAtomIds;
+		// alpha values of atoms
+		std::vector<double> alphaValues;
+		// radii of block bounding spheres, enclosing the atom spheres of each block
+		std::vector<double> blockRadii;
+		// start atom ID of each block of contiguous atoms, with an extra element marking the end of the last block
+		std::vector<int> blockStarts;
+		// X coordinates of block bounding sphere centers
+		std::vector<double> blockXCenters;
+		// Y coordinates of block bounding sphere centers
+		std::vector<double> blockYCenters;
+		// Z coordinates of block bounding sphere centers
+		std::vector<double> blockZCenters;
+		// radius of the bounding sphere enclosing all atom spheres
+		double dBoundingRadius;
+		// X coordinate of bounding sphere center
+		double dBoundingXCenter;
+		// Y coordinate of bounding sphere center
+		double dBoundingYCenter;
+		// Z coordinate of bounding sphere center
+		double dBoundingZCenter;
+		// alpha values of radius classes, indexed by radius class ID
+		std::vector<double> classAlphaValues;
+		// distinct radii of atoms, indexed by radius class ID
+		std::vector<double> classRadii;
+		// single precision copy of alphaValues, for float kernels
+		std::vector<float> floatAlphaValues;
+		// single precision copy of radii
+		std::vector<float> floatRadii;
+		// single precision copy of xCoordinates
+		std::vector<float> floatXCoordinates;
+		// single precision copy of yCoordinates
+		std::vector<float> floatYCoordinates;
+		// single precision copy of zCoordinates
+		std::vector<float> floatZCoordinates;
+		// radii of atoms
+		std::vector<double> radii;
+		// radius class IDs of atoms, indexing classRadii
+		std::vector<int> radiusClassIds;
+		// X coordinates of atoms
+		std::vector<double> xCoordinates;
+		// Y coordinates of atoms
+		std::vector<double> yCoordinates;
+		// Z coordinates of atoms
+		std::vector<double> zCoordinates;
+	};
 
-		/* method: */
-	public:
-		inline bool operator()(const std::set<int>& atomIdsSet) const;
-	private:
+
+private:
+	/**
+	 * Description: State of a depth first inclusion-exclusion expansion, shared by all its recursive steps. A cluster holds atoms of
+	 *	both molecules which are pair-wise neighbors, it is grown one atom at a time, reference atoms first, in ascending ID order.
+	 */
+	struct ClusterExpansion
+	{
+		// candidate atoms to add next to fit part of cluster, index: number of fit atoms in cluster, value: ascending fit atom IDs
+		std::vector<std::vector<int> > candidateFitAtomIds;
+		// candidate atoms to add next to reference part of cluster, index: number of reference atoms in cluster
+		std::vector<std::vector<int> > candidateRefAtomIds;
+		// fit atoms being neighbors of all reference atoms in cluster, index: number of reference atoms in cluster
+		std::vector<std::vector<int> > crossCandidateFitAtomIds;
+		// clusters with intersection volume below this value are dropped, and subtrees no cluster of which can reach it are pruned
+		double dEpsilon;
+		// smallest alpha value of both molecules, bounding the volumes of clusters grown from a cluster
+		double dMinAlpha;
+		// accumulated overlap volume
+		double dOverlapVolume;
+		// fit atoms in cluster
+		std::vector<int> fitAtomIds;
+		// max number of atoms of each molecule in cluster
+		int nMaxIntersectionOrder;
+		// cross neighbor atom IDs, index: reference atom ID, value: ascending fit atom IDs
+		const std::vector<std::vector<int> >* pCrossNeighborAtomIds;
+		// square distances in the same order as pCrossNeighborAtomIds
+		const std::vector<std::vector<double> >* pCrossNeighborSquareDistances;
+		// precalculation result for fit molecule
+		const MoleculePrecalculation* pFitPrecalculation;
+		// precalculation result for reference molecule
+		const MoleculePrecalculation* pRefPrecalculation;
+		// reference atoms in cluster
+		std::vector<int> refAtomIds;
 	};
 
 
+	// max number of contiguous atoms in a bounding block
+	static const int _nBLOCK_ATOMS_COUNT;
 	// p constant
 	static const double _dP;
 	// partial alpha constant
@@ -99,43 +175,56 @@ private:
 
 	// Gaussian cutoff value
 	double _dGaussianCutoff;
+	// intersection volume below which a cluster and all clusters grown from it are dropped
+	double _dIntersectionVolumeEpsilon;
 	// auto storage for fit atoms, could be NULL pointer
 	mutable std::auto_ptr<std::vector<IAtom*> > _fitAtomsPtr;
-	// neighbor atom IDs (between reference and fit molecule, cross neighbors), index: reference atom ID, value: fit atom IDs
-	std::vector<std::set<int> > _neighborAtomIds;
-	// atoms for fit molecule
+	// neighbor atom IDs (between reference and fit molecule, cross neighbors), index: reference atom ID, value: ascending fit atom IDs
+	std::vector<std::vector<int> > _neighborAtomIds;
+	// square distances between reference and fit neighbor atoms, in the same order as _neighborAtomIds
+	std::vector<std::vector<double> > _neighborSquareDistances;
+	// atoms for fit molecule, could be NULL pointer if constructed from prepared molecules
 	const std::vector<IAtom*>* _pFitAtoms;
-	// precalculation result
-	const PrecalculationResult* _pPrecalculationResult;
-	// atoms for reference molecule
+	// precalculation result for fit molecule
+	const MoleculePrecalculation* _pFitPrecalculation;
+	// atoms for reference molecule, could be NULL pointer if constructed from prepared molecules
 	const std::vector<IAtom*>* _pRefAtoms;
-	// square distances between reference and fit atoms, row index: reference atom ID, column index: fit atom ID
-	std::vector<std::vector<double> > _squareDistancesMatrix;
+	// precalculation result for reference molecule
+	const MoleculePrecalculation* _pRefPrecalculation;
 
 	/* method: */
 public:
 	CGaussianVolume();
 	CGaussianVolume(const CGaussianVolume& volume);
-	CGaussianVolume(const std::vector<IAtom*>* pRefAtoms, const std::vector<IAtom*>* pFitAtoms, const CGaussianVolume::PrecalculationResult* pPrecalculationResult);
-	CGaussianVolume(const std::vector<IAtom*>* pRefAtoms, const IMolecule* pFitMolecule, const CGaussianVolume::PrecalculationResult* pPrecalculationResult);
+	CGaussianVolume(const std::vector<IAtom*>* pRefAtoms, const std::vector<IAtom*>* pFitAtoms, const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation, const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation);
+	CGaussianVolume(const std::vector<IAtom*>* pRefAtoms, const IMolecule* pFitMolecule, const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation, const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation);
+	CGaussianVolume(const CGaussianVolume::PreparedMolecule* pRefMolecule, const CGaussianVolume::PreparedMolecule* pFitMolecule, const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation, const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation, const CCrossNeighborList* pNeighborList = NULL);
 	~CGaussianVolume();
 
+	static bool areBoundingSpheresApart(const PreparedMolecule& refMol, const PreparedMolecule& fitMol, const double dGaussianCutoff);
+	static int calculatePrincipalAxes(const PreparedMolecule& preparedMolecule, std::vector<double>& center, std::vector<std::vector<double> >& axes);
+	static int prepareMolecule(const IMolecule& molecule, PreparedMolecule& preparedMolecule);
 	static int precalculate(const IMolecule& refMol, const IMolecule& fitMol, const double dGaussianCutoff, const int nMaxIntersectionOrder, PrecalculationResult& precalculationResult);
+	static int precalculateMolecule(const IMolecule& molecule, const double dGaussianCutoff, const int nMaxIntersectionOrder, MoleculePrecalculation& moleculePrecalculation);
 	double getOverlapVolume(const IMolecule& refMol, const IMolecule& fitMol) const;
+	double getOverlapVolume(const PreparedMolecule& refMol, const PreparedMolecule& fitMol) const;
 	double getOverlapVolume() const;
 	double getReferenceVolume() const;
 	double getGaussianCutoff() const;
+	double getIntersectionVolumeEpsilon() const;
 	void setGaussianCutoff(double dCutoff);
+	void setIntersectionVolumeEpsilon(const double dEpsilon);
 private:
-	inline double calculateAtomIntersectionVolume(const std::set<int>& refAtomIdsSet, const std::set<int>& fitAtomIdsSet) const;
-	template <typename TFilter>
-	static int combineElements(const std::set<int>::const_iterator iterCurrent, const std::set<int>::const_iterator& iterEnd, const int nElementsLeft, const int nElementsToSelect, const TFilter& filter, const std::set<int>& currentCombination, std::vector<std::set<int> >& resultCombinations);
-	static int enumerateIntersectedAtomIds(const std::vector<std::set<int> >& neighborAtomIds, const int nIntersectedAtoms, std::vector<std::set<int> >& intersectedAtomIds);
-	inline static bool isIntersectedAtomsByCrossNeighbors(const std::set<int>& idsSetAsKeys, const std::set<int>& idsSetAsValues, const std::vector<std::set<int> >& neighborAtomIds);
-	inline static bool isIntersectedAtomsByMonotoneNeighbors(const std::set<int>& idsSet, const std::vector<std::set<int> >& neighborAtomIds);
-	inline static bool isIntersectedAtomsByMonotoneNeighbors(const std::set<int>& idsSetAsKeys, const std::set<int>& idsSetAsValues, const std::vector<std::set<int> >& neighborAtomIds);
-	int initializeIntermolecularInformation();
-	static int precalculateMolecule(const IMolecule& molecule, const double dGaussianCutoff, const int nMaxIntersectionOrder, std::vector<double>& alphaValues, std::vector<std::vector<double> >& squareDistancesMatrix, std::vector<std::set<int> >& neighborAtomIds, std::vector<std::vector<std::set<int> > >& intersectedAtomIds);
+	static int calculateBoundingSphere(const PreparedMolecule& preparedMolecule, const int nStartAtomId, const int nEndAtomId, double& dCenterX, double& dCenterY, double& dCenterZ, double& dRadius);
+	static double expandClusters(const MoleculePrecalculation& refPrecalculation, const MoleculePrecalculation& fitPrecalculation, const std::vector<std::vector<int> >& crossNeighborAtomIds, const std::vector<std::vector<double> >& crossNeighborSquareDistances, const double dEpsilon);
+	static void expandFitCluster(ClusterExpansion& expansion, const int nRefAtoms, const int nFitAtoms, const double dAlphaSum, const double dExponent, const double dPrefactor);
+	static void expandRefCluster(ClusterExpansion& expansion, const int nRefAtoms, const double dAlphaSum, const double dExponent, const double dPrefactor);
+	inline static double getNeighborSquareDistance(const std::vector<std::vector<int> >& neighborAtomIds, const std::vector<std::vector<double> >& neighborSquareDistances, const int nAtomId, const int nNeighborAtomId);
+	inline static double getClusterVolume(const double dAlphaSum, const double dExponent, const double dPrefactor);
+	static double getClusterVolumeBound(const double dClusterVolume, const double dAlphaSum, const int nMaxAddedAtoms, const double dMinAlpha);
+	static int prepareAtoms(const std::vector<IAtom*>& atoms, PreparedMolecule& preparedMolecule);
+	static int prepareBoundingSpheres(PreparedMolecule& preparedMolecule);
+	int initializeIntermolecularInformation(const PreparedMolecule& refMolecule, const PreparedMolecule& fitMolecule, const CCrossNeighborList* pNeighborList);
 };
 
 
@@ -161,6 +250,7 @@ private:
 	struct DefaultValues
 	{
 		static const double dGAUSSIAN_CUTOFF;
+		static const double dINTERSECTION_VOLUME_EPSILON;
 		static const int nMAX_INTERSECTION_ORDER;
 
 	private:
@@ -172,6 +262,8 @@ private:
 	bool _bInitForPrecalculationResult;
 	// Gaussian cutoff applied to calculate the Gaussian volume
 	double _dGaussianCutoff;
+	// intersection volume epsilon applied to calculate the Gaussian volume
+	double _dIntersectionVolumeEpsilon;
 	// atoms for fit molecule
 	std::vector<IAtom*> _fitAtoms;
 	// max intersection order to expand when calculating Gaussian volume
@@ -182,85 +274,33 @@ private:
 	const IMolecule* _pRefMolecule;
 	// precalculation result
 	CGaussianVolume::PrecalculationResult _precalculationResult;
+	// precalculation result for reference molecule in use, either shared by caller or pointing into _precalculationResult
+	const CGaussianVolume::MoleculePrecalculation* _pRefPrecalculation;
+	// precalculation result for reference molecule shared by caller, could be NULL pointer
+	const CGaussianVolume::MoleculePrecalculation* _pSharedRefPrecalculation;
 	// atoms for reference molecule
 	std::vector<IAtom*> _refAtoms;
 
 	/* method: */
 public:
 	CGaussianVolumeBuilder(const IMolecule* pRefMolecule, const IMolecule* pFitMolecule);
+	CGaussianVolumeBuilder(const IMolecule* pRefMolecule, const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation, const IMolecule* pFitMolecule);
 	~CGaussianVolumeBuilder();
 
-	inline CGaussianVolume build();
-	inline CGaussianVolume build(const IMolecule* pFitMolecule);
+	CGaussianVolume build();
+	CGaussianVolume build(const IMolecule* pFitMolecule);
+	CGaussianVolume build(const CGaussianVolume::PreparedMolecule* pRefMolecule, const CGaussianVolume::PreparedMolecule* pFitMolecule, const CCrossNeighborList* pNeighborList = NULL);
 	double getGaussianCutoff() const;
+	double getIntersectionVolumeEpsilon() const;
 	int getMaxIntersectionOrder() const;
 	void setGaussianCutoff(const double dCutoff);
+	void setIntersectionVolumeEpsilon(const double dEpsilon);
 	void setMaxIntersectionOrder(const int nOrder);
 private:
 	inline int attemptInitialize();
+	int init(const IMolecule* pRefMolecule, const IMolecule* pFitMolecule);
 };
 
 
-/* Template implementation for CGaussianVolume class: */
-
-/**
- * Description:
- * @template TFilter:
- */
-template <typename TFilter>
-int CGaussianVolume::combineElements(
-	const std::set<int>::const_iterator iterCurrent,
-	const std::set<int>::const_iterator& iterEnd,
-	const int nElementsLeft,
-	const int nElementsToSelect,
-	const TFilter& filter,
-	const std::set<int>& currentCombination,
-	std::vector<std::set<int> >& resultCombinations
-	)
-{
-	// If not enough elements to select
-	if (nElementsLeft < nElementsToSelect)
-	{
-		return 1;
-	}
-	// If enough elements to select
-	else
-	{
-		// If selection done:
-		if (nElementsToSelect == 0)
-		{
-			/* Add current combination to result set. */
-			if (filter(currentCombination))
-			{
-				resultCombinations.push_back(currentCombination);
-				return 0;
-			}
-		}
-		// If need to select more:
-		else
-		{
-			for (std::set<int>::const_iterator iterStart = iterCurrent; iterStart != iterEnd;)
-			{
-				/* Select current element and search more. */
-				std::set<int> combinationCopy = currentCombination;
-				combinationCopy.insert(*iterStart);
-
-				combineElements(
-					++ iterStart,
-					iterEnd,
-					nElementsLeft - 1,
-					nElementsToSelect -1,
-					filter,
-					combinationCopy,
-					resultCombinations
-					);
-			}
-		}
-	}
-
-	return 1;
-}
-
-
 //
 #endif
@@ -16,9 +16,14 @@
 //
 
 
+#include "CrossNeighborList.h"
+#include "GaussianDensityGrid.h"
+#include "GaussianOverlapKernel.h"
 #include "GaussianVolume.h"
-#include "InterfaceFunctionValueEvaluator.h"
+#include "InterfaceCloneable.h"
+#include "InterfaceGradientEvaluator.h"
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -29,12 +34,27 @@ class IMolecule;
 
 
 /**
- * Description: Gaussian volume fitness evaluator used for genetic optimization.
+ * Description: Gaussian volume fitness evaluator used for genetic optimization, also providing the gradient with respect to the
+ *	transformation parameters for derivative based optimizers. Clones share nothing mutable with the original, so that optimizers
+ *	may evaluate on one clone per thread, and batches of points may be evaluated across threads on clones kept by the evaluator.
  */
-class CGaussianVolumeOverlapEvaluator : public IFunctionValueEvaluator
+class CGaussianVolumeOverlapEvaluator : public IGradientEvaluator, public ICloneable
 {
 	/* data: */
 public:
+	/* Parameterizations of the rotation part of a pose, params[3], params[4] and params[5]. */
+	struct PoseParameterizations
+	{
+		// rotation angles along X, Y and Z axis, applied in turn
+		static const int nEULER_ANGLES;
+		// rotation axis scaled by rotation angle
+		static const int nROTATION_VECTOR;
+
+	private:
+		PoseParameterizations() {};
+	};
+
+
 private:
 	/* Error codes. */
 	struct ErrorCodes
@@ -51,7 +71,11 @@ private:
 	{
 		static const bool bNEGATIVE_OVERLAP;
 		static const double dGAUSSIAN_CUTOFF;
+		static const double dINTERSECTION_VOLUME_EPSILON;
 		static const int nMAX_INTERSECTION_ORDER;
+		static const double dNEIGHBOR_LIST_SKIN;
+		static const int nPOSE_PARAMETERIZATION;
+		static const int nTHREADS_COUNT;
 
 	private:
 		DefaultValues() {};
@@ -62,33 +86,97 @@ private:
 	bool _bInitForGaussianVolumeBuilder;
 	// a flag indicating whether to calculate the negative Gaussian overlap volume
 	bool _bNegativeOverlap;
+	// a flag indicating whether the reference molecule is a clone owned by this evaluator
+	bool _bOwnRefMolecule;
+	// counters of atom pairs skipped by bounding sphere culling, accumulated over evaluations
+	CGaussianOverlapKernel::CullingCounters _cullingCounters;
 	// Gaussian cutoff
 	double _dGaussianCutoff;
+	// intersection volume below which a cluster is dropped when expanding higher order overlap
+	double _dIntersectionVolumeEpsilon;
+	// channel ID of the density grid for each radius class of fit molecule
+	std::vector<int> _densityGridChannelIds;
+	// skin distance of cross neighbor list, 0 for testing all atom pairs on each evaluation
+	double _dNeighborListSkin;
+	// prepared fit molecule before transformation
+	CGaussianVolume::PreparedMolecule _fitPreparedMolecule;
+	// preallocated buffer receiving the transformed fit molecule
+	CGaussianVolume::PreparedMolecule _fitPreparedMoleculeBuffer;
+	// preallocated buffers receiving overlap derivatives with respect to the position of each fit atom, along X, Y and Z axis
+	std::vector<double> _fitXGradients;
+	std::vector<double> _fitYGradients;
+	std::vector<double> _fitZGradients;
 	// Gaussian volume builder
 	CGaussianVolumeBuilder _gVolumeBuilder;
+	// accuracy and precision mode of the first order overlap kernel
+	CGaussianOverlapKernel::CSettings _kernelSettings;
 	// max intersection order to expand when calculating Gaussian volume
 	int _nMaxIntersectionOrder;
+	// parameterization of rotation in transformation parameters, see PoseParameterizations
+	int _nPoseParameterization;
+	// number of threads evaluating a batch of points, 0 for one per processor
+	int _nThreadsCount;
+	// cross neighbor list reused across evaluations, could be NULL pointer if disabled
+	std::auto_ptr<CCrossNeighborList> _neighborListPtr;
+	// density grid of reference molecule used as first order overlap backend, could be NULL pointer for the analytic kernel
+	const CGaussianDensityGrid* _pDensityGrid;
 	// fit molecule
 	const IMolecule* _pFitMolecule;
 	// reference molecule
 	const IMolecule* _pRefMolecule;
+	// precalculation result of reference molecule shared by caller, could be NULL pointer if reference molecule is owned
+	const CGaussianVolume::MoleculePrecalculation* _pRefPrecalculation;
+	// prepared reference molecule in use, either shared by caller or pointing to _refPreparedMolecule
+	const CGaussianVolume::PreparedMolecule* _pRefPreparedMolecule;
+	// prepared reference molecule owned by this evaluator
+	CGaussianVolume::PreparedMolecule _refPreparedMolecule;
+	// clones evaluating batches of points along with this evaluator, one per extra thread, owned by this evaluator
+	std::vector<CGaussianVolumeOverlapEvaluator*> _workerEvaluators;
 
 	/* method: */
 public:
 	CGaussianVolumeOverlapEvaluator(const IMolecule& refMolecule, const IMolecule& fitMolecule);
+	CGaussianVolumeOverlapEvaluator(const IMolecule& refMolecule, const CGaussianVolume::PreparedMolecule& refPreparedMolecule, const CGaussianVolume::MoleculePrecalculation& refPrecalculation, const IMolecule& fitMolecule);
 	virtual ~CGaussianVolumeOverlapEvaluator();
 
+	const CGaussianOverlapKernel::CullingCounters& getCullingCounters() const;
+	const CGaussianDensityGrid* getDensityGrid() const;
 	double getGaussianCutoff() const;
+	double getIntersectionVolumeEpsilon() const;
+	const CGaussianOverlapKernel::CSettings& getKernelSettings() const;
 	int getMaxIntersectionOrder() const;
 	bool getNegativeOverlapFlag() const;
+	const CCrossNeighborList* getNeighborList() const;
+	double getNeighborListSkin() const;
+	int getPoseParameterization() const;
+	int getThreadsCount() const;
+	void setDensityGrid(const CGaussianDensityGrid* pDensityGrid);
 	void setGaussianCutoff(const double dCutoff);
+	void setIntersectionVolumeEpsilon(const double dEpsilon);
+	void setKernelSettings(const CGaussianOverlapKernel::CSettings& kernelSettings);
 	void setMaxIntersectionOrder(const int nOrders);
 	void setNegativeOverlapFlag(const bool bFlag);
+	void setNeighborListSkin(const double dSkin);
+	void setPoseParameterization(const int nPoseParameterization);
+	void setThreadsCount(const int nThreadsCount);
+
+	/* Implementation for ICloneable interface: */
+	virtual ICloneable* clone() const;
 
 	/* Implementation for IFunctionValueEvaluator interface: */
 	virtual double getFunctionValue(const std::vector<double>& params);
+	virtual void getFunctionValues(const std::vector<std::vector<double> >& points, std::vector<double>& values);
+
+	/* Implementation for IGradientEvaluator interface: */
+	virtual double getFunctionValueAndGradient(const std::vector<double>& params, std::vector<double>& gradient);
 private:
+	CGaussianVolumeOverlapEvaluator(const CGaussianVolumeOverlapEvaluator& evaluator);
+	CGaussianVolumeOverlapEvaluator& operator=(const CGaussianVolumeOverlapEvaluator& evaluator);
+
 	inline int attemptInitialize();
+	inline void getRigidTransformation(const std::vector<double>& params, double aadTransformation[3][4]) const;
+	int getWorkersCount(const int nPointsCount) const;
+	inline int transformFitAtomCoordinates(const std::vector<double>& params);
 };
 
 
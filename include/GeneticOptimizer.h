@@ -16,6 +16,7 @@
 //
 
 
+#include "InterfaceCloneable.h"
 #include "InterfaceFunctionValueEvaluator.h"
 
 #include <string>
@@ -23,7 +24,9 @@
 
 
 /**
- * Description:
+ * Description: Genetic optimizer maximizing fitness. Random numbers come from a stream of the optimizer seeded by setRandomSeed(),
+ *	drawn on the calling thread only, and fitness of a population may be evaluated across threads, so that a run is reproduced
+ *	exactly from its seed whatever the number of threads.
  */
 class CGeneticOptimizer
 {
@@ -62,8 +65,20 @@ private:
 	std::vector<std::vector<double> > _newPopulation;
 	// fitness of individuals in current population
 	std::vector<double> _populationFitness;
+	// number of fittest individuals surviving unchanged to the next generation
+	int _nElitesCount;
 	// upper limit for iterations
 	int _nMaxIterations;
+	// seed of random numbers stream, each run restarts the stream from it
+	unsigned int _nRandomSeed;
+	// state of random numbers stream
+	unsigned long long _nRandomState;
+	// number of threads evaluating fitness of a population, 0 for one per processor
+	int _nThreadsCount;
+	// evaluator clones owned by this optimizer, one per extra thread
+	std::vector<ICloneable*> _workerClones;
+	// evaluators of extra threads, the same objects as _workerClones
+	std::vector<IFunctionValueEvaluator*> _workerEvaluators;
 
 	
 	/* Message string: */
@@ -88,8 +103,12 @@ private:
 		static const double dDEFAULT_MUTATION_MAGNITUDE_PERCENTAGE;
 		// mutation probability
 		static const double dMUTATION_PROBABILITY;
+		// number of elites
+		static const int nELITES_COUNT;
 		//
 		static const int nMAX_ITERATIONS;
+		// number of threads evaluating fitness
+		static const int nTHREADS_COUNT;
 
 	private:
 		DefaultValues();
@@ -103,23 +122,35 @@ public:
 	int runOptimization(std::vector<double>& resultants, double& dBestFitness);
 	int traceOptimization(std::vector<std::vector<double> >& trajectory);
 
+	int getBestIndividuals(const int nCount, std::vector<std::vector<double> >& individuals, std::vector<double>& fitness) const;
 	double getCrossoverProbability() const;
+	int getElitesCount() const;
 	const std::vector<double>& getMutationMagnitude() const;
 	int getMaxIterations() const;
 	double getMutationProbability() const;
+	unsigned int getRandomSeed() const;
+	int getThreadsCount() const;
 
 	void setCrossoverProbability(double dProbability);
+	void setElitesCount(int nElitesCount);
 	void setMaxIterations(int nMaxIterations);
 	void setMutationMagnitude(const std::vector<double>& mutationMagnitude);
 	void setMutationMagnitudeByPercentage(double dPercentage);
 	void setMutationProbability(double dProbability);
+	void setRandomSeed(unsigned int nSeed);
+	void setThreadsCount(int nThreadsCount);
 private:
+	CGeneticOptimizer(const CGeneticOptimizer& optimizer);
+	CGeneticOptimizer& operator=(const CGeneticOptimizer& optimizer);
+
 	int crossover(const std::vector<double>& oldChromosome1, const std::vector<double>& oldChromosome2, std::vector<double>& newChromosome1, std::vector<double>& newChromosome2);
 	int getBestIndividualId() const;
+	double getRandomNumber();
+	int getWorkersCount() const;
 	int mutateNewPopulation(double dAttenuation);
-	int randomCompetitionSelectIndividual() const;
+	int randomCompetitionSelectIndividual();
 	int replaceCurrentPopulation();
-	int rouletteSelectIndividual() const;
+	int rouletteSelectIndividual();
 	int updatePopulationFitness();
 };
 
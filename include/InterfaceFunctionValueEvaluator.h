@@ -32,6 +32,22 @@ public:
 	 */
 	virtual double getFunctionValue(const std::vector<double>& params) = 0;
 
+	/**
+	 * Description: Get the function values at a batch of points, for optimizers evaluating several points at once. Implementations
+	 *	may evaluate points concurrently, but values must be the same as those of getFunctionValue(). By default points are
+	 *	evaluated one after another by getFunctionValue().
+	 * @param points: (IN) Coordinates of the points at which to evaluate function values.
+	 * @param values: (OUT) Function values at each point, resized to the number of points.
+	 */
+	virtual void getFunctionValues(const std::vector<std::vector<double> >& points, std::vector<double>& values)
+	{
+		values.resize(points.size());
+		for (int iPoint = 0; iPoint < static_cast<int>(points.size()); ++ iPoint)
+		{
+			values[iPoint] = getFunctionValue(points[iPoint]);
+		}
+	}
+
 	virtual ~IFunctionValueEvaluator(){};
 };
 
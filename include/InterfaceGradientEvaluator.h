@@ -0,0 +1,43 @@
+/**
+ * Gradient Evaluator Interface Definition
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file InterfaceGradientEvaluator.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-14
+ */
+
+
+#ifndef INTERFACE_GRADIENT_EVALUATOR_INCLUDE_H
+#define INTERFACE_GRADIENT_EVALUATOR_INCLUDE_H
+//
+
+
+#include "InterfaceFunctionValueEvaluator.h"
+
+#include <vector>
+
+
+/**
+ * Description: Evaluate the function value together with its gradient at a given point, for derivative based optimizers.
+ */
+class IGradientEvaluator : public IFunctionValueEvaluator
+{
+public:
+	/**
+	 * Description: Get the function value and gradient at a specified point in one pass.
+	 * @param params: Coordinate of the point at which to evaluate.
+	 * @param gradient: (OUT) Partial derivatives of the function with respect to each coordinate, resized to the dimension of params.
+	 * @return: Function value at specified point.
+	 */
+	virtual double getFunctionValueAndGradient(const std::vector<double>& params, std::vector<double>& gradient) = 0;
+
+	virtual ~IGradientEvaluator(){};
+};
+
+
+//
+#endif
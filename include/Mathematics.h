@@ -62,11 +62,15 @@ private:
 
 	/* method: */
 public:
+	static int diagonalizeSymmetricMatrix(const std::vector<std::vector<double> >& matrix, std::vector<double>& eigenValues, std::vector<std::vector<double> >& eigenVectors);
+	static int eulerAnglesToRotationMatrix(const double adAngles[3], double aadRotation[3][3]);
 	static int factorial(int n);
 	static double getPiValue();
 	static double pointToLineSquareDistance(const std::vector<double>& point, const std::vector<double>& lineVector);
 	static double pointToPointSquareDistance(const std::vector<double>& position1, const std::vector<double>& position2);
 	static int rectangularToSphericalCoordinate(const std::vector<double>& srcVector, std::vector<double>& dstVector);
+	static int rotationMatrixToRotationVector(const double aadRotation[3][3], double adRotationVector[3]);
+	static int rotationVectorToRotationMatrix(const double adRotationVector[3], double aadRotation[3][3]);
 	static int sphericalToRectanglularCoordinate(const std::vector<double>& srcVector, std::vector<double>& dstVector);
 
 	template <typename T>
@@ -27,7 +27,8 @@ class IMolecule;
 
 
 /**
- * Description:
+ * Description: Evaluate the RMSD of optimally assigned pocket atoms. Evaluations only read the molecules given on construction, so
+ *	batches of points may be evaluated across threads.
  */
 class CPocketComboSimilarityEvaluator : public IFunctionValueEvaluator
 {
@@ -42,6 +43,8 @@ private:
 	const std::auto_ptr<IMolecule> _pocketVolumeFitPtr;
 	// molecule representation of the volume (negative image) of reference pocket
 	const std::auto_ptr<IMolecule> _pocketVolumeRefPtr;
+	// number of threads evaluating a batch of points, 0 for one per processor
+	int _nThreadsCount;
 	// all atoms of reference pocket
 	std::vector<IAtom*> _refPocketAtomsVector;
 
@@ -50,8 +53,12 @@ public:
 	CPocketComboSimilarityEvaluator(const IMolecule& pocketVolumeRef, const IMolecule& pocketRef, const IMolecule& pocketVolumeFit, const IMolecule& pocketFit);
 	virtual ~CPocketComboSimilarityEvaluator();
 
+	int getThreadsCount() const;
+	void setThreadsCount(const int nThreadsCount);
+
 	/* Implementation for IFunctionValueEvaluator interface: */
 	virtual double getFunctionValue(const std::vector<double>& params);
+	virtual void getFunctionValues(const std::vector<std::vector<double> >& points, std::vector<double>& values);
 private:
 };
 
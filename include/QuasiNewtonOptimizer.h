@@ -0,0 +1,114 @@
+/**
+ * Quasi-Newton Optimizer Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file QuasiNewtonOptimizer.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-16
+ */
+
+
+#ifndef QUASI_NEWTON_OPTIMIZER_INCLUDE_H
+#define QUASI_NEWTON_OPTIMIZER_INCLUDE_H
+//
+
+
+#include "InterfaceGradientEvaluator.h"
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Description: Limited memory BFGS minimizer with backtracking line search, run from each of several initial solutions like
+ *	CSimplexOptimizer. The inverse Hessian is approximated by the latest pairs of steps and gradient changes, a history at least as
+ *	long as the dimension gives plain BFGS. Each start stops when the largest gradient component or the relative improvement of one
+ *	iteration falls below its tolerance, or after the max number of iterations.
+ */
+class CQuasiNewtonOptimizer
+{
+	/* data: */
+public:
+	/* Error code: */
+	struct ErrorCodes
+	{
+		static const int nNORMAL;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+private:
+	/* Default value: */
+	struct DefaultValues
+	{
+		static const double dGRADIENT_TOLERANCE;
+		static const double dIMPROVEMENT_TOLERANCE;
+		static const double dMAX_STEP_LENGTH;
+		static const int nHISTORY_SIZE;
+
+	private:
+		DefaultValues();
+	};
+
+	/* Message text: */
+	struct MessageTexts
+	{
+		static const std::string sDIMENSION_NOT_MATCH;
+		static const std::string sPARAMETER_OUT_OF_RANGE;
+
+	private:
+		MessageTexts();
+	};
+
+
+	// max backtracking steps of one line search
+	static const int _nMAX_BACKTRACKING_STEPS;
+	// sufficient decrease coefficient of Armijo condition
+	static const double _dSUFFICIENT_DECREASE_FACTOR;
+
+	// initial feasible soulutions, one per start
+	const std::vector<std::vector<double> > _INITIAL_FEASIBLE_SOLUTIONS;
+	// largest gradient component below which a start is converged
+	double _dGradientTolerance;
+	// relative improvement of one iteration below which a start is converged
+	double _dImprovementTolerance;
+	// max length of one step, trial steps longer than it are shortened
+	double _dMaxStepLength;
+	// reference of an external gradient evaluator
+	IGradientEvaluator& _gradientEvaluator;
+	// number of evaluations of the last optimization
+	int _nEvaluationsCount;
+	// number of pairs of steps and gradient changes kept
+	int _nHistorySize;
+	// dimension of the optimization problem
+	const int _nPROBLEM_DIMENSION;
+
+	/* method: */
+public:
+	CQuasiNewtonOptimizer(IGradientEvaluator& gradientEvaluator, const std::vector<std::vector<double> >& initialFeasibleSolutions);
+	~CQuasiNewtonOptimizer();
+
+	int runOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations);
+
+	int getEvaluationsCount() const;
+	double getGradientTolerance() const;
+	int getHistorySize() const;
+	double getImprovementTolerance() const;
+	double getMaxStepLength() const;
+
+	void setGradientTolerance(double dTolerance);
+	void setHistorySize(int nSize);
+	void setImprovementTolerance(double dTolerance);
+	void setMaxStepLength(double dLength);
+private:
+	int minimize(std::vector<double>& solution, double& dValue, int nMaxIterations);
+};
+
+
+//
+#endif
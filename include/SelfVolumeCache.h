@@ -0,0 +1,99 @@
+/**
+ * Self Volume Cache Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file SelfVolumeCache.h
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-02
+ */
+
+
+#ifndef SELF_VOLUME_CACHE_INCLUDE_H
+#define SELF_VOLUME_CACHE_INCLUDE_H
+//
+
+
+#include <map>
+#include <string>
+
+
+class IMolecule;
+
+
+/**
+ * Description: Gaussian self volumes of database molecules, persisted in a sidecar file so that a static database is evaluated only
+ *	once across screens. Entries are keyed by molecule ID in the database and validated by a content hash of the molecule, a
+ *	molecule whose hash no longer matches is a cache miss and is recomputed. The whole file is bound to a parameters key, as self
+ *	volumes depend on the volume parameters; a file written with another key is discarded on loading.
+ */
+class CSelfVolumeCache
+{
+	/* data: */
+public:
+	/* Error codes. */
+	struct ErrorCodes
+	{
+		static const int nBAD_FORMAT;
+		static const int nCAN_NOT_OPEN_FILE;
+		static const int nNORMAL;
+		static const int nPARAMETERS_MISMATCH;
+
+	private:
+		ErrorCodes() {};
+	};
+
+
+private:
+	/* Tag texts used in cache file. */
+	struct TagTexts
+	{
+		static const std::string sHEADER;
+		static const std::string sPARAMETERS;
+
+	private:
+		TagTexts() {};
+	};
+
+
+	/**
+	 * Description: Cached data of a molecule.
+	 */
+	struct Entry
+	{
+		// content hash of molecule when its self volume was calculated
+		unsigned long long nContentHash;
+		// Gaussian self volume
+		double dSelfVolume;
+	};
+
+
+	// a flag indicating whether entries changed since loading
+	bool _bModified;
+	// entries, key: molecule ID
+	std::map<int, Entry> _entries;
+	// cache file name
+	std::string _sFileName;
+	// parameters key the cached volumes are calculated with
+	std::string _sParametersKey;
+
+	/* method: */
+public:
+	CSelfVolumeCache(const std::string& sFileName, const std::string& sParametersKey);
+	~CSelfVolumeCache();
+
+	static unsigned long long hashMolecule(const IMolecule& molecule);
+	int getEntriesCount() const;
+	const std::string& getFileName() const;
+	bool isModified() const;
+	int load();
+	bool lookUp(const int nMoleculeId, const unsigned long long nContentHash, double& dSelfVolume) const;
+	int save();
+	void store(const int nMoleculeId, const unsigned long long nContentHash, const double dSelfVolume);
+};
+
+
+//
+#endif
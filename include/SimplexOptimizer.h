@@ -22,7 +22,15 @@
 
 
 /**
- * Description:
+ * Description: Nelder-Mead simplex minimizer run from each of several initial simplices. Each start runs until its simplex converges
+ *	or the max number of iterations is reached. A simplex converges when the spread of its function values is within the absolute
+ *	plus relative value tolerance, and the spread of its vertices along each dimension is within the vertex tolerance of that
+ *	dimension. Tests without tolerances set are skipped, and with no tolerance set at all every start runs all iterations.
+ *	Starts are independent: with more than one thread and an evaluator implementing ICloneable, they are spread over threads, each
+ *	evaluating on its own clone of the evaluator. Results are reduced in start order, so they do not depend on the threads count.
+ *	With a pruning fraction set, starts are interleaved in rounds of a few iterations, and after each round a start is abandoned if
+ *	its lowest value is still short of that fraction of the lowest value of all starts (the incumbent), and its improvement over the
+ *	last round, kept up for all remaining iterations, could not reach the incumbent either.
  */
 class CSimplexOptimizer
 {
@@ -84,6 +92,8 @@ private:
 	std::vector<std::vector<double> > _currentFeasibleSolutions;
 	// corresponding function values for current feasible solutions
 	std::vector<double> _currentFunctionValues;
+	// absolute spread of function values within which a simplex converges
+	double _dAbsoluteValueTolerance;
 	// coefficient for contraction operation
 	double _dContractionFactor;
 	// coefficient for extension operation
@@ -92,36 +102,57 @@ private:
 	double _dHighestSolutionValue;
 	// function value of the lowest solution
 	double _dLowestSolutionValue;
+	// fraction of the incumbent a start must reach not to be pruned, 0 for no pruning
+	double _dPruningFraction;
 	// coefficient for reduction operation
 	double _dReductionFactor;
 	// function value at the reflected point
 	double _dReflectedPointValue;
 	// coefficient for reflection operation
 	double _dReflectionFactor;
+	// spread of function values, relative to the lowest one, within which a simplex converges
+	double _dRelativeValueTolerance;
 	// function value of the second highest solution
 	double _dSecondHighestSolutionValue;
 	// reference of an external function value evaluator
 	IFunctionValueEvaluator& _functionValueEvaluator;
+	// number of function evaluations of the last optimization
+	int _nEvaluationsCount;
 	// index for the hightest solution in current group
 	int _nHighestSolutionId;
+	// iterations used by each start of the last optimization
+	std::vector<int> _iterationsCounts;
 	// index for the lowest solution in current group
 	int _nLowestSolutionId;
 	// dimension of the optimization problem
 	const int _nPROBLEM_DIMENSION;
+	// number of starts pruned in the last optimization
+	int _nPrunedStartsCount;
+	// estimated number of function evaluations saved by pruning in the last optimization
+	int _nSavedEvaluationsCount;
 	// index for the second highest solution in current group
 	int _nSecondHighestSolutionId;
+	// number of threads running starts, 0 for one per processor
+	int _nThreadsCount;
 	// centroid point used for reflection
 	std::vector<double> _reflectionCentroid;
 	// reflected point
 	std::vector<double> _reflectedPoint;
+	// spread of vertices along each dimension within which a simplex converges, empty for no vertex test
+	std::vector<double> _vertexTolerances;
 
 	/* Default value: */
 	struct DefaultValues
 	{
+		static const double dABSOLUTE_VALUE_TOLERANCE;
 		static const double dCONTRACTION_FACTOR;
 		static const double dEXTENSION_FACTOR;
 		static const double dREDUCTION_FACTOR;
 		static const double dREFLECTION_FACTOR;
+		static const double dPRUNING_FRACTION;
+		static const double dRELATIVE_VALUE_TOLERANCE;
+		static const int nPRUNING_INTERVAL;
+		static const int nTHREADS_COUNT;
 
 	private:
 		DefaultValues();
@@ -145,21 +176,40 @@ public:
 	int runOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations);
 	int traceOptimization(std::vector<std::vector<CSimplexOptimizer::CourseNode> >& trajectories, int nMaxIterations);
 
+	double getAbsoluteValueTolerance() const;
 	double getContractionFactor() const;
+	int getEvaluationsCount() const;
 	double getExtensionFactor() const;
+	const std::vector<int>& getIterationsCounts() const;
+	int getPrunedStartsCount() const;
+	double getPruningFraction() const;
 	double getReductionFactor() const;
 	double getReflectionFactor() const;
+	double getRelativeValueTolerance() const;
+	int getSavedEvaluationsCount() const;
+	int getThreadsCount() const;
+	const std::vector<double>& getVertexTolerances() const;
 
+	void setAbsoluteValueTolerance(double dTolerance);
 	void setContractionFactor(double dFactor);
 	void setExtensionFactor(double dFactor);
+	void setPruningFraction(double dFraction);
 	void setReductionFactor(double dFactor);
 	void setReflectionFactor(double dFactor);
+	void setRelativeValueTolerance(double dTolerance);
+	void setThreadsCount(int nThreadsCount);
+	void setVertexTolerances(const std::vector<double>& tolerances);
 private:
 	int doContraction();
 	int doExtention();
 	int doReduction();
 	int doReflection();
 	int evaluateAllCurrentSolutions();
+	int getWorkersCount() const;
+	bool isConverged() const;
+	int iterate(int nMaxIterations);
+	int runInterleavedOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations, int nWorkersCount);
+	int runInterleavedRounds(const std::vector<CSimplexOptimizer*>& groupOptimizers, std::vector<double>& minSolution, double& dMinValue, int nMaxIterations, int nWorkersCount);
 	int updateSpecialVertices();
 	int updateReflectionCentroid();
 };
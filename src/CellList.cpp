@@ -0,0 +1,198 @@
+/**
+ * Cell List Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file CellList.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2010-10-22
+ */
+
+
+#include "CellList.h"
+
+#include "Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+
+using std::vector;
+
+
+/* Implementation for CCellList class: */
+
+/* Static members: */
+const int CCellList::DefaultValues::nMAX_CELLS_PER_AXIS = 256;
+
+const int CCellList::ErrorCodes::nNORMAL = 0;
+
+
+/**
+ * Description: Constructor. Bucket all points into cubic cells.
+ * @param xCoordinates: (IN)
+ * @param yCoordinates: (IN)
+ * @param zCoordinates: (IN)
+ * @param dCellSize: (IN) A positive value, usually the max distance within which two points are considered as neighbors.
+ * @exception: CInvalidArgumentException
+ */
+CCellList::CCellList(
+	const std::vector<double>& xCoordinates,
+	const std::vector<double>& yCoordinates,
+	const std::vector<double>& zCoordinates,
+	const double dCellSize
+	) :
+	_dCellSize(dCellSize),
+	_dMinX(0),
+	_dMinY(0),
+	_dMinZ(0),
+	_nCellsX(1),
+	_nCellsY(1),
+	_nCellsZ(1)
+{
+	// If invalid parameters:
+	if (!(dCellSize > 0) || xCoordinates.size() != yCoordinates.size() || xCoordinates.size() != zCoordinates.size())
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameters: "
+			<< "dCellSize = " << dCellSize << ", "
+			<< "coordinates sizes = " << xCoordinates.size() << ", " << yCoordinates.size() << ", " << zCoordinates.size();
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	const int nPOINTS_COUNT = xCoordinates.size();
+
+	/* Calculate grid dimensions. */
+	if (nPOINTS_COUNT > 0)
+	{
+		_dMinX = *std::min_element(xCoordinates.begin(), xCoordinates.end());
+		_dMinY = *std::min_element(yCoordinates.begin(), yCoordinates.end());
+		_dMinZ = *std::min_element(zCoordinates.begin(), zCoordinates.end());
+		const double dEXTENT_X = *std::max_element(xCoordinates.begin(), xCoordinates.end()) - _dMinX;
+		const double dEXTENT_Y = *std::max_element(yCoordinates.begin(), yCoordinates.end()) - _dMinY;
+		const double dEXTENT_Z = *std::max_element(zCoordinates.begin(), zCoordinates.end()) - _dMinZ;
+
+		/* Enlarge cells for sparse points to bound the memory of the grid. */
+		const double dMAX_EXTENT = std::max(dEXTENT_X, std::max(dEXTENT_Y, dEXTENT_Z));
+		if (dMAX_EXTENT / _dCellSize >= DefaultValues::nMAX_CELLS_PER_AXIS)
+		{
+			_dCellSize = dMAX_EXTENT / (DefaultValues::nMAX_CELLS_PER_AXIS - 1);
+		}
+
+		_nCellsX = static_cast<int>(floor(dEXTENT_X / _dCellSize)) + 1;
+		_nCellsY = static_cast<int>(floor(dEXTENT_Y / _dCellSize)) + 1;
+		_nCellsZ = static_cast<int>(floor(dEXTENT_Z / _dCellSize)) + 1;
+	}
+
+	/* Count points in each cell. */
+	vector<int> pointCellIndexes(nPOINTS_COUNT);
+	_cellStarts.assign(_nCellsX * _nCellsY * _nCellsZ + 1, 0);
+	for (int iPoint = 0; iPoint < nPOINTS_COUNT; ++ iPoint)
+	{
+		const int nCellIndex =
+			(getCellIndex(zCoordinates[iPoint], _dMinZ, _nCellsZ) * _nCellsY +
+			getCellIndex(yCoordinates[iPoint], _dMinY, _nCellsY)) * _nCellsX +
+			getCellIndex(xCoordinates[iPoint], _dMinX, _nCellsX);
+		pointCellIndexes[iPoint] = nCellIndex;
+		++ _cellStarts[nCellIndex + 1];
+	}
+
+	/* Accumulate counts to start positions. */
+	for (int iCell = 1; iCell < static_cast<int>(_cellStarts.size()); ++ iCell)
+	{
+		_cellStarts[iCell] += _cellStarts[iCell - 1];
+	}
+
+	/* Group point IDs by cell, keeping ascending order within each cell. */
+	vector<int> cellPositions(_cellStarts.begin(), _cellStarts.end() - 1);
+	_cellPointIds.resize(nPOINTS_COUNT);
+	for (int iPoint = 0; iPoint < nPOINTS_COUNT; ++ iPoint)
+	{
+		_cellPointIds[cellPositions[pointCellIndexes[iPoint]] ++] = iPoint;
+	}
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CCellList::~CCellList()
+{
+}
+
+
+/**
+ * Description: Get IDs of points in the cells adjacent to a position, which is a superset of the points within one cell size of that
+ *	position. Candidates are not sorted.
+ * @param dX: (IN)
+ * @param dY: (IN)
+ * @param dZ: (IN)
+ * @param candidatePointIds: (OUT)
+ */
+int CCellList::getCandidatePointIds(const double dX, const double dY, const double dZ, std::vector<int>& candidatePointIds) const
+{
+	candidatePointIds.clear();
+
+	/* Calculate range of adjacent cells, clamped to the grid. */
+	const double dCELL_X = floor((dX - _dMinX) / _dCellSize);
+	const double dCELL_Y = floor((dY - _dMinY) / _dCellSize);
+	const double dCELL_Z = floor((dZ - _dMinZ) / _dCellSize);
+	// If position far away from the grid:
+	if (dCELL_X < -1 || dCELL_X > _nCellsX || dCELL_Y < -1 || dCELL_Y > _nCellsY || dCELL_Z < -1 || dCELL_Z > _nCellsZ)
+	{
+		return ErrorCodes::nNORMAL;
+	}
+	const int nLowerX = std::max(static_cast<int>(dCELL_X) - 1, 0);
+	const int nUpperX = std::min(static_cast<int>(dCELL_X) + 1, _nCellsX - 1);
+	const int nLowerY = std::max(static_cast<int>(dCELL_Y) - 1, 0);
+	const int nUpperY = std::min(static_cast<int>(dCELL_Y) + 1, _nCellsY - 1);
+	const int nLowerZ = std::max(static_cast<int>(dCELL_Z) - 1, 0);
+	const int nUpperZ = std::min(static_cast<int>(dCELL_Z) + 1, _nCellsZ - 1);
+
+	/* Collect points in those cells. */
+	for (int iCellZ = nLowerZ; iCellZ <= nUpperZ; ++ iCellZ)
+	{
+		for (int iCellY = nLowerY; iCellY <= nUpperY; ++ iCellY)
+		{
+			// cells along X axis are contiguous in storage
+			const int nROW_INDEX = (iCellZ * _nCellsY + iCellY) * _nCellsX;
+			candidatePointIds.insert(
+				candidatePointIds.end(),
+				_cellPointIds.begin() + _cellStarts[nROW_INDEX + nLowerX],
+				_cellPointIds.begin() + _cellStarts[nROW_INDEX + nUpperX + 1]
+				);
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Get size of cubic cell, which could be larger than the one specified in constructor for sparse points.
+ * @return:
+ */
+double CCellList::getCellSize() const
+{
+	return _dCellSize;
+}
+
+
+/**
+ * Description: Get cell index along an axis for a coordinate within the grid.
+ * @param dCoordinate: (IN)
+ * @param dMinCoordinate: (IN)
+ * @param nCells: (IN)
+ * @return:
+ */
+int CCellList::getCellIndex(const double dCoordinate, const double dMinCoordinate, const int nCells) const
+{
+	const int nCellIndex = static_cast<int>(floor((dCoordinate - dMinCoordinate) / _dCellSize));
+
+	return std::min(std::max(nCellIndex, 0), nCells - 1);
+}
@@ -21,6 +21,7 @@
 #include "InterfaceMoleculeReader.h"
 #include "MoleculeManager.h"
 #include "MoleculeReaderManager.h"
+#include "SelfVolumeCache.h"
 #include "SphericalHarmonicService.h"
 #include "UsrService.h"
 #include "Utility.h"
@@ -39,6 +40,9 @@ using std::vector;
 
 /* Static Members: */
 
+/* Default values: */
+const std::string CCommandLineService::DefaultValues::sSELF_VOLUME_CACHE_SUFFIX(".gvcache");
+
 /* Error codes: */
 const int CCommandLineService::ErrorCodes::nNORMAL = 0;
 
@@ -58,6 +62,7 @@ const std::string CCommandLineService::TagTexts::sTOTAL_MOLECULES("@TOTAL_MOLECU
 const std::string CCommandLineService::TagTexts::sTOTAL_TIME("@TOTAL_TIME");
 
 /* Switch names: */
+const std::string CCommandLineService::SwitchNames::sBEST_CONFORMER("-bestConformer");
 const std::string CCommandLineService::SwitchNames::sDATABASE("-db");
 const std::string CCommandLineService::SwitchNames::sDB_RANGE("-dbRange");
 const std::string CCommandLineService::SwitchNames::sFIT("-fit");
@@ -68,6 +73,8 @@ const std::string CCommandLineService::SwitchNames::sQUERY("-query");
 const std::string CCommandLineService::SwitchNames::sREFERENCE("-ref");
 const std::string CCommandLineService::SwitchNames::sSH_DESCRIPTOR("-shDesc");
 const std::string CCommandLineService::SwitchNames::sUSR_DESCRIPTOR("-usrDesc");
+const std::string CCommandLineService::SwitchNames::sVOLUME_CACHE("-volumeCache");
+const std::string CCommandLineService::SwitchNames::sWARM_START("-warmStart");
 
 
 /**
@@ -187,10 +194,33 @@ int CCommandLineService::startFromCommandLine(const CCommandLineArguments& comma
 
 				// main service
 				CGaussianService gaussianService(getConfigurationArguments());
+
+				/* Load self volume cache of database molecules, if requested. */
+				// self volume cache, NULL pointer if not requested
+				auto_ptr<CSelfVolumeCache> selfVolumeCachePtr;
+				// If specified switch (self volume cache) exists:
+				if (commandLineArguments.existSwitch(SwitchNames::sVOLUME_CACHE))
+				{
+					// Default to a sidecar file of the database if no file name given.
+					const string sCacheFileName = commandLineArguments.isEmptySwitch(SwitchNames::sVOLUME_CACHE)
+						? sDbFileName + DefaultValues::sSELF_VOLUME_CACHE_SUFFIX
+						: commandLineArguments.getArguments(SwitchNames::sVOLUME_CACHE)[0];
+					selfVolumeCachePtr.reset(new CSelfVolumeCache(sCacheFileName, gaussianService.getSelfVolumeParametersKey()));
+					// Note: A missing, stale or broken cache file just starts an empty cache.
+					selfVolumeCachePtr->load();
+				}
+
+				/* Conformers of a compound are stored back to back under the same molecule name. */
+				// a flag indicating whether each conformer is aligned from the transformations of the previous one of the same compound
+				const bool bWarmStart = commandLineArguments.existSwitch(SwitchNames::sWARM_START);
+				// a flag indicating whether only the conformer of each compound most similar to the query is reported
+				const bool bBestConformerOnly = commandLineArguments.existSwitch(SwitchNames::sBEST_CONFORMER);
 				// For each query molecule:
 				while (queryMoleculeReaderPtr->readMolecule(*queryMoleculePtr) == IMoleculeReader::ErrorCodes::nNORMAL)
 				{
-					const double dQueryMoleculeVolume = gaussianService.evaluateGaussianVolume(*queryMoleculePtr);
+					/* Prepare query molecule once for all database molecules. */
+					auto_ptr<CGaussianService::CPreparedQuery> preparedQueryPtr = gaussianService.prepareQuery(*queryMoleculePtr);
+					const double dQueryMoleculeVolume = preparedQueryPtr->getSelfVolume();
 
 					/* Output information for query molecule. */
 					outputStream 
@@ -204,26 +234,74 @@ int CCommandLineService::startFromCommandLine(const CCommandLineArguments& comma
 					// ID of current database molecule
 					int nDbMoleculeId = nDbMoleculeStartIdLimit;
 					double dTimeTotal = 0;
+					// name of previous database molecule
+					string sPreviousMoleculeName;
+					// transformations of current database molecule, those of previous one before alignment
+					vector<vector<double> > fitTransformations;
+					// output line of the best conformer of current compound so far, if only best conformers reported
+					string sBestConformerLine;
+					// shape Tanimoto similarity of the best conformer of current compound so far
+					double dBestSimilarity = 0;
 					// For each database molecule:
 					while (dbMoleculeReaderPtr->readMolecule(*dbMoleculePtr) == IMoleculeReader::ErrorCodes::nNORMAL)
 					{
 						// If current database molecule is still in range limit:
 						if (nDbMoleculeId <= nDbMoleculeEndIdLimit)
 						{
+							const bool bSameCompound = nDbMoleculeId > nDbMoleculeStartIdLimit && dbMoleculePtr->getMolecularName() == sPreviousMoleculeName;
+							vector<vector<double> > warmStartTransformations;
+							warmStartTransformations.swap(fitTransformations);
+
 							TIME_START();
-							const double dDbMoleculeVolume = gaussianService.evaluateGaussianVolume(*dbMoleculePtr);
-							const double dOverlapVolume = gaussianService.evaluateMaxGaussianVolumeOverlap(*queryMoleculePtr, *dbMoleculePtr);
+							const double dDbMoleculeVolume = selfVolumeCachePtr.get()
+								? gaussianService.evaluateGaussianVolume(*dbMoleculePtr, nDbMoleculeId, *selfVolumeCachePtr)
+								: gaussianService.evaluateGaussianVolume(*dbMoleculePtr);
+							const double dOverlapVolume = gaussianService.evaluateMaxGaussianVolumeOverlap(
+								*preparedQueryPtr,
+								*dbMoleculePtr,
+								&fitTransformations,
+								bWarmStart && bSameCompound ? &warmStartTransformations : NULL
+								);
 							TIME_TICKS(dTicks);
 
 							++ nDbMoleculeId;
 							dTimeTotal += dTicks;
+							sPreviousMoleculeName = dbMoleculePtr->getMolecularName();
 
 							/* Output for each database molecule. */
-							outputStream 
+							std::stringstream lineStream;
+							lineStream
 								<< dbMoleculePtr->getMolecularName() << "; "
 								<< dQueryMoleculeVolume << "; "
 								<< dDbMoleculeVolume << "; "
-								<< dOverlapVolume << endl;
+								<< dOverlapVolume;
+							// If only best conformers reported:
+							if (bBestConformerOnly)
+							{
+								const double dSimilarity = dOverlapVolume / (dQueryMoleculeVolume + dDbMoleculeVolume - dOverlapVolume);
+								// If first conformer of a compound:
+								if (!bSameCompound)
+								{
+									// If a previous compound to report:
+									if (!sBestConformerLine.empty())
+									{
+										outputStream << sBestConformerLine << endl;
+									}
+									sBestConformerLine = lineStream.str();
+									dBestSimilarity = dSimilarity;
+								}
+								// If better conformer of current compound:
+								else if (dSimilarity > dBestSimilarity)
+								{
+									sBestConformerLine = lineStream.str();
+									dBestSimilarity = dSimilarity;
+								}
+							}
+							// If all conformers reported:
+							else
+							{
+								outputStream << lineStream.str() << endl;
+							}
 						}
 						// If current database molecule is out of range limit:
 						else
@@ -232,6 +310,12 @@ int CCommandLineService::startFromCommandLine(const CCommandLineArguments& comma
 						}
 					}
 
+					/* Output the best conformer of the last compound. */
+					if (!sBestConformerLine.empty())
+					{
+						outputStream << sBestConformerLine << endl;
+					}
+
 					/* Get statistics. */
 					// computation time in seconds.
 					dTimeTotal /= CLOCKS_PER_SEC;
@@ -252,6 +336,20 @@ int CCommandLineService::startFromCommandLine(const CCommandLineArguments& comma
 						<< TagTexts::sTIME_PER_CONFORMER << " "
 						<< dTimeTotal / nTotalDbMolecules << endl;
 				}
+
+				/* Save self volume cache if new volumes are calculated. */
+				// If cache save failure:
+				if (selfVolumeCachePtr.get()
+					&& selfVolumeCachePtr->isModified()
+					&& selfVolumeCachePtr->save() != CSelfVolumeCache::ErrorCodes::nNORMAL)
+				{
+					std::stringstream msgStream;
+					msgStream
+						<< LOCATION_STREAM_INSERTION
+						<< MessageTexts::sCAN_NOT_WRITE_FILE
+						<< selfVolumeCachePtr->getFileName();
+					throw CFileIoException(msgStream.str());
+				}
 			}
 			// If output stream failure:
 			else
@@ -0,0 +1,244 @@
+/**
+ * Cross Neighbor List Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file CrossNeighborList.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-08
+ */
+
+
+#include "CrossNeighborList.h"
+
+#include "Exception.h"
+
+#include <sstream>
+
+
+using std::vector;
+
+
+/* Implementation for CCrossNeighborList class: */
+
+/* Static members: */
+const int CCrossNeighborList::ErrorCodes::nNORMAL = 0;
+
+
+/**
+ * Description: Ctor. The list is built on the first update.
+ * @param dSkin: (IN) A positive skin distance. A larger skin rebuilds less often but lists more pairs out of contact.
+ * @exception: CInvalidArgumentException
+ */
+CCrossNeighborList::CCrossNeighborList(const double dSkin) :
+	_bBuilt(false),
+	_dGaussianCutoff(0),
+	_dSkin(dSkin),
+	_nBuildsCount(0),
+	_nUpdatesCount(0)
+{
+	// If invalid parameter:
+	if (!(dSkin > 0))
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dSkin = " << dSkin;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CCrossNeighborList::~CCrossNeighborList()
+{
+}
+
+
+/**
+ * Description: Build the list from the current pose of fit molecule by testing all atom pairs. Rebuilds are frequent under large
+ *	optimizer steps, and a plain pass into storage kept across builds is cheaper than bucketing atoms into a cell list each time.
+ * @param refMolecule: (IN)
+ * @param fitMolecule: (IN)
+ * @param dGaussianCutoff: (IN)
+ */
+int CCrossNeighborList::build(
+	const CGaussianVolume::PreparedMolecule& refMolecule,
+	const CGaussianVolume::PreparedMolecule& fitMolecule,
+	const double dGaussianCutoff
+	)
+{
+	const int nREF_ATOMS_COUNT = refMolecule.radii.size();
+	_candidateStarts.assign(nREF_ATOMS_COUNT + 1, 0);
+	_candidateFitAtomIds.clear();
+
+	/* List fit atoms of each reference atom within contact distance plus skin, in ascending ID order. */
+	const int nFIT_ATOMS_COUNT = fitMolecule.radii.size();
+	for (int iRefAtomId = 0; iRefAtomId < nREF_ATOMS_COUNT; ++ iRefAtomId)
+	{
+		const double dREF_X = refMolecule.xCoordinates[iRefAtomId];
+		const double dREF_Y = refMolecule.yCoordinates[iRefAtomId];
+		const double dREF_Z = refMolecule.zCoordinates[iRefAtomId];
+		const double dREF_LISTED_RADIUS = refMolecule.radii[iRefAtomId] + dGaussianCutoff + _dSkin;
+
+		for (int iFitAtomId = 0; iFitAtomId < nFIT_ATOMS_COUNT; ++ iFitAtomId)
+		{
+			const double dDeltaX = fitMolecule.xCoordinates[iFitAtomId] - dREF_X;
+			const double dDeltaY = fitMolecule.yCoordinates[iFitAtomId] - dREF_Y;
+			const double dDeltaZ = fitMolecule.zCoordinates[iFitAtomId] - dREF_Z;
+			const double dSquareDistance = dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ;
+			const double dListedDistance = dREF_LISTED_RADIUS + fitMolecule.radii[iFitAtomId];
+
+			// If within skin:
+			if (dSquareDistance < dListedDistance * dListedDistance)
+			{
+				_candidateFitAtomIds.push_back(iFitAtomId);
+			}
+		}
+		_candidateStarts[iRefAtomId + 1] = _candidateFitAtomIds.size();
+	}
+
+	_builtXCoordinates.assign(fitMolecule.xCoordinates.begin(), fitMolecule.xCoordinates.end());
+	_builtYCoordinates.assign(fitMolecule.yCoordinates.begin(), fitMolecule.yCoordinates.end());
+	_builtZCoordinates.assign(fitMolecule.zCoordinates.begin(), fitMolecule.zCoordinates.end());
+	_dGaussianCutoff = dGaussianCutoff;
+	_bBuilt = true;
+	++ _nBuildsCount;
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description:
+ * @return: Number of times the list was built, including the first one.
+ */
+int CCrossNeighborList::getBuildsCount() const
+{
+	return _nBuildsCount;
+}
+
+
+/**
+ * Description:
+ * @return: Listed fit atom IDs, those of reference atom i are in [getCandidateStarts()[i], getCandidateStarts()[i + 1]).
+ */
+const std::vector<int>& CCrossNeighborList::getCandidateFitAtomIds() const
+{
+	return _candidateFitAtomIds;
+}
+
+
+/**
+ * Description:
+ * @return: Start positions of reference atoms in getCandidateFitAtomIds(), one more element than reference atoms.
+ */
+const std::vector<int>& CCrossNeighborList::getCandidateStarts() const
+{
+	return _candidateStarts;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CCrossNeighborList::getSkin() const
+{
+	return _dSkin;
+}
+
+
+/**
+ * Description:
+ * @return: Number of poses the list was updated for.
+ */
+int CCrossNeighborList::getUpdatesCount() const
+{
+	return _nUpdatesCount;
+}
+
+
+/**
+ * Description: Force a rebuild on next update, e.g. when the reference molecule is changed.
+ */
+void CCrossNeighborList::invalidate()
+{
+	_bBuilt = false;
+}
+
+
+/**
+ * Description: Check whether the list may miss a pair in contact for the current pose. Since the reference molecule is fixed, a pair
+ *	not listed stays out of contact while its fit atom moves no farther than the skin.
+ * @param refMolecule: (IN)
+ * @param fitMolecule: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @return:
+ */
+bool CCrossNeighborList::isOutdated(
+	const CGaussianVolume::PreparedMolecule& refMolecule,
+	const CGaussianVolume::PreparedMolecule& fitMolecule,
+	const double dGaussianCutoff
+	) const
+{
+	// If not built, or built for other molecules or cutoff:
+	if (!_bBuilt
+		|| static_cast<int>(_candidateStarts.size()) != static_cast<int>(refMolecule.radii.size()) + 1
+		|| _builtXCoordinates.size() != fitMolecule.xCoordinates.size()
+		|| _dGaussianCutoff != dGaussianCutoff)
+	{
+		return true;
+	}
+
+	const double dSQUARE_SKIN = _dSkin * _dSkin;
+	const int nFIT_ATOMS_COUNT = _builtXCoordinates.size();
+	for (int iFitAtomId = 0; iFitAtomId < nFIT_ATOMS_COUNT; ++ iFitAtomId)
+	{
+		const double dDeltaX = fitMolecule.xCoordinates[iFitAtomId] - _builtXCoordinates[iFitAtomId];
+		const double dDeltaY = fitMolecule.yCoordinates[iFitAtomId] - _builtYCoordinates[iFitAtomId];
+		const double dDeltaZ = fitMolecule.zCoordinates[iFitAtomId] - _builtZCoordinates[iFitAtomId];
+		// If moved beyond skin:
+		if (dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ >= dSQUARE_SKIN)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * Description: Make the list valid for the current pose of fit molecule, rebuilding it only if any fit atom has moved beyond the skin
+ *	since the last build. The reference molecule must stay fixed between updates, otherwise call invalidate() first.
+ * @param refMolecule: (IN) Prepared reference molecule, fixed.
+ * @param fitMolecule: (IN) Prepared fit molecule, in current pose.
+ * @param dGaussianCutoff: (IN)
+ * @return: Whether the list is rebuilt.
+ */
+bool CCrossNeighborList::update(
+	const CGaussianVolume::PreparedMolecule& refMolecule,
+	const CGaussianVolume::PreparedMolecule& fitMolecule,
+	const double dGaussianCutoff
+	)
+{
+	++ _nUpdatesCount;
+
+	// If pairs in contact may be missed:
+	if (isOutdated(refMolecule, fitMolecule, dGaussianCutoff))
+	{
+		build(refMolecule, fitMolecule, dGaussianCutoff);
+		return true;
+	}
+	// If still valid:
+	else
+	{
+		return false;
+	}
+}
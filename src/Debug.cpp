@@ -17,6 +17,8 @@
 #include "Bond.h"
 #include "Debug.h"
 #include "Exception.h"
+#include "GaussianDensityGrid.h"
+#include "GaussianOverlapKernel.h"
 #include "GaussianVolume.h"
 #include "GaussianVolumeOverlapEvaluator.h"
 #include "GeneticOptimizer.h"
@@ -26,9 +28,11 @@
 #include "Molecule.h"
 #include "MoleculeReaderManager.h"
 #include "GaussianService.h"
+#include "QuasiNewtonOptimizer.h"
 #include "SimplexOptimizer.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <ctime>
 #include <cmath>
 #include <cstdlib>
@@ -36,10 +40,15 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <numeric>
 #include <set>
 #include <string>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using std::auto_ptr;
 using std::cout;
@@ -73,6 +82,33 @@ double CTestFunctionValueEvaluator::getFunctionValue(const std::vector<double>&
 	return dValue;
 }
 
+
+CCountingGradientEvaluator::CCountingGradientEvaluator(IGradientEvaluator& evaluator) :
+	_evaluator(evaluator),
+	_nEvaluationsCount(0)
+{
+}
+
+
+long long CCountingGradientEvaluator::getEvaluationsCount() const
+{
+	return _nEvaluationsCount;
+}
+
+
+double CCountingGradientEvaluator::getFunctionValue(const std::vector<double>& params)
+{
+	++ _nEvaluationsCount;
+	return _evaluator.getFunctionValue(params);
+}
+
+
+double CCountingGradientEvaluator::getFunctionValueAndGradient(const std::vector<double>& params, std::vector<double>& gradient)
+{
+	++ _nEvaluationsCount;
+	return _evaluator.getFunctionValueAndGradient(params, gradient);
+}
+
 void testMove(CMolecule mol)
 {
 	mol.move(500, 500, 500);
@@ -265,3 +301,1793 @@ int alignMolecule()
 
 	return 0;
 }
+
+
+/**
+ * Description: Benchmark the first order Gaussian overlap kernels of all instruction sets supported by current processor,
+ *	calculating the overlap of every pair of molecules in a file, e.g. "test_data/gr_actives_conformers_50.mol2".
+ * @param sMoleculeFileName: (IN)
+ * @param nRounds: (IN) Times to repeat the all pairs calculation.
+ */
+int benchmarkOverlapKernels(const std::string& sMoleculeFileName, const int nRounds)
+{
+	/* Read and prepare molecules. */
+	vector<CGaussianVolume::PreparedMolecule> preparedMolecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		preparedMolecules.push_back(CGaussianVolume::PreparedMolecule());
+		CGaussianVolume::prepareMolecule(molecule, preparedMolecules.back());
+	}
+	const int nMOLECULES_COUNT = preparedMolecules.size();
+
+	/* Calculate overlaps with each kernel. */
+	const int nBEST_INSTRUCTION_SET = CGaussianOverlapKernel::detectInstructionSet();
+	vector<double> scalarOverlaps;
+	double dScalarSeconds = 0.0;
+	for (int iInstructionSet = CGaussianOverlapKernel::InstructionSets::nSCALAR; iInstructionSet <= nBEST_INSTRUCTION_SET; ++ iInstructionSet)
+	{
+		vector<double> overlaps;
+		overlaps.reserve(nMOLECULES_COUNT * nMOLECULES_COUNT);
+
+		TIME_START();
+		for (int iRound = 0; iRound < nRounds; ++ iRound)
+		{
+			overlaps.clear();
+			for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+			{
+				for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+				{
+					overlaps.push_back(CGaussianOverlapKernel::calculateOverlapVolume(
+						preparedMolecules[iRefMolecule], preparedMolecules[iFitMolecule], 0.0, CGaussianOverlapKernel::CSettings(), iInstructionSet));
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		// If scalar kernel, as the reference:
+		if (iInstructionSet == CGaussianOverlapKernel::InstructionSets::nSCALAR)
+		{
+			scalarOverlaps = overlaps;
+			dScalarSeconds = dSeconds;
+		}
+
+		double dMaxRelativeDeviation = 0.0;
+		for (int iOverlap = 0; iOverlap < static_cast<int>(overlaps.size()); ++ iOverlap)
+		{
+			const double dRelativeDeviation = std::abs(overlaps[iOverlap] - scalarOverlaps[iOverlap]) / std::abs(scalarOverlaps[iOverlap]);
+			dMaxRelativeDeviation = std::max(dMaxRelativeDeviation, dRelativeDeviation);
+		}
+
+		cout
+			<< CGaussianOverlapKernel::getInstructionSetName(iInstructionSet) << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs x " << nRounds << " rounds, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dScalarSeconds / dSeconds : 0.0) << ", "
+			<< "Max relative deviation: " << dMaxRelativeDeviation
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Report accuracy versus speed of kernel accuracy modes, calculating overlaps of all molecule pairs in a file with the
+ *	kernel selected at startup.
+ * @param sMoleculeFileName: (IN)
+ * @param nRounds: (IN) Repeat rounds for timing.
+ */
+int benchmarkKernelAccuracy(const std::string& sMoleculeFileName, const int nRounds)
+{
+	/* Read and prepare molecules. */
+	vector<CGaussianVolume::PreparedMolecule> preparedMolecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	CMolecule molecule;
+	while (readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		preparedMolecules.push_back(CGaussianVolume::PreparedMolecule());
+		CGaussianVolume::prepareMolecule(molecule, preparedMolecules.back());
+	}
+	const int nMOLECULES_COUNT = preparedMolecules.size();
+
+	/* Calculate overlaps with each accuracy mode, the exact one first as the reference. */
+	const double adMaxRelativeErrors[] = {0, 1e-12, 1e-9, 1e-6, 1e-4, 1e-2};
+	const int nMODES_COUNT = sizeof(adMaxRelativeErrors) / sizeof(adMaxRelativeErrors[0]);
+	vector<double> exactOverlaps;
+	double dExactSeconds = 0.0;
+	for (int iMode = 0; iMode < nMODES_COUNT; ++ iMode)
+	{
+		CGaussianOverlapKernel::CSettings kernelSettings;
+		kernelSettings.setMaxRelativeError(adMaxRelativeErrors[iMode]);
+		vector<double> overlaps;
+		overlaps.reserve(nMOLECULES_COUNT * nMOLECULES_COUNT);
+
+		TIME_START();
+		for (int iRound = 0; iRound < nRounds; ++ iRound)
+		{
+			overlaps.clear();
+			for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+			{
+				for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+				{
+					overlaps.push_back(CGaussianOverlapKernel::calculateOverlapVolume(
+						preparedMolecules[iRefMolecule], preparedMolecules[iFitMolecule], 0.0, kernelSettings));
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		// If exact mode, as the reference:
+		if (iMode == 0)
+		{
+			exactOverlaps = overlaps;
+			dExactSeconds = dSeconds;
+		}
+
+		double dMaxRelativeDeviation = 0.0;
+		for (int iOverlap = 0; iOverlap < static_cast<int>(overlaps.size()); ++ iOverlap)
+		{
+			const double dRelativeDeviation = std::abs(overlaps[iOverlap] - exactOverlaps[iOverlap]) / std::abs(exactOverlaps[iOverlap]);
+			dMaxRelativeDeviation = std::max(dMaxRelativeDeviation, dRelativeDeviation);
+		}
+
+		cout
+			<< CGaussianOverlapKernel::getInstructionSetName(CGaussianOverlapKernel::getInstructionSet()) << " "
+			<< "Max relative error: " << adMaxRelativeErrors[iMode] << " "
+			<< "(exp degree " << kernelSettings.getExpPolynomialDegree() << "): "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs x " << nRounds << " rounds, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dExactSeconds / dSeconds : 0.0) << ", "
+			<< "Max relative deviation: " << dMaxRelativeDeviation
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Rank values in ascending order, rank 0 for the smallest value.
+ * @param values: (IN)
+ * @param ranks: (OUT)
+ */
+static int rankValues(const std::vector<double>& values, std::vector<double>& ranks)
+{
+	const int nVALUES_COUNT = values.size();
+	vector<std::pair<double, int> > sortedValues(nVALUES_COUNT);
+	for (int iValue = 0; iValue < nVALUES_COUNT; ++ iValue)
+	{
+		sortedValues[iValue] = std::make_pair(values[iValue], iValue);
+	}
+	std::sort(sortedValues.begin(), sortedValues.end());
+
+	ranks.resize(nVALUES_COUNT);
+	for (int iRank = 0; iRank < nVALUES_COUNT; ++ iRank)
+	{
+		ranks[sortedValues[iRank].second] = iRank;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Validate the single precision kernels against the reference double precision ones, calculating overlaps of all
+ *	molecule pairs in a file. For each reference molecule, fit molecules are ranked by overlap with both precisions, and the
+ *	ranking agreement is reported as Spearman correlation and agreement of the top ranked fit molecule.
+ * @param sMoleculeFileName: (IN)
+ * @param nRounds: (IN) Repeat rounds for timing.
+ */
+int benchmarkKernelPrecision(const std::string& sMoleculeFileName, const int nRounds)
+{
+	/* Read and prepare molecules. */
+	vector<CGaussianVolume::PreparedMolecule> preparedMolecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		preparedMolecules.push_back(CGaussianVolume::PreparedMolecule());
+		CGaussianVolume::prepareMolecule(molecule, preparedMolecules.back());
+	}
+	const int nMOLECULES_COUNT = preparedMolecules.size();
+
+	/* Calculate overlaps with each precision, the double one first as the reference. */
+	const int anPRECISIONS[] = {CGaussianOverlapKernel::Precisions::nDOUBLE, CGaussianOverlapKernel::Precisions::nFLOAT};
+	const int nPRECISIONS_COUNT = sizeof(anPRECISIONS) / sizeof(anPRECISIONS[0]);
+	vector<double> doubleOverlaps;
+	double dDoubleSeconds = 0.0;
+	for (int iPrecision = 0; iPrecision < nPRECISIONS_COUNT; ++ iPrecision)
+	{
+		CGaussianOverlapKernel::CSettings kernelSettings;
+		kernelSettings.setPrecision(anPRECISIONS[iPrecision]);
+		vector<double> overlaps;
+		overlaps.reserve(nMOLECULES_COUNT * nMOLECULES_COUNT);
+
+		TIME_START();
+		for (int iRound = 0; iRound < nRounds; ++ iRound)
+		{
+			overlaps.clear();
+			for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+			{
+				for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+				{
+					overlaps.push_back(CGaussianOverlapKernel::calculateOverlapVolume(
+						preparedMolecules[iRefMolecule], preparedMolecules[iFitMolecule], 0.0, kernelSettings));
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		// If double precision, as the reference:
+		if (iPrecision == 0)
+		{
+			doubleOverlaps = overlaps;
+			dDoubleSeconds = dSeconds;
+		}
+
+		double dMaxRelativeDeviation = 0.0;
+		for (int iOverlap = 0; iOverlap < static_cast<int>(overlaps.size()); ++ iOverlap)
+		{
+			const double dRelativeDeviation = std::abs(overlaps[iOverlap] - doubleOverlaps[iOverlap]) / std::abs(doubleOverlaps[iOverlap]);
+			dMaxRelativeDeviation = std::max(dMaxRelativeDeviation, dRelativeDeviation);
+		}
+
+		/* Ranking agreement per reference molecule. */
+		double dSpearmanSum = 0.0;
+		double dMinSpearman = 1.0;
+		int nTopAgreements = 0;
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			const vector<double> referenceRow(doubleOverlaps.begin() + iRefMolecule * nMOLECULES_COUNT, doubleOverlaps.begin() + (iRefMolecule + 1) * nMOLECULES_COUNT);
+			const vector<double> row(overlaps.begin() + iRefMolecule * nMOLECULES_COUNT, overlaps.begin() + (iRefMolecule + 1) * nMOLECULES_COUNT);
+			vector<double> referenceRanks;
+			vector<double> ranks;
+			rankValues(referenceRow, referenceRanks);
+			rankValues(row, ranks);
+
+			double dSquareRankDifferenceSum = 0.0;
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				dSquareRankDifferenceSum += (ranks[iFitMolecule] - referenceRanks[iFitMolecule]) * (ranks[iFitMolecule] - referenceRanks[iFitMolecule]);
+			}
+			const double dSpearman = nMOLECULES_COUNT > 1
+				? 1 - 6 * dSquareRankDifferenceSum / (static_cast<double>(nMOLECULES_COUNT) * (static_cast<double>(nMOLECULES_COUNT) * nMOLECULES_COUNT - 1))
+				: 1.0;
+			dSpearmanSum += dSpearman;
+			dMinSpearman = std::min(dMinSpearman, dSpearman);
+
+			// If both precisions rank the same fit molecule top:
+			if (std::max_element(row.begin(), row.end()) - row.begin() == std::max_element(referenceRow.begin(), referenceRow.end()) - referenceRow.begin())
+			{
+				++ nTopAgreements;
+			}
+		}
+
+		cout
+			<< CGaussianOverlapKernel::getInstructionSetName(CGaussianOverlapKernel::getInstructionSet()) << " "
+			<< CGaussianOverlapKernel::getPrecisionName(anPRECISIONS[iPrecision]) << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs x " << nRounds << " rounds, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dDoubleSeconds / dSeconds : 0.0) << ", "
+			<< "Max relative deviation: " << dMaxRelativeDeviation << ", "
+			<< "Spearman mean/min: " << (nMOLECULES_COUNT > 0 ? dSpearmanSum / nMOLECULES_COUNT : 1.0) << "/" << dMinSpearman << ", "
+			<< "Top agreement: " << nTopAgreements << "/" << nMOLECULES_COUNT
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Report the effect of cross neighbor list skin on simplex alignment, aligning every pair among the first molecules of a
+ *	file with the same random starts for each skin. Skin 0, testing all atom pairs on each step, is the reference.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ * @param nMaxIntersectionOrder: (IN)
+ */
+int benchmarkNeighborList(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+
+	/* Same random starts as CGaussianService, 16 groups of 7 solutions. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+
+	/* Align all pairs with each skin. */
+	const double adSKINS[] = {0.0, 0.5, 1.0, 1.5, 2.0, 3.0};
+	const int nSKINS_COUNT = sizeof(adSKINS) / sizeof(adSKINS[0]);
+	vector<double> referenceOverlaps;
+	double dReferenceSeconds = 0.0;
+	for (int iSkin = 0; iSkin < nSKINS_COUNT; ++ iSkin)
+	{
+		vector<double> overlaps;
+		int nBuildsCount = 0;
+		int nUpdatesCount = 0;
+
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+				evaluator.setMaxIntersectionOrder(nMaxIntersectionOrder);
+				evaluator.setNeighborListSkin(adSKINS[iSkin]);
+
+				CSimplexOptimizer simplexOptimizer(evaluator, initialSolutionGroups);
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, 60);
+				overlaps.push_back(-dResultValue);
+
+				// If neighbor list enabled:
+				if (evaluator.getNeighborList())
+				{
+					nBuildsCount += evaluator.getNeighborList()->getBuildsCount();
+					nUpdatesCount += evaluator.getNeighborList()->getUpdatesCount();
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		// If skin 0, as the reference:
+		if (iSkin == 0)
+		{
+			referenceOverlaps = overlaps;
+			dReferenceSeconds = dSeconds;
+		}
+
+		double dMaxRelativeDeviation = 0.0;
+		for (int iOverlap = 0; iOverlap < static_cast<int>(overlaps.size()); ++ iOverlap)
+		{
+			const double dRelativeDeviation = std::abs(overlaps[iOverlap] - referenceOverlaps[iOverlap]) / std::abs(referenceOverlaps[iOverlap]);
+			dMaxRelativeDeviation = std::max(dMaxRelativeDeviation, dRelativeDeviation);
+		}
+
+		cout
+			<< CGaussianOverlapKernel::getInstructionSetName(CGaussianOverlapKernel::getInstructionSet()) << " "
+			<< "order " << nMaxIntersectionOrder << ", skin " << adSKINS[iSkin] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dReferenceSeconds / dSeconds : 0.0) << ", "
+			<< "Rebuilds/evaluations: " << nBuildsCount << "/" << nUpdatesCount << ", "
+			<< "Max relative deviation: " << dMaxRelativeDeviation
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Report the share of atom pairs skipped by bounding sphere culling during simplex alignment, aligning every fit molecule
+ *	to every reference molecule with the same random starts for each instruction set supported by current processor, e.g. pockets
+ *	"test_data/1CYD_pocket.pdb" and "test_data/1D4D_pocket.pdb".
+ * @param sRefFileName: (IN)
+ * @param sFitFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to read from each file.
+ */
+int benchmarkCulling(const std::string& sRefFileName, const std::string& sFitFileName, const int nMoleculesCount)
+{
+	/* Read centered molecules in place, as copying molecules with residues is not supported. */
+	const string asFILE_NAMES[] = {sRefFileName, sFitFileName};
+	vector<CMolecule> moleculeSets[2] = {vector<CMolecule>(nMoleculesCount), vector<CMolecule>(nMoleculesCount)};
+	int anMoleculesCounts[2] = {0, 0};
+	for (int iFile = 0; iFile < 2; ++ iFile)
+	{
+		auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(asFILE_NAMES[iFile]);
+		readerPtr->setReadHydrogenFlag(false);
+		while (anMoleculesCounts[iFile] < nMoleculesCount
+			&& readerPtr->readMolecule(moleculeSets[iFile][anMoleculesCounts[iFile]]) == IMoleculeReader::ErrorCodes::nNORMAL)
+		{
+			moleculeSets[iFile][anMoleculesCounts[iFile]].moveToCentroid();
+			++ anMoleculesCounts[iFile];
+		}
+	}
+	const vector<CMolecule>& refMolecules = moleculeSets[0];
+	const vector<CMolecule>& fitMolecules = moleculeSets[1];
+
+	/* Same random starts as CGaussianService, 16 groups of 7 solutions. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+
+	/* Align all pairs with each kernel. */
+	const int nORIGINAL_INSTRUCTION_SET = CGaussianOverlapKernel::getInstructionSet();
+	const int nBEST_INSTRUCTION_SET = CGaussianOverlapKernel::detectInstructionSet();
+	for (int iInstructionSet = CGaussianOverlapKernel::InstructionSets::nSCALAR; iInstructionSet <= nBEST_INSTRUCTION_SET; ++ iInstructionSet)
+	{
+		CGaussianOverlapKernel::setInstructionSet(iInstructionSet);
+		long long nCulledPairsCount = 0;
+		long long nPairsCount = 0;
+		double dOverlapSum = 0.0;
+
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < anMoleculesCounts[0]; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < anMoleculesCounts[1]; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(refMolecules[iRefMolecule], fitMolecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+
+				CSimplexOptimizer simplexOptimizer(evaluator, initialSolutionGroups);
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, 60);
+				dOverlapSum += -dResultValue;
+
+				nCulledPairsCount += evaluator.getCullingCounters().nCulledPairsCount;
+				nPairsCount += evaluator.getCullingCounters().nPairsCount;
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< CGaussianOverlapKernel::getInstructionSetName(iInstructionSet) << ": "
+			<< anMoleculesCounts[0] << " x " << anMoleculesCounts[1] << " alignments, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Overlap sum: " << dOverlapSum << ", "
+			<< "Culled pairs: " << (nPairsCount > 0 ? 100.0 * nCulledPairsCount / nPairsCount : 0.0) << "%"
+			<< endl;
+	}
+	CGaussianOverlapKernel::setInstructionSet(nORIGINAL_INSTRUCTION_SET);
+
+	return 0;
+}
+
+
+/**
+ * Description: Report interpolation error and speed of first order overlap on density grids of several spacings against the analytic
+ *	kernel, evaluating random poses of every pair among the first molecules of a file.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to evaluate pair-wise.
+ * @param nPosesCount: (IN) Number of random poses per pair.
+ */
+int benchmarkDensityGrid(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPosesCount)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+
+	/* Random poses around the centered reference molecule. */
+	const int nDIMENSIONS = 6;
+	vector<vector<double> > poses(nPosesCount, vector<double>(nDIMENSIONS));
+	srand(1);
+	for (int iPose = 0; iPose < nPosesCount; ++ iPose)
+	{
+		for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+		{
+			const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+			poses[iPose][iDimension] = dRandom * (iDimension < 3 ? 2.0 : 3.1415926);
+		}
+	}
+
+	/* Analytic overlaps as the reference. */
+	vector<double> analyticOverlaps;
+	TIME_START();
+	for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+	{
+		for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+		{
+			CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+			for (int iPose = 0; iPose < nPosesCount; ++ iPose)
+			{
+				analyticOverlaps.push_back(evaluator.getFunctionValue(poses[iPose]));
+			}
+		}
+	}
+	TIME_SECONDS(dAnalyticSeconds);
+	cout
+		<< "Analytic: " << nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs x " << nPosesCount << " poses, "
+		<< "Time(s): " << dAnalyticSeconds
+		<< endl;
+
+	/* Grid overlaps of each spacing. */
+	const double adSPACINGS[] = {0.2, 0.3, 0.4, 0.5};
+	const int nSPACINGS_COUNT = sizeof(adSPACINGS) / sizeof(adSPACINGS[0]);
+	const double dPADDING = 4.0;
+	for (int iSpacing = 0; iSpacing < nSPACINGS_COUNT; ++ iSpacing)
+	{
+		/* Sample grids of all reference molecules, with channels for all fit molecules. */
+		const clock_t nSAMPLING_START_CLOCK = clock();
+		vector<CGaussianVolume::PreparedMolecule> preparedMolecules(nMOLECULES_COUNT);
+		for (int iMolecule = 0; iMolecule < nMOLECULES_COUNT; ++ iMolecule)
+		{
+			CGaussianVolume::prepareMolecule(molecules[iMolecule], preparedMolecules[iMolecule]);
+		}
+		vector<CGaussianDensityGrid*> densityGrids;
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			densityGrids.push_back(new CGaussianDensityGrid(preparedMolecules[iRefMolecule], adSPACINGS[iSpacing], dPADDING, 0.0));
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				for (int iClass = 0; iClass < static_cast<int>(preparedMolecules[iFitMolecule].classRadii.size()); ++ iClass)
+				{
+					densityGrids.back()->getChannelId(preparedMolecules[iFitMolecule].classRadii[iClass], preparedMolecules[iFitMolecule].classAlphaValues[iClass]);
+				}
+			}
+		}
+		const double dSamplingSeconds = static_cast<double>(clock() - nSAMPLING_START_CLOCK) / CLOCKS_PER_SEC;
+
+		/* Evaluate the same poses. */
+		double dMaxRelativeError = 0.0;
+		double dRelativeErrorSum = 0.0;
+		int nComparedCount = 0;
+		int iOverlap = 0;
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setDensityGrid(densityGrids[iRefMolecule]);
+				for (int iPose = 0; iPose < nPosesCount; ++ iPose, ++ iOverlap)
+				{
+					const double dOverlap = evaluator.getFunctionValue(poses[iPose]);
+					// If any overlap:
+					if (analyticOverlaps[iOverlap] > 0)
+					{
+						const double dRelativeError = std::abs(dOverlap - analyticOverlaps[iOverlap]) / analyticOverlaps[iOverlap];
+						dMaxRelativeError = std::max(dMaxRelativeError, dRelativeError);
+						dRelativeErrorSum += dRelativeError;
+						++ nComparedCount;
+					}
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< "Grid spacing " << adSPACINGS[iSpacing] << ": "
+			<< "Nodes per channel: " << densityGrids.front()->getNodesCount() << ", "
+			<< "Sampling time(s): " << dSamplingSeconds << ", "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dAnalyticSeconds / dSeconds : 0.0) << ", "
+			<< "Relative error mean/max: " << (nComparedCount > 0 ? dRelativeErrorSum / nComparedCount : 0.0) << "/" << dMaxRelativeError
+			<< endl;
+
+		for (int iGrid = 0; iGrid < static_cast<int>(densityGrids.size()); ++ iGrid)
+		{
+			delete densityGrids[iGrid];
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Report the deviation of analytic overlap gradients from central differences, and the time of one value and gradient
+ *	evaluation against the 13 value evaluations of central differences, over random poses of every pair among the first molecules
+ *	of a file. Poses deviating beyond 1e-4 are counted separately, as central differences across the contact distance of an atom
+ *	pair see the jump of the cut off term.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to evaluate pair-wise.
+ * @param nPosesCount: (IN) Number of random poses per pair.
+ */
+int benchmarkOverlapGradient(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPosesCount)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+
+	/* Random poses around the centered reference molecule. */
+	const int nDIMENSIONS = 6;
+	vector<vector<double> > poses(nPosesCount, vector<double>(nDIMENSIONS));
+	srand(1);
+	for (int iPose = 0; iPose < nPosesCount; ++ iPose)
+	{
+		for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+		{
+			const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+			poses[iPose][iDimension] = dRandom * (iDimension < 3 ? 2.0 : 3.1415926);
+		}
+	}
+
+	/* Gradients by central differences as the reference. */
+	const double dSTEP = 1e-6;
+	vector<vector<double> > differenceGradients;
+	TIME_START();
+	for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+	{
+		for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+		{
+			CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+			for (int iPose = 0; iPose < nPosesCount; ++ iPose)
+			{
+				vector<double> shiftedPose(poses[iPose]);
+				vector<double> gradient(nDIMENSIONS);
+				evaluator.getFunctionValue(poses[iPose]);
+				for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+				{
+					shiftedPose[iDimension] = poses[iPose][iDimension] + dSTEP;
+					const double dForwardValue = evaluator.getFunctionValue(shiftedPose);
+					shiftedPose[iDimension] = poses[iPose][iDimension] - dSTEP;
+					const double dBackwardValue = evaluator.getFunctionValue(shiftedPose);
+					shiftedPose[iDimension] = poses[iPose][iDimension];
+					gradient[iDimension] = (dForwardValue - dBackwardValue) / (2 * dSTEP);
+				}
+				differenceGradients.push_back(gradient);
+			}
+		}
+	}
+	TIME_SECONDS(dDifferenceSeconds);
+
+	/* Analytic gradients of the same poses. */
+	const double dMAX_AGREEING_DEVIATION = 1e-4;
+	double dMaxRelativeDeviation = 0.0;
+	int nDeviatingCount = 0;
+	int iGradient = 0;
+	clock_t nAnalyticStartClock = clock();
+	for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+	{
+		for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+		{
+			CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+			vector<double> gradient;
+			for (int iPose = 0; iPose < nPosesCount; ++ iPose, ++ iGradient)
+			{
+				evaluator.getFunctionValueAndGradient(poses[iPose], gradient);
+
+				/* Deviation relative to the largest component, as components could vanish. */
+				const vector<double>& differenceGradient = differenceGradients[iGradient];
+				double dScale = 0.0;
+				double dDeviation = 0.0;
+				for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+				{
+					dScale = std::max(dScale, std::abs(differenceGradient[iDimension]));
+					dDeviation = std::max(dDeviation, std::abs(gradient[iDimension] - differenceGradient[iDimension]));
+				}
+				// If deviating, e.g. across a contact distance:
+				if (dScale > 1e-6 && dDeviation / dScale > dMAX_AGREEING_DEVIATION)
+				{
+					++ nDeviatingCount;
+				}
+				// If any gradient:
+				else if (dScale > 1e-6)
+				{
+					dMaxRelativeDeviation = std::max(dMaxRelativeDeviation, dDeviation / dScale);
+				}
+			}
+		}
+	}
+	const double dAnalyticSeconds = static_cast<double>(clock() - nAnalyticStartClock) / CLOCKS_PER_SEC;
+
+	cout
+		<< CGaussianOverlapKernel::getInstructionSetName(CGaussianOverlapKernel::getInstructionSet()) << ": "
+		<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs x " << nPosesCount << " poses, "
+		<< "Central differences time(s): " << dDifferenceSeconds << ", "
+		<< "Analytic time(s): " << dAnalyticSeconds << ", "
+		<< "Speedup: " << (dAnalyticSeconds > 0 ? dDifferenceSeconds / dAnalyticSeconds : 0.0) << ", "
+		<< "Max relative deviation: " << dMaxRelativeDeviation << ", "
+		<< "Deviating poses: " << nDeviatingCount << "/" << iGradient
+		<< endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Compare simplex and quasi-Newton optimizers on the alignment of every pair among the first molecules of a file, from
+ *	the same random starts as CGaussianService: 16 groups of 7 solutions for simplex, the first solution of each group for
+ *	quasi-Newton. Reports evaluations per alignment, time and mean max overlap of each optimizer.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ */
+int benchmarkOptimizers(const std::string& sMoleculeFileName, const int nMoleculesCount)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random starts. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	vector<vector<double> > initialSolutions(nGROUPS_COUNT);
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+		initialSolutions[iGroup] = initialSolutionGroups[iGroup].front();
+	}
+
+	/* Align all pairs with each optimizer. */
+	const string asOPTIMIZER_NAMES[] = {"Simplex", "Quasi-Newton"};
+	vector<double> maxOverlaps[2];
+	for (int iOptimizer = 0; iOptimizer < 2; ++ iOptimizer)
+	{
+		long long nEvaluationsCount = 0;
+		double dOverlapSum = 0.0;
+
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+				CCountingGradientEvaluator countingEvaluator(evaluator);
+
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				// If simplex:
+				if (iOptimizer == 0)
+				{
+					CSimplexOptimizer simplexOptimizer(countingEvaluator, initialSolutionGroups);
+					simplexOptimizer.setExtensionFactor(3.5);
+					simplexOptimizer.runOptimization(resultPoint, dResultValue, 60);
+				}
+				// If quasi-Newton:
+				else
+				{
+					CQuasiNewtonOptimizer quasiNewtonOptimizer(countingEvaluator, initialSolutions);
+					quasiNewtonOptimizer.runOptimization(resultPoint, dResultValue, 100);
+				}
+				nEvaluationsCount += countingEvaluator.getEvaluationsCount();
+				dOverlapSum += -dResultValue;
+				maxOverlaps[iOptimizer].push_back(-dResultValue);
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< asOPTIMIZER_NAMES[iOptimizer] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Evaluations per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(nEvaluationsCount) / nPAIRS_COUNT : 0.0) << ", "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0)
+			<< endl;
+	}
+
+	/* Compare pair by pair. */
+	int nBetterCount = 0;
+	int nWorseCount = 0;
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		// If quasi-Newton better by more than 0.1%:
+		if (maxOverlaps[1][iPair] > maxOverlaps[0][iPair] * 1.001)
+		{
+			++ nBetterCount;
+		}
+		// If quasi-Newton worse by more than 0.1%:
+		else if (maxOverlaps[1][iPair] < maxOverlaps[0][iPair] * 0.999)
+		{
+			++ nWorseCount;
+		}
+	}
+	cout << "Quasi-Newton better/worse than simplex: " << nBetterCount << "/" << nWorseCount << " of " << nPAIRS_COUNT << endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Measure convergence-based early termination of the simplex optimizer on the alignment of every pair among the first
+ *	molecules of a file, from the same 16 random groups as CGaussianService. Runs once without tolerances and once with the given
+ *	value tolerances, and reports evaluations per alignment, mean iterations per start, time and mean max overlap of each run.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ * @param nMaxIteration: (IN) Max iteration per start.
+ * @param dAbsoluteValueTolerance: (IN)
+ * @param dRelativeValueTolerance: (IN)
+ */
+int benchmarkSimplexConvergence(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIteration,
+	const double dAbsoluteValueTolerance, const double dRelativeValueTolerance)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random starts. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+
+	/* Align all pairs without and with tolerances. */
+	const string asRUN_NAMES[] = {"No tolerance", "Value tolerances"};
+	vector<double> maxOverlaps[2];
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		long long nEvaluationsCount = 0;
+		long long nIterationsCount = 0;
+		long long nStartsCount = 0;
+		double dOverlapSum = 0.0;
+
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+				CCountingGradientEvaluator countingEvaluator(evaluator);
+
+				CSimplexOptimizer simplexOptimizer(countingEvaluator, initialSolutionGroups);
+				simplexOptimizer.setExtensionFactor(3.5);
+				// If tolerances applied:
+				if (iRun == 1)
+				{
+					simplexOptimizer.setAbsoluteValueTolerance(dAbsoluteValueTolerance);
+					simplexOptimizer.setRelativeValueTolerance(dRelativeValueTolerance);
+				}
+
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, nMaxIteration);
+
+				const vector<int>& iterationsCounts = simplexOptimizer.getIterationsCounts();
+				nIterationsCount += std::accumulate(iterationsCounts.begin(), iterationsCounts.end(), 0LL);
+				nStartsCount += iterationsCounts.size();
+				nEvaluationsCount += countingEvaluator.getEvaluationsCount();
+				dOverlapSum += -dResultValue;
+				maxOverlaps[iRun].push_back(-dResultValue);
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Evaluations per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(nEvaluationsCount) / nPAIRS_COUNT : 0.0) << ", "
+			<< "Iterations per start: " << (nStartsCount > 0 ? static_cast<double>(nIterationsCount) / nStartsCount : 0.0) << ", "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0)
+			<< endl;
+	}
+
+	/* Count pairs losing overlap by early termination. */
+	int nWorseCount = 0;
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		// If worse by more than 0.1%:
+		if (maxOverlaps[1][iPair] < maxOverlaps[0][iPair] * 0.999)
+		{
+			++ nWorseCount;
+		}
+	}
+	cout << "Early termination worse: " << nWorseCount << " of " << nPAIRS_COUNT << endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Get wall clock time in seconds, for timing multi-threaded code where clock() sums processor time of all threads.
+ *	Falls back to clock() if built without OpenMP.
+ * @return:
+ */
+static double getWallSeconds()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+
+/**
+ * Description: Measure multi-start simplex run in parallel on the alignment of every pair among the first molecules of a file, from
+ *	the same 16 random groups as CGaussianService. Reports wall time per alignment and speedup for 1, 2, 4... threads up to the
+ *	number of processors, and whether results are identical to the single thread run.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ * @param nMaxIntersectionOrder: (IN)
+ */
+int benchmarkParallelSimplex(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random starts. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+
+	/* Threads counts to run with. */
+	int nProcessorsCount = 1;
+#ifdef _OPENMP
+	nProcessorsCount = omp_get_num_procs();
+#endif
+	vector<int> threadsCounts;
+	for (int nThreadsCount = 1; nThreadsCount < nProcessorsCount; nThreadsCount *= 2)
+	{
+		threadsCounts.push_back(nThreadsCount);
+	}
+	threadsCounts.push_back(nProcessorsCount);
+
+	/* Align all pairs with each threads count. */
+	vector<double> serialResults;
+	double dSerialSeconds = 0.0;
+	FOREACH(iterThreadsCount, threadsCounts, vector<int>::const_iterator)
+	{
+		vector<double> results;
+		const double dStartSeconds = getWallSeconds();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+				evaluator.setMaxIntersectionOrder(nMaxIntersectionOrder);
+
+				CSimplexOptimizer simplexOptimizer(evaluator, initialSolutionGroups);
+				simplexOptimizer.setExtensionFactor(3.5);
+				simplexOptimizer.setThreadsCount(*iterThreadsCount);
+
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, 60);
+				results.push_back(dResultValue);
+				results.insert(results.end(), resultPoint.begin(), resultPoint.end());
+			}
+		}
+		const double dSeconds = getWallSeconds() - dStartSeconds;
+
+		// If single thread:
+		if (iterThreadsCount == threadsCounts.begin())
+		{
+			serialResults = results;
+			dSerialSeconds = dSeconds;
+		}
+
+		cout
+			<< "Threads: " << *iterThreadsCount << ", "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Wall time per alignment(ms): " << (nPAIRS_COUNT > 0 ? 1000 * dSeconds / nPAIRS_COUNT : 0.0) << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dSerialSeconds / dSeconds : 0.0) << ", "
+			<< "Identical: " << (results == serialResults ? "yes" : "no")
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Measure pruning of unpromising simplex starts on the alignment of every pair among the first molecules of a file, from
+ *	the same 16 random groups as CGaussianService. Runs once without pruning and once with the given pruning fraction, and reports
+ *	evaluations per alignment, pruned starts, estimated evaluations saved, time and mean max overlap of each run, and the pairs
+ *	whose overlap is lost by pruning.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ * @param nMaxIteration: (IN) Max iteration per start.
+ * @param dPruningFraction: (IN)
+ */
+int benchmarkSimplexPruning(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIteration, const double dPruningFraction)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random starts. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+
+	/* Align all pairs without and with pruning. */
+	const string asRUN_NAMES[] = {"No pruning", "Pruning"};
+	vector<double> maxOverlaps[2];
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		long long nEvaluationsCount = 0;
+		long long nPrunedStartsCount = 0;
+		long long nSavedEvaluationsCount = 0;
+		double dOverlapSum = 0.0;
+
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+
+				CSimplexOptimizer simplexOptimizer(evaluator, initialSolutionGroups);
+				simplexOptimizer.setExtensionFactor(3.5);
+				simplexOptimizer.setPruningFraction(iRun == 0 ? 0.0 : dPruningFraction);
+
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, nMaxIteration);
+
+				nEvaluationsCount += simplexOptimizer.getEvaluationsCount();
+				nPrunedStartsCount += simplexOptimizer.getPrunedStartsCount();
+				nSavedEvaluationsCount += simplexOptimizer.getSavedEvaluationsCount();
+				dOverlapSum += -dResultValue;
+				maxOverlaps[iRun].push_back(-dResultValue);
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Evaluations per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(nEvaluationsCount) / nPAIRS_COUNT : 0.0) << ", "
+			<< "Pruned starts per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(nPrunedStartsCount) / nPAIRS_COUNT : 0.0) << ", "
+			<< "Estimated saved evaluations per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(nSavedEvaluationsCount) / nPAIRS_COUNT : 0.0) << ", "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0)
+			<< endl;
+	}
+
+	/* Count pairs losing overlap by pruning. */
+	int nWorseCount = 0;
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		// If worse by more than 0.1%:
+		if (maxOverlaps[1][iPair] < maxOverlaps[0][iPair] * 0.999)
+		{
+			++ nWorseCount;
+		}
+	}
+	cout << "Pruning worse: " << nWorseCount << " of " << nPAIRS_COUNT << endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Compare random and principal axes initial poses of CGaussianService on all pairs among the first molecules of a file.
+ *	Random poses run the default 16 groups, principal axes poses run 4 groups plus the given number of perturbed copies of each.
+ *	Reports time and mean overlap of each, and the number of pairs principal axes poses align worse than random ones.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN)
+ * @param nPerturbationsNumber: (IN)
+ */
+int benchmarkInitialPoses(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPerturbationsNumber)
+{
+	/* Read molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Align all pairs from random and principal axes poses. */
+	const string asRUN_NAMES[] = {"Random", "Principal axes"};
+	const int anINITIAL_POSES[] = {CGaussianService::InitialPoses::nRANDOM, CGaussianService::InitialPoses::nPRINCIPAL_AXES};
+	vector<double> maxOverlaps[2];
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		CGaussianService service;
+		service.setInitialPoses(anINITIAL_POSES[iRun]);
+		service.setPrincipalAxesPerturbationsNumber(nPerturbationsNumber);
+		srand(1);
+
+		double dOverlapSum = 0.0;
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			auto_ptr<CGaussianService::CPreparedQuery> preparedQueryPtr = service.prepareQuery(molecules[iRefMolecule]);
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				const double dOverlap = service.evaluateMaxGaussianVolumeOverlap(*preparedQueryPtr, molecules[iFitMolecule]);
+				dOverlapSum += dOverlap;
+				maxOverlaps[iRun].push_back(dOverlap);
+			}
+		}
+		TIME_SECONDS(dSeconds);
+
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0)
+			<< endl;
+	}
+
+	/* Count pairs aligned worse or better from principal axes poses. */
+	int nWorseCount = 0;
+	int nBetterCount = 0;
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		// If worse by more than 1%:
+		if (maxOverlaps[1][iPair] < maxOverlaps[0][iPair] * 0.99)
+		{
+			++ nWorseCount;
+		}
+		// If better by more than 1%:
+		else if (maxOverlaps[1][iPair] > maxOverlaps[0][iPair] * 1.01)
+		{
+			++ nBetterCount;
+		}
+	}
+	cout << "Principal axes worse: " << nWorseCount << ", better: " << nBetterCount << " of " << nPAIRS_COUNT << endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Measure batched evaluation of Gaussian volume overlap on every pair among the first molecules of a file, each pair
+ *	evaluating the same batch of random poses. Reports wall time of evaluating points one by one and as one batch on 1, 2, 4...
+ *	threads up to the number of processors, and whether batch values are identical to single point ones.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN)
+ * @param nPointsCount: (IN) Number of poses per batch.
+ * @param nMaxIntersectionOrder: (IN)
+ */
+int benchmarkBatchEvaluation(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPointsCount, const int nMaxIntersectionOrder)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+
+	/* Random poses near the origin, where overlap is not culled. */
+	const int nDIMENSIONS = 6;
+	vector<vector<double> > points(nPointsCount, vector<double>(nDIMENSIONS));
+	srand(1);
+	for (int iPoint = 0; iPoint < nPointsCount; ++ iPoint)
+	{
+		for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+		{
+			const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+			points[iPoint][iDimension] = dRandom * (iDimension < 3 ? 2.0 : 3.1415926);
+		}
+	}
+
+	/* Single point evaluations as reference. */
+	vector<double> referenceValues;
+	double dStartSeconds = getWallSeconds();
+	for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+	{
+		for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+		{
+			CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+			evaluator.setMaxIntersectionOrder(nMaxIntersectionOrder);
+			for (int iPoint = 0; iPoint < nPointsCount; ++ iPoint)
+			{
+				referenceValues.push_back(evaluator.getFunctionValue(points[iPoint]));
+			}
+		}
+	}
+	const double dSingleSeconds = getWallSeconds() - dStartSeconds;
+	cout << "Single points: " << nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " pairs, " << nPointsCount << " points each, Wall time(s): " << dSingleSeconds << endl;
+
+	/* Batches on growing numbers of threads. */
+	int nMaxThreadsCount = 1;
+#ifdef _OPENMP
+	nMaxThreadsCount = omp_get_num_procs();
+#endif
+	for (int nThreadsCount = 1; ; nThreadsCount = std::min(2 * nThreadsCount, nMaxThreadsCount))
+	{
+		vector<double> batchValues;
+		dStartSeconds = getWallSeconds();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setMaxIntersectionOrder(nMaxIntersectionOrder);
+				evaluator.setThreadsCount(nThreadsCount);
+
+				vector<double> values;
+				evaluator.getFunctionValues(points, values);
+				batchValues.insert(batchValues.end(), values.begin(), values.end());
+			}
+		}
+		const double dBatchSeconds = getWallSeconds() - dStartSeconds;
+
+		cout
+			<< "Batch, threads: " << nThreadsCount << ", "
+			<< "Wall time(s): " << dBatchSeconds << ", "
+			<< "Speedup: " << (dBatchSeconds > 0 ? dSingleSeconds / dBatchSeconds : 0.0) << ", "
+			<< "Identical: " << (batchValues == referenceValues ? "yes" : "no")
+			<< endl;
+
+		// If all processors used:
+		if (nThreadsCount >= nMaxThreadsCount)
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Run the genetic optimizer on Gaussian volume overlap of every pair among the first molecules of a file, from the same
+ *	random population and seed, on 1, 2, 4... threads up to the number of processors and at least 2. Reports wall time, speedup
+ *	and mean best overlap of each, and whether results are identical to the single thread run.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN)
+ * @param nPopulationSize: (IN)
+ * @param nGenerations: (IN)
+ */
+int benchmarkGeneticOptimizer(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nPopulationSize, const int nGenerations)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random initial population. */
+	const int nDIMENSIONS = 6;
+	vector<vector<double> > initialPopulation(nPopulationSize, vector<double>(nDIMENSIONS));
+	srand(1);
+	for (int iIndividual = 0; iIndividual < nPopulationSize; ++ iIndividual)
+	{
+		for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+		{
+			const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+			initialPopulation[iIndividual][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+		}
+	}
+
+	/* Optimize all pairs on growing numbers of threads. */
+	int nMaxThreadsCount = 2;
+#ifdef _OPENMP
+	nMaxThreadsCount = std::max(2, omp_get_num_procs());
+#endif
+	vector<vector<double> > referenceResults;
+	double dReferenceSeconds = 0.0;
+	for (int nThreadsCount = 1; ; nThreadsCount = std::min(2 * nThreadsCount, nMaxThreadsCount))
+	{
+		vector<vector<double> > results;
+		double dOverlapSum = 0.0;
+		const double dStartSeconds = getWallSeconds();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+
+				CGeneticOptimizer geneticOptimizer(evaluator, initialPopulation);
+				geneticOptimizer.setMaxIterations(nGenerations);
+				geneticOptimizer.setRandomSeed(1);
+				geneticOptimizer.setThreadsCount(nThreadsCount);
+
+				vector<double> resultPoint;
+				double dBestFitness = 0.0;
+				geneticOptimizer.runOptimization(resultPoint, dBestFitness);
+
+				resultPoint.push_back(dBestFitness);
+				results.push_back(resultPoint);
+				dOverlapSum += dBestFitness;
+			}
+		}
+		const double dSeconds = getWallSeconds() - dStartSeconds;
+		// If single thread:
+		if (nThreadsCount == 1)
+		{
+			referenceResults = results;
+			dReferenceSeconds = dSeconds;
+		}
+
+		cout
+			<< "Threads: " << nThreadsCount << ", "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Wall time(s): " << dSeconds << ", "
+			<< "Speedup: " << (dSeconds > 0 ? dReferenceSeconds / dSeconds : 0.0) << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0) << ", "
+			<< "Identical: " << (results == referenceResults ? "yes" : "no")
+			<< endl;
+
+		// If all processors used:
+		if (nThreadsCount >= nMaxThreadsCount)
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Compare multi-start simplex with memetic alignment on every pair among the first molecules of a file, both as run by
+ *	CGaussianService from random poses. Multi-start simplex runs 16 random groups on exact overlap. Memetic alignment runs the genetic
+ *	optimizer on first order overlap from random poses, keeping as many elites as individuals to refine, then simplex on exact overlap from its fittest individuals. A pair is solved
+ *	by a run if its overlap is within 1% of the best of both runs. Reports evaluations per alignment, split into first order and
+ *	exact ones for memetic alignment, time, mean overlap and solved pairs of each run.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN) Number of molecules to align pair-wise.
+ * @param nMaxIntersectionOrder: (IN) Max intersection order of exact overlap.
+ * @param nPopulationSize: (IN)
+ * @param nGenerations: (IN)
+ * @param nRefinedNumber: (IN) Number of fittest individuals refined by simplex.
+ */
+int benchmarkMemeticAlignment(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nMaxIntersectionOrder, const int nPopulationSize,
+	const int nGenerations, const int nRefinedNumber)
+{
+	/* Read centered molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecule.moveToCentroid();
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Random starts and random initial population. */
+	const int nGROUPS_COUNT = 16;
+	const int nDIMENSIONS = 6;
+	vector<vector<vector<double> > > initialSolutionGroups(nGROUPS_COUNT, vector<vector<double> >(nDIMENSIONS + 1, vector<double>(nDIMENSIONS)));
+	vector<vector<double> > initialPopulation(nPopulationSize, vector<double>(nDIMENSIONS));
+	srand(1);
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		for (int iSolution = 0; iSolution <= nDIMENSIONS; ++ iSolution)
+		{
+			for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+			{
+				const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+				initialSolutionGroups[iGroup][iSolution][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+			}
+		}
+	}
+	for (int iIndividual = 0; iIndividual < nPopulationSize; ++ iIndividual)
+	{
+		for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+		{
+			const double dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+			initialPopulation[iIndividual][iDimension] = dRandom * (iDimension < 3 ? 4.0 : 3.1415926);
+		}
+	}
+
+	/* Same mutation magnitudes and refinement steps as CGaussianService. */
+	vector<double> mutationMagnitude(nDIMENSIONS);
+	vector<double> refinementSteps(nDIMENSIONS);
+	for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+	{
+		mutationMagnitude[iDimension] = iDimension < 3 ? 1.0 : 0.5;
+		refinementSteps[iDimension] = iDimension < 3 ? 0.5 : 0.1;
+	}
+
+	/* Align all pairs by multi-start simplex and memetic alignment. */
+	const string asRUN_NAMES[] = {"Multi-start simplex", "Memetic"};
+	vector<double> maxOverlaps[2];
+	long long anEvaluationsCounts[2] = {0, 0};
+	long long nCoarseEvaluationsCount = 0;
+	double adSeconds[2] = {0.0, 0.0};
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		TIME_START();
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+				evaluator.setNegativeOverlapFlag(true);
+				evaluator.setMaxIntersectionOrder(nMaxIntersectionOrder);
+				CCountingGradientEvaluator countingEvaluator(evaluator);
+
+				vector<vector<vector<double> > > solutionGroups;
+				// If memetic:
+				if (iRun == 1)
+				{
+					CGaussianVolumeOverlapEvaluator coarseEvaluator(molecules[iRefMolecule], molecules[iFitMolecule]);
+					CCountingGradientEvaluator countingCoarseEvaluator(coarseEvaluator);
+
+					CGeneticOptimizer geneticOptimizer(countingCoarseEvaluator, initialPopulation);
+					geneticOptimizer.setElitesCount(std::min(nRefinedNumber, nPopulationSize));
+					geneticOptimizer.setMaxIterations(nGenerations);
+					geneticOptimizer.setMutationMagnitude(mutationMagnitude);
+					geneticOptimizer.setRandomSeed(1);
+
+					vector<double> bestIndividual;
+					double dBestFitness = 0.0;
+					geneticOptimizer.runOptimization(bestIndividual, dBestFitness);
+
+					vector<vector<double> > bestIndividuals;
+					vector<double> bestFitness;
+					geneticOptimizer.getBestIndividuals(nRefinedNumber, bestIndividuals, bestFitness);
+					for (int iIndividual = 0; iIndividual < static_cast<int>(bestIndividuals.size()); ++ iIndividual)
+					{
+						solutionGroups.push_back(vector<vector<double> >(nDIMENSIONS + 1, bestIndividuals[iIndividual]));
+						for (int iDimension = 0; iDimension < nDIMENSIONS; ++ iDimension)
+						{
+							solutionGroups.back()[iDimension + 1][iDimension] += refinementSteps[iDimension];
+						}
+					}
+					nCoarseEvaluationsCount += countingCoarseEvaluator.getEvaluationsCount();
+				}
+				// If multi-start simplex:
+				else
+				{
+					solutionGroups = initialSolutionGroups;
+				}
+
+				CSimplexOptimizer simplexOptimizer(countingEvaluator, solutionGroups);
+				simplexOptimizer.setExtensionFactor(3.5);
+
+				vector<double> resultPoint;
+				double dResultValue = 0.0;
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, 60);
+
+				anEvaluationsCounts[iRun] += countingEvaluator.getEvaluationsCount();
+				maxOverlaps[iRun].push_back(-dResultValue);
+			}
+		}
+		TIME_SECONDS(dSeconds);
+		adSeconds[iRun] = dSeconds;
+	}
+
+	/* Count pairs solved by each run. */
+	int anSolvedCounts[2] = {0, 0};
+	double adOverlapSums[2] = {0.0, 0.0};
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		const double dBestOverlap = std::max(maxOverlaps[0][iPair], maxOverlaps[1][iPair]);
+		for (int iRun = 0; iRun < 2; ++ iRun)
+		{
+			adOverlapSums[iRun] += maxOverlaps[iRun][iPair];
+			// If within 1% of the best:
+			if (maxOverlaps[iRun][iPair] >= dBestOverlap * 0.99)
+			{
+				++ anSolvedCounts[iRun];
+			}
+		}
+	}
+
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Evaluations per alignment: " << (nPAIRS_COUNT > 0 ? static_cast<double>(anEvaluationsCounts[iRun]) / nPAIRS_COUNT : 0.0);
+		// If memetic:
+		if (iRun == 1)
+		{
+			cout << " exact + " << (nPAIRS_COUNT > 0 ? static_cast<double>(nCoarseEvaluationsCount) / nPAIRS_COUNT : 0.0) << " first order";
+		}
+		cout
+			<< ", Time(s): " << adSeconds[iRun] << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? adOverlapSums[iRun] / nPAIRS_COUNT : 0.0) << ", "
+			<< "Solved: " << anSolvedCounts[iRun] << " of " << nPAIRS_COUNT
+			<< endl;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Description: Compare cold and warm started alignment of CGaussianService, screening each of the first molecules of a conformer file
+ *	against the whole file. Warm started alignment starts each conformer from the transformations of the previous conformer of the same
+ *	compound, plus the given number of random groups. Reports time, mean overlap of conformers and mean best overlap of compounds of each,
+ *	and the number of compounds whose best overlap warm start loses by more than 1%.
+ * @param sMoleculeFileName: (IN) Conformers of a compound are stored back to back under the same molecule name.
+ * @param nQueriesCount: (IN)
+ * @param nRandomGroupsNumber: (IN)
+ */
+int benchmarkWarmStart(const std::string& sMoleculeFileName, const int nQueriesCount, const int nRandomGroupsNumber)
+{
+	/* Read molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nQUERIES_COUNT = std::min(nQueriesCount, nMOLECULES_COUNT);
+
+	/* Screen from cold and warm starts. */
+	const string asRUN_NAMES[] = {"Cold start", "Warm start"};
+	vector<double> bestOverlaps[2];
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		CGaussianService service;
+		service.setWarmStartRandomGroupsNumber(nRandomGroupsNumber);
+		srand(1);
+
+		double dOverlapSum = 0.0;
+		double dBestOverlapSum = 0.0;
+		TIME_START();
+		for (int iQuery = 0; iQuery < nQUERIES_COUNT; ++ iQuery)
+		{
+			auto_ptr<CGaussianService::CPreparedQuery> preparedQueryPtr = service.prepareQuery(molecules[iQuery]);
+			vector<vector<double> > fitTransformations;
+			for (int iMolecule = 0; iMolecule < nMOLECULES_COUNT; ++ iMolecule)
+			{
+				const bool bSameCompound = iMolecule > 0 && molecules[iMolecule].getMolecularName() == molecules[iMolecule - 1].getMolecularName();
+				const vector<vector<double> > warmStartTransformations = fitTransformations;
+				const double dOverlap = service.evaluateMaxGaussianVolumeOverlap(*preparedQueryPtr, molecules[iMolecule], &fitTransformations,
+					iRun == 1 && bSameCompound ? &warmStartTransformations : NULL);
+				dOverlapSum += dOverlap;
+
+				// If first conformer of a compound:
+				if (!bSameCompound)
+				{
+					bestOverlaps[iRun].push_back(dOverlap);
+				}
+				else
+				{
+					bestOverlaps[iRun].back() = std::max(bestOverlaps[iRun].back(), dOverlap);
+				}
+			}
+		}
+		TIME_SECONDS(dSeconds);
+		for (int iCompound = 0; iCompound < static_cast<int>(bestOverlaps[iRun].size()); ++ iCompound)
+		{
+			dBestOverlapSum += bestOverlaps[iRun][iCompound];
+		}
+
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nQUERIES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nQUERIES_COUNT > 0 ? dOverlapSum / (nQUERIES_COUNT * nMOLECULES_COUNT) : 0.0) << ", "
+			<< "Mean best overlap of compounds: " << (bestOverlaps[iRun].empty() ? 0.0 : dBestOverlapSum / bestOverlaps[iRun].size())
+			<< endl;
+	}
+
+	/* Count compounds whose best overlap warm start loses. */
+	int nWorseCount = 0;
+	for (int iCompound = 0; iCompound < static_cast<int>(bestOverlaps[0].size()); ++ iCompound)
+	{
+		// If worse by more than 1%:
+		if (bestOverlaps[1][iCompound] < bestOverlaps[0][iCompound] * 0.99)
+		{
+			++ nWorseCount;
+		}
+	}
+	cout << "Warm start worse: " << nWorseCount << " of " << bestOverlaps[0].size() << " query compound pairs" << endl;
+
+	return 0;
+}
+
+
+/**
+ * Description: Compare Euler angles and rotation vectors as the rotation part of poses optimized by CGaussianService, on the
+ *	alignment of every pair among the first molecules of a file with the given optimizer. Reports time and mean max overlap of
+ *	each parameterization, pairs aligned worse or better with rotation vectors, and the max deviation of the overlap recalculated
+ *	from the returned transformations, which are given with rotation angles either way.
+ * @param sMoleculeFileName: (IN)
+ * @param nMoleculesCount: (IN)
+ * @param nOptimizer: (IN) One of CGaussianService::Optimizers.
+ */
+int benchmarkPoseParameterization(const std::string& sMoleculeFileName, const int nMoleculesCount, const int nOptimizer)
+{
+	/* Read molecules. */
+	vector<CMolecule> molecules;
+	auto_ptr<IMoleculeReader> readerPtr = CMoleculeReaderManager::getMoleculeReader(sMoleculeFileName);
+	readerPtr->setReadHydrogenFlag(false);
+	CMolecule molecule;
+	while (static_cast<int>(molecules.size()) < nMoleculesCount && readerPtr->readMolecule(molecule) == IMoleculeReader::ErrorCodes::nNORMAL)
+	{
+		molecules.push_back(molecule);
+	}
+	const int nMOLECULES_COUNT = molecules.size();
+	const int nPAIRS_COUNT = nMOLECULES_COUNT * nMOLECULES_COUNT;
+
+	/* Align all pairs with each parameterization. */
+	const string asRUN_NAMES[] = {"Euler angles", "Rotation vector"};
+	const int anPOSE_PARAMETERIZATIONS[] = {
+		CGaussianVolumeOverlapEvaluator::PoseParameterizations::nEULER_ANGLES,
+		CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR
+		};
+	const vector<double> ZERO_POSE(6, 0.0);
+	vector<double> maxOverlaps[2];
+	for (int iRun = 0; iRun < 2; ++ iRun)
+	{
+		CGaussianService service;
+		service.setOptimizer(nOptimizer);
+		service.setPoseParameterization(anPOSE_PARAMETERIZATIONS[iRun]);
+		srand(1);
+
+		double dOverlapSum = 0.0;
+		double dMaxDeviation = 0.0;
+		double dSeconds = 0.0;
+		vector<vector<double> > fitTransformations;
+		for (int iRefMolecule = 0; iRefMolecule < nMOLECULES_COUNT; ++ iRefMolecule)
+		{
+			auto_ptr<CGaussianService::CPreparedQuery> preparedQueryPtr = service.prepareQuery(molecules[iRefMolecule]);
+			for (int iFitMolecule = 0; iFitMolecule < nMOLECULES_COUNT; ++ iFitMolecule)
+			{
+				const clock_t nStartClock = clock();
+				const double dOverlap = service.evaluateMaxGaussianVolumeOverlap(*preparedQueryPtr, molecules[iFitMolecule], &fitTransformations);
+				dSeconds += static_cast<double>(clock() - nStartClock) / CLOCKS_PER_SEC;
+				dOverlapSum += dOverlap;
+				maxOverlaps[iRun].push_back(dOverlap);
+
+				/* Recalculate the overlap of the fit molecule moved by the transformations. */
+				CMolecule fitMolecule(molecules[iFitMolecule]);
+				fitMolecule.move(fitTransformations[0][0], fitTransformations[0][1], fitTransformations[0][2]);
+				fitMolecule.rotateXYZ(fitTransformations[1][0], fitTransformations[1][1], fitTransformations[1][2]);
+				fitMolecule.move(fitTransformations[2][0], fitTransformations[2][1], fitTransformations[2][2]);
+				CGaussianVolumeOverlapEvaluator evaluator(molecules[iRefMolecule], fitMolecule);
+				evaluator.setMaxIntersectionOrder(service.getGaussianMaxIntersectionOrder());
+				dMaxDeviation = std::max(dMaxDeviation, std::abs(evaluator.getFunctionValue(ZERO_POSE) - dOverlap));
+			}
+		}
+
+		cout
+			<< asRUN_NAMES[iRun] << ": "
+			<< nMOLECULES_COUNT << " x " << nMOLECULES_COUNT << " alignments, "
+			<< "Time(s): " << dSeconds << ", "
+			<< "Mean overlap: " << (nPAIRS_COUNT > 0 ? dOverlapSum / nPAIRS_COUNT : 0.0) << ", "
+			<< "Max deviation of recalculated overlap: " << dMaxDeviation
+			<< endl;
+	}
+
+	/* Count pairs aligned worse or better with rotation vectors. */
+	int nWorseCount = 0;
+	int nBetterCount = 0;
+	for (int iPair = 0; iPair < nPAIRS_COUNT; ++ iPair)
+	{
+		// If worse by more than 1%:
+		if (maxOverlaps[1][iPair] < maxOverlaps[0][iPair] * 0.99)
+		{
+			++ nWorseCount;
+		}
+		// If better by more than 1%:
+		else if (maxOverlaps[1][iPair] > maxOverlaps[0][iPair] * 1.01)
+		{
+			++ nBetterCount;
+		}
+	}
+	cout << "Rotation vector worse: " << nWorseCount << ", better: " << nBetterCount << " of " << nPAIRS_COUNT << endl;
+
+	return 0;
+}
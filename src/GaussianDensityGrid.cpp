@@ -0,0 +1,284 @@
+/**
+ * Gaussian Density Grid Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file GaussianDensityGrid.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-10
+ */
+
+
+#include "GaussianDensityGrid.h"
+
+#include "Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+
+using std::vector;
+
+
+/* Implementation for CGaussianDensityGrid class: */
+
+/* Static members: */
+const int CGaussianDensityGrid::ErrorCodes::nNORMAL = 0;
+
+const double CGaussianDensityGrid::_dPI = 3.14159265358;
+
+
+/**
+ * Description: Ctor, laying out the grid over the reference atoms. No channel is sampled until first used.
+ * @param refMolecule: (IN) Prepared reference molecule, copied.
+ * @param dSpacing: (IN) A positive distance between neighbor nodes, trading interpolation error for memory and sampling time.
+ * @param dPadding: (IN) A non-negative distance the grid extends beyond reference atom centers on each side.
+ * @param dGaussianCutoff: (IN) Gaussian cutoff of the contact test, as for the overlap kernel.
+ * @exception: CInvalidArgumentException
+ */
+CGaussianDensityGrid::CGaussianDensityGrid(
+	const CGaussianVolume::PreparedMolecule& refMolecule,
+	const double dSpacing,
+	const double dPadding,
+	const double dGaussianCutoff
+	) :
+	_dGaussianCutoff(dGaussianCutoff),
+	_dOriginX(0),
+	_dOriginY(0),
+	_dOriginZ(0),
+	_dPadding(dPadding),
+	_dSpacing(dSpacing),
+	_nXNodesCount(0),
+	_nYNodesCount(0),
+	_nZNodesCount(0),
+	_refMolecule(refMolecule)
+{
+	// If invalid parameter:
+	if (!(dSpacing > 0) || !(dPadding >= 0))
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dSpacing = " << dSpacing << ", "
+			<< "dPadding = " << dPadding;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	// If any atom:
+	if (!refMolecule.radii.empty())
+	{
+		/* Bounding box of atom centers, grown by padding and rounded up to whole spacings. */
+		const double adMINS[3] = {
+			*std::min_element(refMolecule.xCoordinates.begin(), refMolecule.xCoordinates.end()),
+			*std::min_element(refMolecule.yCoordinates.begin(), refMolecule.yCoordinates.end()),
+			*std::min_element(refMolecule.zCoordinates.begin(), refMolecule.zCoordinates.end())
+			};
+		const double adMAXS[3] = {
+			*std::max_element(refMolecule.xCoordinates.begin(), refMolecule.xCoordinates.end()),
+			*std::max_element(refMolecule.yCoordinates.begin(), refMolecule.yCoordinates.end()),
+			*std::max_element(refMolecule.zCoordinates.begin(), refMolecule.zCoordinates.end())
+			};
+		int anNodesCounts[3];
+		for (int iAxis = 0; iAxis < 3; ++ iAxis)
+		{
+			anNodesCounts[iAxis] = static_cast<int>(ceil((adMAXS[iAxis] - adMINS[iAxis] + 2 * dPadding) / dSpacing)) + 1;
+		}
+
+		_dOriginX = adMINS[0] - dPadding;
+		_dOriginY = adMINS[1] - dPadding;
+		_dOriginZ = adMINS[2] - dPadding;
+		_nXNodesCount = anNodesCounts[0];
+		_nYNodesCount = anNodesCounts[1];
+		_nZNodesCount = anNodesCounts[2];
+	}
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CGaussianDensityGrid::~CGaussianDensityGrid()
+{
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of a fit molecule with the reference molecule, interpolating each fit atom
+ *	trilinearly in the channel of its radius.
+ * @param fitMolecule: (IN) Prepared fit molecule in its current pose.
+ * @param classChannelIds: (IN) Channel ID of each radius class of fit molecule, see getChannelId().
+ * @return: Overlap volume scalar.
+ */
+double CGaussianDensityGrid::calculateOverlapVolume(const CGaussianVolume::PreparedMolecule& fitMolecule, const std::vector<int>& classChannelIds) const
+{
+	const int nFIT_ATOMS_COUNT = fitMolecule.radii.size();
+	const int nZ_STRIDE = 1;
+	const int nY_STRIDE = _nZNodesCount;
+	const int nX_STRIDE = _nYNodesCount * _nZNodesCount;
+	double dOverlap = 0.0;
+
+	// For each atom in fit molecule:
+	for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+	{
+		const double dX = (fitMolecule.xCoordinates[iFitAtom] - _dOriginX) / _dSpacing;
+		const double dY = (fitMolecule.yCoordinates[iFitAtom] - _dOriginY) / _dSpacing;
+		const double dZ = (fitMolecule.zCoordinates[iFitAtom] - _dOriginZ) / _dSpacing;
+		// If out of grid:
+		if (!(dX >= 0 && dY >= 0 && dZ >= 0 && dX < _nXNodesCount - 1 && dY < _nYNodesCount - 1 && dZ < _nZNodesCount - 1))
+		{
+			continue;
+		}
+
+		const int nX = static_cast<int>(dX);
+		const int nY = static_cast<int>(dY);
+		const int nZ = static_cast<int>(dZ);
+		const double dTX = dX - nX;
+		const double dTY = dY - nY;
+		const double dTZ = dZ - nZ;
+		const double* const pNode = &_channels[classChannelIds[fitMolecule.radiusClassIds[iFitAtom]]][nX * nX_STRIDE + nY * nY_STRIDE + nZ];
+
+		/* Interpolate along Z, then Y, then X. */
+		const double dV00 = pNode[0] + dTZ * (pNode[nZ_STRIDE] - pNode[0]);
+		const double dV01 = pNode[nY_STRIDE] + dTZ * (pNode[nY_STRIDE + nZ_STRIDE] - pNode[nY_STRIDE]);
+		const double dV10 = pNode[nX_STRIDE] + dTZ * (pNode[nX_STRIDE + nZ_STRIDE] - pNode[nX_STRIDE]);
+		const double dV11 = pNode[nX_STRIDE + nY_STRIDE] + dTZ * (pNode[nX_STRIDE + nY_STRIDE + nZ_STRIDE] - pNode[nX_STRIDE + nY_STRIDE]);
+		const double dV0 = dV00 + dTY * (dV01 - dV00);
+		const double dV1 = dV10 + dTY * (dV11 - dV10);
+		dOverlap += dV0 + dTX * (dV1 - dV0);
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: Look up the channel of a fit atom radius, sampling it on first use.
+ * @param dFitRadius: (IN) Fit atom radius, channels are matched by exact value as radius classes of prepared molecules are.
+ * @param dFitAlpha: (IN) Alpha value of fit atoms of that radius, used only when the channel is sampled.
+ * @return: Channel ID.
+ */
+int CGaussianDensityGrid::getChannelId(const double dFitRadius, const double dFitAlpha) const
+{
+	const vector<double>::const_iterator iterRadius = std::find(_channelRadii.begin(), _channelRadii.end(), dFitRadius);
+	// If sampled:
+	if (iterRadius != _channelRadii.end())
+	{
+		return iterRadius - _channelRadii.begin();
+	}
+	// If first use:
+	else
+	{
+		sampleChannel(dFitRadius, dFitAlpha);
+		return _channels.size() - 1;
+	}
+}
+
+
+/**
+ * Description:
+ * @return: Number of channels sampled so far.
+ */
+int CGaussianDensityGrid::getChannelsCount() const
+{
+	return _channels.size();
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianDensityGrid::getGaussianCutoff() const
+{
+	return _dGaussianCutoff;
+}
+
+
+/**
+ * Description:
+ * @return: Number of nodes of each channel.
+ */
+int CGaussianDensityGrid::getNodesCount() const
+{
+	return _nXNodesCount * _nYNodesCount * _nZNodesCount;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianDensityGrid::getPadding() const
+{
+	return _dPadding;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianDensityGrid::getSpacing() const
+{
+	return _dSpacing;
+}
+
+
+/**
+ * Description: Sample a new channel. Each reference atom only visits the nodes within its contact distance, adding the same pair
+ *	term as the scalar overlap kernel.
+ * @param dFitRadius: (IN)
+ * @param dFitAlpha: (IN)
+ */
+int CGaussianDensityGrid::sampleChannel(const double dFitRadius, const double dFitAlpha) const
+{
+	_channelRadii.push_back(dFitRadius);
+	_channels.push_back(vector<double>(getNodesCount(), 0.0));
+	vector<double>& channel = _channels.back();
+
+	const int nREF_ATOMS_COUNT = _refMolecule.radii.size();
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = _refMolecule.xCoordinates[iRefAtom];
+		const double dRefY = _refMolecule.yCoordinates[iRefAtom];
+		const double dRefZ = _refMolecule.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = _refMolecule.alphaValues[iRefAtom];
+		const double dContactDistance = _refMolecule.radii[iRefAtom] + dFitRadius + _dGaussianCutoff;
+		const double dPrefactor = 8 * pow(_dPI / (dAlphaRefAtom + dFitAlpha), 1.5);
+		const double dExponentFactor = dAlphaRefAtom * dFitAlpha / (dAlphaRefAtom + dFitAlpha);
+
+		/* Node range covering the contact sphere. */
+		const int nMIN_X = std::max(0, static_cast<int>(ceil((dRefX - dContactDistance - _dOriginX) / _dSpacing)));
+		const int nMAX_X = std::min(_nXNodesCount - 1, static_cast<int>(floor((dRefX + dContactDistance - _dOriginX) / _dSpacing)));
+		const int nMIN_Y = std::max(0, static_cast<int>(ceil((dRefY - dContactDistance - _dOriginY) / _dSpacing)));
+		const int nMAX_Y = std::min(_nYNodesCount - 1, static_cast<int>(floor((dRefY + dContactDistance - _dOriginY) / _dSpacing)));
+		const int nMIN_Z = std::max(0, static_cast<int>(ceil((dRefZ - dContactDistance - _dOriginZ) / _dSpacing)));
+		const int nMAX_Z = std::min(_nZNodesCount - 1, static_cast<int>(floor((dRefZ + dContactDistance - _dOriginZ) / _dSpacing)));
+
+		for (int iX = nMIN_X; iX <= nMAX_X; ++ iX)
+		{
+			const double dDeltaX = _dOriginX + iX * _dSpacing - dRefX;
+			for (int iY = nMIN_Y; iY <= nMAX_Y; ++ iY)
+			{
+				const double dDeltaY = _dOriginY + iY * _dSpacing - dRefY;
+				double* const pRow = &channel[(iX * _nYNodesCount + iY) * _nZNodesCount];
+				for (int iZ = nMIN_Z; iZ <= nMAX_Z; ++ iZ)
+				{
+					const double dDeltaZ = _dOriginZ + iZ * _dSpacing - dRefZ;
+					const double dR2 = dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ;
+					// If in contact:
+					if (dR2 < dContactDistance * dContactDistance)
+					{
+						pRow[iZ] += dPrefactor * exp(-dExponentFactor * dR2);
+					}
+				}
+			}
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
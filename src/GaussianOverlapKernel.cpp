@@ -0,0 +1,2017 @@
+/**
+ * Gaussian Overlap Kernel Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file GaussianOverlapKernel.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2010-10-20
+ */
+
+
+#include "GaussianOverlapKernel.h"
+
+#include "CrossNeighborList.h"
+#include "Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+
+/* SIMD kernels are only available for x86 processors with GCC compatible compilers. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+#include <immintrin.h>
+#endif
+
+
+using std::string;
+
+
+/* Implementation for CGaussianOverlapKernel class: */
+
+/* Static Members: */
+const int CGaussianOverlapKernel::ErrorCodes::nNORMAL = 0;
+
+const int CGaussianOverlapKernel::InstructionSets::nSCALAR = 0;
+const int CGaussianOverlapKernel::InstructionSets::nSSE2 = 1;
+const int CGaussianOverlapKernel::InstructionSets::nAVX2 = 2;
+
+const int CGaussianOverlapKernel::Precisions::nDOUBLE = 0;
+const int CGaussianOverlapKernel::Precisions::nFLOAT = 1;
+
+const double CGaussianOverlapKernel::dMAX_RELATIVE_DEVIATION = 1e-12;
+const int CGaussianOverlapKernel::_nMAX_EXP_POLYNOMIAL_DEGREE = 13;
+const double CGaussianOverlapKernel::_dPI = 3.14159265358;
+
+int CGaussianOverlapKernel::_nInstructionSet = CGaussianOverlapKernel::detectInstructionSet();
+
+
+/* Constants for range reduction of exp(), following the Cephes library. */
+// max absolute value of exponent, keeping 2^n a normal number
+static const double dEXP_ARGUMENT_LIMIT = 708.0;
+static const double dEXP_LOG2E = 1.4426950408889634073599;
+static const double dEXP_C1 = 6.93145751953125E-1;
+static const double dEXP_C2 = 1.42860682030941723212E-6;
+// max absolute value of reduced argument, ln2 / 2
+static const double dEXP_MAX_REDUCED_ARGUMENT = 0.34657359027997264;
+
+/* Coefficients of the truncated Taylor polynomial of exp() in fast mode, 1 / k!. */
+static const double adEXP_TAYLOR_COEFFICIENTS[] =
+{
+	1.0,
+	1.0,
+	1.0 / 2,
+	1.0 / 6,
+	1.0 / 24,
+	1.0 / 120,
+	1.0 / 720,
+	1.0 / 5040,
+	1.0 / 40320,
+	1.0 / 362880,
+	1.0 / 3628800,
+	1.0 / 39916800,
+	1.0 / 479001600,
+	1.0 / 6227020800.0
+};
+
+
+/**
+ * Description: exp() by a truncated Taylor polynomial after range reduction, valid for arguments in [-708, 708].
+ * @param x: (IN)
+ * @param nDegree: (IN) Degree of polynomial.
+ * @return:
+ */
+static inline double fastExp(double x, const int nDegree)
+{
+	x = std::max(std::min(x, dEXP_ARGUMENT_LIMIT), -dEXP_ARGUMENT_LIMIT);
+
+	/* Range reduction: x = n * ln2 + r. */
+	const double dN = floor(x * dEXP_LOG2E + 0.5);
+	const double dR = x - dN * dEXP_C1 - dN * dEXP_C2;
+
+	double dPolynomial = adEXP_TAYLOR_COEFFICIENTS[nDegree];
+	for (int iCoefficient = nDegree - 1; iCoefficient >= 0; -- iCoefficient)
+	{
+		dPolynomial = dPolynomial * dR + adEXP_TAYLOR_COEFFICIENTS[iCoefficient];
+	}
+
+	return ldexp(dPolynomial, static_cast<int>(dN));
+}
+
+
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+
+/* Constants for the vectorized exp(), following the rational approximation of the Cephes library. */
+static const double dEXP_P0 = 1.26177193074810590878E-4;
+static const double dEXP_P1 = 3.02994407707441961300E-2;
+static const double dEXP_P2 = 9.99999999999999999910E-1;
+static const double dEXP_Q0 = 3.00198505138664455042E-6;
+static const double dEXP_Q1 = 2.52448340349684104192E-3;
+static const double dEXP_Q2 = 2.27265548208155028766E-1;
+static const double dEXP_Q3 = 2.00000000000000000009E0;
+// 1.5 * 2^52, adding it to a double rounds it to integer and exposes the integer in the low bits of the mantissa
+static const double dEXP_ROUNDING_MAGIC = 6755399441055744.0;
+
+/* Constants for the vectorized single precision exp(), following the polynomial approximation of the Cephes library. */
+// max absolute value of exponent, keeping 2^n a normal number
+static const float fEXP_ARGUMENT_LIMIT = 87.0f;
+static const float fEXP_LOG2E = 1.44269504088896341f;
+static const float fEXP_C1 = 0.693359375f;
+static const float fEXP_C2 = -2.12194440e-4f;
+static const float fEXP_P0 = 1.9875691500E-4f;
+static const float fEXP_P1 = 1.3981999507E-3f;
+static const float fEXP_P2 = 8.3334519073E-3f;
+static const float fEXP_P3 = 4.1665795894E-2f;
+static const float fEXP_P4 = 1.6666665459E-1f;
+static const float fEXP_P5 = 5.0000001201E-1f;
+
+
+/**
+ * Description: Vectorized exp() of two double values, valid for arguments in [-708, 708].
+ * @param x: (IN)
+ * @return:
+ */
+__attribute__((target("sse2")))
+static inline __m128d expSse2(__m128d x)
+{
+	x = _mm_max_pd(x, _mm_set1_pd(-dEXP_ARGUMENT_LIMIT));
+	x = _mm_min_pd(x, _mm_set1_pd(dEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m128d magic = _mm_set1_pd(dEXP_ROUNDING_MAGIC);
+	const __m128d nShifted = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(dEXP_LOG2E)), magic);
+	const __m128d n = _mm_sub_pd(nShifted, magic);
+	x = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(dEXP_C1)));
+	x = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(dEXP_C2)));
+
+	/* Rational approximation: exp(r) = 1 + 2 * r * P(r^2) / (Q(r^2) - r * P(r^2)). */
+	const __m128d xx = _mm_mul_pd(x, x);
+	__m128d px = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(dEXP_P0), xx), _mm_set1_pd(dEXP_P1));
+	px = _mm_add_pd(_mm_mul_pd(px, xx), _mm_set1_pd(dEXP_P2));
+	px = _mm_mul_pd(px, x);
+	__m128d qx = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(dEXP_Q0), xx), _mm_set1_pd(dEXP_Q1));
+	qx = _mm_add_pd(_mm_mul_pd(qx, xx), _mm_set1_pd(dEXP_Q2));
+	qx = _mm_add_pd(_mm_mul_pd(qx, xx), _mm_set1_pd(dEXP_Q3));
+	x = _mm_div_pd(px, _mm_sub_pd(qx, px));
+	x = _mm_add_pd(_mm_set1_pd(1.0), _mm_add_pd(x, x));
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m128i nInteger = _mm_sub_epi64(_mm_castpd_si128(nShifted), _mm_castpd_si128(magic));
+	const __m128i scale = _mm_slli_epi64(_mm_add_epi64(nInteger, _mm_set1_epi64x(1023)), 52);
+
+	return _mm_mul_pd(x, _mm_castsi128_pd(scale));
+}
+
+
+/**
+ * Description: Vectorized exp() of four double values, valid for arguments in [-708, 708].
+ * @param x: (IN)
+ * @return:
+ */
+__attribute__((target("avx2")))
+static inline __m256d expAvx2(__m256d x)
+{
+	x = _mm256_max_pd(x, _mm256_set1_pd(-dEXP_ARGUMENT_LIMIT));
+	x = _mm256_min_pd(x, _mm256_set1_pd(dEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m256d magic = _mm256_set1_pd(dEXP_ROUNDING_MAGIC);
+	const __m256d nShifted = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(dEXP_LOG2E)), magic);
+	const __m256d n = _mm256_sub_pd(nShifted, magic);
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(dEXP_C1)));
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(dEXP_C2)));
+
+	/* Rational approximation: exp(r) = 1 + 2 * r * P(r^2) / (Q(r^2) - r * P(r^2)). */
+	const __m256d xx = _mm256_mul_pd(x, x);
+	__m256d px = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(dEXP_P0), xx), _mm256_set1_pd(dEXP_P1));
+	px = _mm256_add_pd(_mm256_mul_pd(px, xx), _mm256_set1_pd(dEXP_P2));
+	px = _mm256_mul_pd(px, x);
+	__m256d qx = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(dEXP_Q0), xx), _mm256_set1_pd(dEXP_Q1));
+	qx = _mm256_add_pd(_mm256_mul_pd(qx, xx), _mm256_set1_pd(dEXP_Q2));
+	qx = _mm256_add_pd(_mm256_mul_pd(qx, xx), _mm256_set1_pd(dEXP_Q3));
+	x = _mm256_div_pd(px, _mm256_sub_pd(qx, px));
+	x = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_add_pd(x, x));
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m256i nInteger = _mm256_sub_epi64(_mm256_castpd_si256(nShifted), _mm256_castpd_si256(magic));
+	const __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(nInteger, _mm256_set1_epi64x(1023)), 52);
+
+	return _mm256_mul_pd(x, _mm256_castsi256_pd(scale));
+}
+
+
+/**
+ * Description: Vectorized exp() of four float values, valid for arguments in [-87, 87].
+ * @param x: (IN)
+ * @return:
+ */
+__attribute__((target("sse2")))
+static inline __m128 expFloatSse2(__m128 x)
+{
+	x = _mm_max_ps(x, _mm_set1_ps(-fEXP_ARGUMENT_LIMIT));
+	x = _mm_min_ps(x, _mm_set1_ps(fEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m128i nInteger = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(fEXP_LOG2E)));
+	const __m128 n = _mm_cvtepi32_ps(nInteger);
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(fEXP_C1)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(fEXP_C2)));
+
+	/* Polynomial approximation: exp(r) = 1 + r + r^2 * P(r). */
+	__m128 px = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fEXP_P0), x), _mm_set1_ps(fEXP_P1));
+	px = _mm_add_ps(_mm_mul_ps(px, x), _mm_set1_ps(fEXP_P2));
+	px = _mm_add_ps(_mm_mul_ps(px, x), _mm_set1_ps(fEXP_P3));
+	px = _mm_add_ps(_mm_mul_ps(px, x), _mm_set1_ps(fEXP_P4));
+	px = _mm_add_ps(_mm_mul_ps(px, x), _mm_set1_ps(fEXP_P5));
+	px = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(px, x), x), x), _mm_set1_ps(1.0f));
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m128i scale = _mm_slli_epi32(_mm_add_epi32(nInteger, _mm_set1_epi32(127)), 23);
+
+	return _mm_mul_ps(px, _mm_castsi128_ps(scale));
+}
+
+
+/**
+ * Description: Vectorized exp() of eight float values, valid for arguments in [-87, 87].
+ * @param x: (IN)
+ * @return:
+ */
+__attribute__((target("avx2")))
+static inline __m256 expFloatAvx2(__m256 x)
+{
+	x = _mm256_max_ps(x, _mm256_set1_ps(-fEXP_ARGUMENT_LIMIT));
+	x = _mm256_min_ps(x, _mm256_set1_ps(fEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m256i nInteger = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(fEXP_LOG2E)));
+	const __m256 n = _mm256_cvtepi32_ps(nInteger);
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(fEXP_C1)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(fEXP_C2)));
+
+	/* Polynomial approximation: exp(r) = 1 + r + r^2 * P(r). */
+	__m256 px = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fEXP_P0), x), _mm256_set1_ps(fEXP_P1));
+	px = _mm256_add_ps(_mm256_mul_ps(px, x), _mm256_set1_ps(fEXP_P2));
+	px = _mm256_add_ps(_mm256_mul_ps(px, x), _mm256_set1_ps(fEXP_P3));
+	px = _mm256_add_ps(_mm256_mul_ps(px, x), _mm256_set1_ps(fEXP_P4));
+	px = _mm256_add_ps(_mm256_mul_ps(px, x), _mm256_set1_ps(fEXP_P5));
+	px = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(px, x), x), x), _mm256_set1_ps(1.0f));
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(nInteger, _mm256_set1_epi32(127)), 23);
+
+	return _mm256_mul_ps(px, _mm256_castsi256_ps(scale));
+}
+
+
+/**
+ * Description: Vectorized fastExp() of two double values.
+ * @param x: (IN)
+ * @param nDegree: (IN) Degree of polynomial.
+ * @return:
+ */
+__attribute__((target("sse2")))
+static inline __m128d fastExpSse2(__m128d x, const int nDegree)
+{
+	x = _mm_max_pd(x, _mm_set1_pd(-dEXP_ARGUMENT_LIMIT));
+	x = _mm_min_pd(x, _mm_set1_pd(dEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m128d magic = _mm_set1_pd(dEXP_ROUNDING_MAGIC);
+	const __m128d nShifted = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(dEXP_LOG2E)), magic);
+	const __m128d n = _mm_sub_pd(nShifted, magic);
+	x = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(dEXP_C1)));
+	x = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(dEXP_C2)));
+
+	__m128d polynomial = _mm_set1_pd(adEXP_TAYLOR_COEFFICIENTS[nDegree]);
+	for (int iCoefficient = nDegree - 1; iCoefficient >= 0; -- iCoefficient)
+	{
+		polynomial = _mm_add_pd(_mm_mul_pd(polynomial, x), _mm_set1_pd(adEXP_TAYLOR_COEFFICIENTS[iCoefficient]));
+	}
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m128i nInteger = _mm_sub_epi64(_mm_castpd_si128(nShifted), _mm_castpd_si128(magic));
+	const __m128i scale = _mm_slli_epi64(_mm_add_epi64(nInteger, _mm_set1_epi64x(1023)), 52);
+
+	return _mm_mul_pd(polynomial, _mm_castsi128_pd(scale));
+}
+
+
+/**
+ * Description: Vectorized fastExp() of four double values.
+ * @param x: (IN)
+ * @param nDegree: (IN) Degree of polynomial.
+ * @return:
+ */
+__attribute__((target("avx2")))
+static inline __m256d fastExpAvx2(__m256d x, const int nDegree)
+{
+	x = _mm256_max_pd(x, _mm256_set1_pd(-dEXP_ARGUMENT_LIMIT));
+	x = _mm256_min_pd(x, _mm256_set1_pd(dEXP_ARGUMENT_LIMIT));
+
+	/* Range reduction: x = n * ln2 + r. */
+	const __m256d magic = _mm256_set1_pd(dEXP_ROUNDING_MAGIC);
+	const __m256d nShifted = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(dEXP_LOG2E)), magic);
+	const __m256d n = _mm256_sub_pd(nShifted, magic);
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(dEXP_C1)));
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(dEXP_C2)));
+
+	__m256d polynomial = _mm256_set1_pd(adEXP_TAYLOR_COEFFICIENTS[nDegree]);
+	for (int iCoefficient = nDegree - 1; iCoefficient >= 0; -- iCoefficient)
+	{
+		polynomial = _mm256_add_pd(_mm256_mul_pd(polynomial, x), _mm256_set1_pd(adEXP_TAYLOR_COEFFICIENTS[iCoefficient]));
+	}
+
+	/* Scale by 2^n, building the exponent bits directly. */
+	const __m256i nInteger = _mm256_sub_epi64(_mm256_castpd_si256(nShifted), _mm256_castpd_si256(magic));
+	const __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(nInteger, _mm256_set1_epi64x(1023)), 52);
+
+	return _mm256_mul_pd(polynomial, _mm256_castsi256_pd(scale));
+}
+
+#endif
+
+
+/**
+ * Description: Test whether an atom sphere, grown by the Gaussian cutoff, is out of contact with the bounding sphere of a block of fit
+ *	atoms, in which case no atom of the block could be in contact with the atom.
+ * @param dRefX: (IN)
+ * @param dRefY: (IN)
+ * @param dRefZ: (IN)
+ * @param dRadiusWithCutoff: (IN) Atom radius plus Gaussian cutoff.
+ * @param fitMol: (IN)
+ * @param nBlockId: (IN)
+ * @return:
+ */
+static inline bool isBlockApart(
+	const double dRefX,
+	const double dRefY,
+	const double dRefZ,
+	const double dRadiusWithCutoff,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const int nBlockId
+	)
+{
+	const double dX = fitMol.blockXCenters[nBlockId] - dRefX;
+	const double dY = fitMol.blockYCenters[nBlockId] - dRefY;
+	const double dZ = fitMol.blockZCenters[nBlockId] - dRefZ;
+	const double dContactDistance = dRadiusWithCutoff + fitMol.blockRadii[nBlockId];
+
+	return dX * dX + dY * dY + dZ * dZ >= dContactDistance * dContactDistance;
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of two prepared molecules, using the kernel selected at startup in exact double
+ *	precision mode.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff
+	)
+{
+	return calculateOverlapVolume(refMol, fitMol, dGaussianCutoff, CSettings(), _nInstructionSet, NULL);
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of two prepared molecules, using the kernel selected at startup in given mode.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @param settings: (IN) Accuracy and precision mode.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CSettings& settings
+	)
+{
+	return calculateOverlapVolume(refMol, fitMol, dGaussianCutoff, settings, _nInstructionSet, NULL);
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of two prepared molecules, using the kernel of given instruction set.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @param settings: (IN) Accuracy and precision mode.
+ * @param nInstructionSet: (IN) One of InstructionSets, must be supported by the running processor.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CSettings& settings,
+	const int nInstructionSet
+	)
+{
+	return calculateOverlapVolume(refMol, fitMol, dGaussianCutoff, settings, nInstructionSet, NULL);
+}
+
+
+/**
+ * Description: Same as the overload without counters, also counting atom pairs skipped by bounding sphere culling.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @param settings: (IN) Accuracy and precision mode.
+ * @param cullingCounters: (IN, OUT) Counters to accumulate into.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CSettings& settings,
+	CullingCounters& cullingCounters
+	)
+{
+	return calculateOverlapVolume(refMol, fitMol, dGaussianCutoff, settings, _nInstructionSet, &cullingCounters);
+}
+
+
+/**
+ * Description: Dispatch to the kernel of given instruction set and mode, once the bounding spheres of both molecules are in contact.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param settings: (IN)
+ * @param nInstructionSet: (IN)
+ * @param pCullingCounters: (IN, OUT) Could be NULL pointer.
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CSettings& settings,
+	const int nInstructionSet,
+	CullingCounters* pCullingCounters
+	)
+{
+	// If counting:
+	if (pCullingCounters)
+	{
+		pCullingCounters->nPairsCount += static_cast<long long>(refMol.radii.size()) * fitMol.radii.size();
+	}
+
+	// If molecules far apart:
+	if (CGaussianVolume::areBoundingSpheresApart(refMol, fitMol, dGaussianCutoff))
+	{
+		// If counting:
+		if (pCullingCounters)
+		{
+			pCullingCounters->nCulledPairsCount += static_cast<long long>(refMol.radii.size()) * fitMol.radii.size();
+		}
+		return 0.0;
+	}
+	// If single precision:
+	else if (settings.getPrecision() == Precisions::nFLOAT)
+	{
+		// If AVX2:
+		if (nInstructionSet == InstructionSets::nAVX2)
+		{
+			return calculateOverlapVolumeFloatAvx2(refMol, fitMol, dGaussianCutoff);
+		}
+		// If SSE2:
+		else if (nInstructionSet == InstructionSets::nSSE2)
+		{
+			return calculateOverlapVolumeFloatSse2(refMol, fitMol, dGaussianCutoff);
+		}
+		// If scalar:
+		else
+		{
+			return calculateOverlapVolumeFloatScalar(refMol, fitMol, dGaussianCutoff);
+		}
+	}
+	// If fast mode and radius classes fit in the tables:
+	else if (settings.getExpPolynomialDegree() > 0
+		&& static_cast<int>(refMol.classRadii.size()) <= _nMAX_TABULATED_CLASSES_COUNT
+		&& static_cast<int>(fitMol.classRadii.size()) <= _nMAX_TABULATED_CLASSES_COUNT)
+	{
+		// If AVX2:
+		if (nInstructionSet == InstructionSets::nAVX2)
+		{
+			return calculateOverlapVolumeFastAvx2(refMol, fitMol, dGaussianCutoff, settings.getExpPolynomialDegree());
+		}
+		// If SSE2:
+		else if (nInstructionSet == InstructionSets::nSSE2)
+		{
+			return calculateOverlapVolumeFastSse2(refMol, fitMol, dGaussianCutoff, settings.getExpPolynomialDegree());
+		}
+		// If scalar:
+		else
+		{
+			return calculateOverlapVolumeFastScalar(refMol, fitMol, dGaussianCutoff, settings.getExpPolynomialDegree());
+		}
+	}
+	// If AVX2:
+	else if (nInstructionSet == InstructionSets::nAVX2)
+	{
+		return calculateOverlapVolumeAvx2(refMol, fitMol, dGaussianCutoff, pCullingCounters);
+	}
+	// If SSE2:
+	else if (nInstructionSet == InstructionSets::nSSE2)
+	{
+		return calculateOverlapVolumeSse2(refMol, fitMol, dGaussianCutoff, pCullingCounters);
+	}
+	// If scalar:
+	else
+	{
+		return calculateOverlapVolumeScalar(refMol, fitMol, dGaussianCutoff, pCullingCounters);
+	}
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of two prepared molecules, testing only atom pairs listed in a cross neighbor
+ *	list, by the scalar listed kernel whatever the kernel selected at startup. In fast or single precision mode, all pairs are tested
+ *	instead.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @param settings: (IN) Accuracy and precision mode.
+ * @param neighborList: (IN) Neighbor list updated for the current poses of both molecules, with the same cutoff.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolume(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CSettings& settings,
+	const CCrossNeighborList& neighborList
+	)
+{
+	// If exact double precision mode:
+	if (settings.getPrecision() == Precisions::nDOUBLE && settings.getExpPolynomialDegree() == 0)
+	{
+		return calculateOverlapVolumeListedScalar(refMol, fitMol, dGaussianCutoff, neighborList);
+	}
+	// If fast or single precision mode:
+	else
+	{
+		return calculateOverlapVolume(refMol, fitMol, dGaussianCutoff, settings, _nInstructionSet, NULL);
+	}
+}
+
+
+/**
+ * Description: Calculate the first order overlap volume of two prepared molecules together with its gradients with respect to the
+ *	position of each fit atom, using the AVX2 gradient kernel if selected and the scalar one otherwise. For a pair in contact, the term
+ *	v = 8 * (PI / (a_i + a_j))^1.5 * exp(-a_i * a_j / (a_i + a_j) * r^2) contributes -2 * a_i * a_j / (a_i + a_j) * v * (x_j - x_i) to
+ *	the gradient of fit atom j. The contact test makes the overlap discontinuous at the contact distance, where gradients ignore the
+ *	jump, as it is negligible with default cutoff.
+ * @param refMol: (IN) Prepared reference molecule.
+ * @param fitMol: (IN) Prepared fit molecule.
+ * @param dGaussianCutoff: (IN) Atom pairs farther than the sum of their radii plus this cutoff are ignored.
+ * @param pXGradients: (OUT) Derivatives along X axis, one per fit atom.
+ * @param pYGradients: (OUT) Derivatives along Y axis, one per fit atom.
+ * @param pZGradients: (OUT) Derivatives along Z axis, one per fit atom.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeAndGradients(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	double* pXGradients,
+	double* pYGradients,
+	double* pZGradients
+	)
+{
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	std::fill(pXGradients, pXGradients + nFIT_ATOMS_COUNT, 0.0);
+	std::fill(pYGradients, pYGradients + nFIT_ATOMS_COUNT, 0.0);
+	std::fill(pZGradients, pZGradients + nFIT_ATOMS_COUNT, 0.0);
+
+	// If molecules far apart:
+	if (CGaussianVolume::areBoundingSpheresApart(refMol, fitMol, dGaussianCutoff))
+	{
+		return 0.0;
+	}
+	// If AVX2:
+	else if (_nInstructionSet == InstructionSets::nAVX2)
+	{
+		return calculateOverlapVolumeAndGradientsAvx2(refMol, fitMol, dGaussianCutoff, pXGradients, pYGradients, pZGradients);
+	}
+	// If scalar or SSE2:
+	else
+	{
+		return calculateOverlapVolumeAndGradientsScalar(refMol, fitMol, dGaussianCutoff, pXGradients, pYGradients, pZGradients);
+	}
+}
+
+
+/**
+ * Description: Scalar gradient kernel, skipping out of contact blocks as the scalar kernel does. Gradients must be zeroed by caller.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pXGradients: (IN, OUT)
+ * @param pYGradients: (IN, OUT)
+ * @param pZGradients: (IN, OUT)
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeAndGradientsScalar(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	double* pXGradients,
+	double* pYGradients,
+	double* pZGradients
+	)
+{
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	const int nFIT_BLOCKS_COUNT = fitMol.blockRadii.size();
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+
+		// For each block of atoms in fit molecule:
+		for (int iFitBlock = 0; iFitBlock < nFIT_BLOCKS_COUNT; ++ iFitBlock)
+		{
+			// If block out of contact:
+			if (isBlockApart(dRefX, dRefY, dRefZ, dRadiusRefAtom + dGaussianCutoff, fitMol, iFitBlock))
+			{
+				continue;
+			}
+
+			// For each atom in block:
+			for (int iFitAtom = fitMol.blockStarts[iFitBlock]; iFitAtom < fitMol.blockStarts[iFitBlock + 1]; ++ iFitAtom)
+			{
+				const double dX = pFitX[iFitAtom] - dRefX;
+				const double dY = pFitY[iFitAtom] - dRefY;
+				const double dZ = pFitZ[iFitAtom] - dRefZ;
+				const double dR2 = dX * dX + dY * dY + dZ * dZ;
+				const double dContactDistance = dRadiusRefAtom + pFitRadius[iFitAtom] + dGaussianCutoff;
+				if (dR2 < dContactDistance * dContactDistance)
+				{
+					const double dAlphaSum = dAlphaRefAtom + pFitAlpha[iFitAtom];
+					const double dAlphaProductOverSum = dAlphaRefAtom * pFitAlpha[iFitAtom] / dAlphaSum;
+					const double dT = _dPI / dAlphaSum;
+					const double dV = 8 * exp(-dAlphaProductOverSum * dR2) * dT * sqrt(dT);
+					const double dScale = -2 * dAlphaProductOverSum * dV;
+					dOverlap += dV;
+					pXGradients[iFitAtom] += dScale * dX;
+					pYGradients[iFitAtom] += dScale * dY;
+					pZGradients[iFitAtom] += dScale * dZ;
+				}
+			}
+		}
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: AVX2 gradient kernel, processing four fit atoms per step. Falls back to the scalar gradient kernel if AVX2 is not
+ *	compiled in. Gradients must be zeroed by caller.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pXGradients: (IN, OUT)
+ * @param pYGradients: (IN, OUT)
+ * @param pZGradients: (IN, OUT)
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("avx2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeAndGradientsAvx2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	double* pXGradients,
+	double* pYGradients,
+	double* pZGradients
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	// count of fit atoms handled by vector steps
+	const int nVECTOR_ATOMS_COUNT = nFIT_ATOMS_COUNT - nFIT_ATOMS_COUNT % 4;
+
+	__m256d overlapSum = _mm256_setzero_pd();
+	double dTailOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+		const __m256d refX = _mm256_set1_pd(refMol.xCoordinates[iRefAtom]);
+		const __m256d refY = _mm256_set1_pd(refMol.yCoordinates[iRefAtom]);
+		const __m256d refZ = _mm256_set1_pd(refMol.zCoordinates[iRefAtom]);
+		const __m256d refAlpha = _mm256_set1_pd(dAlphaRefAtom);
+		const __m256d refRadiusWithCutoff = _mm256_set1_pd(dRadiusRefAtom + dGaussianCutoff);
+
+		// For each four atoms in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nVECTOR_ATOMS_COUNT; iFitAtom += 4)
+		{
+			const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(pFitX + iFitAtom), refX);
+			const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(pFitY + iFitAtom), refY);
+			const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(pFitZ + iFitAtom), refZ);
+			const __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+			const __m256d contactDistance = _mm256_add_pd(refRadiusWithCutoff, _mm256_loadu_pd(pFitRadius + iFitAtom));
+			const __m256d contactMask = _mm256_cmp_pd(r2, _mm256_mul_pd(contactDistance, contactDistance), _CMP_LT_OQ);
+			// If no atom in contact:
+			if (_mm256_movemask_pd(contactMask) == 0)
+			{
+				continue;
+			}
+
+			const __m256d fitAlpha = _mm256_loadu_pd(pFitAlpha + iFitAtom);
+			const __m256d alphaSum = _mm256_add_pd(refAlpha, fitAlpha);
+			const __m256d alphaProductOverSum = _mm256_div_pd(_mm256_mul_pd(refAlpha, fitAlpha), alphaSum);
+			const __m256d k = expAvx2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(alphaProductOverSum, r2)));
+			const __m256d t = _mm256_div_pd(_mm256_set1_pd(_dPI), alphaSum);
+			const __m256d v = _mm256_and_pd(contactMask,
+				_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(8.0), k), _mm256_mul_pd(t, _mm256_sqrt_pd(t))));
+			const __m256d scale = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), alphaProductOverSum), v);
+			overlapSum = _mm256_add_pd(overlapSum, v);
+			_mm256_storeu_pd(pXGradients + iFitAtom, _mm256_add_pd(_mm256_loadu_pd(pXGradients + iFitAtom), _mm256_mul_pd(scale, dx)));
+			_mm256_storeu_pd(pYGradients + iFitAtom, _mm256_add_pd(_mm256_loadu_pd(pYGradients + iFitAtom), _mm256_mul_pd(scale, dy)));
+			_mm256_storeu_pd(pZGradients + iFitAtom, _mm256_add_pd(_mm256_loadu_pd(pZGradients + iFitAtom), _mm256_mul_pd(scale, dz)));
+		}
+
+		/* Remaining fit atoms. */
+		for (int iFitAtom = nVECTOR_ATOMS_COUNT; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const double dX = pFitX[iFitAtom] - refMol.xCoordinates[iRefAtom];
+			const double dY = pFitY[iFitAtom] - refMol.yCoordinates[iRefAtom];
+			const double dZ = pFitZ[iFitAtom] - refMol.zCoordinates[iRefAtom];
+			const double dR2 = dX * dX + dY * dY + dZ * dZ;
+			const double dContactDistance = dRadiusRefAtom + pFitRadius[iFitAtom] + dGaussianCutoff;
+			if (dR2 < dContactDistance * dContactDistance)
+			{
+				const double dAlphaSum = dAlphaRefAtom + pFitAlpha[iFitAtom];
+				const double dAlphaProductOverSum = dAlphaRefAtom * pFitAlpha[iFitAtom] / dAlphaSum;
+				const double dT = _dPI / dAlphaSum;
+				const double dV = 8 * exp(-dAlphaProductOverSum * dR2) * dT * sqrt(dT);
+				const double dScale = -2 * dAlphaProductOverSum * dV;
+				dTailOverlap += dV;
+				pXGradients[iFitAtom] += dScale * dX;
+				pYGradients[iFitAtom] += dScale * dY;
+				pZGradients[iFitAtom] += dScale * dZ;
+			}
+		}
+	}
+
+	double adOverlapSum[4];
+	_mm256_storeu_pd(adOverlapSum, overlapSum);
+
+	return (adOverlapSum[0] + adOverlapSum[1]) + (adOverlapSum[2] + adOverlapSum[3]) + dTailOverlap;
+#else
+	return calculateOverlapVolumeAndGradientsScalar(refMol, fitMol, dGaussianCutoff, pXGradients, pYGradients, pZGradients);
+#endif
+}
+
+
+/**
+ * Description: Scalar kernel. Blocks of fit atoms whose bounding sphere is out of contact with a reference atom are skipped.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pCullingCounters: (IN, OUT) Count of culled pairs is accumulated into, could be NULL pointer.
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeScalar(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	CullingCounters* pCullingCounters
+	)
+{
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	const int nFIT_BLOCKS_COUNT = fitMol.blockRadii.size();
+	double dOverlap = 0.0;
+	long long nCulledPairsCount = 0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+
+		// For each block of atoms in fit molecule:
+		for (int iFitBlock = 0; iFitBlock < nFIT_BLOCKS_COUNT; ++ iFitBlock)
+		{
+			const int nBLOCK_START = fitMol.blockStarts[iFitBlock];
+			const int nBLOCK_END = fitMol.blockStarts[iFitBlock + 1];
+			// If block out of contact:
+			if (isBlockApart(dRefX, dRefY, dRefZ, dRadiusRefAtom + dGaussianCutoff, fitMol, iFitBlock))
+			{
+				nCulledPairsCount += nBLOCK_END - nBLOCK_START;
+				continue;
+			}
+
+			// For each atom in block:
+			for (int iFitAtom = nBLOCK_START; iFitAtom < nBLOCK_END; ++ iFitAtom)
+			{
+				/* Same summation sequence as CMathematics::pointToPointSquareDistance(). */
+				double dR2 = 0.0;
+				dR2 += (pFitX[iFitAtom] - dRefX) * (pFitX[iFitAtom] - dRefX);
+				dR2 += (pFitY[iFitAtom] - dRefY) * (pFitY[iFitAtom] - dRefY);
+				dR2 += (pFitZ[iFitAtom] - dRefZ) * (pFitZ[iFitAtom] - dRefZ);
+
+				const double dContactDistance = dRadiusRefAtom + pFitRadius[iFitAtom] + dGaussianCutoff;
+				if (dR2 < dContactDistance * dContactDistance)
+				{
+					const double dAlphaFitAtom = pFitAlpha[iFitAtom];
+
+					const double dK = exp(-(dAlphaRefAtom * dAlphaFitAtom * dR2) / (dAlphaRefAtom + dAlphaFitAtom));
+					const double dV = 8 * dK * pow(_dPI / (dAlphaRefAtom + dAlphaFitAtom), 1.5);
+					dOverlap += dV;
+				}
+			}
+		}
+	}
+
+	// If counting:
+	if (pCullingCounters)
+	{
+		pCullingCounters->nCulledPairsCount += nCulledPairsCount;
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: SSE2 kernel, processing two fit atoms per step and skipping out of contact blocks as the scalar kernel does. Falls
+ *	back to the scalar kernel if SSE2 is not compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pCullingCounters: (IN, OUT) Count of culled pairs is accumulated into, could be NULL pointer.
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("sse2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeSse2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	CullingCounters* pCullingCounters
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	const int nFIT_BLOCKS_COUNT = fitMol.blockRadii.size();
+
+	__m128d overlapSum = _mm_setzero_pd();
+	double dTailOverlap = 0.0;
+	long long nCulledPairsCount = 0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+		const __m128d refX = _mm_set1_pd(dRefX);
+		const __m128d refY = _mm_set1_pd(dRefY);
+		const __m128d refZ = _mm_set1_pd(dRefZ);
+		const __m128d refAlpha = _mm_set1_pd(dAlphaRefAtom);
+		const __m128d refRadiusWithCutoff = _mm_set1_pd(dRadiusRefAtom + dGaussianCutoff);
+
+		// For each block of atoms in fit molecule:
+		for (int iFitBlock = 0; iFitBlock < nFIT_BLOCKS_COUNT; ++ iFitBlock)
+		{
+			const int nBLOCK_START = fitMol.blockStarts[iFitBlock];
+			const int nBLOCK_END = fitMol.blockStarts[iFitBlock + 1];
+			// If block out of contact:
+			if (isBlockApart(dRefX, dRefY, dRefZ, dRadiusRefAtom + dGaussianCutoff, fitMol, iFitBlock))
+			{
+				nCulledPairsCount += nBLOCK_END - nBLOCK_START;
+				continue;
+			}
+
+			// end of atoms handled by vector steps in block
+			const int nVECTOR_END = nBLOCK_END - (nBLOCK_END - nBLOCK_START) % 2;
+
+			// For each pair of atoms in block:
+			for (int iFitAtom = nBLOCK_START; iFitAtom < nVECTOR_END; iFitAtom += 2)
+			{
+				const __m128d dx = _mm_sub_pd(_mm_loadu_pd(pFitX + iFitAtom), refX);
+				const __m128d dy = _mm_sub_pd(_mm_loadu_pd(pFitY + iFitAtom), refY);
+				const __m128d dz = _mm_sub_pd(_mm_loadu_pd(pFitZ + iFitAtom), refZ);
+				const __m128d r2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+				const __m128d contactDistance = _mm_add_pd(refRadiusWithCutoff, _mm_loadu_pd(pFitRadius + iFitAtom));
+				const __m128d contactMask = _mm_cmplt_pd(r2, _mm_mul_pd(contactDistance, contactDistance));
+				// If no atom in contact:
+				if (_mm_movemask_pd(contactMask) == 0)
+				{
+					continue;
+				}
+
+				const __m128d fitAlpha = _mm_loadu_pd(pFitAlpha + iFitAtom);
+				const __m128d alphaSum = _mm_add_pd(refAlpha, fitAlpha);
+				const __m128d exponent = _mm_div_pd(_mm_mul_pd(_mm_mul_pd(refAlpha, fitAlpha), r2), alphaSum);
+				const __m128d k = expSse2(_mm_sub_pd(_mm_setzero_pd(), exponent));
+				const __m128d t = _mm_div_pd(_mm_set1_pd(_dPI), alphaSum);
+				const __m128d v = _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(8.0), k), _mm_mul_pd(t, _mm_sqrt_pd(t)));
+				overlapSum = _mm_add_pd(overlapSum, _mm_and_pd(contactMask, v));
+			}
+
+			/* Remaining fit atoms of block. */
+			for (int iFitAtom = nVECTOR_END; iFitAtom < nBLOCK_END; ++ iFitAtom)
+			{
+				const double dX = pFitX[iFitAtom] - dRefX;
+				const double dY = pFitY[iFitAtom] - dRefY;
+				const double dZ = pFitZ[iFitAtom] - dRefZ;
+				const double dR2 = dX * dX + dY * dY + dZ * dZ;
+				const double dContactDistance = dRadiusRefAtom + pFitRadius[iFitAtom] + dGaussianCutoff;
+				if (dR2 < dContactDistance * dContactDistance)
+				{
+					const double dAlphaSum = dAlphaRefAtom + pFitAlpha[iFitAtom];
+					const double dT = _dPI / dAlphaSum;
+					dTailOverlap += 8 * exp(-(dAlphaRefAtom * pFitAlpha[iFitAtom] * dR2) / dAlphaSum) * dT * sqrt(dT);
+				}
+			}
+		}
+	}
+
+	// If counting:
+	if (pCullingCounters)
+	{
+		pCullingCounters->nCulledPairsCount += nCulledPairsCount;
+	}
+
+	double adOverlapSum[2];
+	_mm_storeu_pd(adOverlapSum, overlapSum);
+
+	return adOverlapSum[0] + adOverlapSum[1] + dTailOverlap;
+#else
+	return calculateOverlapVolumeScalar(refMol, fitMol, dGaussianCutoff, pCullingCounters);
+#endif
+}
+
+
+/**
+ * Description: AVX2 kernel, processing four fit atoms per step and skipping out of contact blocks as the scalar kernel does. Falls
+ *	back to the scalar kernel if AVX2 is not compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pCullingCounters: (IN, OUT) Count of culled pairs is accumulated into, could be NULL pointer.
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("avx2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeAvx2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	CullingCounters* pCullingCounters
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	const int nFIT_BLOCKS_COUNT = fitMol.blockRadii.size();
+
+	__m256d overlapSum = _mm256_setzero_pd();
+	double dTailOverlap = 0.0;
+	long long nCulledPairsCount = 0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+		const __m256d refX = _mm256_set1_pd(dRefX);
+		const __m256d refY = _mm256_set1_pd(dRefY);
+		const __m256d refZ = _mm256_set1_pd(dRefZ);
+		const __m256d refAlpha = _mm256_set1_pd(dAlphaRefAtom);
+		const __m256d refRadiusWithCutoff = _mm256_set1_pd(dRadiusRefAtom + dGaussianCutoff);
+
+		// For each block of atoms in fit molecule:
+		for (int iFitBlock = 0; iFitBlock < nFIT_BLOCKS_COUNT; ++ iFitBlock)
+		{
+			const int nBLOCK_START = fitMol.blockStarts[iFitBlock];
+			const int nBLOCK_END = fitMol.blockStarts[iFitBlock + 1];
+			// If block out of contact:
+			if (isBlockApart(dRefX, dRefY, dRefZ, dRadiusRefAtom + dGaussianCutoff, fitMol, iFitBlock))
+			{
+				nCulledPairsCount += nBLOCK_END - nBLOCK_START;
+				continue;
+			}
+
+			// end of atoms handled by vector steps in block
+			const int nVECTOR_END = nBLOCK_END - (nBLOCK_END - nBLOCK_START) % 4;
+
+			// For each four atoms in block:
+			for (int iFitAtom = nBLOCK_START; iFitAtom < nVECTOR_END; iFitAtom += 4)
+			{
+				const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(pFitX + iFitAtom), refX);
+				const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(pFitY + iFitAtom), refY);
+				const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(pFitZ + iFitAtom), refZ);
+				const __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+				const __m256d contactDistance = _mm256_add_pd(refRadiusWithCutoff, _mm256_loadu_pd(pFitRadius + iFitAtom));
+				const __m256d contactMask = _mm256_cmp_pd(r2, _mm256_mul_pd(contactDistance, contactDistance), _CMP_LT_OQ);
+				// If no atom in contact:
+				if (_mm256_movemask_pd(contactMask) == 0)
+				{
+					continue;
+				}
+
+				const __m256d fitAlpha = _mm256_loadu_pd(pFitAlpha + iFitAtom);
+				const __m256d alphaSum = _mm256_add_pd(refAlpha, fitAlpha);
+				const __m256d exponent = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(refAlpha, fitAlpha), r2), alphaSum);
+				const __m256d k = expAvx2(_mm256_sub_pd(_mm256_setzero_pd(), exponent));
+				const __m256d t = _mm256_div_pd(_mm256_set1_pd(_dPI), alphaSum);
+				const __m256d v = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(8.0), k), _mm256_mul_pd(t, _mm256_sqrt_pd(t)));
+				overlapSum = _mm256_add_pd(overlapSum, _mm256_and_pd(contactMask, v));
+			}
+
+			/* Remaining fit atoms of block. */
+			for (int iFitAtom = nVECTOR_END; iFitAtom < nBLOCK_END; ++ iFitAtom)
+			{
+				const double dX = pFitX[iFitAtom] - dRefX;
+				const double dY = pFitY[iFitAtom] - dRefY;
+				const double dZ = pFitZ[iFitAtom] - dRefZ;
+				const double dR2 = dX * dX + dY * dY + dZ * dZ;
+				const double dContactDistance = dRadiusRefAtom + pFitRadius[iFitAtom] + dGaussianCutoff;
+				if (dR2 < dContactDistance * dContactDistance)
+				{
+					const double dAlphaSum = dAlphaRefAtom + pFitAlpha[iFitAtom];
+					const double dT = _dPI / dAlphaSum;
+					dTailOverlap += 8 * exp(-(dAlphaRefAtom * pFitAlpha[iFitAtom] * dR2) / dAlphaSum) * dT * sqrt(dT);
+				}
+			}
+		}
+	}
+
+	// If counting:
+	if (pCullingCounters)
+	{
+		pCullingCounters->nCulledPairsCount += nCulledPairsCount;
+	}
+
+	double adOverlapSum[4];
+	_mm256_storeu_pd(adOverlapSum, overlapSum);
+
+	return (adOverlapSum[0] + adOverlapSum[1]) + (adOverlapSum[2] + adOverlapSum[3]) + dTailOverlap;
+#else
+	return calculateOverlapVolumeScalar(refMol, fitMol, dGaussianCutoff, pCullingCounters);
+#endif
+}
+
+
+/**
+ * Description: Scalar kernel of single precision.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeFloatScalar(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff
+	)
+{
+	const int nREF_ATOMS_COUNT = refMol.floatRadii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.floatRadii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const float* const pFitX = &fitMol.floatXCoordinates[0];
+	const float* const pFitY = &fitMol.floatYCoordinates[0];
+	const float* const pFitZ = &fitMol.floatZCoordinates[0];
+	const float* const pFitAlpha = &fitMol.floatAlphaValues[0];
+	const float* const pFitRadius = &fitMol.floatRadii[0];
+	const float fPI = static_cast<float>(_dPI);
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const float fRefX = refMol.floatXCoordinates[iRefAtom];
+		const float fRefY = refMol.floatYCoordinates[iRefAtom];
+		const float fRefZ = refMol.floatZCoordinates[iRefAtom];
+		const float fAlphaRefAtom = refMol.floatAlphaValues[iRefAtom];
+		const float fRadiusRefAtomWithCutoff = refMol.floatRadii[iRefAtom] + static_cast<float>(dGaussianCutoff);
+		float fRefAtomOverlap = 0.0f;
+
+		// For each atom in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const float fX = pFitX[iFitAtom] - fRefX;
+			const float fY = pFitY[iFitAtom] - fRefY;
+			const float fZ = pFitZ[iFitAtom] - fRefZ;
+			const float fR2 = fX * fX + fY * fY + fZ * fZ;
+			const float fContactDistance = fRadiusRefAtomWithCutoff + pFitRadius[iFitAtom];
+			if (fR2 < fContactDistance * fContactDistance)
+			{
+				const float fAlphaSum = fAlphaRefAtom + pFitAlpha[iFitAtom];
+				const float fT = fPI / fAlphaSum;
+				fRefAtomOverlap += 8 * std::exp(-(fAlphaRefAtom * pFitAlpha[iFitAtom] * fR2) / fAlphaSum) * fT * std::sqrt(fT);
+			}
+		}
+
+		dOverlap += fRefAtomOverlap;
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: SSE2 kernel of single precision, processing four fit atoms per step. Falls back to the scalar one if SSE2 is not
+ *	compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("sse2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeFloatSse2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.floatRadii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.floatRadii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const float* const pFitX = &fitMol.floatXCoordinates[0];
+	const float* const pFitY = &fitMol.floatYCoordinates[0];
+	const float* const pFitZ = &fitMol.floatZCoordinates[0];
+	const float* const pFitAlpha = &fitMol.floatAlphaValues[0];
+	const float* const pFitRadius = &fitMol.floatRadii[0];
+	const float fPI = static_cast<float>(_dPI);
+	// count of fit atoms handled by vector steps
+	const int nVECTOR_ATOMS_COUNT = nFIT_ATOMS_COUNT - nFIT_ATOMS_COUNT % 4;
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const float fAlphaRefAtom = refMol.floatAlphaValues[iRefAtom];
+		const float fRadiusRefAtomWithCutoff = refMol.floatRadii[iRefAtom] + static_cast<float>(dGaussianCutoff);
+		const __m128 refX = _mm_set1_ps(refMol.floatXCoordinates[iRefAtom]);
+		const __m128 refY = _mm_set1_ps(refMol.floatYCoordinates[iRefAtom]);
+		const __m128 refZ = _mm_set1_ps(refMol.floatZCoordinates[iRefAtom]);
+		const __m128 refAlpha = _mm_set1_ps(fAlphaRefAtom);
+		const __m128 refRadiusWithCutoff = _mm_set1_ps(fRadiusRefAtomWithCutoff);
+		__m128 refAtomOverlapSum = _mm_setzero_ps();
+
+		// For each four atoms in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nVECTOR_ATOMS_COUNT; iFitAtom += 4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(pFitX + iFitAtom), refX);
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(pFitY + iFitAtom), refY);
+			const __m128 dz = _mm_sub_ps(_mm_loadu_ps(pFitZ + iFitAtom), refZ);
+			const __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			const __m128 contactDistance = _mm_add_ps(refRadiusWithCutoff, _mm_loadu_ps(pFitRadius + iFitAtom));
+			const __m128 contactMask = _mm_cmplt_ps(r2, _mm_mul_ps(contactDistance, contactDistance));
+			// If no atom in contact:
+			if (_mm_movemask_ps(contactMask) == 0)
+			{
+				continue;
+			}
+
+			const __m128 fitAlpha = _mm_loadu_ps(pFitAlpha + iFitAtom);
+			const __m128 alphaSum = _mm_add_ps(refAlpha, fitAlpha);
+			const __m128 exponent = _mm_div_ps(_mm_mul_ps(_mm_mul_ps(refAlpha, fitAlpha), r2), alphaSum);
+			const __m128 k = expFloatSse2(_mm_sub_ps(_mm_setzero_ps(), exponent));
+			const __m128 t = _mm_div_ps(_mm_set1_ps(fPI), alphaSum);
+			const __m128 v = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(8.0f), k), _mm_mul_ps(t, _mm_sqrt_ps(t)));
+			refAtomOverlapSum = _mm_add_ps(refAtomOverlapSum, _mm_and_ps(contactMask, v));
+		}
+
+		float afRefAtomOverlapSum[4];
+		_mm_storeu_ps(afRefAtomOverlapSum, refAtomOverlapSum);
+		float fRefAtomOverlap = (afRefAtomOverlapSum[0] + afRefAtomOverlapSum[1]) + (afRefAtomOverlapSum[2] + afRefAtomOverlapSum[3]);
+
+		/* Remaining fit atoms. */
+		for (int iFitAtom = nVECTOR_ATOMS_COUNT; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const float fX = pFitX[iFitAtom] - refMol.floatXCoordinates[iRefAtom];
+			const float fY = pFitY[iFitAtom] - refMol.floatYCoordinates[iRefAtom];
+			const float fZ = pFitZ[iFitAtom] - refMol.floatZCoordinates[iRefAtom];
+			const float fR2 = fX * fX + fY * fY + fZ * fZ;
+			const float fContactDistance = fRadiusRefAtomWithCutoff + pFitRadius[iFitAtom];
+			if (fR2 < fContactDistance * fContactDistance)
+			{
+				const float fAlphaSum = fAlphaRefAtom + pFitAlpha[iFitAtom];
+				const float fT = fPI / fAlphaSum;
+				fRefAtomOverlap += 8 * std::exp(-(fAlphaRefAtom * pFitAlpha[iFitAtom] * fR2) / fAlphaSum) * fT * std::sqrt(fT);
+			}
+		}
+
+		dOverlap += fRefAtomOverlap;
+	}
+
+	return dOverlap;
+#else
+	return calculateOverlapVolumeFloatScalar(refMol, fitMol, dGaussianCutoff);
+#endif
+}
+
+
+/**
+ * Description: AVX2 kernel of single precision, processing eight fit atoms per step. Falls back to the scalar one if AVX2 is not
+ *	compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("avx2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeFloatAvx2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.floatRadii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.floatRadii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	const float* const pFitX = &fitMol.floatXCoordinates[0];
+	const float* const pFitY = &fitMol.floatYCoordinates[0];
+	const float* const pFitZ = &fitMol.floatZCoordinates[0];
+	const float* const pFitAlpha = &fitMol.floatAlphaValues[0];
+	const float* const pFitRadius = &fitMol.floatRadii[0];
+	const float fPI = static_cast<float>(_dPI);
+	// count of fit atoms handled by vector steps
+	const int nVECTOR_ATOMS_COUNT = nFIT_ATOMS_COUNT - nFIT_ATOMS_COUNT % 8;
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const float fAlphaRefAtom = refMol.floatAlphaValues[iRefAtom];
+		const float fRadiusRefAtomWithCutoff = refMol.floatRadii[iRefAtom] + static_cast<float>(dGaussianCutoff);
+		const __m256 refX = _mm256_set1_ps(refMol.floatXCoordinates[iRefAtom]);
+		const __m256 refY = _mm256_set1_ps(refMol.floatYCoordinates[iRefAtom]);
+		const __m256 refZ = _mm256_set1_ps(refMol.floatZCoordinates[iRefAtom]);
+		const __m256 refAlpha = _mm256_set1_ps(fAlphaRefAtom);
+		const __m256 refRadiusWithCutoff = _mm256_set1_ps(fRadiusRefAtomWithCutoff);
+		__m256 refAtomOverlapSum = _mm256_setzero_ps();
+
+		// For each eight atoms in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nVECTOR_ATOMS_COUNT; iFitAtom += 8)
+		{
+			const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(pFitX + iFitAtom), refX);
+			const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(pFitY + iFitAtom), refY);
+			const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(pFitZ + iFitAtom), refZ);
+			const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			const __m256 contactDistance = _mm256_add_ps(refRadiusWithCutoff, _mm256_loadu_ps(pFitRadius + iFitAtom));
+			const __m256 contactMask = _mm256_cmp_ps(r2, _mm256_mul_ps(contactDistance, contactDistance), _CMP_LT_OQ);
+			// If no atom in contact:
+			if (_mm256_movemask_ps(contactMask) == 0)
+			{
+				continue;
+			}
+
+			const __m256 fitAlpha = _mm256_loadu_ps(pFitAlpha + iFitAtom);
+			const __m256 alphaSum = _mm256_add_ps(refAlpha, fitAlpha);
+			const __m256 exponent = _mm256_div_ps(_mm256_mul_ps(_mm256_mul_ps(refAlpha, fitAlpha), r2), alphaSum);
+			const __m256 k = expFloatAvx2(_mm256_sub_ps(_mm256_setzero_ps(), exponent));
+			const __m256 t = _mm256_div_ps(_mm256_set1_ps(fPI), alphaSum);
+			const __m256 v = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(8.0f), k), _mm256_mul_ps(t, _mm256_sqrt_ps(t)));
+			refAtomOverlapSum = _mm256_add_ps(refAtomOverlapSum, _mm256_and_ps(contactMask, v));
+		}
+
+		const __m128 halfSum = _mm_add_ps(_mm256_castps256_ps128(refAtomOverlapSum), _mm256_extractf128_ps(refAtomOverlapSum, 1));
+		float afRefAtomOverlapSum[4];
+		_mm_storeu_ps(afRefAtomOverlapSum, halfSum);
+		float fRefAtomOverlap = (afRefAtomOverlapSum[0] + afRefAtomOverlapSum[1]) + (afRefAtomOverlapSum[2] + afRefAtomOverlapSum[3]);
+
+		/* Remaining fit atoms. */
+		for (int iFitAtom = nVECTOR_ATOMS_COUNT; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const float fX = pFitX[iFitAtom] - refMol.floatXCoordinates[iRefAtom];
+			const float fY = pFitY[iFitAtom] - refMol.floatYCoordinates[iRefAtom];
+			const float fZ = pFitZ[iFitAtom] - refMol.floatZCoordinates[iRefAtom];
+			const float fR2 = fX * fX + fY * fY + fZ * fZ;
+			const float fContactDistance = fRadiusRefAtomWithCutoff + pFitRadius[iFitAtom];
+			if (fR2 < fContactDistance * fContactDistance)
+			{
+				const float fAlphaSum = fAlphaRefAtom + pFitAlpha[iFitAtom];
+				const float fT = fPI / fAlphaSum;
+				fRefAtomOverlap += 8 * std::exp(-(fAlphaRefAtom * pFitAlpha[iFitAtom] * fR2) / fAlphaSum) * fT * std::sqrt(fT);
+			}
+		}
+
+		dOverlap += fRefAtomOverlap;
+	}
+
+	return dOverlap;
+#else
+	return calculateOverlapVolumeFloatScalar(refMol, fitMol, dGaussianCutoff);
+#endif
+}
+
+
+/**
+ * Description: Tabulate constants of each pair of radius classes of two prepared molecules, whose classes counts must not exceed
+ *	_nMAX_TABULATED_CLASSES_COUNT.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param pairConstants: (OUT)
+ */
+int CGaussianOverlapKernel::buildPairConstants(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	PairConstants& pairConstants
+	)
+{
+	const int nREF_CLASSES_COUNT = refMol.classRadii.size();
+	const int nFIT_CLASSES_COUNT = fitMol.classRadii.size();
+
+	for (int iRefClass = 0; iRefClass < nREF_CLASSES_COUNT; ++ iRefClass)
+	{
+		for (int iFitClass = 0; iFitClass < nFIT_CLASSES_COUNT; ++ iFitClass)
+		{
+			const int nPAIR_INDEX = iRefClass * _nMAX_TABULATED_CLASSES_COUNT + iFitClass;
+			const double dAlphaRef = refMol.classAlphaValues[iRefClass];
+			const double dAlphaFit = fitMol.classAlphaValues[iFitClass];
+			const double dContactDistance = refMol.classRadii[iRefClass] + fitMol.classRadii[iFitClass] + dGaussianCutoff;
+			const double dT = _dPI / (dAlphaRef + dAlphaFit);
+
+			pairConstants.adAlphaProductOverSums[nPAIR_INDEX] = dAlphaRef * dAlphaFit / (dAlphaRef + dAlphaFit);
+			pairConstants.adContactSquareDistances[nPAIR_INDEX] = dContactDistance * dContactDistance;
+			pairConstants.adPrefactors[nPAIR_INDEX] = 8 * dT * sqrt(dT);
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Scalar kernel of fast mode.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param nExpPolynomialDegree: (IN) Degree of exp() polynomial, positive.
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeFastScalar(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const int nExpPolynomialDegree
+	)
+{
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	PairConstants pairConstants;
+	buildPairConstants(refMol, fitMol, dGaussianCutoff, pairConstants);
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const int* const pFitClassId = &fitMol.radiusClassIds[0];
+	const int nDEGREE = nExpPolynomialDegree;
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const int nREF_PAIR_OFFSET = refMol.radiusClassIds[iRefAtom] * _nMAX_TABULATED_CLASSES_COUNT;
+
+		// For each atom in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const double dX = pFitX[iFitAtom] - dRefX;
+			const double dY = pFitY[iFitAtom] - dRefY;
+			const double dZ = pFitZ[iFitAtom] - dRefZ;
+			const double dR2 = dX * dX + dY * dY + dZ * dZ;
+			const int nPAIR_INDEX = nREF_PAIR_OFFSET + pFitClassId[iFitAtom];
+			if (dR2 < pairConstants.adContactSquareDistances[nPAIR_INDEX])
+			{
+				dOverlap += pairConstants.adPrefactors[nPAIR_INDEX] * fastExp(-pairConstants.adAlphaProductOverSums[nPAIR_INDEX] * dR2, nDEGREE);
+			}
+		}
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: SSE2 kernel of fast mode, processing two fit atoms per step. Falls back to the scalar one if SSE2 is not compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param nExpPolynomialDegree: (IN) Degree of exp() polynomial, positive.
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("sse2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeFastSse2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const int nExpPolynomialDegree
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	PairConstants pairConstants;
+	buildPairConstants(refMol, fitMol, dGaussianCutoff, pairConstants);
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const int* const pFitClassId = &fitMol.radiusClassIds[0];
+	const double* const pAlphaProductOverSum = pairConstants.adAlphaProductOverSums;
+	const double* const pContactSquareDistance = pairConstants.adContactSquareDistances;
+	const double* const pPrefactor = pairConstants.adPrefactors;
+	const int nDEGREE = nExpPolynomialDegree;
+	// count of fit atoms handled by vector steps
+	const int nVECTOR_ATOMS_COUNT = nFIT_ATOMS_COUNT - nFIT_ATOMS_COUNT % 2;
+
+	__m128d overlapSum = _mm_setzero_pd();
+	double dTailOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const __m128d refX = _mm_set1_pd(refMol.xCoordinates[iRefAtom]);
+		const __m128d refY = _mm_set1_pd(refMol.yCoordinates[iRefAtom]);
+		const __m128d refZ = _mm_set1_pd(refMol.zCoordinates[iRefAtom]);
+		const int nREF_PAIR_OFFSET = refMol.radiusClassIds[iRefAtom] * _nMAX_TABULATED_CLASSES_COUNT;
+
+		// For each pair of atoms in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nVECTOR_ATOMS_COUNT; iFitAtom += 2)
+		{
+			const __m128d dx = _mm_sub_pd(_mm_loadu_pd(pFitX + iFitAtom), refX);
+			const __m128d dy = _mm_sub_pd(_mm_loadu_pd(pFitY + iFitAtom), refY);
+			const __m128d dz = _mm_sub_pd(_mm_loadu_pd(pFitZ + iFitAtom), refZ);
+			const __m128d r2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+			const int nPAIR_INDEX_0 = nREF_PAIR_OFFSET + pFitClassId[iFitAtom];
+			const int nPAIR_INDEX_1 = nREF_PAIR_OFFSET + pFitClassId[iFitAtom + 1];
+			const __m128d contactSquareDistance = _mm_set_pd(pContactSquareDistance[nPAIR_INDEX_1], pContactSquareDistance[nPAIR_INDEX_0]);
+			const __m128d contactMask = _mm_cmplt_pd(r2, contactSquareDistance);
+			// If no atom in contact:
+			if (_mm_movemask_pd(contactMask) == 0)
+			{
+				continue;
+			}
+
+			const __m128d alphaProductOverSum = _mm_set_pd(pAlphaProductOverSum[nPAIR_INDEX_1], pAlphaProductOverSum[nPAIR_INDEX_0]);
+			const __m128d prefactor = _mm_set_pd(pPrefactor[nPAIR_INDEX_1], pPrefactor[nPAIR_INDEX_0]);
+			const __m128d k = fastExpSse2(_mm_sub_pd(_mm_setzero_pd(), _mm_mul_pd(alphaProductOverSum, r2)), nDEGREE);
+			overlapSum = _mm_add_pd(overlapSum, _mm_and_pd(contactMask, _mm_mul_pd(prefactor, k)));
+		}
+
+		/* Remaining fit atom. */
+		for (int iFitAtom = nVECTOR_ATOMS_COUNT; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const double dX = pFitX[iFitAtom] - refMol.xCoordinates[iRefAtom];
+			const double dY = pFitY[iFitAtom] - refMol.yCoordinates[iRefAtom];
+			const double dZ = pFitZ[iFitAtom] - refMol.zCoordinates[iRefAtom];
+			const double dR2 = dX * dX + dY * dY + dZ * dZ;
+			const int nPAIR_INDEX = nREF_PAIR_OFFSET + pFitClassId[iFitAtom];
+			if (dR2 < pContactSquareDistance[nPAIR_INDEX])
+			{
+				dTailOverlap += pPrefactor[nPAIR_INDEX] * fastExp(-pAlphaProductOverSum[nPAIR_INDEX] * dR2, nDEGREE);
+			}
+		}
+	}
+
+	double adOverlapSum[2];
+	_mm_storeu_pd(adOverlapSum, overlapSum);
+
+	return adOverlapSum[0] + adOverlapSum[1] + dTailOverlap;
+#else
+	return calculateOverlapVolumeFastScalar(refMol, fitMol, dGaussianCutoff, nExpPolynomialDegree);
+#endif
+}
+
+
+/**
+ * Description: AVX2 kernel of fast mode, processing four fit atoms per step with gathered pair constants. Falls back to the scalar
+ *	one if AVX2 is not compiled in.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param nExpPolynomialDegree: (IN) Degree of exp() polynomial, positive.
+ * @return:
+ */
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+__attribute__((target("avx2")))
+#endif
+double CGaussianOverlapKernel::calculateOverlapVolumeFastAvx2(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const int nExpPolynomialDegree
+	)
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const int nFIT_ATOMS_COUNT = fitMol.radii.size();
+	// If any molecule is empty:
+	if (nREF_ATOMS_COUNT == 0 || nFIT_ATOMS_COUNT == 0)
+	{
+		return 0.0;
+	}
+
+	PairConstants pairConstants;
+	buildPairConstants(refMol, fitMol, dGaussianCutoff, pairConstants);
+
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const int* const pFitClassId = &fitMol.radiusClassIds[0];
+	const double* const pAlphaProductOverSum = pairConstants.adAlphaProductOverSums;
+	const double* const pContactSquareDistance = pairConstants.adContactSquareDistances;
+	const double* const pPrefactor = pairConstants.adPrefactors;
+	const int nDEGREE = nExpPolynomialDegree;
+	// count of fit atoms handled by vector steps
+	const int nVECTOR_ATOMS_COUNT = nFIT_ATOMS_COUNT - nFIT_ATOMS_COUNT % 4;
+
+	__m256d overlapSum = _mm256_setzero_pd();
+	double dTailOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const __m256d refX = _mm256_set1_pd(refMol.xCoordinates[iRefAtom]);
+		const __m256d refY = _mm256_set1_pd(refMol.yCoordinates[iRefAtom]);
+		const __m256d refZ = _mm256_set1_pd(refMol.zCoordinates[iRefAtom]);
+		const int nREF_PAIR_OFFSET = refMol.radiusClassIds[iRefAtom] * _nMAX_TABULATED_CLASSES_COUNT;
+		const __m128i refPairOffset = _mm_set1_epi32(nREF_PAIR_OFFSET);
+
+		// For each four atoms in fit molecule:
+		for (int iFitAtom = 0; iFitAtom < nVECTOR_ATOMS_COUNT; iFitAtom += 4)
+		{
+			const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(pFitX + iFitAtom), refX);
+			const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(pFitY + iFitAtom), refY);
+			const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(pFitZ + iFitAtom), refZ);
+			const __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+			const __m128i pairIndexes = _mm_add_epi32(refPairOffset, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pFitClassId + iFitAtom)));
+			const __m256d contactSquareDistance = _mm256_i32gather_pd(pContactSquareDistance, pairIndexes, 8);
+			const __m256d contactMask = _mm256_cmp_pd(r2, contactSquareDistance, _CMP_LT_OQ);
+			// If no atom in contact:
+			if (_mm256_movemask_pd(contactMask) == 0)
+			{
+				continue;
+			}
+
+			const __m256d alphaProductOverSum = _mm256_i32gather_pd(pAlphaProductOverSum, pairIndexes, 8);
+			const __m256d prefactor = _mm256_i32gather_pd(pPrefactor, pairIndexes, 8);
+			const __m256d k = fastExpAvx2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(alphaProductOverSum, r2)), nDEGREE);
+			overlapSum = _mm256_add_pd(overlapSum, _mm256_and_pd(contactMask, _mm256_mul_pd(prefactor, k)));
+		}
+
+		/* Remaining fit atoms. */
+		for (int iFitAtom = nVECTOR_ATOMS_COUNT; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			const double dX = pFitX[iFitAtom] - refMol.xCoordinates[iRefAtom];
+			const double dY = pFitY[iFitAtom] - refMol.yCoordinates[iRefAtom];
+			const double dZ = pFitZ[iFitAtom] - refMol.zCoordinates[iRefAtom];
+			const double dR2 = dX * dX + dY * dY + dZ * dZ;
+			const int nPAIR_INDEX = nREF_PAIR_OFFSET + pFitClassId[iFitAtom];
+			if (dR2 < pContactSquareDistance[nPAIR_INDEX])
+			{
+				dTailOverlap += pPrefactor[nPAIR_INDEX] * fastExp(-pAlphaProductOverSum[nPAIR_INDEX] * dR2, nDEGREE);
+			}
+		}
+	}
+
+	double adOverlapSum[4];
+	_mm256_storeu_pd(adOverlapSum, overlapSum);
+
+	return (adOverlapSum[0] + adOverlapSum[1]) + (adOverlapSum[2] + adOverlapSum[3]) + dTailOverlap;
+#else
+	return calculateOverlapVolumeFastScalar(refMol, fitMol, dGaussianCutoff, nExpPolynomialDegree);
+#endif
+}
+
+
+/**
+ * Description: Scalar kernel over listed pairs. Listed fit atoms are ascending, so the summation sequence is that of the scalar
+ *	kernel with pairs out of contact skipped, and the result is identical.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
+ * @param neighborList: (IN)
+ * @return:
+ */
+double CGaussianOverlapKernel::calculateOverlapVolumeListedScalar(
+	const CGaussianVolume::PreparedMolecule& refMol,
+	const CGaussianVolume::PreparedMolecule& fitMol,
+	const double dGaussianCutoff,
+	const CCrossNeighborList& neighborList
+	)
+{
+	const std::vector<int>& candidateStarts = neighborList.getCandidateStarts();
+	const std::vector<int>& candidateFitAtomIds = neighborList.getCandidateFitAtomIds();
+	// If no pair listed:
+	if (candidateFitAtomIds.empty())
+	{
+		return 0.0;
+	}
+
+	const int nREF_ATOMS_COUNT = refMol.radii.size();
+	const double* const pFitX = &fitMol.xCoordinates[0];
+	const double* const pFitY = &fitMol.yCoordinates[0];
+	const double* const pFitZ = &fitMol.zCoordinates[0];
+	const double* const pFitAlpha = &fitMol.alphaValues[0];
+	const double* const pFitRadius = &fitMol.radii[0];
+	const int* const pFitAtomIds = &candidateFitAtomIds[0];
+	double dOverlap = 0.0;
+
+	// For each atom in reference molecule:
+	for (int iRefAtom = 0; iRefAtom < nREF_ATOMS_COUNT; ++ iRefAtom)
+	{
+		const double dRefX = refMol.xCoordinates[iRefAtom];
+		const double dRefY = refMol.yCoordinates[iRefAtom];
+		const double dRefZ = refMol.zCoordinates[iRefAtom];
+		const double dAlphaRefAtom = refMol.alphaValues[iRefAtom];
+		const double dRadiusRefAtom = refMol.radii[iRefAtom];
+
+		// For each listed atom in fit molecule:
+		for (int iCandidate = candidateStarts[iRefAtom]; iCandidate < candidateStarts[iRefAtom + 1]; ++ iCandidate)
+		{
+			const int nFitAtom = pFitAtomIds[iCandidate];
+
+			/* Same summation sequence as CMathematics::pointToPointSquareDistance(). */
+			double dR2 = 0.0;
+			dR2 += (pFitX[nFitAtom] - dRefX) * (pFitX[nFitAtom] - dRefX);
+			dR2 += (pFitY[nFitAtom] - dRefY) * (pFitY[nFitAtom] - dRefY);
+			dR2 += (pFitZ[nFitAtom] - dRefZ) * (pFitZ[nFitAtom] - dRefZ);
+
+			const double dContactDistance = dRadiusRefAtom + pFitRadius[nFitAtom] + dGaussianCutoff;
+			if (dR2 < dContactDistance * dContactDistance)
+			{
+				const double dAlphaFitAtom = pFitAlpha[nFitAtom];
+
+				const double dK = exp(-(dAlphaRefAtom * dAlphaFitAtom * dR2) / (dAlphaRefAtom + dAlphaFitAtom));
+				const double dV = 8 * dK * pow(_dPI / (dAlphaRefAtom + dAlphaFitAtom), 1.5);
+				dOverlap += dV;
+			}
+		}
+	}
+
+	return dOverlap;
+}
+
+
+/**
+ * Description: Detect the best instruction set supported by the running processor.
+ * @return: One of InstructionSets.
+ */
+int CGaussianOverlapKernel::detectInstructionSet()
+{
+#ifdef GAUSSIAN_OVERLAP_KERNEL_X86_SIMD
+	// Called during static initialization, so initialize CPU model information explicitly.
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return InstructionSets::nAVX2;
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		return InstructionSets::nSSE2;
+	}
+#endif
+
+	return InstructionSets::nSCALAR;
+}
+
+
+/**
+ * Description:
+ * @return: Instruction set of the kernel in use.
+ */
+int CGaussianOverlapKernel::getInstructionSet()
+{
+	return _nInstructionSet;
+}
+
+
+/**
+ * Description:
+ * @param nInstructionSet: (IN)
+ * @return: Human readable name of the instruction set.
+ */
+string CGaussianOverlapKernel::getInstructionSetName(const int nInstructionSet)
+{
+	if (nInstructionSet == InstructionSets::nAVX2)
+	{
+		return string("AVX2");
+	}
+	else if (nInstructionSet == InstructionSets::nSSE2)
+	{
+		return string("SSE2");
+	}
+	else
+	{
+		return string("SCALAR");
+	}
+}
+
+
+/**
+ * Description:
+ * @param nPrecision: (IN)
+ * @return: Human readable name of the precision.
+ */
+string CGaussianOverlapKernel::getPrecisionName(const int nPrecision)
+{
+	if (nPrecision == Precisions::nFLOAT)
+	{
+		return string("FLOAT");
+	}
+	else
+	{
+		return string("DOUBLE");
+	}
+}
+
+
+/**
+ * Description: Determine if the kernel of given instruction set can be run on current processor.
+ * @param nInstructionSet: (IN)
+ * @return:
+ */
+bool CGaussianOverlapKernel::isSupportedInstructionSet(const int nInstructionSet)
+{
+	return nInstructionSet >= InstructionSets::nSCALAR && nInstructionSet <= detectInstructionSet();
+}
+
+
+/**
+ * Description: Select the kernel in use, e.g. forcing the scalar one for reference calculation.
+ * @param nInstructionSet: (IN) One of InstructionSets, must be supported by the running processor.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianOverlapKernel::setInstructionSet(const int nInstructionSet)
+{
+	// If valid parameter:
+	if (isSupportedInstructionSet(nInstructionSet))
+	{
+		_nInstructionSet = nInstructionSet;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nInstructionSet = " << nInstructionSet;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/* Implementation for CGaussianOverlapKernel::CSettings class: */
+
+/**
+ * Description: Ctor, selecting exact double precision mode.
+ */
+CGaussianOverlapKernel::CSettings::CSettings() :
+	_dMaxRelativeError(0),
+	_nExpPolynomialDegree(0),
+	_nPrecision(Precisions::nDOUBLE)
+{
+}
+
+
+/**
+ * Description:
+ * @return: Degree of exp() polynomial in fast mode, 0 for exact mode.
+ */
+int CGaussianOverlapKernel::CSettings::getExpPolynomialDegree() const
+{
+	return _nExpPolynomialDegree;
+}
+
+
+/**
+ * Description:
+ * @return: Max relative error of fast mode, 0 for exact mode.
+ */
+double CGaussianOverlapKernel::CSettings::getMaxRelativeError() const
+{
+	return _dMaxRelativeError;
+}
+
+
+/**
+ * Description:
+ * @return: Floating point precision, one of Precisions.
+ */
+int CGaussianOverlapKernel::CSettings::getPrecision() const
+{
+	return _nPrecision;
+}
+
+
+/**
+ * Description: Select accuracy mode. A positive value selects fast mode, using the lowest degree of exp() polynomial whose truncation
+ *	error, bounded by 2 * (ln2 / 2)^(d + 1) / (d + 1)! on the reduced argument, does not exceed it. Values below the bound of the
+ *	highest degree are rejected, use exact mode instead.
+ * @param dMaxRelativeError: (IN) Max relative error of overlap volume, 0 for exact mode.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianOverlapKernel::CSettings::setMaxRelativeError(const double dMaxRelativeError)
+{
+	// If invalid parameter:
+	if (!(dMaxRelativeError >= 0))
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dMaxRelativeError = " << dMaxRelativeError;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	// If exact mode:
+	if (dMaxRelativeError == 0)
+	{
+		_dMaxRelativeError = 0;
+		_nExpPolynomialDegree = 0;
+		return;
+	}
+
+	/* Find the lowest degree meeting the error. */
+	double dTruncationError = 2 * dEXP_MAX_REDUCED_ARGUMENT;
+	for (int iDegree = 1; iDegree <= _nMAX_EXP_POLYNOMIAL_DEGREE; ++ iDegree)
+	{
+		dTruncationError *= dEXP_MAX_REDUCED_ARGUMENT / (iDegree + 1);
+		if (dTruncationError <= dMaxRelativeError)
+		{
+			_dMaxRelativeError = dMaxRelativeError;
+			_nExpPolynomialDegree = iDegree;
+			return;
+		}
+	}
+
+	/* No degree meets the error. */
+	std::stringstream msgStream;
+	msgStream
+		<< LOCATION_STREAM_INSERTION
+		<< "Invalid parameter, below the error of the highest polynomial degree: "
+		<< "dMaxRelativeError = " << dMaxRelativeError;
+	throw CInvalidArgumentException(msgStream.str());
+}
+
+
+/**
+ * Description: Select floating point precision. Double precision is the reference, single precision is meant for ranking in screens,
+ *	which needs only a few significant digits of overlap.
+ * @param nPrecision: (IN) One of Precisions.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianOverlapKernel::CSettings::setPrecision(const int nPrecision)
+{
+	// If valid parameter:
+	if (nPrecision == Precisions::nDOUBLE || nPrecision == Precisions::nFLOAT)
+	{
+		_nPrecision = nPrecision;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nPrecision = " << nPrecision;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
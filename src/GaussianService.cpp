@@ -16,16 +16,22 @@
 #include "BusinessException.h"
 #include "ConfigurationArguments.h"
 #include "Exception.h"
+#include "GaussianDensityGrid.h"
+#include "GaussianOverlapKernel.h"
 #include "GaussianVolume.h"
 #include "GaussianVolumeOverlapEvaluator.h"
+#include "GeneticOptimizer.h"
 #include "InterfaceAtom.h"
 #include "InterfaceMolecule.h"
 #include "Mathematics.h"
 #include "MoleculeManager.h"
 #include "PocketComboSimilarityEvaluator.h"
+#include "QuasiNewtonOptimizer.h"
+#include "SelfVolumeCache.h"
 #include "SimplexOptimizer.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -45,13 +51,52 @@ using std::vector;
 /* Static Member: */
 
 const int CGaussianService::_nDIMENSIONS = 6;
+const double CGaussianService::_dMEMETIC_MUTATION_ROTATION = 0.5;
+const double CGaussianService::_dMEMETIC_MUTATION_TRANSLATION = 1.0;
+const double CGaussianService::_dPRINCIPAL_AXES_PERTURBATION_ANGLE = 0.5;
+const double CGaussianService::_dPRINCIPAL_AXES_ROTATION_STEP = 0.5;
+const double CGaussianService::_dPRINCIPAL_AXES_TRANSLATION_STEP = 1.5;
+const double CGaussianService::_dREFINEMENT_ROTATION_STEP = 0.1;
+const double CGaussianService::_dREFINEMENT_TRANSLATION_STEP = 0.5;
+const double CGaussianService::_dWARM_START_ROTATION_STEP = 0.5;
+const double CGaussianService::_dWARM_START_TRANSLATION_STEP = 1.5;
+
+const int CGaussianService::InitialPoses::nRANDOM = 0;
+const int CGaussianService::InitialPoses::nPRINCIPAL_AXES = 1;
+
+const int CGaussianService::Optimizers::nSIMPLEX = 0;
+const int CGaussianService::Optimizers::nQUASI_NEWTON = 1;
+const int CGaussianService::Optimizers::nMEMETIC = 2;
 
 /* Default Values: */
+const double CGaussianService::DefaultValues::dGAUSSIAN_CUTOFF = 0;
+const double CGaussianService::DefaultValues::dGAUSSIAN_DENSITY_GRID_PADDING = 4.0;
+const double CGaussianService::DefaultValues::dGAUSSIAN_DENSITY_GRID_SPACING = 0;
+const double CGaussianService::DefaultValues::dGAUSSIAN_INTERSECTION_VOLUME_EPSILON = 0;
+const double CGaussianService::DefaultValues::dGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR = 0;
+const bool CGaussianService::DefaultValues::bGAUSSIAN_KERNEL_SINGLE_PRECISION = false;
+const int CGaussianService::DefaultValues::nGAUSSIAN_MAX_INTERSECTION_ORDER = 1;
+const double CGaussianService::DefaultValues::dGAUSSIAN_NEIGHBOR_LIST_SKIN = 0;
+const int CGaussianService::DefaultValues::nINITIAL_POSES = CGaussianService::InitialPoses::nRANDOM;
+const int CGaussianService::DefaultValues::nMEMETIC_GENERATIONS_NUMBER = 15;
+const int CGaussianService::DefaultValues::nMEMETIC_POPULATION_SIZE = 50;
+const int CGaussianService::DefaultValues::nMEMETIC_REFINED_NUMBER = 4;
+const int CGaussianService::DefaultValues::nOPTIMIZER = CGaussianService::Optimizers::nSIMPLEX;
+const int CGaussianService::DefaultValues::nPOSE_PARAMETERIZATION = CGaussianVolumeOverlapEvaluator::PoseParameterizations::nEULER_ANGLES;
+const int CGaussianService::DefaultValues::nPRINCIPAL_AXES_PERTURBATIONS_NUMBER = 0;
+const int CGaussianService::DefaultValues::nQUASI_NEWTON_MAX_ITERATIONS = 100;
+const double CGaussianService::DefaultValues::dSIMPLEX_ABSOLUTE_VALUE_TOLERANCE = 0;
 const double CGaussianService::DefaultValues::dSIMPLEX_CONTRACTION_FACTOR = 0.5;
 const double CGaussianService::DefaultValues::dSIMPLEX_EXTENSION_FACTOR = 3.5;
+const double CGaussianService::DefaultValues::dSIMPLEX_PRUNING_FRACTION = 0;
 const double CGaussianService::DefaultValues::dSIMPLEX_REFLECTION_FACTOR = 1.0;
+const double CGaussianService::DefaultValues::dSIMPLEX_RELATIVE_VALUE_TOLERANCE = 0;
+const double CGaussianService::DefaultValues::dSIMPLEX_ROTATION_TOLERANCE = 0;
+const double CGaussianService::DefaultValues::dSIMPLEX_TRANSLATION_TOLERANCE = 0;
 const int CGaussianService::DefaultValues::nSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER = 16;
 const int CGaussianService::DefaultValues::nSIMPLEX_MAX_ITERATIONS = 60;
+const int CGaussianService::DefaultValues::nSIMPLEX_THREADS_COUNT = 1;
+const int CGaussianService::DefaultValues::nWARM_START_RANDOM_GROUPS_NUMBER = 1;
 
 /* Message texts: */
 const std::string CGaussianService::MessageTexts::sBAD_CAST("Bad type cast! ");
@@ -64,13 +109,271 @@ const int CGaussianService::ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT = 1;
 const int CGaussianService::ErrorCodes::nNORMAL = 0;
 
 /* Parameter Names: */
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_DENSITY_GRID_PADDING("GAUSSIAN_DENSITY_GRID_PADDING");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_DENSITY_GRID_SPACING("GAUSSIAN_DENSITY_GRID_SPACING");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_INTERSECTION_VOLUME_EPSILON("GAUSSIAN_INTERSECTION_VOLUME_EPSILON");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR("GAUSSIAN_KERNEL_MAX_RELATIVE_ERROR");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_KERNEL_SINGLE_PRECISION("GAUSSIAN_KERNEL_SINGLE_PRECISION");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_MAX_INTERSECTION_ORDER("GAUSSIAN_MAX_INTERSECTION_ORDER");
+const std::string CGaussianService::ParameterNames::sGAUSSIAN_NEIGHBOR_LIST_SKIN("GAUSSIAN_NEIGHBOR_LIST_SKIN");
+const std::string CGaussianService::ParameterNames::sINITIAL_POSES("INITIAL_POSES");
+const std::string CGaussianService::ParameterNames::sMEMETIC_GENERATIONS_NUMBER("MEMETIC_GENERATIONS_NUMBER");
+const std::string CGaussianService::ParameterNames::sMEMETIC_POPULATION_SIZE("MEMETIC_POPULATION_SIZE");
+const std::string CGaussianService::ParameterNames::sMEMETIC_REFINED_NUMBER("MEMETIC_REFINED_NUMBER");
+const std::string CGaussianService::ParameterNames::sOPTIMIZER("OPTIMIZER");
+const std::string CGaussianService::ParameterNames::sPOSE_PARAMETERIZATION("POSE_PARAMETERIZATION");
+const std::string CGaussianService::ParameterNames::sPRINCIPAL_AXES_PERTURBATIONS_NUMBER("PRINCIPAL_AXES_PERTURBATIONS_NUMBER");
+const std::string CGaussianService::ParameterNames::sQUASI_NEWTON_MAX_ITERATIONS("QUASI_NEWTON_MAX_ITERATION");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_ABSOLUTE_VALUE_TOLERANCE("SIMPLEX_ABSOLUTE_VALUE_TOLERANCE");
 const std::string CGaussianService::ParameterNames::sSIMPLEX_CONTRACTION_FACTOR("SIMPLEX_CONTRACTION_FACTOR");
 const std::string CGaussianService::ParameterNames::sSIMPLEX_EXTENSION_FACTOR("SIMPLEX_EXTENSION_FACTOR");
 const std::string CGaussianService::ParameterNames::sSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER("SIMPLEX_GAUSSIAN_INITIAL_SOLUTION_GROUP_NUM");
 const std::string CGaussianService::ParameterNames::sSIMPLEX_MAX_ITERATIONS("SIMPLEX_MAX_ITERATION");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_PRUNING_FRACTION("SIMPLEX_PRUNING_FRACTION");
 const std::string CGaussianService::ParameterNames::sSIMPLEX_REFLECTION_FACTOR("SIMPLEX_REFLECTION_FACTOR");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_RELATIVE_VALUE_TOLERANCE("SIMPLEX_RELATIVE_VALUE_TOLERANCE");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_ROTATION_TOLERANCE("SIMPLEX_ROTATION_TOLERANCE");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_THREADS_COUNT("SIMPLEX_THREADS_COUNT");
+const std::string CGaussianService::ParameterNames::sSIMPLEX_TRANSLATION_TOLERANCE("SIMPLEX_TRANSLATION_TOLERANCE");
+const std::string CGaussianService::ParameterNames::sWARM_START_RANDOM_GROUPS_NUMBER("WARM_START_RANDOM_GROUPS_NUMBER");
 
 
+/**
+ * Description: Rotation matrix about a unit axis through the origin, by Rodrigues' formula.
+ * @param axis: (IN) Unit axis.
+ * @param dAngle: (IN) Angle in radians, counterclockwise looking down the axis.
+ * @param aadRotation: (OUT)
+ */
+static void getAxisRotation(const std::vector<double>& axis, const double dAngle, double aadRotation[3][3])
+{
+	const double dSINE = sin(dAngle);
+	const double dCOSINE = cos(dAngle);
+	const double adCROSS[3][3] = {
+		{0, -axis[2], axis[1]},
+		{axis[2], 0, -axis[0]},
+		{-axis[1], axis[0], 0}
+		};
+	for (int i = 0; i < 3; ++ i)
+	{
+		for (int j = 0; j < 3; ++ j)
+		{
+			aadRotation[i][j] = (i == j ? dCOSINE : 0) + dSINE * adCROSS[i][j] + (1 - dCOSINE) * axis[i] * axis[j];
+		}
+	}
+}
+
+
+/**
+ * Description: Rotation angles of a rotation matrix in the convention of pose parameters, i.e. the matrix equals rotations about X,
+ *	then Y, then Z axis: R = Rz(dAngleZ) * Ry(dAngleY) * Rx(dAngleX).
+ * @param aadRotation: (IN)
+ * @param dAngleX: (OUT)
+ * @param dAngleY: (OUT) In [-pi/2, pi/2].
+ * @param dAngleZ: (OUT)
+ */
+static void getRotationAngles(const double aadRotation[3][3], double& dAngleX, double& dAngleY, double& dAngleZ)
+{
+	dAngleY = asin(std::max(-1.0, std::min(1.0, -aadRotation[2][0])));
+	// If not gimbal locked:
+	if (fabs(aadRotation[2][0]) < 1 - 1e-12)
+	{
+		dAngleX = atan2(aadRotation[2][1], aadRotation[2][2]);
+		dAngleZ = atan2(aadRotation[1][0], aadRotation[0][0]);
+	}
+	// If gimbal locked, only the sum or difference of X and Z angles is defined:
+	else
+	{
+		dAngleX = atan2(-aadRotation[2][0] * aadRotation[0][1], aadRotation[1][1]);
+		dAngleZ = 0;
+	}
+}
+
+
+/**
+ * Description: Replace the rotation angles of a pose, see getRotationAngles(), by the rotation vector of the same rotation.
+ * @param point: (IN, OUT) Pose [tX, tY, tZ, rX, rY, rZ].
+ */
+static void eulerAnglesToRotationVector(std::vector<double>& point)
+{
+	double aadRotation[3][3];
+	CMathematics::eulerAnglesToRotationMatrix(&point[3], aadRotation);
+	CMathematics::rotationMatrixToRotationVector(aadRotation, &point[3]);
+}
+
+
+/**
+ * Description: Replace the rotation vector of a pose by the rotation angles of the same rotation, see getRotationAngles().
+ * @param point: (IN, OUT) Pose [tX, tY, tZ, vX, vY, vZ].
+ */
+static void rotationVectorToEulerAngles(std::vector<double>& point)
+{
+	double aadRotation[3][3];
+	CMathematics::rotationVectorToRotationMatrix(&point[3], aadRotation);
+	getRotationAngles(aadRotation, point[3], point[4], point[5]);
+}
+
+
+/* Implementation for CGaussianService::CPreparedQuery class: */
+
+/**
+ * Description: Ctor, preparing everything about the query molecule which does not depend on database molecules.
+ * @param queryMolecule: (IN)
+ * @param dGaussianCutoff: (IN) Gaussian cutoff used to precalculate the query molecule.
+ * @param nMaxIntersectionOrder: (IN) Max intersection order used to precalculate the query molecule.
+ * @param dIntersectionVolumeEpsilon: (IN) Intersection volume epsilon used to calculate self volume of the query molecule.
+ * @param dDensityGridSpacing: (IN) Spacing of the density grid of the query molecule, 0 for no grid. Ignored for higher order overlap.
+ * @param dDensityGridPadding: (IN) Padding of the density grid.
+ * @exception:
+ *		CBadCastException:
+ *		CEmptyMoleculeException:
+ *		CInvalidArgumentException:
+ */
+CGaussianService::CPreparedQuery::CPreparedQuery(
+	const IMolecule& queryMolecule,
+	const double dGaussianCutoff,
+	const int nMaxIntersectionOrder,
+	const double dIntersectionVolumeEpsilon,
+	const double dDensityGridSpacing,
+	const double dDensityGridPadding
+	) :
+	_centeredMoleculePtr(dynamic_cast<IMolecule*>(queryMolecule.clone())),
+	_centroid(queryMolecule.getCentroid()),
+	_dSelfVolume(0)
+{
+	// If empty molecule:
+	if (queryMolecule.getAtomsCount() <= 0)
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sEMPTY_MOLECULE
+			<< "Function parameter: queryMolecule. ";
+		throw CEmptyMoleculeException(msgStream.str());
+	}
+
+	// If type cast success:
+	if (_centeredMoleculePtr.get())
+	{
+		/* Move molecule to centroid. */
+		/* Note: This is the initial point of alignment. */
+		_centeredMoleculePtr->moveToCentroid();
+
+		CGaussianVolume::prepareMolecule(*_centeredMoleculePtr, _preparedMolecule);
+		CGaussianVolume::calculatePrincipalAxes(_preparedMolecule, _principalCenter, _principalAxes);
+		CGaussianVolume::precalculateMolecule(*_centeredMoleculePtr, dGaussianCutoff, nMaxIntersectionOrder, _precalculation);
+
+		_dSelfVolume = calculateSelfVolume(_preparedMolecule, _precalculation, dIntersectionVolumeEpsilon);
+
+		// If density grid enabled, only first order overlap being calculated on it:
+		if (dDensityGridSpacing > 0 && nMaxIntersectionOrder == 1)
+		{
+			_densityGridPtr.reset(new CGaussianDensityGrid(_preparedMolecule, dDensityGridSpacing, dDensityGridPadding, dGaussianCutoff));
+		}
+	}
+	// If type cast failure:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sBAD_CAST
+			<< MessageTexts::sNOT_IMOLECULE_INTERFACE;
+		throw CBadCastException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CGaussianService::CPreparedQuery::~CPreparedQuery()
+{
+}
+
+
+/**
+ * Description:
+ * @return: Query molecule moved to its centroid.
+ */
+const IMolecule& CGaussianService::CPreparedQuery::getCenteredMolecule() const
+{
+	return *_centeredMoleculePtr;
+}
+
+
+/**
+ * Description:
+ * @return: Centroid of query molecule before centering.
+ */
+const std::vector<double>& CGaussianService::CPreparedQuery::getCentroid() const
+{
+	return _centroid;
+}
+
+
+/**
+ * Description:
+ * @return: Density grid of centered query molecule, NULL pointer if disabled. Its channels are sampled on first use by any database
+ *	molecule.
+ */
+const CGaussianDensityGrid* CGaussianService::CPreparedQuery::getDensityGrid() const
+{
+	return _densityGridPtr.get();
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+const CGaussianVolume::MoleculePrecalculation& CGaussianService::CPreparedQuery::getPrecalculation() const
+{
+	return _precalculation;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+const CGaussianVolume::PreparedMolecule& CGaussianService::CPreparedQuery::getPreparedMolecule() const
+{
+	return _preparedMolecule;
+}
+
+
+/**
+ * Description:
+ * @return: Principal axes of centered query molecule as rows, see CGaussianVolume::calculatePrincipalAxes().
+ */
+const std::vector<std::vector<double> >& CGaussianService::CPreparedQuery::getPrincipalAxes() const
+{
+	return _principalAxes;
+}
+
+
+/**
+ * Description:
+ * @return: Volume weighted centroid of centered query molecule.
+ */
+const std::vector<double>& CGaussianService::CPreparedQuery::getPrincipalCenter() const
+{
+	return _principalCenter;
+}
+
+
+/**
+ * Description:
+ * @return: Gaussian volume of query molecule.
+ */
+double CGaussianService::CPreparedQuery::getSelfVolume() const
+{
+	return _dSelfVolume;
+}
+
+
+/* Implementation for CGaussianService class: */
+
 /* Public Methods: */
 
 /**
@@ -137,8 +440,22 @@ double CGaussianService::evaluateGaussianVolume(const IMolecule& molecule) const
 	// If not empty molecule:
 	if (molecule.getAtomsCount() > 0)
 	{
-		CGaussianVolume gaussianVolume;
-		return gaussianVolume.getOverlapVolume(molecule, molecule);
+		CGaussianVolume::PreparedMolecule preparedMolecule;
+		CGaussianVolume::MoleculePrecalculation precalculation;
+		CGaussianVolume::prepareMolecule(molecule, preparedMolecule);
+		// If higher order volume:
+		if (getGaussianMaxIntersectionOrder() > 1)
+		{
+			CGaussianVolume::precalculateMolecule(molecule, DefaultValues::dGAUSSIAN_CUTOFF, getGaussianMaxIntersectionOrder(), precalculation);
+		}
+		// If first order volume:
+		else
+		{
+			precalculation.dGaussianCutoff = DefaultValues::dGAUSSIAN_CUTOFF;
+			precalculation.nMaxIntersectionOrder = 1;
+		}
+
+		return calculateSelfVolume(preparedMolecule, precalculation, getGaussianIntersectionVolumeEpsilon());
 	}
 	// If empty molecule:
 	else
@@ -153,6 +470,31 @@ double CGaussianService::evaluateGaussianVolume(const IMolecule& molecule) const
 }
 
 
+/**
+ * Description: Same as the overload without cache, but looking up the self volume in a cache first, and storing it there on miss.
+ * @param molecule: (IN)
+ * @param nMoleculeId: (IN) Molecule ID in database, keying the cache entry.
+ * @param selfVolumeCache: (IN, OUT) Cache loaded with the key of getSelfVolumeParametersKey().
+ * @return: Gaussian volume of the molecule.
+ * @exception:
+ * 	CEmptyMoleculeException:
+ */
+double CGaussianService::evaluateGaussianVolume(const IMolecule& molecule, const int nMoleculeId, CSelfVolumeCache& selfVolumeCache) const
+{
+	const unsigned long long nContentHash = CSelfVolumeCache::hashMolecule(molecule);
+	double dSelfVolume = 0.0;
+
+	// If cache miss:
+	if (!selfVolumeCache.lookUp(nMoleculeId, nContentHash, dSelfVolume))
+	{
+		dSelfVolume = evaluateGaussianVolume(molecule);
+		selfVolumeCache.store(nMoleculeId, nContentHash, dSelfVolume);
+	}
+
+	return dSelfVolume;
+}
+
+
 /**
  * Description:
  * @param refMol: (IN)
@@ -163,6 +505,7 @@ double CGaussianService::evaluateGaussianVolume(const IMolecule& molecule) const
  * @exception:
  *		CBadCastException:
  *		CEmptyMoleculeException:
+ *		CInvalidArgumentException: Quasi-Newton optimizer set with higher order overlap.
  */
 double CGaussianService::evaluateMaxGaussianVolumeOverlap(
 	const IMolecule& refMol,
@@ -173,46 +516,185 @@ double CGaussianService::evaluateMaxGaussianVolumeOverlap(
 	// If not empty molecule:
 	if (refMol.getAtomsCount() > 0 && fitMol.getAtomsCount() > 0)
 	{
-		/* Construct initial feasible solutions. */
-		// Note: For simplex optimization, there should be (number of dimension + 1) initial solutions to start the optimization.
-		// initial solution group number
-		const int nInitialGroups = getSimplexInitialSolutionGroupsNumber();
-		vector<vector<vector<double> > > initialSolutionGroups;
-		generateInitialSolutionGroups(nInitialGroups, _nDIMENSIONS + 1, initialSolutionGroups);
+		auto_ptr<CPreparedQuery> preparedQueryPtr = prepareQuery(refMol);
+		return evaluateMaxGaussianVolumeOverlap(*preparedQueryPtr, fitMol, pFitTransformations);
+	}
+	// If empty molecule:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sEMPTY_MOLECULE
+			<< "Function parameter: refMol or fitMol. ";
+		throw CEmptyMoleculeException(msgStream.str());
+	}
+}
 
-		/* Get molecule copies. */
-		auto_ptr<IMolecule> refMoleculePtr(dynamic_cast<IMolecule*>(refMol.clone()));
+
+/**
+ * Description: Same as the overload with reference molecule, but reusing a query prepared by prepareQuery(), which is much cheaper
+ *	when a query is evaluated against many database molecules. Alignment may be warm started from the transformations of a similar
+ *	molecule, typically the previous conformer of the same compound: a start around them replaces the configured initial poses,
+ *	with a few random starts added.
+ * @param preparedQuery: (IN)
+ * @param fitMol: (IN)
+ * @param pFitTransformations: (OUT) See the overload with reference molecule.
+ * @param pWarmStartTransformations: (IN) Transformations got in pFitTransformations for a molecule similar to fitMol, NULL pointer
+ *	for a cold start.
+ * @return: Max Gaussian volume overlap.
+ * @exception:
+ *		CBadCastException:
+ *		CEmptyMoleculeException:
+ *		CInvalidArgumentException: Quasi-Newton optimizer set with higher order overlap.
+ */
+double CGaussianService::evaluateMaxGaussianVolumeOverlap(
+	const CPreparedQuery& preparedQuery,
+	const IMolecule& fitMol,
+	std::vector<std::vector<double> >* pFitTransformations,
+	const std::vector<std::vector<double> >* pWarmStartTransformations
+	) const
+{
+	// If not empty molecule:
+	if (fitMol.getAtomsCount() > 0)
+	{
+		/* Get molecule copy. */
 		auto_ptr<IMolecule> fitMoleculePtr(dynamic_cast<IMolecule*>(fitMol.clone()));
 		// If type cast success:
-		if (refMoleculePtr.get() && fitMoleculePtr.get())
+		if (fitMoleculePtr.get())
 		{
-			/* Move molecules to centroid. */
+			/* Move molecule to centroid. */
 			/* Note: This is the initial point of alignment. */
-			refMoleculePtr->moveToCentroid();
 			fitMoleculePtr->moveToCentroid();
 
+			/* Construct initial feasible solutions. */
+			// Note: For simplex optimization, there should be (number of dimension + 1) initial solutions to start the optimization.
+			vector<vector<vector<double> > > initialSolutionGroups;
+			// If warm start:
+			if (pWarmStartTransformations)
+			{
+				generateWarmStartSolutionGroups(preparedQuery, *pWarmStartTransformations, initialSolutionGroups);
+			}
+			// If principal axes poses:
+			else if (getInitialPoses() == InitialPoses::nPRINCIPAL_AXES)
+			{
+				generatePrincipalAxesSolutionGroups(preparedQuery, *fitMoleculePtr, initialSolutionGroups);
+			}
+			// If random poses:
+			else
+			{
+				generateInitialSolutionGroups(getSimplexInitialSolutionGroupsNumber(), _nDIMENSIONS + 1, initialSolutionGroups);
+			}
+			// If optimizing rotation vectors, initial poses being generated with rotation angles:
+			if (getPoseParameterization() == CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR)
+			{
+				FOREACH(iterSolutionsGroup, initialSolutionGroups, vector<vector<vector<double> > >::iterator)
+				{
+					std::for_each(iterSolutionsGroup->begin(), iterSolutionsGroup->end(), eulerAnglesToRotationVector);
+				}
+			}
+
 			/* Construct evaluator. */
-			CGaussianVolumeOverlapEvaluator gaussianOverlapEvaluator(*refMoleculePtr, *fitMoleculePtr);
+			CGaussianVolumeOverlapEvaluator gaussianOverlapEvaluator(
+				preparedQuery.getCenteredMolecule(),
+				preparedQuery.getPreparedMolecule(),
+				preparedQuery.getPrecalculation(),
+				*fitMoleculePtr
+				);
 			gaussianOverlapEvaluator.setNegativeOverlapFlag(true);
-
-			/* Construct simplex optimizer. */
-			CSimplexOptimizer simplexOptimizer(gaussianOverlapEvaluator, initialSolutionGroups);
-			simplexOptimizer.setReflectionFactor(getSimplexReflectionFactor());
-			simplexOptimizer.setExtensionFactor(getSimplexExtensionFactor());
-			simplexOptimizer.setContractionFactor(getSimplexContractionFactor());
+			gaussianOverlapEvaluator.setGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF);
+			gaussianOverlapEvaluator.setIntersectionVolumeEpsilon(getGaussianIntersectionVolumeEpsilon());
+			gaussianOverlapEvaluator.setMaxIntersectionOrder(getGaussianMaxIntersectionOrder());
+			gaussianOverlapEvaluator.setNeighborListSkin(getGaussianNeighborListSkin());
+			gaussianOverlapEvaluator.setPoseParameterization(getPoseParameterization());
+			initKernelSettings(gaussianOverlapEvaluator);
 
 			/* Do optimization. */
 			// optimal transformation only for the centered reference and fit molecule
 			vector<double> resultPoint;
 			double dResultValue = 0.0;
-			simplexOptimizer.runOptimization(resultPoint, dResultValue, getSimplexMaxIterations());
+			// If quasi-Newton:
+			if (getOptimizer() == Optimizers::nQUASI_NEWTON)
+			{
+				// If higher order overlap, whose gradient would only come from finite differences:
+				if (getGaussianMaxIntersectionOrder() > 1)
+				{
+					std::stringstream msgStream;
+					msgStream
+						<< LOCATION_STREAM_INSERTION
+						<< MessageTexts::sINVALID_ARGUMENT
+						<< "Quasi-Newton optimizer with Gaussian max intersection order = "
+						<< getGaussianMaxIntersectionOrder();
+					throw CInvalidArgumentException(msgStream.str());
+				}
+
+				/* Start from the first solution of each group, gradients always come from the analytic kernel. */
+				vector<vector<double> > initialSolutions;
+				FOREACH(iterSolutionsGroup, initialSolutionGroups, vector<vector<vector<double> > >::const_iterator)
+				{
+					initialSolutions.push_back(iterSolutionsGroup->front());
+				}
+
+				CQuasiNewtonOptimizer quasiNewtonOptimizer(gaussianOverlapEvaluator, initialSolutions);
+				quasiNewtonOptimizer.runOptimization(resultPoint, dResultValue, getQuasiNewtonMaxIterations());
+			}
+			// If memetic:
+			else if (getOptimizer() == Optimizers::nMEMETIC)
+			{
+				runMemeticOptimization(preparedQuery, *fitMoleculePtr, initialSolutionGroups, gaussianOverlapEvaluator, resultPoint, dResultValue);
+			}
+			// If simplex:
+			else
+			{
+				// If first order overlap, the only one calculated on density grid:
+				if (getGaussianMaxIntersectionOrder() == 1)
+				{
+					gaussianOverlapEvaluator.setDensityGrid(preparedQuery.getDensityGrid());
+				}
+
+				CSimplexOptimizer simplexOptimizer(gaussianOverlapEvaluator, initialSolutionGroups);
+				initSimplexOptimizer(simplexOptimizer);
+				simplexOptimizer.runOptimization(resultPoint, dResultValue, getSimplexMaxIterations());
+			}
+
+			/* Refine the pose found on density grid with the analytic kernel, so that the returned overlap is exact. */
+			// If aligned on density grid:
+			if (gaussianOverlapEvaluator.getDensityGrid())
+			{
+				vector<vector<vector<double> > > refinementSolutionGroups;
+				generateRefinementSolutionGroups(resultPoint, refinementSolutionGroups);
+
+				CGaussianVolumeOverlapEvaluator analyticOverlapEvaluator(
+					preparedQuery.getCenteredMolecule(),
+					preparedQuery.getPreparedMolecule(),
+					preparedQuery.getPrecalculation(),
+					*fitMoleculePtr
+					);
+				analyticOverlapEvaluator.setNegativeOverlapFlag(true);
+				analyticOverlapEvaluator.setGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF);
+				analyticOverlapEvaluator.setIntersectionVolumeEpsilon(getGaussianIntersectionVolumeEpsilon());
+				analyticOverlapEvaluator.setMaxIntersectionOrder(getGaussianMaxIntersectionOrder());
+				analyticOverlapEvaluator.setNeighborListSkin(getGaussianNeighborListSkin());
+				analyticOverlapEvaluator.setPoseParameterization(getPoseParameterization());
+				initKernelSettings(analyticOverlapEvaluator);
+
+				CSimplexOptimizer refinementOptimizer(analyticOverlapEvaluator, refinementSolutionGroups);
+				initSimplexOptimizer(refinementOptimizer);
+				refinementOptimizer.runOptimization(resultPoint, dResultValue, getSimplexMaxIterations());
+			}
 
 			/* Get results. */
 			if (pFitTransformations)
 			{
+				// If optimized rotation vector, transformations are always given with rotation angles:
+				if (getPoseParameterization() == CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR)
+				{
+					rotationVectorToEulerAngles(resultPoint);
+				}
+
 				/* Get centroid of molecule. */
 				static const int nDIMENSION = 3;
-				const vector<double>& refMoleculeCentroid = refMol.getCentroid();
+				const vector<double>& refMoleculeCentroid = preparedQuery.getCentroid();
 				const vector<double>& fitMoleculeCentroid = fitMol.getCentroid();
 
 				pFitTransformations->clear();
@@ -255,7 +737,7 @@ double CGaussianService::evaluateMaxGaussianVolumeOverlap(
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< MessageTexts::sEMPTY_MOLECULE
-			<< "Function parameter: refMol or fitMol. ";
+			<< "Function parameter: fitMol. ";
 		throw CEmptyMoleculeException(msgStream.str());
 	}
 }
@@ -351,12 +833,12 @@ double CGaussianService::evaluatePocketComboSimilarity(
 				*fitPocketVolumeClonePtr,
 				*fitPocketAlphaCPtr
 				);
+			// The evaluator can not be cloned for simplex starts, so its batches are evaluated across threads instead.
+			functionEvaluator.setThreadsCount(getSimplexThreadsCount());
 
 			/* Construct simplex optimizer. */
 			CSimplexOptimizer simplexOptimizer(functionEvaluator, initialSolutionGroups);
-			simplexOptimizer.setReflectionFactor(getSimplexReflectionFactor());
-			simplexOptimizer.setExtensionFactor(getSimplexExtensionFactor());
-			simplexOptimizer.setContractionFactor(getSimplexContractionFactor());
+			initSimplexOptimizer(simplexOptimizer);
 
 			/* Do optimization. */
 			// optimal transformation only for the centered reference and fit molecule
@@ -428,18 +910,9 @@ double CGaussianService::evaluatePocketComboSimilarity(
  * Description:
  * @return:
  */
-std::map<std::string, std::string> CGaussianService::getParametersMap() const
+double CGaussianService::getGaussianDensityGridPadding() const
 {
-	/* Construct parameters map. */
-	// parameters map
-	map<string, string> parametersMap;
-	parametersMap[ParameterNames::sSIMPLEX_CONTRACTION_FACTOR] = CUtility::toString(getSimplexContractionFactor());
-	parametersMap[ParameterNames::sSIMPLEX_EXTENSION_FACTOR] = CUtility::toString(getSimplexExtensionFactor());
-	parametersMap[ParameterNames::sSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER] = CUtility::toString(getSimplexInitialSolutionGroupsNumber());
-	parametersMap[ParameterNames::sSIMPLEX_MAX_ITERATIONS] = CUtility::toString(getSimplexMaxIterations());
-	parametersMap[ParameterNames::sSIMPLEX_REFLECTION_FACTOR] = CUtility::toString(getSimplexReflectionFactor());
-	
-	return parametersMap;
+	return _parameterAggregation.dGaussianDensityGridPadding;
 }
 
 
@@ -447,9 +920,9 @@ std::map<std::string, std::string> CGaussianService::getParametersMap() const
  * Description:
  * @return:
  */
-double CGaussianService::getSimplexContractionFactor() const
+double CGaussianService::getGaussianDensityGridSpacing() const
 {
-	return _parameterAggregation.dSimplexContractionFactor;
+	return _parameterAggregation.dGaussianDensityGridSpacing;
 }
 
 
@@ -457,9 +930,9 @@ double CGaussianService::getSimplexContractionFactor() const
  * Description:
  * @return:
  */
-double CGaussianService::getSimplexExtensionFactor() const
+double CGaussianService::getGaussianIntersectionVolumeEpsilon() const
 {
-	return _parameterAggregation.dSimplexExtensionFactor;
+	return _parameterAggregation.dGaussianIntersectionVolumeEpsilon;
 }
 
 
@@ -467,9 +940,9 @@ double CGaussianService::getSimplexExtensionFactor() const
  * Description:
  * @return:
  */
-int CGaussianService::getSimplexInitialSolutionGroupsNumber() const
+double CGaussianService::getGaussianKernelMaxRelativeError() const
 {
-	return _parameterAggregation.nSimplexInitialSolutionGroupsNumber;
+	return _parameterAggregation.dGaussianKernelMaxRelativeError;
 }
 
 
@@ -477,9 +950,9 @@ int CGaussianService::getSimplexInitialSolutionGroupsNumber() const
  * Description:
  * @return:
  */
-int CGaussianService::getSimplexMaxIterations() const
+bool CGaussianService::getGaussianKernelSinglePrecisionFlag() const
 {
-	return _parameterAggregation.nSimplexMaxIterations;
+	return _parameterAggregation.bGaussianKernelSinglePrecision;
 }
 
 
@@ -487,51 +960,317 @@ int CGaussianService::getSimplexMaxIterations() const
  * Description:
  * @return:
  */
-double CGaussianService::getSimplexReflectionFactor() const
+int CGaussianService::getGaussianMaxIntersectionOrder() const
 {
-	return _parameterAggregation.dSimplexReflectionFactor;
+	return _parameterAggregation.nGaussianMaxIntersectionOrder;
 }
 
 
 /**
  * Description:
- * @param dContractionFactor: (IN)
- * @exception:
- *	CInvalidArgumentException:
+ * @return:
  */
-void CGaussianService::setSimplexContractionFactor(double dContractionFactor)
+double CGaussianService::getGaussianNeighborListSkin() const
 {
-	// If valid argument:
-	if (dContractionFactor > 0)
-	{
-		_parameterAggregation.dSimplexContractionFactor = dContractionFactor;
-	}
-	// If invalid argument:
-	else
-	{
-		std::stringstream msgStream;
-		msgStream
-			<< LOCATION_STREAM_INSERTION
-			<< MessageTexts::sINVALID_ARGUMENT
-			<< "dContractionFactor = "
-			<< dContractionFactor;
-		throw CInvalidArgumentException(msgStream.str());
-	}
+	return _parameterAggregation.dGaussianNeighborListSkin;
 }
 
 
 /**
  * Description:
- * @param dExtensionFactor: (IN)
+ * @return: One of InitialPoses.
+ */
+int CGaussianService::getInitialPoses() const
+{
+	return _parameterAggregation.nInitialPoses;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getMemeticGenerationsNumber() const
+{
+	return _parameterAggregation.nMemeticGenerationsNumber;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getMemeticPopulationSize() const
+{
+	return _parameterAggregation.nMemeticPopulationSize;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getMemeticRefinedNumber() const
+{
+	return _parameterAggregation.nMemeticRefinedNumber;
+}
+
+
+/**
+ * Description:
+ * @return: One of Optimizers.
+ */
+int CGaussianService::getOptimizer() const
+{
+	return _parameterAggregation.nOptimizer;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+std::map<std::string, std::string> CGaussianService::getParametersMap() const
+{
+	/* Construct parameters map. */
+	// parameters map
+	map<string, string> parametersMap;
+	parametersMap[ParameterNames::sGAUSSIAN_DENSITY_GRID_PADDING] = CUtility::toString(getGaussianDensityGridPadding());
+	parametersMap[ParameterNames::sGAUSSIAN_DENSITY_GRID_SPACING] = CUtility::toString(getGaussianDensityGridSpacing());
+	parametersMap[ParameterNames::sGAUSSIAN_INTERSECTION_VOLUME_EPSILON] = CUtility::toString(getGaussianIntersectionVolumeEpsilon());
+	parametersMap[ParameterNames::sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR] = CUtility::toString(getGaussianKernelMaxRelativeError());
+	parametersMap[ParameterNames::sGAUSSIAN_KERNEL_SINGLE_PRECISION] = CUtility::toString(getGaussianKernelSinglePrecisionFlag());
+	parametersMap[ParameterNames::sGAUSSIAN_MAX_INTERSECTION_ORDER] = CUtility::toString(getGaussianMaxIntersectionOrder());
+	parametersMap[ParameterNames::sGAUSSIAN_NEIGHBOR_LIST_SKIN] = CUtility::toString(getGaussianNeighborListSkin());
+	parametersMap[ParameterNames::sINITIAL_POSES] = CUtility::toString(getInitialPoses());
+	parametersMap[ParameterNames::sMEMETIC_GENERATIONS_NUMBER] = CUtility::toString(getMemeticGenerationsNumber());
+	parametersMap[ParameterNames::sMEMETIC_POPULATION_SIZE] = CUtility::toString(getMemeticPopulationSize());
+	parametersMap[ParameterNames::sMEMETIC_REFINED_NUMBER] = CUtility::toString(getMemeticRefinedNumber());
+	parametersMap[ParameterNames::sOPTIMIZER] = CUtility::toString(getOptimizer());
+	parametersMap[ParameterNames::sPOSE_PARAMETERIZATION] = CUtility::toString(getPoseParameterization());
+	parametersMap[ParameterNames::sPRINCIPAL_AXES_PERTURBATIONS_NUMBER] = CUtility::toString(getPrincipalAxesPerturbationsNumber());
+	parametersMap[ParameterNames::sQUASI_NEWTON_MAX_ITERATIONS] = CUtility::toString(getQuasiNewtonMaxIterations());
+	parametersMap[ParameterNames::sSIMPLEX_ABSOLUTE_VALUE_TOLERANCE] = CUtility::toString(getSimplexAbsoluteValueTolerance());
+	parametersMap[ParameterNames::sSIMPLEX_CONTRACTION_FACTOR] = CUtility::toString(getSimplexContractionFactor());
+	parametersMap[ParameterNames::sSIMPLEX_EXTENSION_FACTOR] = CUtility::toString(getSimplexExtensionFactor());
+	parametersMap[ParameterNames::sSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER] = CUtility::toString(getSimplexInitialSolutionGroupsNumber());
+	parametersMap[ParameterNames::sSIMPLEX_MAX_ITERATIONS] = CUtility::toString(getSimplexMaxIterations());
+	parametersMap[ParameterNames::sSIMPLEX_PRUNING_FRACTION] = CUtility::toString(getSimplexPruningFraction());
+	parametersMap[ParameterNames::sSIMPLEX_REFLECTION_FACTOR] = CUtility::toString(getSimplexReflectionFactor());
+	parametersMap[ParameterNames::sSIMPLEX_RELATIVE_VALUE_TOLERANCE] = CUtility::toString(getSimplexRelativeValueTolerance());
+	parametersMap[ParameterNames::sSIMPLEX_ROTATION_TOLERANCE] = CUtility::toString(getSimplexRotationTolerance());
+	parametersMap[ParameterNames::sSIMPLEX_THREADS_COUNT] = CUtility::toString(getSimplexThreadsCount());
+	parametersMap[ParameterNames::sSIMPLEX_TRANSLATION_TOLERANCE] = CUtility::toString(getSimplexTranslationTolerance());
+	parametersMap[ParameterNames::sWARM_START_RANDOM_GROUPS_NUMBER] = CUtility::toString(getWarmStartRandomGroupsNumber());
+	
+	return parametersMap;
+}
+
+
+/**
+ * Description:
+ * @return: One of CGaussianVolumeOverlapEvaluator::PoseParameterizations.
+ */
+int CGaussianService::getPoseParameterization() const
+{
+	return _parameterAggregation.nPoseParameterization;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getPrincipalAxesPerturbationsNumber() const
+{
+	return _parameterAggregation.nPrincipalAxesPerturbationsNumber;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getQuasiNewtonMaxIterations() const
+{
+	return _parameterAggregation.nQuasiNewtonMaxIterations;
+}
+
+
+/**
+ * Description: Text identifying all parameters which self volumes depend on, to bind a self volume cache to them.
+ * @return:
+ */
+std::string CGaussianService::getSelfVolumeParametersKey() const
+{
+	stringstream keyStream;
+	keyStream.precision(17);
+	keyStream
+		<< "GAUSSIAN_CUTOFF=" << DefaultValues::dGAUSSIAN_CUTOFF << ";"
+		<< ParameterNames::sGAUSSIAN_INTERSECTION_VOLUME_EPSILON << "=" << getGaussianIntersectionVolumeEpsilon() << ";"
+		<< ParameterNames::sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR << "=" << getGaussianKernelMaxRelativeError() << ";"
+		<< ParameterNames::sGAUSSIAN_KERNEL_SINGLE_PRECISION << "=" << getGaussianKernelSinglePrecisionFlag() << ";"
+		<< ParameterNames::sGAUSSIAN_MAX_INTERSECTION_ORDER << "=" << getGaussianMaxIntersectionOrder();
+
+	return keyStream.str();
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexAbsoluteValueTolerance() const
+{
+	return _parameterAggregation.dSimplexAbsoluteValueTolerance;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexContractionFactor() const
+{
+	return _parameterAggregation.dSimplexContractionFactor;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexExtensionFactor() const
+{
+	return _parameterAggregation.dSimplexExtensionFactor;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getSimplexInitialSolutionGroupsNumber() const
+{
+	return _parameterAggregation.nSimplexInitialSolutionGroupsNumber;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getSimplexMaxIterations() const
+{
+	return _parameterAggregation.nSimplexMaxIterations;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexPruningFraction() const
+{
+	return _parameterAggregation.dSimplexPruningFraction;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexReflectionFactor() const
+{
+	return _parameterAggregation.dSimplexReflectionFactor;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexRelativeValueTolerance() const
+{
+	return _parameterAggregation.dSimplexRelativeValueTolerance;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexRotationTolerance() const
+{
+	return _parameterAggregation.dSimplexRotationTolerance;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getSimplexThreadsCount() const
+{
+	return _parameterAggregation.nSimplexThreadsCount;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+double CGaussianService::getSimplexTranslationTolerance() const
+{
+	return _parameterAggregation.dSimplexTranslationTolerance;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CGaussianService::getWarmStartRandomGroupsNumber() const
+{
+	return _parameterAggregation.nWarmStartRandomGroupsNumber;
+}
+
+
+/**
+ * Description: Prepare a query molecule once, to be evaluated against many database molecules. The density grid is only built
+ *	for first order overlap aligned by simplex or memetic alignment, as quasi-Newton alignment always runs on the analytic kernel.
+ * @param queryMolecule: (IN)
+ * @return:
+ * @exception:
+ *		CBadCastException:
+ *		CEmptyMoleculeException:
+ */
+std::auto_ptr<CGaussianService::CPreparedQuery> CGaussianService::prepareQuery(const IMolecule& queryMolecule) const
+{
+	return auto_ptr<CPreparedQuery>(new CPreparedQuery(
+		queryMolecule,
+		DefaultValues::dGAUSSIAN_CUTOFF,
+		getGaussianMaxIntersectionOrder(),
+		getGaussianIntersectionVolumeEpsilon(),
+		getGaussianMaxIntersectionOrder() == 1 && getOptimizer() != Optimizers::nQUASI_NEWTON ? getGaussianDensityGridSpacing() : 0,
+		getGaussianDensityGridPadding()
+		));
+}
+
+
+/**
+ * Description: Set padding of query density grids. Fit atoms beyond the padding contribute nothing on the grid, a padding no less
+ *	than the largest sum of two atom radii loses no overlap.
+ * @param dPadding: (IN)
  * @exception:
  *	CInvalidArgumentException:
  */
-void CGaussianService::setSimplexExtensionFactor(double dExtensionFactor)
+void CGaussianService::setGaussianDensityGridPadding(double dPadding)
 {
 	// If valid argument:
-	if (dExtensionFactor > 0)
+	if (dPadding >= 0)
 	{
-		_parameterAggregation.dSimplexExtensionFactor = dExtensionFactor;
+		_parameterAggregation.dGaussianDensityGridPadding = dPadding;
 	}
 	// If invalid argument:
 	else
@@ -540,25 +1279,26 @@ void CGaussianService::setSimplexExtensionFactor(double dExtensionFactor)
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< MessageTexts::sINVALID_ARGUMENT
-			<< "dExtensionFactor = "
-			<< dExtensionFactor;
+			<< "dPadding = "
+			<< dPadding;
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
 
 
 /**
- * Description:
- * @param nGroupsNumber: (IN)
+ * Description: Set spacing of query density grids. With a positive spacing and first order overlap, each alignment runs first on
+ *	the density grid of the query, then is refined from the best pose with the analytic kernel, which gives the returned overlap.
+ * @param dSpacing: (IN) 0 for aligning with the analytic kernel only.
  * @exception:
  *	CInvalidArgumentException:
  */
-void CGaussianService::setSimplexInitialSolutionGroupsNumber(int nGroupsNumber)
+void CGaussianService::setGaussianDensityGridSpacing(double dSpacing)
 {
 	// If valid argument:
-	if (nGroupsNumber > 0)
+	if (dSpacing >= 0)
 	{
-		_parameterAggregation.nSimplexInitialSolutionGroupsNumber = nGroupsNumber;
+		_parameterAggregation.dGaussianDensityGridSpacing = dSpacing;
 	}
 	// If invalid argument:
 	else
@@ -567,8 +1307,8 @@ void CGaussianService::setSimplexInitialSolutionGroupsNumber(int nGroupsNumber)
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< MessageTexts::sINVALID_ARGUMENT
-			<< "nGroupsNumber = "
-			<< nGroupsNumber;
+			<< "dSpacing = "
+			<< dSpacing;
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
@@ -576,16 +1316,16 @@ void CGaussianService::setSimplexInitialSolutionGroupsNumber(int nGroupsNumber)
 
 /**
  * Description:
- * @param nMaxIteration: (IN)
+ * @param dEpsilon: (IN)
  * @exception:
  *	CInvalidArgumentException:
  */
-void CGaussianService::setSimplexMaxIterations(int nMaxIterations)
+void CGaussianService::setGaussianIntersectionVolumeEpsilon(double dEpsilon)
 {
 	// If valid argument:
-	if (nMaxIterations > 0)
+	if (dEpsilon >= 0)
 	{
-		_parameterAggregation.nSimplexMaxIterations = nMaxIterations;
+		_parameterAggregation.dGaussianIntersectionVolumeEpsilon = dEpsilon;
 	}
 	// If invalid argument:
 	else
@@ -594,25 +1334,27 @@ void CGaussianService::setSimplexMaxIterations(int nMaxIterations)
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< MessageTexts::sINVALID_ARGUMENT
-			<< "nMaxIterations = "
-			<< nMaxIterations;
+			<< "dEpsilon = "
+			<< dEpsilon;
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
 
 
 /**
- * Description:
- * @param dReflectionFactor: (IN)
+ * Description: Set max relative error of first order overlap kernels, applied to the overlap evaluators of this service only.
+ * @param dMaxRelativeError: (IN) 0 for exact kernels, a positive value for fast kernels, see CGaussianOverlapKernel::CSettings.
  * @exception:
  *	CInvalidArgumentException:
  */
-void CGaussianService::setSimplexReflectionFactor(double dReflectionFactor)
+void CGaussianService::setGaussianKernelMaxRelativeError(double dMaxRelativeError)
 {
 	// If valid argument:
-	if (dReflectionFactor > 0)
+	if (dMaxRelativeError >= 0)
 	{
-		_parameterAggregation.dSimplexReflectionFactor = dReflectionFactor;
+		// Reject errors no fast kernel can meet before keeping it.
+		CGaussianOverlapKernel::CSettings().setMaxRelativeError(dMaxRelativeError);
+		_parameterAggregation.dGaussianKernelMaxRelativeError = dMaxRelativeError;
 	}
 	// If invalid argument:
 	else
@@ -621,116 +1363,1249 @@ void CGaussianService::setSimplexReflectionFactor(double dReflectionFactor)
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< MessageTexts::sINVALID_ARGUMENT
-			<< "dReflectionFactor = "
-			<< dReflectionFactor;
+			<< "dMaxRelativeError = "
+			<< dMaxRelativeError;
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
 
 
-/* Private Methods: */
+/**
+ * Description: Select precision of first order overlap kernels. Like the accuracy mode, it is applied to the overlap evaluators of
+ *	this service only.
+ * @param bFlag: (IN) True for single precision, false for double precision.
+ */
+void CGaussianService::setGaussianKernelSinglePrecisionFlag(bool bFlag)
+{
+	_parameterAggregation.bGaussianKernelSinglePrecision = bFlag;
+}
+
 
 /**
  * Description:
- * @param initialSolutions: (OUT)
- * @return:
+ * @param nOrder: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
  */
-int CGaussianService::generateInitialSolutionGroups(int nGroups, int nSolutionsPerGroup, std::vector<std::vector<std::vector<double> > >& initialSolutionGroups) const
+void CGaussianService::setGaussianMaxIntersectionOrder(int nOrder)
 {
-	// number of groups
-	const int nGROUPS = nGroups;
-	// number of solutions per group
-	const int nSOLUTIONS_PER_GROUP = nSolutionsPerGroup;
-	// total solutions generated
-	int nTotalSolutions = 0;
-	
-	// For each group:
-	for (int iGroup = 0; iGroup < nGROUPS; ++iGroup)
+	// If valid argument:
+	if (nOrder > 0)
 	{
-		// current group
-		vector<vector<double> > currentGroup;
+		_parameterAggregation.nGaussianMaxIntersectionOrder = nOrder;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nOrder = "
+			<< nOrder;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set skin distance of cross neighbor lists, which are rebuilt during alignment only when the fit molecule has moved
+ *	beyond the skin. Overlap values are not affected.
+ * @param dSkin: (IN) 0 for testing all atom pairs on each step.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setGaussianNeighborListSkin(double dSkin)
+{
+	// If valid argument:
+	if (dSkin >= 0)
+	{
+		_parameterAggregation.dGaussianNeighborListSkin = dSkin;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dSkin = "
+			<< dSkin;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set the initial poses of Gaussian volume overlap alignment starts, random poses by default. Principal axes poses are
+ *	deterministic and ignore the number of initial solution groups. Pocket combo similarity always starts from random poses.
+ * @param nInitialPoses: (IN) One of InitialPoses.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setInitialPoses(int nInitialPoses)
+{
+	// If valid argument:
+	if (nInitialPoses == InitialPoses::nRANDOM || nInitialPoses == InitialPoses::nPRINCIPAL_AXES)
+	{
+		_parameterAggregation.nInitialPoses = nInitialPoses;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nInitialPoses = "
+			<< nInitialPoses;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nGenerationsNumber: (IN) Number of generations.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setMemeticGenerationsNumber(int nGenerationsNumber)
+{
+	// If valid argument:
+	if (nGenerationsNumber >= 1)
+	{
+		_parameterAggregation.nMemeticGenerationsNumber = nGenerationsNumber;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nGenerationsNumber = "
+			<< nGenerationsNumber;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nPopulationSize: (IN) Number of individuals, initial poses beyond the population size are dropped and random ones fill a shortfall.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setMemeticPopulationSize(int nPopulationSize)
+{
+	// If valid argument:
+	if (nPopulationSize >= 2)
+	{
+		_parameterAggregation.nMemeticPopulationSize = nPopulationSize;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nPopulationSize = "
+			<< nPopulationSize;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nRefinedNumber: (IN) Number of fittest distinct individuals refined by simplex.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setMemeticRefinedNumber(int nRefinedNumber)
+{
+	// If valid argument:
+	if (nRefinedNumber >= 1)
+	{
+		_parameterAggregation.nMemeticRefinedNumber = nRefinedNumber;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nRefinedNumber = "
+			<< nRefinedNumber;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set the local optimizer of Gaussian volume overlap alignment. Pocket combo similarity is always optimized by simplex.
+ * @param nOptimizer: (IN) One of Optimizers.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setOptimizer(int nOptimizer)
+{
+	// If valid argument:
+	if (nOptimizer == Optimizers::nSIMPLEX || nOptimizer == Optimizers::nQUASI_NEWTON || nOptimizer == Optimizers::nMEMETIC)
+	{
+		_parameterAggregation.nOptimizer = nOptimizer;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nOptimizer = "
+			<< nOptimizer;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nPoseParameterization: (IN) One of CGaussianVolumeOverlapEvaluator::PoseParameterizations. Transformations got from
+ *	alignment are given with rotation angles either way.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setPoseParameterization(int nPoseParameterization)
+{
+	// If valid argument:
+	if (nPoseParameterization == CGaussianVolumeOverlapEvaluator::PoseParameterizations::nEULER_ANGLES
+		|| nPoseParameterization == CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR)
+	{
+		_parameterAggregation.nPoseParameterization = nPoseParameterization;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nPoseParameterization = "
+			<< nPoseParameterization;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nPerturbationsNumber: (IN) Number of perturbed copies of each of the four principal axes poses, 0 for none.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setPrincipalAxesPerturbationsNumber(int nPerturbationsNumber)
+{
+	// If valid argument:
+	if (nPerturbationsNumber >= 0)
+	{
+		_parameterAggregation.nPrincipalAxesPerturbationsNumber = nPerturbationsNumber;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nPerturbationsNumber = "
+			<< nPerturbationsNumber;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nMaxIterations: (IN) Max iterations per start.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setQuasiNewtonMaxIterations(int nMaxIterations)
+{
+	// If valid argument:
+	if (nMaxIterations > 0)
+	{
+		_parameterAggregation.nQuasiNewtonMaxIterations = nMaxIterations;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nMaxIterations = "
+			<< nMaxIterations;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Absolute spread of simplex function values within which a start converges, 0 for no test.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexAbsoluteValueTolerance(double dTolerance)
+{
+	// If valid argument:
+	if (dTolerance >= 0)
+	{
+		_parameterAggregation.dSimplexAbsoluteValueTolerance = dTolerance;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dTolerance = "
+			<< dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dContractionFactor: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexContractionFactor(double dContractionFactor)
+{
+	// If valid argument:
+	if (dContractionFactor > 0)
+	{
+		_parameterAggregation.dSimplexContractionFactor = dContractionFactor;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dContractionFactor = "
+			<< dContractionFactor;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dExtensionFactor: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexExtensionFactor(double dExtensionFactor)
+{
+	// If valid argument:
+	if (dExtensionFactor > 0)
+	{
+		_parameterAggregation.dSimplexExtensionFactor = dExtensionFactor;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dExtensionFactor = "
+			<< dExtensionFactor;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nGroupsNumber: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexInitialSolutionGroupsNumber(int nGroupsNumber)
+{
+	// If valid argument:
+	if (nGroupsNumber > 0)
+	{
+		_parameterAggregation.nSimplexInitialSolutionGroupsNumber = nGroupsNumber;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nGroupsNumber = "
+			<< nGroupsNumber;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nMaxIteration: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexMaxIterations(int nMaxIterations)
+{
+	// If valid argument:
+	if (nMaxIterations > 0)
+	{
+		_parameterAggregation.nSimplexMaxIterations = nMaxIterations;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nMaxIterations = "
+			<< nMaxIterations;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set how aggressively simplex starts of an alignment are pruned, as a start is abandoned while short of this fraction
+ *	of the best overlap of all starts and not improving fast enough to reach it. Higher values save more evaluations at the risk of
+ *	missing the best pose.
+ * @param dFraction: (IN) Between 0 and 1, 0 for no pruning.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexPruningFraction(double dFraction)
+{
+	// If valid argument:
+	if (dFraction >= 0 && dFraction <= 1)
+	{
+		_parameterAggregation.dSimplexPruningFraction = dFraction;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dFraction = "
+			<< dFraction;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dReflectionFactor: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexReflectionFactor(double dReflectionFactor)
+{
+	// If valid argument:
+	if (dReflectionFactor > 0)
+	{
+		_parameterAggregation.dSimplexReflectionFactor = dReflectionFactor;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dReflectionFactor = "
+			<< dReflectionFactor;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Spread of simplex function values relative to the lowest one within which a start converges, 0 for no test.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexRelativeValueTolerance(double dTolerance)
+{
+	// If valid argument:
+	if (dTolerance >= 0)
+	{
+		_parameterAggregation.dSimplexRelativeValueTolerance = dTolerance;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dTolerance = "
+			<< dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Spread of simplex vertices along rotation angles within which a start converges, in radians.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexRotationTolerance(double dTolerance)
+{
+	// If valid argument:
+	if (dTolerance >= 0)
+	{
+		_parameterAggregation.dSimplexRotationTolerance = dTolerance;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dTolerance = "
+			<< dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set the number of threads running the simplex starts of one alignment, so that a single alignment uses several
+ *	processors, or evaluating each batch of simplex vertices for pocket combo similarity. Results do not depend on it.
+ * @param nThreadsCount: (IN) 0 for one thread per processor.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexThreadsCount(int nThreadsCount)
+{
+	// If valid argument:
+	if (nThreadsCount >= 0)
+	{
+		_parameterAggregation.nSimplexThreadsCount = nThreadsCount;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nThreadsCount = "
+			<< nThreadsCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Spread of simplex vertices along translations within which a start converges, in Angstroms.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setSimplexTranslationTolerance(double dTolerance)
+{
+	// If valid argument:
+	if (dTolerance >= 0)
+	{
+		_parameterAggregation.dSimplexTranslationTolerance = dTolerance;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "dTolerance = "
+			<< dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nGroupsNumber: (IN) Number of random start groups added to the start around warm start transformations.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGaussianService::setWarmStartRandomGroupsNumber(int nGroupsNumber)
+{
+	// If valid argument:
+	if (nGroupsNumber >= 0)
+	{
+		_parameterAggregation.nWarmStartRandomGroupsNumber = nGroupsNumber;
+	}
+	// If invalid argument:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "nGroupsNumber = "
+			<< nGroupsNumber;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/* Private Methods: */
+
+/**
+ * Description: Calculate Gaussian self volume of a molecule, by the first order overlap kernel or by higher order expansion
+ *	according to the max intersection order of the precalculation result.
+ * @param preparedMolecule: (IN)
+ * @param precalculation: (IN)
+ * @param dIntersectionVolumeEpsilon: (IN)
+ * @return:
+ */
+double CGaussianService::calculateSelfVolume(
+	const CGaussianVolume::PreparedMolecule& preparedMolecule,
+	const CGaussianVolume::MoleculePrecalculation& precalculation,
+	const double dIntersectionVolumeEpsilon
+	)
+{
+	// If first order volume:
+	if (precalculation.nMaxIntersectionOrder == 1)
+	{
+		CGaussianVolume gaussianVolume;
+		gaussianVolume.setGaussianCutoff(precalculation.dGaussianCutoff);
+		return gaussianVolume.getOverlapVolume(preparedMolecule, preparedMolecule);
+	}
+	// If higher order volume:
+	else
+	{
+		CGaussianVolume gaussianVolume(&preparedMolecule, &preparedMolecule, &precalculation, &precalculation);
+		gaussianVolume.setIntersectionVolumeEpsilon(dIntersectionVolumeEpsilon);
+		return gaussianVolume.getReferenceVolume();
+	}
+}
+
+
+/**
+ * Description:
+ * @param initialSolutions: (OUT)
+ * @return:
+ */
+int CGaussianService::generateInitialSolutionGroups(int nGroups, int nSolutionsPerGroup, std::vector<std::vector<std::vector<double> > >& initialSolutionGroups) const
+{
+	// number of groups
+	const int nGROUPS = nGroups;
+	// number of solutions per group
+	const int nSOLUTIONS_PER_GROUP = nSolutionsPerGroup;
+	// total solutions generated
+	int nTotalSolutions = 0;
+	
+	// For each group:
+	for (int iGroup = 0; iGroup < nGROUPS; ++iGroup)
+	{
+		// current group
+		vector<vector<double> > currentGroup;
+
+		// For each solution:
+		for (int iSolution = 0; iSolution < nSOLUTIONS_PER_GROUP; ++iSolution)
+		{
+			// current solution
+			vector<double> currentSolution;
+
+			// For each dimension:
+			for (int iDimension = 0; iDimension < _nDIMENSIONS; ++iDimension)
+			{
+				double dRandom = 0.0;
+				// translation
+				if (iDimension < 3)
+				{
+					dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+					dRandom *= 4.0;
+				}
+				// rotation
+				else
+				{
+					dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
+					dRandom *= 3.1415926;
+				}
+				currentSolution.push_back(dRandom);
+				++nTotalSolutions;
+			}
+			currentGroup.push_back(currentSolution);
+		}
+		initialSolutionGroups.push_back(currentGroup);
+	}
+
+	return nTotalSolutions;
+}
+
+
+/**
+ * Description: Generate one group of solutions per principal axes pose, superposing the principal axes and volume weighted centroid
+ *	of the fit molecule onto those of the query. Principal axes are only defined up to sign, so each of the four proper flips of
+ *	the fit axes is a pose; each pose may be followed by copies rotated about the query axes by multiples of a fixed angle. Each
+ *	group holds the pose itself and one step from it along each dimension, so the result is deterministic.
+ * @param preparedQuery: (IN)
+ * @param fitMolecule: (IN) Fit molecule moved to its centroid, the initial point of alignment.
+ * @param initialSolutionGroups: (OUT)
+ * @return: Number of groups generated.
+ */
+int CGaussianService::generatePrincipalAxesSolutionGroups(
+	const CPreparedQuery& preparedQuery,
+	const IMolecule& fitMolecule,
+	std::vector<std::vector<std::vector<double> > >& initialSolutionGroups
+	) const
+{
+	/* Principal axes of both molecules. */
+	CGaussianVolume::PreparedMolecule fitPreparedMolecule;
+	CGaussianVolume::prepareMolecule(fitMolecule, fitPreparedMolecule);
+	vector<double> fitCenter;
+	vector<vector<double> > fitAxes;
+	CGaussianVolume::calculatePrincipalAxes(fitPreparedMolecule, fitCenter, fitAxes);
+	const vector<double>& refCenter = preparedQuery.getPrincipalCenter();
+	const vector<vector<double> >& refAxes = preparedQuery.getPrincipalAxes();
+
+	// signs of fit axes, the proper rotations among axis flips
+	static const double aadFLIPS[4][3] = {{1, 1, 1}, {1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}};
+	const int nPERTURBATIONS_NUMBER = getPrincipalAxesPerturbationsNumber();
+
+	initialSolutionGroups.clear();
+	// For each flip:
+	for (int iFlip = 0; iFlip < 4; ++ iFlip)
+	{
+		/* Rotation taking each flipped fit axis onto the query axis: R = sum of refAxis * flippedFitAxis^T. */
+		double aadRotation[3][3];
+		for (int i = 0; i < 3; ++ i)
+		{
+			for (int j = 0; j < 3; ++ j)
+			{
+				aadRotation[i][j] = 0;
+				for (int iAxis = 0; iAxis < 3; ++ iAxis)
+				{
+					aadRotation[i][j] += refAxes[iAxis][i] * aadFLIPS[iFlip][iAxis] * fitAxes[iAxis][j];
+				}
+			}
+		}
+
+		// For the pose and each perturbed copy:
+		for (int iPerturbation = 0; iPerturbation <= nPERTURBATIONS_NUMBER; ++ iPerturbation)
+		{
+			double aadPose[3][3];
+			// If the pose itself:
+			if (iPerturbation == 0)
+			{
+				std::copy(&aadRotation[0][0], &aadRotation[0][0] + 9, &aadPose[0][0]);
+			}
+			// If perturbed copy:
+			else
+			{
+				/* Cycle over query axes, then signs, then growing multiples of the angle. */
+				const int nCOPY_ID = iPerturbation - 1;
+				const double dANGLE = _dPRINCIPAL_AXES_PERTURBATION_ANGLE * (nCOPY_ID / 3 % 2 == 0 ? 1 : -1) * (1 + nCOPY_ID / 6);
+				double aadPerturbation[3][3];
+				getAxisRotation(refAxes[nCOPY_ID % 3], dANGLE, aadPerturbation);
+				for (int i = 0; i < 3; ++ i)
+				{
+					for (int j = 0; j < 3; ++ j)
+					{
+						aadPose[i][j] = 0;
+						for (int k = 0; k < 3; ++ k)
+						{
+							aadPose[i][j] += aadPerturbation[i][k] * aadRotation[k][j];
+						}
+					}
+				}
+			}
+
+			/* Translation moving the rotated fit center onto the query center, then rotation angles. */
+			vector<double> centerPoint(_nDIMENSIONS);
+			for (int i = 0; i < 3; ++ i)
+			{
+				centerPoint[i] = refCenter[i];
+				for (int j = 0; j < 3; ++ j)
+				{
+					centerPoint[i] -= aadPose[i][j] * fitCenter[j];
+				}
+			}
+			getRotationAngles(aadPose, centerPoint[3], centerPoint[4], centerPoint[5]);
+
+			vector<vector<double> > currentGroup(1, centerPoint);
+			// For each dimension:
+			for (int iDimension = 0; iDimension < _nDIMENSIONS; ++iDimension)
+			{
+				currentGroup.push_back(centerPoint);
+				currentGroup.back()[iDimension] += iDimension < 3 ? _dPRINCIPAL_AXES_TRANSLATION_STEP : _dPRINCIPAL_AXES_ROTATION_STEP;
+			}
+			initialSolutionGroups.push_back(currentGroup);
+		}
+	}
+
+	return initialSolutionGroups.size();
+}
+
+
+/**
+ * Description: Generate one group of solutions around a point, the point itself and one step from it along each dimension, for a
+ *	simplex refining that point.
+ * @param centerPoint: (IN)
+ * @param refinementSolutionGroups: (OUT)
+ * @return: Number of solutions generated.
+ */
+int CGaussianService::generateRefinementSolutionGroups(const std::vector<double>& centerPoint, std::vector<std::vector<std::vector<double> > >& refinementSolutionGroups) const
+{
+	vector<vector<double> > currentGroup(1, centerPoint);
+
+	// For each dimension:
+	for (int iDimension = 0; iDimension < _nDIMENSIONS; ++iDimension)
+	{
+		currentGroup.push_back(centerPoint);
+		currentGroup.back()[iDimension] += iDimension < 3 ? _dREFINEMENT_TRANSLATION_STEP : _dREFINEMENT_ROTATION_STEP;
+	}
+	refinementSolutionGroups.assign(1, currentGroup);
+
+	return currentGroup.size();
+}
+
+
+/**
+ * Description: Generate solution groups warm starting an alignment: one group around the pose of given transformations, then random
+ *	groups of the configured number.
+ * @param preparedQuery: (IN)
+ * @param warmStartTransformations: (IN) Transformations in the format of pFitTransformations of evaluateMaxGaussianVolumeOverlap().
+ * @param initialSolutionGroups: (OUT)
+ * @return: Number of groups generated.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+int CGaussianService::generateWarmStartSolutionGroups(
+	const CPreparedQuery& preparedQuery,
+	const std::vector<std::vector<double> >& warmStartTransformations,
+	std::vector<std::vector<std::vector<double> > >& initialSolutionGroups
+	) const
+{
+	static const int nDIMENSION = 3;
+	// If not translation, rotation and translation:
+	if (warmStartTransformations.size() != 3
+		|| static_cast<int>(warmStartTransformations[1].size()) != nDIMENSION
+		|| static_cast<int>(warmStartTransformations[2].size()) != nDIMENSION)
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_ARGUMENT
+			<< "Function parameter: warmStartTransformations. ";
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	/* Pose of centered molecules: the last translation less the query centroid, then the rotation. */
+	const vector<double>& refMoleculeCentroid = preparedQuery.getCentroid();
+	vector<double> centerPoint;
+	for (int iDimension = 0; iDimension < nDIMENSION; ++ iDimension)
+	{
+		centerPoint.push_back(warmStartTransformations[2][iDimension] - refMoleculeCentroid[iDimension]);
+	}
+	centerPoint.insert(centerPoint.end(), warmStartTransformations[1].begin(), warmStartTransformations[1].end());
+
+	vector<vector<double> > currentGroup(1, centerPoint);
+	// For each dimension:
+	for (int iDimension = 0; iDimension < _nDIMENSIONS; ++iDimension)
+	{
+		currentGroup.push_back(centerPoint);
+		currentGroup.back()[iDimension] += iDimension < 3 ? _dWARM_START_TRANSLATION_STEP : _dWARM_START_ROTATION_STEP;
+	}
+	initialSolutionGroups.assign(1, currentGroup);
+
+	generateInitialSolutionGroups(getWarmStartRandomGroupsNumber(), _nDIMENSIONS + 1, initialSolutionGroups);
+
+	return initialSolutionGroups.size();
+}
+
+
+/**
+ * Description: Common initialization.
+ */
+int CGaussianService::initialize()
+{
+	// Initialize random seed.
+	srand(static_cast<unsigned int>(time(NULL)));
+
+	/* Debug: Using a constant seed. */
+	//srand(2);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Apply kernel accuracy and precision parameters to an overlap evaluator.
+ * @param overlapEvaluator: (IN, OUT)
+ */
+int CGaussianService::initKernelSettings(CGaussianVolumeOverlapEvaluator& overlapEvaluator) const
+{
+	CGaussianOverlapKernel::CSettings kernelSettings;
+	kernelSettings.setMaxRelativeError(getGaussianKernelMaxRelativeError());
+	kernelSettings.setPrecision(getGaussianKernelSinglePrecisionFlag() ? CGaussianOverlapKernel::Precisions::nFLOAT : CGaussianOverlapKernel::Precisions::nDOUBLE);
+	overlapEvaluator.setKernelSettings(kernelSettings);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Initialize all parameters to default value.
+ */
+int CGaussianService::initParameters()
+{
+	setGaussianDensityGridPadding(DefaultValues::dGAUSSIAN_DENSITY_GRID_PADDING);
+	setGaussianDensityGridSpacing(DefaultValues::dGAUSSIAN_DENSITY_GRID_SPACING);
+	setGaussianIntersectionVolumeEpsilon(DefaultValues::dGAUSSIAN_INTERSECTION_VOLUME_EPSILON);
+	setGaussianKernelMaxRelativeError(DefaultValues::dGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR);
+	setGaussianKernelSinglePrecisionFlag(DefaultValues::bGAUSSIAN_KERNEL_SINGLE_PRECISION);
+	setGaussianMaxIntersectionOrder(DefaultValues::nGAUSSIAN_MAX_INTERSECTION_ORDER);
+	setGaussianNeighborListSkin(DefaultValues::dGAUSSIAN_NEIGHBOR_LIST_SKIN);
+	setInitialPoses(DefaultValues::nINITIAL_POSES);
+	setMemeticGenerationsNumber(DefaultValues::nMEMETIC_GENERATIONS_NUMBER);
+	setMemeticPopulationSize(DefaultValues::nMEMETIC_POPULATION_SIZE);
+	setMemeticRefinedNumber(DefaultValues::nMEMETIC_REFINED_NUMBER);
+	setOptimizer(DefaultValues::nOPTIMIZER);
+	setPoseParameterization(DefaultValues::nPOSE_PARAMETERIZATION);
+	setPrincipalAxesPerturbationsNumber(DefaultValues::nPRINCIPAL_AXES_PERTURBATIONS_NUMBER);
+	setQuasiNewtonMaxIterations(DefaultValues::nQUASI_NEWTON_MAX_ITERATIONS);
+	setSimplexAbsoluteValueTolerance(DefaultValues::dSIMPLEX_ABSOLUTE_VALUE_TOLERANCE);
+	setSimplexContractionFactor(DefaultValues::dSIMPLEX_CONTRACTION_FACTOR);
+	setSimplexExtensionFactor(DefaultValues::dSIMPLEX_EXTENSION_FACTOR);
+	setSimplexInitialSolutionGroupsNumber(DefaultValues::nSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER);
+	setSimplexMaxIterations(DefaultValues::nSIMPLEX_MAX_ITERATIONS);
+	setSimplexThreadsCount(DefaultValues::nSIMPLEX_THREADS_COUNT);
+	setSimplexPruningFraction(DefaultValues::dSIMPLEX_PRUNING_FRACTION);
+	setSimplexReflectionFactor(DefaultValues::dSIMPLEX_REFLECTION_FACTOR);
+	setSimplexRelativeValueTolerance(DefaultValues::dSIMPLEX_RELATIVE_VALUE_TOLERANCE);
+	setSimplexRotationTolerance(DefaultValues::dSIMPLEX_ROTATION_TOLERANCE);
+	setSimplexTranslationTolerance(DefaultValues::dSIMPLEX_TRANSLATION_TOLERANCE);
+	setWarmStartRandomGroupsNumber(DefaultValues::nWARM_START_RANDOM_GROUPS_NUMBER);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Initialize all parameters according to configuration. Parameters which does not exist in configuration file will be initialize to default value.
+ * @param configArguments: (IN) Configuration arguments from configuration file.
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ *	ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT:
+ */
+int CGaussianService::initParameters(const CConfigurationArguments& configArguments)
+{
+	// error code to be returned
+	int nErrorCode = ErrorCodes::nNORMAL;
+
+	initParameters();
+
+	/* Set parameters to configured value if possible. */
+	try
+	{
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_DENSITY_GRID_PADDING))
+		{
+			double dPadding = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_DENSITY_GRID_PADDING, dPadding);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianDensityGridPadding(dPadding);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_DENSITY_GRID_SPACING))
+		{
+			double dSpacing = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_DENSITY_GRID_SPACING, dSpacing);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianDensityGridSpacing(dSpacing);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_INTERSECTION_VOLUME_EPSILON))
+		{
+			double dEpsilon = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_INTERSECTION_VOLUME_EPSILON, dEpsilon);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianIntersectionVolumeEpsilon(dEpsilon);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR))
+		{
+			double dMaxRelativeError = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_KERNEL_MAX_RELATIVE_ERROR, dMaxRelativeError);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianKernelMaxRelativeError(dMaxRelativeError);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_KERNEL_SINGLE_PRECISION))
+		{
+			int nFlag = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_KERNEL_SINGLE_PRECISION, nFlag);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianKernelSinglePrecisionFlag(nFlag != 0);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_MAX_INTERSECTION_ORDER))
+		{
+			int nOrder = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_MAX_INTERSECTION_ORDER, nOrder);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianMaxIntersectionOrder(nOrder);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sGAUSSIAN_NEIGHBOR_LIST_SKIN))
+		{
+			double dSkin = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sGAUSSIAN_NEIGHBOR_LIST_SKIN, dSkin);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setGaussianNeighborListSkin(dSkin);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sINITIAL_POSES))
+		{
+			int nInitialPoses = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sINITIAL_POSES, nInitialPoses);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setInitialPoses(nInitialPoses);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sMEMETIC_GENERATIONS_NUMBER))
+		{
+			int nGenerationsNumber = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sMEMETIC_GENERATIONS_NUMBER, nGenerationsNumber);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setMemeticGenerationsNumber(nGenerationsNumber);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sMEMETIC_POPULATION_SIZE))
+		{
+			int nPopulationSize = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sMEMETIC_POPULATION_SIZE, nPopulationSize);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setMemeticPopulationSize(nPopulationSize);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
-		// For each solution:
-		for (int iSolution = 0; iSolution < nSOLUTIONS_PER_GROUP; ++iSolution)
+		if (configArguments.existArgument(ParameterNames::sMEMETIC_REFINED_NUMBER))
 		{
-			// current solution
-			vector<double> currentSolution;
+			int nRefinedNumber = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sMEMETIC_REFINED_NUMBER, nRefinedNumber);
 
-			// For each dimension:
-			for (int iDimension = 0; iDimension < _nDIMENSIONS; ++iDimension)
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
 			{
-				double dRandom = 0.0;
-				// translation
-				if (iDimension < 3)
-				{
-					dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
-					dRandom *= 4.0;
-				}
-				// rotation
-				else
-				{
-					dRandom = 2 * (rand() / static_cast<double>(RAND_MAX)) - 1;
-					dRandom *= 3.1415926;
-				}
-				currentSolution.push_back(dRandom);
-				++nTotalSolutions;
+				setMemeticRefinedNumber(nRefinedNumber);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
 			}
-			currentGroup.push_back(currentSolution);
 		}
-		initialSolutionGroups.push_back(currentGroup);
-	}
-
-	return nTotalSolutions;
-}
 
+		if (configArguments.existArgument(ParameterNames::sOPTIMIZER))
+		{
+			int nOptimizer = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sOPTIMIZER, nOptimizer);
 
-/**
- * Description: Common initialization.
- */
-int CGaussianService::initialize()
-{
-	// Initialize random seed.
-	srand(static_cast<unsigned int>(time(NULL)));
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setOptimizer(nOptimizer);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
-	/* Debug: Using a constant seed. */
-	//srand(2);
+		if (configArguments.existArgument(ParameterNames::sPOSE_PARAMETERIZATION))
+		{
+			int nPoseParameterization = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sPOSE_PARAMETERIZATION, nPoseParameterization);
 
-	return ErrorCodes::nNORMAL;
-}
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setPoseParameterization(nPoseParameterization);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
+		if (configArguments.existArgument(ParameterNames::sPRINCIPAL_AXES_PERTURBATIONS_NUMBER))
+		{
+			int nPerturbationsNumber = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sPRINCIPAL_AXES_PERTURBATIONS_NUMBER, nPerturbationsNumber);
 
-/**
- * Description: Initialize all parameters to default value.
- */
-int CGaussianService::initParameters()
-{
-	setSimplexContractionFactor(DefaultValues::dSIMPLEX_CONTRACTION_FACTOR);
-	setSimplexExtensionFactor(DefaultValues::dSIMPLEX_EXTENSION_FACTOR);
-	setSimplexInitialSolutionGroupsNumber(DefaultValues::nSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER);
-	setSimplexMaxIterations(DefaultValues::nSIMPLEX_MAX_ITERATIONS);
-	setSimplexReflectionFactor(DefaultValues::dSIMPLEX_REFLECTION_FACTOR);
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setPrincipalAxesPerturbationsNumber(nPerturbationsNumber);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
-	return ErrorCodes::nNORMAL;
-}
+		if (configArguments.existArgument(ParameterNames::sQUASI_NEWTON_MAX_ITERATIONS))
+		{
+			int nMaxIterations = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sQUASI_NEWTON_MAX_ITERATIONS, nMaxIterations);
 
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setQuasiNewtonMaxIterations(nMaxIterations);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
-/**
- * Description: Initialize all parameters according to configuration. Parameters which does not exist in configuration file will be initialize to default value.
- * @param configArguments: (IN) Configuration arguments from configuration file.
- * @return:
- *	ErrorCodes::nNORMAL:
- *	ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT:
- */
-int CGaussianService::initParameters(const CConfigurationArguments& configArguments)
-{
-	// error code to be returned
-	int nErrorCode = ErrorCodes::nNORMAL;
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_ABSOLUTE_VALUE_TOLERANCE))
+		{
+			double dTolerance = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_ABSOLUTE_VALUE_TOLERANCE, dTolerance);
 
-	initParameters();
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexAbsoluteValueTolerance(dTolerance);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
 
-	/* Set parameters to configured value if possible. */
-	try
-	{
 		if (configArguments.existArgument(ParameterNames::sSIMPLEX_CONTRACTION_FACTOR))
 		{
 			double dContractionFactor = 0;
@@ -782,6 +2657,74 @@ int CGaussianService::initParameters(const CConfigurationArguments& configArgume
 			}
 		}
 
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_PRUNING_FRACTION))
+		{
+			double dFraction = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_PRUNING_FRACTION, dFraction);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexPruningFraction(dFraction);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_RELATIVE_VALUE_TOLERANCE))
+		{
+			double dTolerance = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_RELATIVE_VALUE_TOLERANCE, dTolerance);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexRelativeValueTolerance(dTolerance);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_ROTATION_TOLERANCE))
+		{
+			double dTolerance = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_ROTATION_TOLERANCE, dTolerance);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexRotationTolerance(dTolerance);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_TRANSLATION_TOLERANCE))
+		{
+			double dTolerance = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_TRANSLATION_TOLERANCE, dTolerance);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexTranslationTolerance(dTolerance);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
 		if (configArguments.existArgument(ParameterNames::sSIMPLEX_INITIAL_SOLUTION_GROUPS_NUMBER))
 		{
 			int nGroupNumber = 0;
@@ -815,6 +2758,52 @@ int CGaussianService::initParameters(const CConfigurationArguments& configArgume
 				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
 			}
 		}
+
+		if (configArguments.existArgument(ParameterNames::sSIMPLEX_THREADS_COUNT))
+		{
+			int nThreadsCount = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sSIMPLEX_THREADS_COUNT, nThreadsCount);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setSimplexThreadsCount(nThreadsCount);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		if (configArguments.existArgument(ParameterNames::sWARM_START_RANDOM_GROUPS_NUMBER))
+		{
+			int nGroupsNumber = 0;
+			const int nArgumentErrorCode = configArguments.getArgumentValue(ParameterNames::sWARM_START_RANDOM_GROUPS_NUMBER, nGroupsNumber);
+
+			// If argument conversion succeeds:
+			if (nArgumentErrorCode == CConfigurationArguments::ErrorCodes::nNORMAL)
+			{
+				setWarmStartRandomGroupsNumber(nGroupsNumber);
+			}
+			// If argument conversion fails:
+			else
+			{
+				nErrorCode = ErrorCodes::nINVALID_CONFIGURATION_ARGUMENT;
+			}
+		}
+
+		// If quasi-Newton on higher order overlap, which has no analytic gradient:
+		if (getOptimizer() == Optimizers::nQUASI_NEWTON && getGaussianMaxIntersectionOrder() > 1)
+		{
+			std::stringstream msgStream;
+			msgStream
+				<< LOCATION_STREAM_INSERTION
+				<< MessageTexts::sINVALID_ARGUMENT
+				<< "Quasi-Newton optimizer with Gaussian max intersection order = "
+				<< getGaussianMaxIntersectionOrder();
+			throw CInvalidArgumentException(msgStream.str());
+		}
 	}
 	// If parameter conversion succeeds but the corresponding value is invalid:
 	catch(CInvalidArgumentException& exception)
@@ -824,3 +2813,129 @@ int CGaussianService::initParameters(const CConfigurationArguments& configArgume
 
 	return nErrorCode;
 }
+
+
+/**
+ * Description: Apply simplex parameters to a simplex optimizer of pose parameters, including pruning and threads count, with translation
+ *	and rotation tolerances for the vertex spread along the 3 translations and 3 rotation angles respectively.
+ * @param simplexOptimizer: (IN, OUT)
+ */
+int CGaussianService::initSimplexOptimizer(CSimplexOptimizer& simplexOptimizer) const
+{
+	simplexOptimizer.setReflectionFactor(getSimplexReflectionFactor());
+	simplexOptimizer.setExtensionFactor(getSimplexExtensionFactor());
+	simplexOptimizer.setContractionFactor(getSimplexContractionFactor());
+	simplexOptimizer.setAbsoluteValueTolerance(getSimplexAbsoluteValueTolerance());
+	simplexOptimizer.setRelativeValueTolerance(getSimplexRelativeValueTolerance());
+	simplexOptimizer.setPruningFraction(getSimplexPruningFraction());
+	simplexOptimizer.setThreadsCount(getSimplexThreadsCount());
+
+	// If vertex spread tested:
+	if (getSimplexTranslationTolerance() > 0 || getSimplexRotationTolerance() > 0)
+	{
+		vector<double> vertexTolerances(_nDIMENSIONS);
+		for (int iDimension = 0; iDimension < _nDIMENSIONS; ++ iDimension)
+		{
+			vertexTolerances[iDimension] = iDimension < 3 ? getSimplexTranslationTolerance() : getSimplexRotationTolerance();
+		}
+		simplexOptimizer.setVertexTolerances(vertexTolerances);
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Memetic alignment. A genetic optimizer explores poses on first order overlap, which is cheap, and on the query density
+ *	grid if any, then its fittest distinct individuals start a simplex on the exact overlap.
+ * @param preparedQuery: (IN)
+ * @param fitMolecule: (IN) Centered fit molecule.
+ * @param initialSolutionGroups: (IN) Start groups, the first solution of each seeds the initial population.
+ * @param overlapEvaluator: (IN) Evaluator of negative exact overlap, as minimized by simplex.
+ * @param resultPoint: (OUT)
+ * @param dResultValue: (OUT) Negative max overlap.
+ */
+int CGaussianService::runMemeticOptimization(
+	const CPreparedQuery& preparedQuery,
+	const IMolecule& fitMolecule,
+	const std::vector<std::vector<std::vector<double> > >& initialSolutionGroups,
+	IFunctionValueEvaluator& overlapEvaluator,
+	std::vector<double>& resultPoint,
+	double& dResultValue
+	) const
+{
+	/* Initial population: the first solution of each start group, filled up with random poses. */
+	vector<vector<double> > initialPopulation;
+	FOREACH(iterSolutionsGroup, initialSolutionGroups, vector<vector<vector<double> > >::const_iterator)
+	{
+		// If population not full:
+		if (static_cast<int>(initialPopulation.size()) < getMemeticPopulationSize())
+		{
+			initialPopulation.push_back(iterSolutionsGroup->front());
+		}
+	}
+	// If population not full:
+	if (static_cast<int>(initialPopulation.size()) < getMemeticPopulationSize())
+	{
+		vector<vector<vector<double> > > randomSolutionGroups;
+		generateInitialSolutionGroups(1, getMemeticPopulationSize() - initialPopulation.size(), randomSolutionGroups);
+		// If optimizing rotation vectors:
+		if (getPoseParameterization() == CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR)
+		{
+			std::for_each(randomSolutionGroups.front().begin(), randomSolutionGroups.front().end(), eulerAnglesToRotationVector);
+		}
+		initialPopulation.insert(initialPopulation.end(), randomSolutionGroups.front().begin(), randomSolutionGroups.front().end());
+	}
+
+	/* Construct evaluator of positive first order overlap as fitness. */
+	CGaussianVolumeOverlapEvaluator coarseOverlapEvaluator(
+		preparedQuery.getCenteredMolecule(),
+		preparedQuery.getPreparedMolecule(),
+		preparedQuery.getPrecalculation(),
+		fitMolecule
+		);
+	coarseOverlapEvaluator.setGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF);
+	coarseOverlapEvaluator.setMaxIntersectionOrder(1);
+	coarseOverlapEvaluator.setNeighborListSkin(getGaussianNeighborListSkin());
+	coarseOverlapEvaluator.setPoseParameterization(getPoseParameterization());
+	coarseOverlapEvaluator.setDensityGrid(preparedQuery.getDensityGrid());
+	initKernelSettings(coarseOverlapEvaluator);
+
+	/* Explore poses, keeping as many elites as individuals to refine. */
+	// Note: The stream of the genetic optimizer is seeded from the global random generator, like random poses.
+	vector<double> mutationMagnitude(_nDIMENSIONS);
+	for (int iDimension = 0; iDimension < _nDIMENSIONS; ++ iDimension)
+	{
+		mutationMagnitude[iDimension] = iDimension < 3 ? _dMEMETIC_MUTATION_TRANSLATION : _dMEMETIC_MUTATION_ROTATION;
+	}
+
+	CGeneticOptimizer geneticOptimizer(coarseOverlapEvaluator, initialPopulation);
+	geneticOptimizer.setElitesCount(std::min(getMemeticRefinedNumber(), getMemeticPopulationSize()));
+	geneticOptimizer.setMaxIterations(getMemeticGenerationsNumber());
+	geneticOptimizer.setMutationMagnitude(mutationMagnitude);
+	geneticOptimizer.setRandomSeed(rand());
+	geneticOptimizer.setThreadsCount(getSimplexThreadsCount());
+
+	vector<double> bestIndividual;
+	double dBestFitness = 0.0;
+	geneticOptimizer.runOptimization(bestIndividual, dBestFitness);
+
+	/* Refine the fittest individuals on exact overlap. */
+	vector<vector<double> > bestIndividuals;
+	vector<double> bestFitness;
+	geneticOptimizer.getBestIndividuals(getMemeticRefinedNumber(), bestIndividuals, bestFitness);
+
+	vector<vector<vector<double> > > refinementSolutionGroups;
+	FOREACH(iterIndividual, bestIndividuals, vector<vector<double> >::const_iterator)
+	{
+		vector<vector<vector<double> > > individualSolutionGroups;
+		generateRefinementSolutionGroups(*iterIndividual, individualSolutionGroups);
+		refinementSolutionGroups.push_back(individualSolutionGroups.front());
+	}
+
+	CSimplexOptimizer simplexOptimizer(overlapEvaluator, refinementSolutionGroups);
+	initSimplexOptimizer(simplexOptimizer);
+	simplexOptimizer.runOptimization(resultPoint, dResultValue, getSimplexMaxIterations());
+
+	return ErrorCodes::nNORMAL;
+}
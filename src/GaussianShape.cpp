@@ -70,6 +70,23 @@ int main(int argc, const char* argv[])
 
 	//alignMolecule();
 	//stabilityTest();
+	//benchmarkOverlapKernels("test_data/gr_actives_conformers_50.mol2", 10);
+	//benchmarkKernelAccuracy("test_data/gr_actives_conformers_50.mol2", 10);
+	//benchmarkKernelPrecision("test_data/gr_actives_conformers_50.mol2", 10);
+	//benchmarkNeighborList("test_data/gr_actives_conformers_50.mol2", 10, 1);
+	//benchmarkDensityGrid("test_data/gr_actives_conformers_50.mol2", 10, 200);
+	//benchmarkCulling("test_data/1CYD_pocket.pdb", "test_data/1D4D_pocket.pdb", 1);
+	//benchmarkOverlapGradient("test_data/gr_actives_conformers_50.mol2", 10, 200);
+	//benchmarkOptimizers("test_data/gr_actives_conformers_50.mol2", 25);
+	//benchmarkSimplexConvergence("test_data/gr_actives_conformers_50.mol2", 20, 300, 0.01, 1e-4);
+	//benchmarkParallelSimplex("test_data/gr_actives_conformers_50.mol2", 10, 1);
+	//benchmarkSimplexPruning("test_data/gr_actives_conformers_50.mol2", 20, 60, 0.7);
+	//benchmarkInitialPoses("test_data/gr_actives_conformers_50.mol2", 20, 0);
+	//benchmarkBatchEvaluation("test_data/gr_actives_conformers_50.mol2", 10, 64, 1);
+	//benchmarkGeneticOptimizer("test_data/gr_actives_conformers_50.mol2", 5, 50, 100);
+	//benchmarkMemeticAlignment("test_data/gr_actives_conformers_50.mol2", 10, 3, 50, 15, 4);
+	//benchmarkWarmStart("test_data/gr_actives_conformers_50.mol2", 10, 1);
+	//benchmarkPoseParameterization("test_data/gr_actives_conformers_50.mol2", 10, 0);
 	debug();
 
 	//std::cout << "Press any key to exit..." << std::endl;
@@ -13,7 +13,10 @@
 
 #include "GaussianVolume.h"
 
+#include "CellList.h"
+#include "CrossNeighborList.h"
 #include "Exception.h"
+#include "GaussianOverlapKernel.h"
 #include "InterfaceAtom.h"
 #include "InterfaceMolecule.h"
 #include "Mathematics.h"
@@ -27,69 +30,17 @@
 
 using std::auto_ptr;
 using std::list;
-using std::set;
 using std::string;
 using std::vector;
 
 
-/* Implementation for CGaussianVolume::CIntersectedAtomsFilter class: */
-
-/**
- * Description: Constructor.
- * @param pNeighborAtomIds: (IN)
- */
-CGaussianVolume::CIntersectedAtomsFilter::CIntersectedAtomsFilter(const std::vector<std::set<int> >* pNeighborAtomIds) :
-	_pNeighborAtomIds(pNeighborAtomIds)
-{
-	// If not NULL parameter:
-	if (pNeighborAtomIds)
-	{
-	}
-	// If NULL parameter:
-	else
-	{
-		std::stringstream msgStream;
-		msgStream
-			<< LOCATION_STREAM_INSERTION
-			<< "Invalid parameters: "
-			<< "pNeighborAtomIds = NULL. ";
-		throw CInvalidArgumentException(msgStream.str());
-	}
-}
-
-
-/**
- * Description: Filter out pair-wise intersected atoms cluster.
- * @param atomIdsSet: (IN)
- * @return:
- */
-bool CGaussianVolume::CIntersectedAtomsFilter::operator()(const std::set<int>& atomIdsSet) const
-{
-	FOREACH(iterId, atomIdsSet, set<int>::const_iterator)
-	{
-		/* Validate with all IDs behind current one. */
-		set<int>::const_iterator iterIdBehind = iterId;
-		for (++ iterIdBehind; iterIdBehind != atomIdsSet.end(); ++ iterIdBehind)
-		{
-			const set<int>& neighborIdsSet = (*_pNeighborAtomIds)[*iterId];
-			// If not a neighbor of current ID:
-			if (!EXIST(*iterIdBehind, neighborIdsSet))
-			{
-				return false;
-			}
-		}
-	}
-
-	return true;
-}
-
-
 /* Implementation for CGaussianVolume class: */
 
 /* Static members: */
 const double CGaussianVolume::_dP = 2.8284271247;
 const double CGaussianVolume::_dPI = 3.14159265358;
 const double CGaussianVolume::_dPARTIAL_ALPHA = 2.41798793102;
+const int CGaussianVolume::_nBLOCK_ATOMS_COUNT = 8;
 
 const int CGaussianVolume::ErrorCodes::nNORMAL = 0;
 
@@ -97,7 +48,13 @@ const int CGaussianVolume::ErrorCodes::nNORMAL = 0;
 /**
  * Description: Constructor.
  */
-CGaussianVolume::CGaussianVolume()
+CGaussianVolume::CGaussianVolume() :
+	_dGaussianCutoff(0),
+	_dIntersectionVolumeEpsilon(0),
+	_pFitAtoms(NULL),
+	_pFitPrecalculation(NULL),
+	_pRefAtoms(NULL),
+	_pRefPrecalculation(NULL)
 {
 }
 
@@ -107,12 +64,14 @@ CGaussianVolume::CGaussianVolume()
  */
 CGaussianVolume::CGaussianVolume(const CGaussianVolume& volume) :
 	_dGaussianCutoff(volume._dGaussianCutoff),
+	_dIntersectionVolumeEpsilon(volume._dIntersectionVolumeEpsilon),
 	_fitAtomsPtr(volume._fitAtomsPtr),
 	_neighborAtomIds(volume._neighborAtomIds),
+	_neighborSquareDistances(volume._neighborSquareDistances),
 	_pFitAtoms(volume._pFitAtoms),
-	_pPrecalculationResult(volume._pPrecalculationResult),
+	_pFitPrecalculation(volume._pFitPrecalculation),
 	_pRefAtoms(volume._pRefAtoms),
-	_squareDistancesMatrix(volume._squareDistancesMatrix)
+	_pRefPrecalculation(volume._pRefPrecalculation)
 {
 }
 
@@ -121,30 +80,42 @@ CGaussianVolume::CGaussianVolume(const CGaussianVolume& volume) :
  * Description: Constructor.
  * @param pRefAtoms: (IN)
  * @param pFitAtoms: (IN)
- * @param pPrecalculationResult: (IN)
+ * @param pRefPrecalculation: (IN)
+ * @param pFitPrecalculation: (IN)
  */
 CGaussianVolume::CGaussianVolume(
 	const std::vector<IAtom*>* pRefAtoms,
 	const std::vector<IAtom*>* pFitAtoms,
-	const CGaussianVolume::PrecalculationResult* pPrecalculationResult
+	const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation,
+	const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation
 	) :
+	_dGaussianCutoff(0),
+	_dIntersectionVolumeEpsilon(0),
 	_pFitAtoms(pFitAtoms),
-	_pPrecalculationResult(pPrecalculationResult),
-	_pRefAtoms(pRefAtoms)
+	_pFitPrecalculation(pFitPrecalculation),
+	_pRefAtoms(pRefAtoms),
+	_pRefPrecalculation(pRefPrecalculation)
 {
 	// If not NULL parameters:
-	if (pRefAtoms && pFitAtoms && pPrecalculationResult)
+	if (pRefAtoms && pFitAtoms && pRefPrecalculation && pFitPrecalculation)
 	{
 		// If valid parameters:
-		if (pRefAtoms->size() == pPrecalculationResult->alphaValuesForRef.size() &&
-			pRefAtoms->size() == pPrecalculationResult->neighborAtomIdsForRef.size() &&
-			pRefAtoms->size() == pPrecalculationResult->squareDistancesMatrixForRef.size() &&
-			pFitAtoms->size() == pPrecalculationResult->alphaValuesForFit.size() &&
-			pFitAtoms->size() == pPrecalculationResult->neighborAtomIdsForFit.size() &&
-			pFitAtoms->size() == pPrecalculationResult->squareDistancesMatrixForFit.size() &&
-			pPrecalculationResult->intersectedAtomIdsForRef.size() == pPrecalculationResult->intersectedAtomIdsForFit.size())
+		if (pRefAtoms->size() == pRefPrecalculation->alphaValues.size() &&
+			pRefAtoms->size() == pRefPrecalculation->neighborAtomIds.size() &&
+			pRefAtoms->size() == pRefPrecalculation->neighborSquareDistances.size() &&
+			pFitAtoms->size() == pFitPrecalculation->alphaValues.size() &&
+			pFitAtoms->size() == pFitPrecalculation->neighborAtomIds.size() &&
+			pFitAtoms->size() == pFitPrecalculation->neighborSquareDistances.size() &&
+			pRefPrecalculation->nMaxIntersectionOrder == pFitPrecalculation->nMaxIntersectionOrder &&
+			pRefPrecalculation->dGaussianCutoff == pFitPrecalculation->dGaussianCutoff)
 		{
-			initializeIntermolecularInformation();
+			_dGaussianCutoff = pRefPrecalculation->dGaussianCutoff;
+
+			PreparedMolecule refMolecule;
+			PreparedMolecule fitMolecule;
+			prepareAtoms(*pRefAtoms, refMolecule);
+			prepareAtoms(*pFitAtoms, fitMolecule);
+			initializeIntermolecularInformation(refMolecule, fitMolecule, NULL);
 		}
 		// If invalid parameters:
 		else
@@ -153,7 +124,7 @@ CGaussianVolume::CGaussianVolume(
 			msgStream
 				<< LOCATION_STREAM_INSERTION
 				<< "Inconsistent parameters, may be corrupted: "
-				<< "Content of pPrecalculationResult.";
+				<< "Content of pRefPrecalculation or pFitPrecalculation.";
 			throw CInvalidArgumentException(msgStream.str());
 		}
 	}
@@ -164,7 +135,7 @@ CGaussianVolume::CGaussianVolume(
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< "Invalid parameters: "
-			<< "pRefAtoms, pFitAtoms or pPrecalculationResult = NULL. ";
+			<< "pRefAtoms, pFitAtoms, pRefPrecalculation or pFitPrecalculation = NULL. ";
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
@@ -174,16 +145,18 @@ CGaussianVolume::CGaussianVolume(
  * Description: Constructor.
  * @param pRefAtoms: (IN)
  * @param pFitMolecule: (IN)
- * @param pPrecalculationResult: (IN)
+ * @param pRefPrecalculation: (IN)
+ * @param pFitPrecalculation: (IN)
  */
 CGaussianVolume::CGaussianVolume(
 	const std::vector<IAtom*>* pRefAtoms,
 	const IMolecule* pFitMolecule,
-	const CGaussianVolume::PrecalculationResult* pPrecalculationResult
+	const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation,
+	const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation
 	)
 {
 	// If not NULL parameter:
-	if (pRefAtoms && pFitMolecule && pPrecalculationResult)
+	if (pRefAtoms && pFitMolecule && pRefPrecalculation && pFitPrecalculation)
 	{
 		/* Construct fit atoms. */
 		list<IAtom*> fitAtomsList = pFitMolecule->getAtomsList();
@@ -193,7 +166,7 @@ CGaussianVolume::CGaussianVolume(
 
 		try
 		{
-			new(this) CGaussianVolume(pRefAtoms, pFitAtoms, pPrecalculationResult);
+			new(this) CGaussianVolume(pRefAtoms, pFitAtoms, pRefPrecalculation, pFitPrecalculation);
 			_fitAtomsPtr.reset(pFitAtoms);
 		}
 		catch(CInvalidArgumentException& exception)
@@ -214,7 +187,73 @@ CGaussianVolume::CGaussianVolume(
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< "Invalid parameters: "
-			<< "pRefAtoms, pFitMolecule or pPrecalculationResult = NULL. ";
+			<< "pRefAtoms, pFitMolecule, pRefPrecalculation or pFitPrecalculation = NULL. ";
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Constructor from prepared molecules, touching no IAtom instance. Since the precalculation result of a molecule does not
+ *	change with rigid transformation, the prepared fit molecule could be any pose of the precalculated one, only intermolecular
+ *	information is calculated here.
+ * @param pRefMolecule: (IN)
+ * @param pFitMolecule: (IN)
+ * @param pRefPrecalculation: (IN)
+ * @param pFitPrecalculation: (IN)
+ * @param pNeighborList: (IN) Cross neighbor list updated for the current poses, whose listed pairs are tested instead of finding
+ *	neighbors from scratch, could be NULL pointer.
+ */
+CGaussianVolume::CGaussianVolume(
+	const CGaussianVolume::PreparedMolecule* pRefMolecule,
+	const CGaussianVolume::PreparedMolecule* pFitMolecule,
+	const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation,
+	const CGaussianVolume::MoleculePrecalculation* pFitPrecalculation,
+	const CCrossNeighborList* pNeighborList
+	) :
+	_dGaussianCutoff(0),
+	_dIntersectionVolumeEpsilon(0),
+	_pFitAtoms(NULL),
+	_pFitPrecalculation(pFitPrecalculation),
+	_pRefAtoms(NULL),
+	_pRefPrecalculation(pRefPrecalculation)
+{
+	// If not NULL parameters:
+	if (pRefMolecule && pFitMolecule && pRefPrecalculation && pFitPrecalculation)
+	{
+		// If valid parameters:
+		if (pRefMolecule->radii.size() == pRefPrecalculation->alphaValues.size() &&
+			pRefMolecule->radii.size() == pRefPrecalculation->neighborAtomIds.size() &&
+			pRefMolecule->radii.size() == pRefPrecalculation->neighborSquareDistances.size() &&
+			pFitMolecule->radii.size() == pFitPrecalculation->alphaValues.size() &&
+			pFitMolecule->radii.size() == pFitPrecalculation->neighborAtomIds.size() &&
+			pFitMolecule->radii.size() == pFitPrecalculation->neighborSquareDistances.size() &&
+			pRefPrecalculation->nMaxIntersectionOrder == pFitPrecalculation->nMaxIntersectionOrder &&
+			pRefPrecalculation->dGaussianCutoff == pFitPrecalculation->dGaussianCutoff)
+		{
+			_dGaussianCutoff = pRefPrecalculation->dGaussianCutoff;
+
+			initializeIntermolecularInformation(*pRefMolecule, *pFitMolecule, pNeighborList);
+		}
+		// If invalid parameters:
+		else
+		{
+			std::stringstream msgStream;
+			msgStream
+				<< LOCATION_STREAM_INSERTION
+				<< "Inconsistent parameters, may be corrupted: "
+				<< "Content of pRefPrecalculation or pFitPrecalculation.";
+			throw CInvalidArgumentException(msgStream.str());
+		}
+	}
+	// If NULL parameters:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameters: "
+			<< "pRefMolecule, pFitMolecule, pRefPrecalculation or pFitPrecalculation = NULL. ";
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
@@ -229,220 +268,402 @@ CGaussianVolume::~CGaussianVolume()
 
 
 /**
- * Description:
- * @param refAtomIdsSet: (IN)
- * @param fitAtomIdsSet: (IN)
+ * Description: Test whether the bounding spheres of two prepared molecules are too far apart for any atom pair to be in contact, so
+ *	that their overlap volume is 0.
+ * @param refMol: (IN)
+ * @param fitMol: (IN)
+ * @param dGaussianCutoff: (IN)
  * @return:
  */
-double CGaussianVolume::calculateAtomIntersectionVolume(
-	const std::set<int>& refAtomIdsSet,
-	const std::set<int>& fitAtomIdsSet
-	) const
+bool CGaussianVolume::areBoundingSpheresApart(const PreparedMolecule& refMol, const PreparedMolecule& fitMol, const double dGaussianCutoff)
 {
-	/* Calculate delta value. */
-	double dDelta = 0;
-	FOREACH(iterAtomId, refAtomIdsSet, set<int>::const_iterator)
+	const double dDeltaX = fitMol.dBoundingXCenter - refMol.dBoundingXCenter;
+	const double dDeltaY = fitMol.dBoundingYCenter - refMol.dBoundingYCenter;
+	const double dDeltaZ = fitMol.dBoundingZCenter - refMol.dBoundingZCenter;
+	const double dContactDistance = refMol.dBoundingRadius + fitMol.dBoundingRadius + dGaussianCutoff;
+
+	return dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ >= dContactDistance * dContactDistance;
+}
+
+
+/**
+ * Description: Calculate the bounding sphere of a range of prepared atoms, centered at their centroid and enclosing their atom spheres.
+ * @param preparedMolecule: (IN)
+ * @param nStartAtomId: (IN)
+ * @param nEndAtomId: (IN) One past the last atom.
+ * @param dCenterX: (OUT)
+ * @param dCenterY: (OUT)
+ * @param dCenterZ: (OUT)
+ * @param dRadius: (OUT)
+ */
+int CGaussianVolume::calculateBoundingSphere(
+	const PreparedMolecule& preparedMolecule,
+	const int nStartAtomId,
+	const int nEndAtomId,
+	double& dCenterX,
+	double& dCenterY,
+	double& dCenterZ,
+	double& dRadius
+	)
+{
+	dCenterX = 0;
+	dCenterY = 0;
+	dCenterZ = 0;
+	dRadius = 0;
+	// If empty range:
+	if (nEndAtomId <= nStartAtomId)
 	{
-		dDelta += _pPrecalculationResult->alphaValuesForRef[*iterAtomId];
+		return ErrorCodes::nNORMAL;
 	}
-	FOREACH(iterAtomId, fitAtomIdsSet, set<int>::const_iterator)
+
+	for (int iAtomId = nStartAtomId; iAtomId < nEndAtomId; ++ iAtomId)
 	{
-		dDelta += _pPrecalculationResult->alphaValuesForFit[*iterAtomId];
+		dCenterX += preparedMolecule.xCoordinates[iAtomId];
+		dCenterY += preparedMolecule.yCoordinates[iAtomId];
+		dCenterZ += preparedMolecule.zCoordinates[iAtomId];
 	}
+	dCenterX /= nEndAtomId - nStartAtomId;
+	dCenterY /= nEndAtomId - nStartAtomId;
+	dCenterZ /= nEndAtomId - nStartAtomId;
 
-	/* Calculate K value. */
-	double dK = 0;
-	FOREACH(iterRefAtomId, refAtomIdsSet, set<int>::const_iterator)
+	for (int iAtomId = nStartAtomId; iAtomId < nEndAtomId; ++ iAtomId)
 	{
-		set<int>::const_iterator iterRefAtomIdBehind = iterRefAtomId;
-		for (++ iterRefAtomIdBehind; iterRefAtomIdBehind != refAtomIdsSet.end(); ++ iterRefAtomIdBehind)
-		{
-			dK +=
-				_pPrecalculationResult->alphaValuesForRef[*iterRefAtomId] *
-				_pPrecalculationResult->alphaValuesForRef[*iterRefAtomIdBehind] *
-				_pPrecalculationResult->squareDistancesMatrixForRef[*iterRefAtomId][*iterRefAtomIdBehind];
-		}
+		const double dDeltaX = preparedMolecule.xCoordinates[iAtomId] - dCenterX;
+		const double dDeltaY = preparedMolecule.yCoordinates[iAtomId] - dCenterY;
+		const double dDeltaZ = preparedMolecule.zCoordinates[iAtomId] - dCenterZ;
+		dRadius = std::max(dRadius, sqrt(dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ) + preparedMolecule.radii[iAtomId]);
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Calculate the principal axes of the Gaussian volume of a molecule, as eigenvectors of the second moment tensor of
+ *	atom centers weighted by atom volumes (cubic radii). Axes are sorted by descending extent and form a right handed frame, their
+ *	signs are otherwise arbitrary.
+ * @param preparedMolecule: (IN)
+ * @param center: (OUT) Volume weighted centroid.
+ * @param axes: (OUT) Three unit axes as rows.
+ */
+int CGaussianVolume::calculatePrincipalAxes(const PreparedMolecule& preparedMolecule, std::vector<double>& center, std::vector<std::vector<double> >& axes)
+{
+	const int nATOMS_COUNT = preparedMolecule.radii.size();
+
+	/* Weighted centroid. */
+	double dWeightSum = 0;
+	center.assign(3, 0.0);
+	for (int iAtomId = 0; iAtomId < nATOMS_COUNT; ++ iAtomId)
+	{
+		const double dRADIUS = preparedMolecule.radii[iAtomId];
+		const double dWEIGHT = dRADIUS * dRADIUS * dRADIUS;
+		dWeightSum += dWEIGHT;
+		center[0] += dWEIGHT * preparedMolecule.xCoordinates[iAtomId];
+		center[1] += dWEIGHT * preparedMolecule.yCoordinates[iAtomId];
+		center[2] += dWEIGHT * preparedMolecule.zCoordinates[iAtomId];
 	}
-	FOREACH(iterFitAtomId, fitAtomIdsSet, set<int>::const_iterator)
+	// If no volume:
+	if (dWeightSum <= 0)
 	{
-		set<int>::const_iterator iterFitAtomIdBehind = iterFitAtomId;
-		for (++ iterFitAtomIdBehind; iterFitAtomIdBehind != fitAtomIdsSet.end(); ++ iterFitAtomIdBehind)
+		axes.assign(3, vector<double>(3, 0.0));
+		for (int iAxis = 0; iAxis < 3; ++ iAxis)
 		{
-			dK +=
-				_pPrecalculationResult->alphaValuesForFit[*iterFitAtomId] *
-				_pPrecalculationResult->alphaValuesForFit[*iterFitAtomIdBehind] *
-				_pPrecalculationResult->squareDistancesMatrixForFit[*iterFitAtomId][*iterFitAtomIdBehind];
+			axes[iAxis][iAxis] = 1.0;
 		}
+		return ErrorCodes::nNORMAL;
 	}
-	FOREACH(iterRefAtomId, refAtomIdsSet, set<int>::const_iterator)
+	for (int iDimension = 0; iDimension < 3; ++ iDimension)
 	{
-		FOREACH(iterFitAtomId, fitAtomIdsSet, set<int>::const_iterator)
+		center[iDimension] /= dWeightSum;
+	}
+
+	/* Weighted second moment tensor about the centroid. */
+	vector<vector<double> > moments(3, vector<double>(3, 0.0));
+	for (int iAtomId = 0; iAtomId < nATOMS_COUNT; ++ iAtomId)
+	{
+		const double dRADIUS = preparedMolecule.radii[iAtomId];
+		const double dWEIGHT = dRADIUS * dRADIUS * dRADIUS;
+		const double deltas[3] = {
+			preparedMolecule.xCoordinates[iAtomId] - center[0],
+			preparedMolecule.yCoordinates[iAtomId] - center[1],
+			preparedMolecule.zCoordinates[iAtomId] - center[2]
+			};
+		for (int iRow = 0; iRow < 3; ++ iRow)
 		{
-			dK +=
-				_pPrecalculationResult->alphaValuesForRef[*iterRefAtomId] *
-				_pPrecalculationResult->alphaValuesForFit[*iterFitAtomId] *
-				_squareDistancesMatrix[*iterRefAtomId][*iterFitAtomId];
+			for (int iColumn = iRow; iColumn < 3; ++ iColumn)
+			{
+				moments[iRow][iColumn] += dWEIGHT * deltas[iRow] * deltas[iColumn];
+			}
 		}
 	}
-	dK = exp(- (dK / dDelta));
 
-	// final intersection volume
-	const double dIntersectionVolume =
-		pow(_dP, refAtomIdsSet.size() + fitAtomIdsSet.size()) *
-		dK *
-		pow(_dPI / dDelta, 1.5);
+	vector<double> eigenValues;
+	CMathematics::diagonalizeSymmetricMatrix(moments, eigenValues, axes);
+
+	/* Make the frame right handed: third axis = first x second. */
+	axes[2][0] = axes[0][1] * axes[1][2] - axes[0][2] * axes[1][1];
+	axes[2][1] = axes[0][2] * axes[1][0] - axes[0][0] * axes[1][2];
+	axes[2][2] = axes[0][0] * axes[1][1] - axes[0][1] * axes[1][0];
 
-	return dIntersectionVolume;
+	return ErrorCodes::nNORMAL;
 }
 
 
 /**
- * Description:
- * @param neighborAtomIds: (IN)
- * @param nIntersectedAtoms: (IN)
- * @param intersectedAtomIds: (OUT)
+ * Description: Calculate overlap volume of two molecules by inclusion-exclusion over clusters of pair-wise neighbored atoms, each
+ *	holding at least one atom of each molecule. Clusters are grown depth first along neighbor lists, while the Gaussian product of
+ *	a cluster is updated incrementally from its parent, so only clusters actually intersected are ever visited.
+ * @param refPrecalculation: (IN)
+ * @param fitPrecalculation: (IN)
+ * @param crossNeighborAtomIds: (IN) Index: reference atom ID, value: ascending fit atom IDs.
+ * @param crossNeighborSquareDistances: (IN) Square distances in the same order as crossNeighborAtomIds.
+ * @param dEpsilon: (IN) Clusters with intersection volume below this value are dropped. Clusters grown from a cluster are only
+ *	skipped when a bound of their volumes is below it, see getClusterVolumeBound(), as a grown cluster may be larger than its parent.
+ * @return:
  */
-int CGaussianVolume::enumerateIntersectedAtomIds(
-	const std::vector<std::set<int> >& neighborAtomIds,
-	const int nIntersectedAtoms,
-	std::vector<std::set<int> >& intersectedAtomIds
+double CGaussianVolume::expandClusters(
+	const MoleculePrecalculation& refPrecalculation,
+	const MoleculePrecalculation& fitPrecalculation,
+	const std::vector<std::vector<int> >& crossNeighborAtomIds,
+	const std::vector<std::vector<double> >& crossNeighborSquareDistances,
+	const double dEpsilon
 	)
 {
-	// If valid parameter:
-	if (nIntersectedAtoms >= 0)
+	/* Prepare expansion state. */
+	const int nMAX_INTERSECTION_ORDER = refPrecalculation.nMaxIntersectionOrder;
+	ClusterExpansion expansion;
+	expansion.candidateFitAtomIds.resize(nMAX_INTERSECTION_ORDER + 1);
+	expansion.candidateRefAtomIds.resize(nMAX_INTERSECTION_ORDER + 1);
+	expansion.crossCandidateFitAtomIds.resize(nMAX_INTERSECTION_ORDER + 1);
+	expansion.dEpsilon = dEpsilon;
+	expansion.dMinAlpha = 0;
+	// If both molecules hold atoms:
+	if (!refPrecalculation.alphaValues.empty() && !fitPrecalculation.alphaValues.empty())
+	{
+		expansion.dMinAlpha = std::min(
+			*std::min_element(refPrecalculation.alphaValues.begin(), refPrecalculation.alphaValues.end()),
+			*std::min_element(fitPrecalculation.alphaValues.begin(), fitPrecalculation.alphaValues.end())
+			);
+	}
+	expansion.dOverlapVolume = 0;
+	expansion.fitAtomIds.resize(nMAX_INTERSECTION_ORDER);
+	expansion.nMaxIntersectionOrder = nMAX_INTERSECTION_ORDER;
+	expansion.pCrossNeighborAtomIds = &crossNeighborAtomIds;
+	expansion.pCrossNeighborSquareDistances = &crossNeighborSquareDistances;
+	expansion.pFitPrecalculation = &fitPrecalculation;
+	expansion.pRefPrecalculation = &refPrecalculation;
+	expansion.refAtomIds.resize(nMAX_INTERSECTION_ORDER);
+
+	/* Grow clusters from each reference atom. */
+	for (int iRefAtomId = 0; iRefAtomId < static_cast<int>(refPrecalculation.alphaValues.size()); ++ iRefAtomId)
+	{
+		expansion.refAtomIds[0] = iRefAtomId;
+		expansion.candidateRefAtomIds[1] = refPrecalculation.neighborAtomIds[iRefAtomId];
+		expansion.crossCandidateFitAtomIds[1] = crossNeighborAtomIds[iRefAtomId];
+
+		expandRefCluster(expansion, 1, refPrecalculation.alphaValues[iRefAtomId], 0, _dP);
+	}
+
+	return expansion.dOverlapVolume;
+}
+
+
+/**
+ * Description: Add the term of current cluster, then grow it by one more fit atom.
+ * @param expansion: (IN/OUT)
+ * @param nRefAtoms: (IN) Number of reference atoms in cluster.
+ * @param nFitAtoms: (IN) Number of fit atoms in cluster.
+ * @param dAlphaSum: (IN) Sum of alpha values of cluster.
+ * @param dExponent: (IN) Sum of alpha_i * alpha_j * d_ij^2 over atom pairs of cluster.
+ * @param dPrefactor: (IN) Product of p constants of cluster.
+ */
+void CGaussianVolume::expandFitCluster(
+	ClusterExpansion& expansion,
+	const int nRefAtoms,
+	const int nFitAtoms,
+	const double dAlphaSum,
+	const double dExponent,
+	const double dPrefactor
+	)
+{
+	const double dCLUSTER_VOLUME = getClusterVolume(dAlphaSum, dExponent, dPrefactor);
+	// If negligible cluster and clusters grown from it:
+	if (getClusterVolumeBound(dCLUSTER_VOLUME, dAlphaSum, expansion.nMaxIntersectionOrder - nFitAtoms, expansion.dMinAlpha) < expansion.dEpsilon)
+	{
+		return;
+	}
+
+	/* Add current term unless negligible, with sign (-1)^(|S| + |T|). */
+	// If not negligible cluster:
+	if (dCLUSTER_VOLUME >= expansion.dEpsilon)
 	{
-		// If special case: Do not enumerate.
-		if (nIntersectedAtoms == 0)
+		expansion.dOverlapVolume += (nRefAtoms + nFitAtoms) % 2 == 0 ? dCLUSTER_VOLUME : - dCLUSTER_VOLUME;
+	}
+
+	// If max order reached:
+	if (nFitAtoms >= expansion.nMaxIntersectionOrder)
+	{
+		return;
+	}
+
+	/* Grow by each fit atom being a neighbor of all atoms in cluster. */
+	const MoleculePrecalculation& fitPrecalculation = *expansion.pFitPrecalculation;
+	const MoleculePrecalculation& refPrecalculation = *expansion.pRefPrecalculation;
+	const vector<int>& candidateFitAtomIds = expansion.candidateFitAtomIds[nFitAtoms];
+	vector<int>& nextCandidateFitAtomIds = expansion.candidateFitAtomIds[nFitAtoms + 1];
+	FOREACH(iterFitAtomId, candidateFitAtomIds, vector<int>::const_iterator)
+	{
+		const int nFitAtomId = *iterFitAtomId;
+
+		/* Update exponent with pairs formed by the new atom. */
+		double dPairsSum = 0;
+		for (int iRef = 0; iRef < nRefAtoms; ++ iRef)
 		{
-			return ErrorCodes::nNORMAL;
+			const int nRefAtomId = expansion.refAtomIds[iRef];
+			dPairsSum += refPrecalculation.alphaValues[nRefAtomId] *
+				getNeighborSquareDistance(*expansion.pCrossNeighborAtomIds, *expansion.pCrossNeighborSquareDistances, nRefAtomId, nFitAtomId);
 		}
-		// If special case: Only need to get the key atom IDs.
-		else if (nIntersectedAtoms == 1)
+		for (int iFit = 0; iFit < nFitAtoms; ++ iFit)
 		{
-			// reduce reallocation for performance
-			intersectedAtomIds.reserve(neighborAtomIds.size());
-
-			for (int iKeyId = 0; iKeyId < static_cast<int>(neighborAtomIds.size()); ++ iKeyId)
-			{
-				/* Add single ID set. */
-				intersectedAtomIds.push_back(set<int>());
-				intersectedAtomIds.back().insert(iKeyId);
-			}
+			const int nOtherFitAtomId = expansion.fitAtomIds[iFit];
+			dPairsSum += fitPrecalculation.alphaValues[nOtherFitAtomId] *
+				getNeighborSquareDistance(fitPrecalculation.neighborAtomIds, fitPrecalculation.neighborSquareDistances, nOtherFitAtomId, nFitAtomId);
 		}
-		// If special case: Get single neighbor for each key atom ID.
-		else if (nIntersectedAtoms == 2)
-		{
-			// reduce reallocation for performance
-			intersectedAtomIds.reserve(4 * neighborAtomIds.size());
+		const double dALPHA = fitPrecalculation.alphaValues[nFitAtomId];
 
-			for (int iKeyId = 0; iKeyId < static_cast<int>(neighborAtomIds.size()); ++ iKeyId)
-			{
-				/* Pair with each neighbor. */
-				const set<int>& currentNeighborIdsSet = neighborAtomIds[iKeyId];
-				FOREACH(iterNeighborId, currentNeighborIdsSet, set<int>::const_iterator)
-				{
-					/* Add paired IDs set. */
-					intersectedAtomIds.push_back(set<int>());
-					intersectedAtomIds.back().insert(iKeyId);
-					intersectedAtomIds.back().insert(*iterNeighborId);
-				}
-			}
-		}
-		// If general case (to select more than 2 neighbors):
-		else
+		/* Keep candidates behind the new atom and neighbored with it, unless the grown cluster is at max order. */
+		nextCandidateFitAtomIds.clear();
+		if (nFitAtoms + 1 < expansion.nMaxIntersectionOrder)
 		{
-			// reduce reallocation for performance
-			intersectedAtomIds.reserve(4 * neighborAtomIds.size());
+			const vector<int>& neighborIds = fitPrecalculation.neighborAtomIds[nFitAtomId];
+			std::set_intersection(
+				candidateFitAtomIds.begin(), candidateFitAtomIds.end(),
+				neighborIds.begin(), neighborIds.end(),
+				std::back_inserter(nextCandidateFitAtomIds)
+				);
+		}
 
-			// to filter out pair-wise intersected atoms
-			CIntersectedAtomsFilter intersectedAtomsFilter(&neighborAtomIds);
+		expansion.fitAtomIds[nFitAtoms] = nFitAtomId;
+		expandFitCluster(expansion, nRefAtoms, nFitAtoms + 1, dAlphaSum + dALPHA, dExponent + dALPHA * dPairsSum, dPrefactor * _dP);
+	}
+}
 
-			/* Pick nIntersectedAtoms - 1 atom IDs for each key atom ID. */
-			for (int iKeyId = 0; iKeyId < static_cast<int>(neighborAtomIds.size()); ++ iKeyId)
-			{
-				// neighbors for this key atom
-				const set<int>& currentNeighborIdsSet = neighborAtomIds[iKeyId];
-
-				// intersected atom IDs
-				vector<set<int> > pickedIds;
-				pickedIds.reserve(10);
-				combineElements(
-					currentNeighborIdsSet.begin(),
-					currentNeighborIdsSet.end(),
-					currentNeighborIdsSet.size(),
-					nIntersectedAtoms - 1,
-					intersectedAtomsFilter,
-					set<int>(),
-					pickedIds
-					);
-
-				/* Add key atom ID to IDs set. */
-				FOREACH(iterIdsSet, pickedIds, vector<set<int> >::iterator)
-				{
-					iterIdsSet->insert(iKeyId);
-				}
 
-				// Store this result.
-				std::copy(pickedIds.begin(), pickedIds.end(), std::back_inserter(intersectedAtomIds));
-			}
+/**
+ * Description: Grow a cluster holding reference atoms only, by one fit atom to form terms, or by one more reference atom.
+ * @param expansion: (IN/OUT)
+ * @param nRefAtoms: (IN) Number of reference atoms in cluster.
+ * @param dAlphaSum: (IN) Sum of alpha values of cluster.
+ * @param dExponent: (IN) Sum of alpha_i * alpha_j * d_ij^2 over atom pairs of cluster.
+ * @param dPrefactor: (IN) Product of p constants of cluster.
+ */
+void CGaussianVolume::expandRefCluster(
+	ClusterExpansion& expansion,
+	const int nRefAtoms,
+	const double dAlphaSum,
+	const double dExponent,
+	const double dPrefactor
+	)
+{
+	// If negligible clusters grown from this one, by fit atoms and by the reference atoms left:
+	const int nMAX_ADDED_ATOMS = expansion.nMaxIntersectionOrder + (expansion.nMaxIntersectionOrder - nRefAtoms);
+	if (getClusterVolumeBound(getClusterVolume(dAlphaSum, dExponent, dPrefactor), dAlphaSum, nMAX_ADDED_ATOMS, expansion.dMinAlpha) < expansion.dEpsilon)
+	{
+		return;
+	}
+
+	const MoleculePrecalculation& fitPrecalculation = *expansion.pFitPrecalculation;
+	const MoleculePrecalculation& refPrecalculation = *expansion.pRefPrecalculation;
+	const vector<int>& crossCandidateFitAtomIds = expansion.crossCandidateFitAtomIds[nRefAtoms];
+
+	/* Grow by each fit atom being a neighbor of all reference atoms in cluster. */
+	vector<int>& candidateFitAtomIds = expansion.candidateFitAtomIds[1];
+	FOREACH(iterFitAtomId, crossCandidateFitAtomIds, vector<int>::const_iterator)
+	{
+		const int nFitAtomId = *iterFitAtomId;
+
+		/* Update exponent with pairs formed by the new atom. */
+		double dPairsSum = 0;
+		for (int iRef = 0; iRef < nRefAtoms; ++ iRef)
+		{
+			const int nRefAtomId = expansion.refAtomIds[iRef];
+			dPairsSum += refPrecalculation.alphaValues[nRefAtomId] *
+				getNeighborSquareDistance(*expansion.pCrossNeighborAtomIds, *expansion.pCrossNeighborSquareDistances, nRefAtomId, nFitAtomId);
 		}
+		const double dALPHA = fitPrecalculation.alphaValues[nFitAtomId];
+
+		/* Keep candidates behind the new atom and neighbored with it, unless the grown cluster is at max order. */
+		candidateFitAtomIds.clear();
+		if (expansion.nMaxIntersectionOrder > 1)
+		{
+			const vector<int>& neighborIds = fitPrecalculation.neighborAtomIds[nFitAtomId];
+			std::set_intersection(
+				crossCandidateFitAtomIds.begin(), crossCandidateFitAtomIds.end(),
+				neighborIds.begin(), neighborIds.end(),
+				std::back_inserter(candidateFitAtomIds)
+				);
+		}
+
+		expansion.fitAtomIds[0] = nFitAtomId;
+		expandFitCluster(expansion, nRefAtoms, 1, dAlphaSum + dALPHA, dExponent + dALPHA * dPairsSum, dPrefactor * _dP);
 	}
-	// If invalid parameter:
-	else
+
+	// If max order reached:
+	if (nRefAtoms >= expansion.nMaxIntersectionOrder)
 	{
-		std::stringstream msgStream;
-		msgStream
-			<< LOCATION_STREAM_INSERTION
-			<< "Invalid parameters: "
-			<< "nIntersectedAtoms = " << nIntersectedAtoms;
-		throw CInvalidArgumentException(msgStream.str());
+		return;
 	}
 
-	return ErrorCodes::nNORMAL;
+	/* Grow by each reference atom being a neighbor of all reference atoms in cluster. */
+	const vector<int>& candidateRefAtomIds = expansion.candidateRefAtomIds[nRefAtoms];
+	FOREACH(iterRefAtomId, candidateRefAtomIds, vector<int>::const_iterator)
+	{
+		const int nRefAtomId = *iterRefAtomId;
+
+		/* Update exponent with pairs formed by the new atom. */
+		double dPairsSum = 0;
+		for (int iRef = 0; iRef < nRefAtoms; ++ iRef)
+		{
+			const int nOtherRefAtomId = expansion.refAtomIds[iRef];
+			dPairsSum += refPrecalculation.alphaValues[nOtherRefAtomId] *
+				getNeighborSquareDistance(refPrecalculation.neighborAtomIds, refPrecalculation.neighborSquareDistances, nOtherRefAtomId, nRefAtomId);
+		}
+		const double dALPHA = refPrecalculation.alphaValues[nRefAtomId];
+
+		/* Keep reference candidates behind the new atom and neighbored with it, and fit candidates neighbored with it. */
+		vector<int>& nextCandidateRefAtomIds = expansion.candidateRefAtomIds[nRefAtoms + 1];
+		nextCandidateRefAtomIds.clear();
+		if (nRefAtoms + 1 < expansion.nMaxIntersectionOrder)
+		{
+			const vector<int>& neighborIds = refPrecalculation.neighborAtomIds[nRefAtomId];
+			std::set_intersection(
+				candidateRefAtomIds.begin(), candidateRefAtomIds.end(),
+				neighborIds.begin(), neighborIds.end(),
+				std::back_inserter(nextCandidateRefAtomIds)
+				);
+		}
+		const vector<int>& crossNeighborIds = (*expansion.pCrossNeighborAtomIds)[nRefAtomId];
+		vector<int>& nextCrossCandidateFitAtomIds = expansion.crossCandidateFitAtomIds[nRefAtoms + 1];
+		nextCrossCandidateFitAtomIds.clear();
+		std::set_intersection(
+			crossCandidateFitAtomIds.begin(), crossCandidateFitAtomIds.end(),
+			crossNeighborIds.begin(), crossNeighborIds.end(),
+			std::back_inserter(nextCrossCandidateFitAtomIds)
+			);
+
+		expansion.refAtomIds[nRefAtoms] = nRefAtomId;
+		expandRefCluster(expansion, nRefAtoms + 1, dAlphaSum + dALPHA, dExponent + dALPHA * dPairsSum, dPrefactor * _dP);
+	}
 }
 
 
 /**
- * Description:
+ * Description: Calculate the overlap volume of reference and fit molecule, expanded up to max intersection order on each side.
  * @return:
  */
 double CGaussianVolume::getOverlapVolume() const
 {
-	// max order of intersection volume for single molecule
-	const int nMAX_INTERSECTION_ORDER = _pPrecalculationResult->intersectedAtomIdsForRef.size();
-
-	/* Calculate cross intersected volume. */
-	double dOverlapVolume = 0;
-	// For each order of reference molecule:
-	for (int iOrderRef = 0; iOrderRef < nMAX_INTERSECTION_ORDER; ++ iOrderRef)
-	{
-		// For each order of fit molecule:
-		for (int iOrderFit = 0; iOrderFit < nMAX_INTERSECTION_ORDER; ++ iOrderFit)
-		{
-			// sign for the cross product term
-			const int nSign = (iOrderRef + 1 + iOrderFit + 1) % 2 == 0 ? 1 : -1;
-
-			// intersected atom IDs for reference molecule at current order
-			const vector<set<int> >& intersectedIdsCurrRef = _pPrecalculationResult->intersectedAtomIdsForRef[iOrderRef];
-			// intersected atom IDs for fit molecule at current order
-			const vector<set<int> >& intersectedIdsCurrFit = _pPrecalculationResult->intersectedAtomIdsForFit[iOrderFit];
-			// For each term of reference molecule:
-			FOREACH(iterIdsSetRef, intersectedIdsCurrRef, vector<set<int> >::const_iterator)
-			{
-				// For each term of fit molecule:
-				FOREACH(iterIdsSetFit, intersectedIdsCurrFit, vector<set<int> >::const_iterator)
-				{
-					// If cross intersected:
-					if (isIntersectedAtomsByCrossNeighbors(*iterIdsSetRef, *iterIdsSetFit, _neighborAtomIds))
-					{
-						dOverlapVolume += nSign * calculateAtomIntersectionVolume(*iterIdsSetRef, *iterIdsSetFit);
-					}
-				}
-			}
-		}
-	}
-
-	return dOverlapVolume;
+	return expandClusters(*_pRefPrecalculation, *_pFitPrecalculation, _neighborAtomIds, _neighborSquareDistances, _dIntersectionVolumeEpsilon);
 }
 
 
@@ -454,84 +675,58 @@ double CGaussianVolume::getOverlapVolume() const
  */
 double CGaussianVolume::getOverlapVolume(const IMolecule& refMol, const IMolecule& fitMol) const
 {
-	const list<IAtom*> refAtomsList = refMol.getAtomsList();
-	const list<IAtom*> fitAtomsList = fitMol.getAtomsList();
-	double dOverlap = 0.0;
-
-	// For each atom in reference molecule:
-	FOREACH(iterRefAtom, refAtomsList, list<IAtom*>::const_iterator)
-	{
-		const IAtom& refAtom = **iterRefAtom;
-
-		const vector<double>& refAtomPosition = refAtom.getPosition();
-		const double dRadiusRefAtom = refAtom.getAtomRadius();
-		const double dAlphaRefAtom = _dPARTIAL_ALPHA / (dRadiusRefAtom * dRadiusRefAtom);
-
-		// For each atom in fit molecule:
-		FOREACH(iterFitAtom, fitAtomsList, list<IAtom*>::const_iterator)
-		{
-			const IAtom& fitAtom = **iterFitAtom;
+	PreparedMolecule preparedRefMolecule;
+	PreparedMolecule preparedFitMolecule;
+	prepareMolecule(refMol, preparedRefMolecule);
+	prepareMolecule(fitMol, preparedFitMolecule);
 
-			const vector<double>& fitAtomPosition = fitAtom.getPosition();
-			const double dRadiusFitAtom = fitAtom.getAtomRadius();
-
-			const double dR2 = CMathematics::pointToPointSquareDistance(refAtomPosition, fitAtomPosition);
-			if (dR2 < (dRadiusRefAtom + dRadiusFitAtom + _dGaussianCutoff) * (dRadiusRefAtom + dRadiusFitAtom + _dGaussianCutoff))
-			{
-				const double dAlphaFitAtom = _dPARTIAL_ALPHA / (dRadiusFitAtom * dRadiusFitAtom);
+	return getOverlapVolume(preparedRefMolecule, preparedFitMolecule);
+}
 
-				const double dK = exp(-(dAlphaRefAtom * dAlphaFitAtom * dR2) / (dAlphaRefAtom + dAlphaFitAtom));
-				const double dV = 8 * dK * pow(_dPI / (dAlphaRefAtom + dAlphaFitAtom), 1.5);
-				dOverlap += dV;
-			}
-		}
-	}
 
-	return dOverlap;
+/**
+ * Description: Calculate the overlap volume of two prepared molecules, without touching any IAtom instance.
+ *	The calculation is done by the SIMD kernel selected at startup in exact double precision mode, see CGaussianOverlapKernel for its
+ *	accuracy.
+ * @param refMol: (IN) Prepared reference molecule, usually the query molecule.
+ * @param fitMol: (IN) Prepared fitting molecule, usually the target molecule in database.
+ * @return: Overlap volume scalar.
+ */
+double CGaussianVolume::getOverlapVolume(const PreparedMolecule& refMol, const PreparedMolecule& fitMol) const
+{
+	return CGaussianOverlapKernel::calculateOverlapVolume(refMol, fitMol, _dGaussianCutoff);
 }
 
 
 /**
- * Description:
+ * Description: Calculate the volume of reference molecule, as its overlap volume with itself.
  * @return:
  */
 double CGaussianVolume::getReferenceVolume() const
 {
-	// max order of intersection volume for single molecule
-	const int nMAX_INTERSECTION_ORDER = _pPrecalculationResult->intersectedAtomIdsForRef.size();
-
-	/* Calculate cross intersected volume. */
-	double dOverlapVolume = 0;
-	// For each order of reference molecule:
-	for (int iOrderOuter = 0; iOrderOuter < nMAX_INTERSECTION_ORDER; ++ iOrderOuter)
+	/* Build symmetric neighbors of reference molecule, including each atom itself, as cross neighbors with itself. */
+	const vector<vector<int> >& neighborAtomIds = _pRefPrecalculation->neighborAtomIds;
+	const vector<vector<double> >& neighborSquareDistances = _pRefPrecalculation->neighborSquareDistances;
+	const int nATOMS_COUNT = neighborAtomIds.size();
+	vector<vector<int> > selfNeighborAtomIds(nATOMS_COUNT);
+	vector<vector<double> > selfNeighborSquareDistances(nATOMS_COUNT);
+	for (int iAtomId = 0; iAtomId < nATOMS_COUNT; ++ iAtomId)
 	{
-		// For each order of reference molecule:
-		for (int iOrderInner = 0; iOrderInner < nMAX_INTERSECTION_ORDER; ++ iOrderInner)
+		// Neighbors in front of current atom have been added by them.
+		selfNeighborAtomIds[iAtomId].push_back(iAtomId);
+		selfNeighborSquareDistances[iAtomId].push_back(0);
+		for (int iNeighbor = 0; iNeighbor < static_cast<int>(neighborAtomIds[iAtomId].size()); ++ iNeighbor)
 		{
-			// sign for the cross product term
-			const int nSign = (iOrderOuter + 1 + iOrderInner + 1) % 2 == 0 ? 1 : -1;
-
-			// intersected atom IDs for reference molecule at current order
-			const vector<set<int> >& intersectedIdsCurrOuter = _pPrecalculationResult->intersectedAtomIdsForRef[iOrderOuter];
-			// intersected atom IDs for reference molecule at current order
-			const vector<set<int> >& intersectedIdsCurrInner = _pPrecalculationResult->intersectedAtomIdsForRef[iOrderInner];
-			// For each term of reference molecule:
-			FOREACH(iterIdsSetOuter, intersectedIdsCurrOuter, vector<set<int> >::const_iterator)
-			{
-				// For each term of reference molecule:
-				FOREACH(iterIdsSetInner, intersectedIdsCurrInner, vector<set<int> >::const_iterator)
-				{
-					// If cross intersected:
-					if (isIntersectedAtomsByMonotoneNeighbors(*iterIdsSetOuter, *iterIdsSetInner, _pPrecalculationResult->neighborAtomIdsForRef))
-					{
-						dOverlapVolume += nSign * calculateAtomIntersectionVolume(*iterIdsSetOuter, *iterIdsSetInner);
-					}
-				}
-			}
+			const int nNeighborAtomId = neighborAtomIds[iAtomId][iNeighbor];
+			const double dSquareDistance = neighborSquareDistances[iAtomId][iNeighbor];
+			selfNeighborAtomIds[iAtomId].push_back(nNeighborAtomId);
+			selfNeighborSquareDistances[iAtomId].push_back(dSquareDistance);
+			selfNeighborAtomIds[nNeighborAtomId].push_back(iAtomId);
+			selfNeighborSquareDistances[nNeighborAtomId].push_back(dSquareDistance);
 		}
 	}
 
-	return dOverlapVolume;
+	return expandClusters(*_pRefPrecalculation, *_pRefPrecalculation, selfNeighborAtomIds, selfNeighborSquareDistances, _dIntersectionVolumeEpsilon);
 }
 
 
@@ -545,156 +740,169 @@ double CGaussianVolume::getGaussianCutoff() const
 
 
 /**
- * Description:
- * @param idsSetAsKeys: (IN)
- * @param idsSetAsValues: (IN)
- * @param neighborAtomIds: (IN)
+ * Description: Get intersection volume below which a cluster and all clusters grown from it are dropped.
  * @return:
  */
-bool CGaussianVolume::isIntersectedAtomsByCrossNeighbors(
-	const std::set<int>& idsSetAsKeys,
-	const std::set<int>& idsSetAsValues,
-	const std::vector<std::set<int> >& neighborAtomIds
-	)
+double CGaussianVolume::getIntersectionVolumeEpsilon() const
 {
-	FOREACH(iterKeyId, idsSetAsKeys, set<int>::const_iterator)
-	{
-		FOREACH(iterValueId, idsSetAsValues, set<int>::const_iterator)
-		{
-			// If current value atom is not a neighbor of current key atom:
-			if (!EXIST(*iterValueId, neighborAtomIds[*iterKeyId]))
-			{
-				return false;
-			}
-		}
-	}
+	return _dIntersectionVolumeEpsilon;
+}
+
+
+/**
+ * Description: Calculate intersection volume of a cluster of Gaussian atoms, as p^n * exp(-K / alpha) * (PI / alpha)^1.5.
+ * @param dAlphaSum: (IN) Sum of alpha values of cluster.
+ * @param dExponent: (IN) Sum of alpha_i * alpha_j * d_ij^2 over atom pairs of cluster.
+ * @param dPrefactor: (IN) Product of p constants of cluster.
+ * @return:
+ */
+double CGaussianVolume::getClusterVolume(const double dAlphaSum, const double dExponent, const double dPrefactor)
+{
+	const double dT = _dPI / dAlphaSum;
 
-	return true;
+	return dPrefactor * exp(- (dExponent / dAlphaSum)) * dT * sqrt(dT);
 }
 
 
 /**
- * Description:
- * @param idsSet: (IN)
- * @param neighborAtomIds: (IN)
+ * Description: Bound the intersection volumes of a cluster and of all clusters grown from it by up to a number of atoms. Each added
+ *	Gaussian is at most p, so adding k atoms of total alpha a multiplies the integrand by at most p^k, and narrows its width from
+ *	alpha to alpha + a: the volume grows by at most p^k * (alpha / (alpha + k * min alpha))^1.5. Unlike the volume itself, which
+ *	may grow by a factor of p, the bound never grows along a branch, so pruning on it never drops a cluster above epsilon.
+ * @param dClusterVolume: (IN) Intersection volume of cluster, see getClusterVolume().
+ * @param dAlphaSum: (IN) Sum of alpha values of cluster.
+ * @param nMaxAddedAtoms: (IN) Max number of atoms clusters may be grown by.
+ * @param dMinAlpha: (IN) Smallest alpha value of atoms that may be added.
  * @return:
  */
-bool CGaussianVolume::isIntersectedAtomsByMonotoneNeighbors(
-	const std::set<int>& idsSet,
-	const std::vector<std::set<int> >& neighborAtomIds
-	)
+double CGaussianVolume::getClusterVolumeBound(const double dClusterVolume, const double dAlphaSum, const int nMaxAddedAtoms, const double dMinAlpha)
 {
-	FOREACH(iterId, idsSet, set<int>::const_iterator)
+	double dMaxFactor = 1.0;
+	double dPrefactor = 1.0;
+	for (int nAddedAtoms = 1; nAddedAtoms <= nMaxAddedAtoms; ++ nAddedAtoms)
 	{
-		/* Validate with all IDs behind current one. */
-		set<int>::const_iterator iterIdBehind = iterId;
-		for (++ iterIdBehind; iterIdBehind != idsSet.end(); ++ iterIdBehind)
-		{
-			const set<int>& neighborIdsSet = neighborAtomIds[*iterId];
-			// If not a neighbor of current ID:
-			if (!EXIST(*iterIdBehind, neighborIdsSet))
-			{
-				return false;
-			}
-		}
+		dPrefactor *= _dP;
+		const double dNarrowing = dAlphaSum / (dAlphaSum + nAddedAtoms * dMinAlpha);
+		dMaxFactor = std::max(dMaxFactor, dPrefactor * dNarrowing * sqrt(dNarrowing));
 	}
 
-	return true;
+	return dClusterVolume * dMaxFactor;
 }
 
 
 /**
- * Description:
- * @param idsSetAsKeys: (IN)
- * @param idsSetAsValues: (IN)
- * @param neighborAtomIds: (IN)
- * @return:
+ * Description: Look up square distance of a pair of atoms in sparse neighbor distances.
+ * @param neighborAtomIds: (IN) Ascending neighbor atom IDs list.
+ * @param neighborSquareDistances: (IN) Square distances in the same order as neighborAtomIds.
+ * @param nAtomId: (IN)
+ * @param nNeighborAtomId: (IN)
+ * @return: Square distance, or HUGE_VAL if not neighbors, whose Gaussian contribution vanishes.
  */
-bool CGaussianVolume::isIntersectedAtomsByMonotoneNeighbors(
-	const std::set<int>& idsSetAsKeys,
-	const std::set<int>& idsSetAsValues,
-	const std::vector<std::set<int> >& neighborAtomIds
+double CGaussianVolume::getNeighborSquareDistance(
+	const std::vector<std::vector<int> >& neighborAtomIds,
+	const std::vector<std::vector<double> >& neighborSquareDistances,
+	const int nAtomId,
+	const int nNeighborAtomId
 	)
 {
-	FOREACH(iterKeyId, idsSetAsKeys, set<int>::const_iterator)
+	const vector<int>& neighborIds = neighborAtomIds[nAtomId];
+	vector<int>::const_iterator iterNeighborId = std::lower_bound(neighborIds.begin(), neighborIds.end(), nNeighborAtomId);
+
+	// If a neighbor:
+	if (iterNeighborId != neighborIds.end() && *iterNeighborId == nNeighborAtomId)
 	{
-		FOREACH(iterValueId, idsSetAsValues, set<int>::const_iterator)
-		{
-			// If key ID should be used as a key to determine neighbor relation:
-			if (*iterKeyId < *iterValueId)
-			{
-				// If current value atom is not a neighbor of current key atom:
-				if (!EXIST(*iterValueId, neighborAtomIds[*iterKeyId]))
-				{
-					return false;
-				}
-			}
-			// If value ID should be used as a key to determine neighbor relation:
-			else if (*iterKeyId > *iterValueId)
-			{
-				// If current key atom is not a neighbor of current value atom:
-				if (!EXIST(*iterKeyId, neighborAtomIds[*iterValueId]))
-				{
-					return false;
-				}
-			}
-			// If key ID is value ID itself:
-			else
-			{
-				continue;
-			}
-		}
+		return neighborSquareDistances[nAtomId][iterNeighborId - neighborIds.begin()];
+	}
+	// If not a neighbor:
+	else
+	{
+		return HUGE_VAL;
 	}
-
-	return true;
 }
 
 
 /**
- * Description:
+ * Description: Find cross neighbors between reference and fit atoms, with their square distances.
+ * @param refMolecule: (IN)
+ * @param fitMolecule: (IN)
+ * @param pNeighborList: (IN) Cross neighbor list updated for the current poses, could be NULL pointer.
  */
-int CGaussianVolume::initializeIntermolecularInformation()
+int CGaussianVolume::initializeIntermolecularInformation(
+	const PreparedMolecule& refMolecule,
+	const PreparedMolecule& fitMolecule,
+	const CCrossNeighborList* pNeighborList
+	)
 {
 	// If not NULL member variable:
-	if (_pRefAtoms && _pFitAtoms && _pPrecalculationResult)
+	if (_pRefPrecalculation && _pFitPrecalculation)
 	{
-		_squareDistancesMatrix.clear();
-		_squareDistancesMatrix.reserve(_pRefAtoms->size());
-		_neighborAtomIds.clear();
-		_neighborAtomIds.reserve(_pRefAtoms->size());
+		const int nREF_ATOMS_COUNT = refMolecule.radii.size();
+		_neighborAtomIds.assign(nREF_ATOMS_COUNT, vector<int>());
+		_neighborSquareDistances.assign(nREF_ATOMS_COUNT, vector<double>());
 
-		const double dGAUSSIAN_CUTOFF = _pPrecalculationResult->dGaussianCutoff;
+		const double dGAUSSIAN_CUTOFF = _pRefPrecalculation->dGaussianCutoff;
 
-		FOREACH(iterRefAtom, *_pRefAtoms, vector<IAtom*>::const_iterator)
+		// If a neighbor list, only its listed pairs are tested:
+		if (pNeighborList)
 		{
-			/* Preallocate an empty row in square distances matrix for performance reasons. */
-			_squareDistancesMatrix.push_back(vector<double>());
-			// current row in square distances matrix for this reference atom
-			vector<double>& squareDistancesRow = _squareDistancesMatrix.back();
-			squareDistancesRow.reserve(_pFitAtoms->size());
-
-			/* Preallocate neighbor IDs container for current reference atom. */
-			_neighborAtomIds.push_back(set<int>());
-			set<int>& neighborAtomIdsSet = _neighborAtomIds.back();
-
-			const IAtom& refAtom = **iterRefAtom;
-			int iFitAtomId = 0;
-			FOREACH(iterFitAtom, *_pFitAtoms, vector<IAtom*>::const_iterator)
+			const vector<int>& candidateStarts = pNeighborList->getCandidateStarts();
+			const vector<int>& candidateFitAtomIds = pNeighborList->getCandidateFitAtomIds();
+			for (int iRefAtomId = 0; iRefAtomId < nREF_ATOMS_COUNT; ++ iRefAtomId)
 			{
-				const IAtom& fitAtom = **iterFitAtom;
+				for (int iCandidate = candidateStarts[iRefAtomId]; iCandidate < candidateStarts[iRefAtomId + 1]; ++ iCandidate)
+				{
+					const int nFitAtomId = candidateFitAtomIds[iCandidate];
+					const double dDeltaX = fitMolecule.xCoordinates[nFitAtomId] - refMolecule.xCoordinates[iRefAtomId];
+					const double dDeltaY = fitMolecule.yCoordinates[nFitAtomId] - refMolecule.yCoordinates[iRefAtomId];
+					const double dDeltaZ = fitMolecule.zCoordinates[nFitAtomId] - refMolecule.zCoordinates[iRefAtomId];
+					const double dSquareDistance = dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ;
+					const double dContactDistance = refMolecule.radii[iRefAtomId] + fitMolecule.radii[nFitAtomId] + dGAUSSIAN_CUTOFF;
+
+					// If a neighbor:
+					if (dSquareDistance < dContactDistance * dContactDistance)
+					{
+						_neighborAtomIds[iRefAtomId].push_back(nFitAtomId);
+						_neighborSquareDistances[iRefAtomId].push_back(dSquareDistance);
+					}
+				}
+			}
+		}
+		// If no neighbor list:
+		else
+		{
+			/* Bucket fit atoms into cells as large as the max contact distance. */
+			const double dMAX_REF_RADIUS = refMolecule.radii.empty() ? 0 : *std::max_element(refMolecule.radii.begin(), refMolecule.radii.end());
+			const double dMAX_FIT_RADIUS = fitMolecule.radii.empty() ? 0 : *std::max_element(fitMolecule.radii.begin(), fitMolecule.radii.end());
+			const CCellList fitCellList(fitMolecule.xCoordinates, fitMolecule.yCoordinates, fitMolecule.zCoordinates, dMAX_REF_RADIUS + dMAX_FIT_RADIUS + dGAUSSIAN_CUTOFF);
+
+			/* Record cross neighbors of each reference atom found in adjacent cells. */
+			vector<int> candidateFitAtomIds;
+			for (int iRefAtomId = 0; iRefAtomId < nREF_ATOMS_COUNT; ++ iRefAtomId)
+			{
+				const double dREF_X = refMolecule.xCoordinates[iRefAtomId];
+				const double dREF_Y = refMolecule.yCoordinates[iRefAtomId];
+				const double dREF_Z = refMolecule.zCoordinates[iRefAtomId];
 
-				/* Deal with distance information. */
-				const double dSquareDistance = CMathematics::pointToPointSquareDistance(refAtom.getPosition(), fitAtom.getPosition());
-				squareDistancesRow.push_back(dSquareDistance);
+				/* Candidates come in cell order, sort them to keep neighbor IDs ascending. */
+				fitCellList.getCandidatePointIds(dREF_X, dREF_Y, dREF_Z, candidateFitAtomIds);
+				std::sort(candidateFitAtomIds.begin(), candidateFitAtomIds.end());
 
-				/* Deal with neighbor information. */
-				// If a neighbor:
-				if (dSquareDistance < pow(refAtom.getAtomRadius() + fitAtom.getAtomRadius() + dGAUSSIAN_CUTOFF, 2))
+				FOREACH(iterFitAtomId, candidateFitAtomIds, vector<int>::const_iterator)
 				{
-					neighborAtomIdsSet.insert(iFitAtomId);
+					const int nFitAtomId = *iterFitAtomId;
+					const double dDeltaX = fitMolecule.xCoordinates[nFitAtomId] - dREF_X;
+					const double dDeltaY = fitMolecule.yCoordinates[nFitAtomId] - dREF_Y;
+					const double dDeltaZ = fitMolecule.zCoordinates[nFitAtomId] - dREF_Z;
+					const double dSquareDistance = dDeltaX * dDeltaX + dDeltaY * dDeltaY + dDeltaZ * dDeltaZ;
+					const double dContactDistance = refMolecule.radii[iRefAtomId] + fitMolecule.radii[nFitAtomId] + dGAUSSIAN_CUTOFF;
+
+					// If a neighbor:
+					if (dSquareDistance < dContactDistance * dContactDistance)
+					{
+						_neighborAtomIds[iRefAtomId].push_back(nFitAtomId);
+						_neighborSquareDistances[iRefAtomId].push_back(dSquareDistance);
+					}
 				}
-
-				++ iFitAtomId;
 			}
 		}
 	}
@@ -705,7 +913,7 @@ int CGaussianVolume::initializeIntermolecularInformation()
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< "NULL member variable! "
-			<< "Member variable: _pRefAtoms, _pFitAtoms, _pPrecalculationResult. ";
+			<< "Member variable: _pRefPrecalculation, _pFitPrecalculation. ";
 		throw CInvalidArgumentException(msgStream.str());
 	}
 
@@ -733,26 +941,10 @@ int CGaussianVolume::precalculate(
 	if (dGaussianCutoff >= 0 && nMaxIntersectionOrder > 0)
 	{
 		// Precalculate reference molecule.
-		precalculateMolecule(
-			refMol,
-			dGaussianCutoff,
-			nMaxIntersectionOrder,
-			precalculationResult.alphaValuesForRef,
-			precalculationResult.squareDistancesMatrixForRef,
-			precalculationResult.neighborAtomIdsForRef,
-			precalculationResult.intersectedAtomIdsForRef
-			);
+		precalculateMolecule(refMol, dGaussianCutoff, nMaxIntersectionOrder, precalculationResult.refPrecalculation);
 
 		// Precalculate fit molecule.
-		precalculateMolecule(
-			fitMol,
-			dGaussianCutoff,
-			nMaxIntersectionOrder,
-			precalculationResult.alphaValuesForFit,
-			precalculationResult.squareDistancesMatrixForFit,
-			precalculationResult.neighborAtomIdsForFit,
-			precalculationResult.intersectedAtomIdsForFit
-			);
+		precalculateMolecule(fitMol, dGaussianCutoff, nMaxIntersectionOrder, precalculationResult.fitPrecalculation);
 
 		precalculationResult.dGaussianCutoff = dGaussianCutoff;
 	}
@@ -773,96 +965,84 @@ int CGaussianVolume::precalculate(
 
 
 /**
- * Description:
+ * Description: Precalculate the information of a single molecule, which could be shared by any overlap calculation with this molecule.
  * @param molecule: (IN)
  * @param dGaussianCutoff: (IN)
  * @param nMaxIntersectionOrder: (IN)
- * @param alphaValues: (OUT)
- * @param squareDistancesMatrix: (OUT)
- * @param neighborAtomIds: (OUT)
- * @param intersectedAtomIds: (OUT)
+ * @param moleculePrecalculation: (OUT)
  */
 int CGaussianVolume::precalculateMolecule(
 	const IMolecule& molecule,
 	const double dGaussianCutoff,
 	const int nMaxIntersectionOrder,
-	std::vector<double>& alphaValues,
-	std::vector<std::vector<double> >& squareDistancesMatrix,
-	std::vector<std::set<int> >& neighborAtomIds,
-	std::vector<std::vector<std::set<int> > >& intersectedAtomIds
+	MoleculePrecalculation& moleculePrecalculation
 	)
 {
 	// If valid parameter:
 	if (dGaussianCutoff >= 0 && nMaxIntersectionOrder > 0)
 	{
+		vector<double>& alphaValues = moleculePrecalculation.alphaValues;
+		vector<vector<double> >& neighborSquareDistances = moleculePrecalculation.neighborSquareDistances;
+		vector<vector<int> >& neighborAtomIds = moleculePrecalculation.neighborAtomIds;
+		moleculePrecalculation.dGaussianCutoff = dGaussianCutoff;
+		moleculePrecalculation.nMaxIntersectionOrder = nMaxIntersectionOrder;
+
 		/* Do preallocation for performance reasons. */
-		const int nATOMS_COUNT = molecule.getAtomsCount();
+		const list<IAtom*> atomsList = molecule.getAtomsList();
+		const vector<IAtom*> atoms(atomsList.begin(), atomsList.end());
+		const int nATOMS_COUNT = atoms.size();
 		alphaValues.clear();
 		alphaValues.reserve(nATOMS_COUNT);
-		squareDistancesMatrix.clear();
-		squareDistancesMatrix.reserve(nATOMS_COUNT);
-		neighborAtomIds.clear();
-		neighborAtomIds.reserve(nATOMS_COUNT);
-		intersectedAtomIds.clear();
-		intersectedAtomIds.reserve(nMaxIntersectionOrder);
+		neighborSquareDistances.assign(nATOMS_COUNT, vector<double>());
+		neighborAtomIds.assign(nATOMS_COUNT, vector<int>());
+
+		/* Calculate alpha values and bucket atoms into cells as large as the max contact distance. */
+		vector<double> xCoordinates, yCoordinates, zCoordinates;
+		xCoordinates.reserve(nATOMS_COUNT);
+		yCoordinates.reserve(nATOMS_COUNT);
+		zCoordinates.reserve(nATOMS_COUNT);
+		double dMaxRadius = 0;
+		FOREACH(iterAtom, atoms, vector<IAtom*>::const_iterator)
+		{
+			const IAtom& atom = **iterAtom;
 
-		const list<IAtom*> atomsList = molecule.getAtomsList();
-		int iOuterAtomId = 0;
-		FOREACH(iterAtomOuter, atomsList, list<IAtom*>::const_iterator)
+			const double dAlpha = _dPARTIAL_ALPHA / pow(atom.getAtomRadius(), 2);
+			alphaValues.push_back(dAlpha);
+
+			xCoordinates.push_back(atom.getPositionX());
+			yCoordinates.push_back(atom.getPositionY());
+			zCoordinates.push_back(atom.getPositionZ());
+			dMaxRadius = std::max(dMaxRadius, atom.getAtomRadius());
+		}
+		const CCellList cellList(xCoordinates, yCoordinates, zCoordinates, 2 * dMaxRadius + dGaussianCutoff);
+
+		/* Record neighbors behind each atom found in adjacent cells. */
+		vector<int> candidateAtomIds;
+		for (int iOuterAtomId = 0; iOuterAtomId < nATOMS_COUNT; ++ iOuterAtomId)
 		{
-			const IAtom& atomOuter = **iterAtomOuter;
-
-			/* Construct square distances container for current atom. */
-			squareDistancesMatrix.push_back(vector<double>());
-			vector<double>& squareDistancesRow = squareDistancesMatrix.back();
-			squareDistancesRow.reserve(nATOMS_COUNT);
-
-			/* Construct neighbor IDs container for current atom. */
-			neighborAtomIds.push_back(set<int>());
-			set<int>& currentNeighborIdsSet = neighborAtomIds.back();
-
-			/* Calculate distance and neighbors. */
-			// atom coordinate
-			const vector<double>& outerAtomPosition = atomOuter.getPosition();
-			int iInnerAtomId = 0;
-			FOREACH(iterAtomInner, atomsList, list<IAtom*>::const_iterator)
+			const IAtom& atomOuter = *atoms[iOuterAtomId];
+
+			/* Candidates come in cell order, sort them to keep neighbor IDs ascending. */
+			cellList.getCandidatePointIds(xCoordinates[iOuterAtomId], yCoordinates[iOuterAtomId], zCoordinates[iOuterAtomId], candidateAtomIds);
+			std::sort(candidateAtomIds.begin(), candidateAtomIds.end());
+			FOREACH(iterInnerAtomId, candidateAtomIds, vector<int>::const_iterator)
 			{
-				const IAtom& atomInner = **iterAtomInner;
-				// atom coordinate
-				const vector<double>& innerAtomPosition = atomInner.getPosition();
-				const double dSquareDistance = iInnerAtomId >= iOuterAtomId ?
-					CMathematics::pointToPointSquareDistance(outerAtomPosition, innerAtomPosition) : squareDistancesMatrix[iOuterAtomId][iInnerAtomId];
+				// If not behind current atom:
+				if (*iterInnerAtomId <= iOuterAtomId)
+				{
+					continue;
+				}
 
-				/* Record square distances. */
-				squareDistancesRow.push_back(dSquareDistance);
+				const IAtom& atomInner = *atoms[*iterInnerAtomId];
+				const double dSquareDistance = CMathematics::pointToPointSquareDistance(atomOuter.getPosition(), atomInner.getPosition());
 
-				/* Record neighbor atom ID. */
-				if (iInnerAtomId > iOuterAtomId && dSquareDistance < pow(atomOuter.getAtomRadius() + atomInner.getAtomRadius() + dGaussianCutoff, 2))
+				/* Record neighbor atom ID and square distance. */
+				if (dSquareDistance < pow(atomOuter.getAtomRadius() + atomInner.getAtomRadius() + dGaussianCutoff, 2))
 				{
-					currentNeighborIdsSet.insert(iInnerAtomId);
+					neighborAtomIds[iOuterAtomId].push_back(*iterInnerAtomId);
+					neighborSquareDistances[iOuterAtomId].push_back(dSquareDistance);
 				}
-
-				++ iInnerAtomId;
 			}
-
-			/* Calculate alpha values. */
-			const double dAlpha = _dPARTIAL_ALPHA / pow(atomOuter.getAtomRadius(), 2);
-			alphaValues.push_back(dAlpha);
-
-			++ iOuterAtomId;
-		}
-
-		/* Precalculate intersected atom IDs for molecule. */
-		// For each order:
-		for (int iOrder = 1; iOrder <= nMaxIntersectionOrder; ++ iOrder)
-		{
-			intersectedAtomIds.push_back(vector<set<int> >());
-			vector<set<int> >& intersectedAtomIdsForCurrentOrder = intersectedAtomIds.back();
-			enumerateIntersectedAtomIds(
-				neighborAtomIds,
-				iOrder,
-				intersectedAtomIdsForCurrentOrder
-				);
 		}
 	}
 	// If invalid parameter:
@@ -881,6 +1061,114 @@ int CGaussianVolume::precalculateMolecule(
 }
 
 
+/**
+ * Description: Build the contiguous coordinates, alpha values and radii arrays of atoms, to be consumed by the overlap kernel. Atoms
+ *	of the same radius share a radius class, so that pair constants can be tabulated per class pair. Single precision copies are
+ *	built as well, for float kernels.
+ * @param atoms: (IN)
+ * @param preparedMolecule: (OUT)
+ */
+int CGaussianVolume::prepareAtoms(const std::vector<IAtom*>& atoms, PreparedMolecule& preparedMolecule)
+{
+	const int nATOMS_COUNT = atoms.size();
+
+	preparedMolecule.alphaValues.resize(nATOMS_COUNT);
+	preparedMolecule.classAlphaValues.clear();
+	preparedMolecule.classRadii.clear();
+	preparedMolecule.floatAlphaValues.resize(nATOMS_COUNT);
+	preparedMolecule.floatRadii.resize(nATOMS_COUNT);
+	preparedMolecule.floatXCoordinates.resize(nATOMS_COUNT);
+	preparedMolecule.floatYCoordinates.resize(nATOMS_COUNT);
+	preparedMolecule.floatZCoordinates.resize(nATOMS_COUNT);
+	preparedMolecule.radii.resize(nATOMS_COUNT);
+	preparedMolecule.radiusClassIds.resize(nATOMS_COUNT);
+	preparedMolecule.xCoordinates.resize(nATOMS_COUNT);
+	preparedMolecule.yCoordinates.resize(nATOMS_COUNT);
+	preparedMolecule.zCoordinates.resize(nATOMS_COUNT);
+
+	for (int iAtom = 0; iAtom < nATOMS_COUNT; ++ iAtom)
+	{
+		const IAtom& atom = *atoms[iAtom];
+		const double dRadius = atom.getAtomRadius();
+		const double dALPHA = _dPARTIAL_ALPHA / (dRadius * dRadius);
+
+		preparedMolecule.alphaValues[iAtom] = dALPHA;
+		preparedMolecule.radii[iAtom] = dRadius;
+		preparedMolecule.xCoordinates[iAtom] = atom.getPositionX();
+		preparedMolecule.yCoordinates[iAtom] = atom.getPositionY();
+		preparedMolecule.zCoordinates[iAtom] = atom.getPositionZ();
+		preparedMolecule.floatAlphaValues[iAtom] = static_cast<float>(dALPHA);
+		preparedMolecule.floatRadii[iAtom] = static_cast<float>(dRadius);
+		preparedMolecule.floatXCoordinates[iAtom] = static_cast<float>(atom.getPositionX());
+		preparedMolecule.floatYCoordinates[iAtom] = static_cast<float>(atom.getPositionY());
+		preparedMolecule.floatZCoordinates[iAtom] = static_cast<float>(atom.getPositionZ());
+
+		/* Find radius class, few classes per molecule, so linear search suffices. */
+		const vector<double>::const_iterator iterClassRadius =
+			std::find(preparedMolecule.classRadii.begin(), preparedMolecule.classRadii.end(), dRadius);
+		preparedMolecule.radiusClassIds[iAtom] = iterClassRadius - preparedMolecule.classRadii.begin();
+		// If new radius class:
+		if (iterClassRadius == preparedMolecule.classRadii.end())
+		{
+			preparedMolecule.classAlphaValues.push_back(dALPHA);
+			preparedMolecule.classRadii.push_back(dRadius);
+		}
+	}
+
+	prepareBoundingSpheres(preparedMolecule);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Build bounding spheres of the whole molecule and of each block of contiguous atoms, from the prepared coordinates and
+ *	radii. Spheres are rigid with the molecule, so a pose is followed by transforming their centers like atoms.
+ * @param preparedMolecule: (IN, OUT)
+ */
+int CGaussianVolume::prepareBoundingSpheres(PreparedMolecule& preparedMolecule)
+{
+	const int nATOMS_COUNT = preparedMolecule.radii.size();
+	const int nBLOCKS_COUNT = (nATOMS_COUNT + _nBLOCK_ATOMS_COUNT - 1) / _nBLOCK_ATOMS_COUNT;
+
+	calculateBoundingSphere(
+		preparedMolecule, 0, nATOMS_COUNT,
+		preparedMolecule.dBoundingXCenter, preparedMolecule.dBoundingYCenter, preparedMolecule.dBoundingZCenter, preparedMolecule.dBoundingRadius
+		);
+
+	preparedMolecule.blockRadii.resize(nBLOCKS_COUNT);
+	preparedMolecule.blockStarts.resize(nBLOCKS_COUNT + 1);
+	preparedMolecule.blockXCenters.resize(nBLOCKS_COUNT);
+	preparedMolecule.blockYCenters.resize(nBLOCKS_COUNT);
+	preparedMolecule.blockZCenters.resize(nBLOCKS_COUNT);
+	for (int iBlock = 0; iBlock < nBLOCKS_COUNT; ++ iBlock)
+	{
+		const int nSTART_ATOM_ID = iBlock * _nBLOCK_ATOMS_COUNT;
+		preparedMolecule.blockStarts[iBlock] = nSTART_ATOM_ID;
+		calculateBoundingSphere(
+			preparedMolecule, nSTART_ATOM_ID, std::min(nSTART_ATOM_ID + _nBLOCK_ATOMS_COUNT, nATOMS_COUNT),
+			preparedMolecule.blockXCenters[iBlock], preparedMolecule.blockYCenters[iBlock], preparedMolecule.blockZCenters[iBlock], preparedMolecule.blockRadii[iBlock]
+			);
+	}
+	preparedMolecule.blockStarts[nBLOCKS_COUNT] = nATOMS_COUNT;
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Build the contiguous coordinates, alpha values and radii arrays of a molecule, to be consumed by the overlap kernel.
+ * @param molecule: (IN)
+ * @param preparedMolecule: (OUT)
+ */
+int CGaussianVolume::prepareMolecule(const IMolecule& molecule, PreparedMolecule& preparedMolecule)
+{
+	const list<IAtom*> atomsList = molecule.getAtomsList();
+
+	return prepareAtoms(vector<IAtom*>(atomsList.begin(), atomsList.end()), preparedMolecule);
+}
+
+
 /**
  * Description: Set Gaussian cutoff value.
  * @param dCutoff: (IN) A non negative value representing Caussian cutoff value.
@@ -903,10 +1191,33 @@ void CGaussianVolume::setGaussianCutoff(double dCutoff)
 }
 
 
+/**
+ * Description: Set intersection volume below which a cluster and all clusters grown from it are dropped. Zero keeps all clusters.
+ * @param dEpsilon: (IN) A non negative value.
+ */
+void CGaussianVolume::setIntersectionVolumeEpsilon(const double dEpsilon)
+{
+	if (dEpsilon >= 0)
+	{
+		_dIntersectionVolumeEpsilon = dEpsilon;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter! "
+			<< "Detail: dEpsilon = " << dEpsilon;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
 /* Implementation for CGaussianVolumeBuilder class: */
 
 /* static members: */
 const double CGaussianVolumeBuilder::DefaultValues::dGAUSSIAN_CUTOFF = 0;
+const double CGaussianVolumeBuilder::DefaultValues::dINTERSECTION_VOLUME_EPSILON = 0;
 const int CGaussianVolumeBuilder::DefaultValues::nMAX_INTERSECTION_ORDER = 1;
 
 const int CGaussianVolumeBuilder::ErrorCodes::nNORMAL = 0;
@@ -920,31 +1231,52 @@ const int CGaussianVolumeBuilder::ErrorCodes::nNORMAL = 0;
 CGaussianVolumeBuilder::CGaussianVolumeBuilder(const IMolecule* pRefMolecule, const IMolecule* pFitMolecule) :
 	_bInitForPrecalculationResult(false),
 	_dGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF),
+	_dIntersectionVolumeEpsilon(DefaultValues::dINTERSECTION_VOLUME_EPSILON),
 	_nMaxIntersectionOrder(DefaultValues::nMAX_INTERSECTION_ORDER),
 	_pFitMolecule(pFitMolecule),
-	_pRefMolecule(pRefMolecule)
+	_pRefMolecule(pRefMolecule),
+	_pRefPrecalculation(NULL),
+	_pSharedRefPrecalculation(NULL)
 {
-	// If NULL parameter:
-	if (pRefMolecule && pFitMolecule)
-	{
-		/* Extract atoms of reference molecule. */
-		list<IAtom*> refAtomsList = pRefMolecule->getAtomsList();
-		_refAtoms.reserve(refAtomsList.size());
-		std::copy(refAtomsList.begin(), refAtomsList.end(), std::back_inserter(_refAtoms));
+	init(pRefMolecule, pFitMolecule);
+}
 
-		/* Extract atoms of fit molecule. */
-		list<IAtom*> fitAtomsList = pFitMolecule->getAtomsList();
-		_fitAtoms.reserve(fitAtomsList.size());
-		std::copy(fitAtomsList.begin(), fitAtomsList.end(), std::back_inserter(_fitAtoms));
-	}
+
+/**
+ * Description: Constructor, sharing the precalculation result of reference molecule, e.g. a query used against many fit molecules.
+ *	The shared result is used only if it matches the Gaussian cutoff and max intersection order of this builder, otherwise
+ *	the reference molecule is precalculated again.
+ * @param pRefMolecule: (IN)
+ * @param pRefPrecalculation: (IN) Precalculation result of reference molecule, must live longer than this builder.
+ * @param pFitMolecule: (IN)
+ */
+CGaussianVolumeBuilder::CGaussianVolumeBuilder(
+	const IMolecule* pRefMolecule,
+	const CGaussianVolume::MoleculePrecalculation* pRefPrecalculation,
+	const IMolecule* pFitMolecule
+	) :
+	_bInitForPrecalculationResult(false),
+	_dGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF),
+	_dIntersectionVolumeEpsilon(DefaultValues::dINTERSECTION_VOLUME_EPSILON),
+	_nMaxIntersectionOrder(DefaultValues::nMAX_INTERSECTION_ORDER),
+	_pFitMolecule(pFitMolecule),
+	_pRefMolecule(pRefMolecule),
+	_pRefPrecalculation(NULL),
+	_pSharedRefPrecalculation(pRefPrecalculation)
+{
 	// If not NULL parameter:
+	if (pRefPrecalculation)
+	{
+		init(pRefMolecule, pFitMolecule);
+	}
+	// If NULL parameter:
 	else
 	{
 		std::stringstream msgStream;
 		msgStream
 			<< LOCATION_STREAM_INSERTION
 			<< "Invalid parameter: "
-			<< "pRefMolecule = NULL or pFitMolecule = NULL. ";
+			<< "pRefPrecalculation = NULL. ";
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
@@ -967,13 +1299,27 @@ int CGaussianVolumeBuilder::attemptInitialize()
 	// If precalculation has not been done:
 	if (!_bInitForPrecalculationResult)
 	{
-		CGaussianVolume::precalculate(
-			*_pRefMolecule,
-			*_pFitMolecule,
-			getGaussianCutoff(),
-			getMaxIntersectionOrder(),
-			_precalculationResult
-			);
+		// If the shared precalculation result of reference molecule matches current parameters:
+		if (_pSharedRefPrecalculation
+			&& _pSharedRefPrecalculation->dGaussianCutoff == getGaussianCutoff()
+			&& _pSharedRefPrecalculation->nMaxIntersectionOrder == getMaxIntersectionOrder())
+		{
+			CGaussianVolume::precalculateMolecule(*_pFitMolecule, getGaussianCutoff(), getMaxIntersectionOrder(), _precalculationResult.fitPrecalculation);
+			_precalculationResult.dGaussianCutoff = getGaussianCutoff();
+			_pRefPrecalculation = _pSharedRefPrecalculation;
+		}
+		// If no shared precalculation result can be used:
+		else
+		{
+			CGaussianVolume::precalculate(
+				*_pRefMolecule,
+				*_pFitMolecule,
+				getGaussianCutoff(),
+				getMaxIntersectionOrder(),
+				_precalculationResult
+				);
+			_pRefPrecalculation = &_precalculationResult.refPrecalculation;
+		}
 
 		_bInitForPrecalculationResult = true;
 	}
@@ -982,6 +1328,43 @@ int CGaussianVolumeBuilder::attemptInitialize()
 }
 
 
+/**
+ * Description: Setup shared by constructors, extracting atoms of both molecules.
+ * @param pRefMolecule: (IN)
+ * @param pFitMolecule: (IN)
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+int CGaussianVolumeBuilder::init(const IMolecule* pRefMolecule, const IMolecule* pFitMolecule)
+{
+	// If not NULL parameter:
+	if (pRefMolecule && pFitMolecule)
+	{
+		/* Extract atoms of reference molecule. */
+		list<IAtom*> refAtomsList = pRefMolecule->getAtomsList();
+		_refAtoms.reserve(refAtomsList.size());
+		std::copy(refAtomsList.begin(), refAtomsList.end(), std::back_inserter(_refAtoms));
+
+		/* Extract atoms of fit molecule. */
+		list<IAtom*> fitAtomsList = pFitMolecule->getAtomsList();
+		_fitAtoms.reserve(fitAtomsList.size());
+		std::copy(fitAtomsList.begin(), fitAtomsList.end(), std::back_inserter(_fitAtoms));
+	}
+	// If NULL parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "pRefMolecule = NULL or pFitMolecule = NULL. ";
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
 /**
  * Description:
  * @param fitMolecule: (IN)
@@ -994,7 +1377,10 @@ CGaussianVolume CGaussianVolumeBuilder::build(const IMolecule* pFitMolecule)
 	{
 		attemptInitialize();
 
-		return CGaussianVolume(&_refAtoms, pFitMolecule, &_precalculationResult);
+		CGaussianVolume gaussianVolume(&_refAtoms, pFitMolecule, _pRefPrecalculation, &_precalculationResult.fitPrecalculation);
+		gaussianVolume.setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
+
+		return gaussianVolume;
 	}
 	// If invalid parameter:
 	else
@@ -1017,7 +1403,47 @@ CGaussianVolume CGaussianVolumeBuilder::build()
 {
 	attemptInitialize();
 
-	return CGaussianVolume(&_refAtoms, &_fitAtoms, &_precalculationResult);
+	CGaussianVolume gaussianVolume(&_refAtoms, &_fitAtoms, _pRefPrecalculation, &_precalculationResult.fitPrecalculation);
+	gaussianVolume.setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
+
+	return gaussianVolume;
+}
+
+
+/**
+ * Description: Build Gaussian volume for poses of reference and fit molecule, without touching any IAtom instance. Intramolecular
+ *	information is precalculated only once by this builder, only intermolecular information is calculated for each call.
+ * @param pRefMolecule: (IN) Prepared reference molecule, in any rigid pose.
+ * @param pFitMolecule: (IN) Prepared fit molecule, in any rigid pose.
+ * @param pNeighborList: (IN) Cross neighbor list updated for these poses, with the Gaussian cutoff of this builder, could be NULL pointer.
+ * @return:
+ */
+CGaussianVolume CGaussianVolumeBuilder::build(
+	const CGaussianVolume::PreparedMolecule* pRefMolecule,
+	const CGaussianVolume::PreparedMolecule* pFitMolecule,
+	const CCrossNeighborList* pNeighborList
+	)
+{
+	// If valid parameters:
+	if (pRefMolecule && pFitMolecule)
+	{
+		attemptInitialize();
+
+		CGaussianVolume gaussianVolume(pRefMolecule, pFitMolecule, _pRefPrecalculation, &_precalculationResult.fitPrecalculation, pNeighborList);
+		gaussianVolume.setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
+
+		return gaussianVolume;
+	}
+	// If invalid parameters:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameters: "
+			<< "pRefMolecule = NULL or pFitMolecule = NULL. ";
+		throw CInvalidArgumentException(msgStream.str());
+	}
 }
 
 
@@ -1043,6 +1469,16 @@ int CGaussianVolumeBuilder::getMaxIntersectionOrder() const
 
 /**
  * Description:
+ * @return:
+ */
+double CGaussianVolumeBuilder::getIntersectionVolumeEpsilon() const
+{
+	return _dIntersectionVolumeEpsilon;
+}
+
+
+/**
+ * Description: Set Gaussian cutoff, precalculating again on the next build if changed.
  * @param dCutoff: (IN)
  */
 void CGaussianVolumeBuilder::setGaussianCutoff(const double dCutoff)
@@ -1050,7 +1486,12 @@ void CGaussianVolumeBuilder::setGaussianCutoff(const double dCutoff)
 	// If valid parameter:
 	if (dCutoff >= 0)
 	{
-		_dGaussianCutoff = dCutoff;
+		// If changed:
+		if (dCutoff != _dGaussianCutoff)
+		{
+			_dGaussianCutoff = dCutoff;
+			_bInitForPrecalculationResult = false;
+		}
 	}
 	// If invalid parameter:
 	else
@@ -1067,13 +1508,42 @@ void CGaussianVolumeBuilder::setGaussianCutoff(const double dCutoff)
 
 /**
  * Description:
+ * @param dEpsilon: (IN)
+ */
+void CGaussianVolumeBuilder::setIntersectionVolumeEpsilon(const double dEpsilon)
+{
+	// If valid parameter:
+	if (dEpsilon >= 0)
+	{
+		_dIntersectionVolumeEpsilon = dEpsilon;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dEpsilon = " << dEpsilon;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set max intersection order, precalculating again on the next build if changed.
  * @param nOrder: (IN)
  */
 void CGaussianVolumeBuilder::setMaxIntersectionOrder(const int nOrder)
 {
 	if (nOrder > 0)
 	{
-		_nMaxIntersectionOrder = nOrder;
+		// If changed:
+		if (nOrder != _nMaxIntersectionOrder)
+		{
+			_nMaxIntersectionOrder = nOrder;
+			_bInitForPrecalculationResult = false;
+		}
 	}
 	else
 	{
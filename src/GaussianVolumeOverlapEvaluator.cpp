@@ -14,6 +14,7 @@
 #include "GaussianVolumeOverlapEvaluator.h"
 
 #include "BusinessException.h"
+#include "GaussianOverlapKernel.h"
 #include "GaussianVolume.h"
 #include "InterfaceAtom.h"
 #include "InterfaceMolecule.h"
@@ -27,6 +28,10 @@
 #include <string>
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using std::auto_ptr;
 using std::list;
@@ -35,14 +40,155 @@ using std::string;
 using std::vector;
 
 
+/**
+ * Description: Apply a rigid transformation to a point.
+ * @param aadTransformation: (IN) Rotation matrix in the first three columns, translation in the last column.
+ * @param dX: (IN, OUT)
+ * @param dY: (IN, OUT)
+ * @param dZ: (IN, OUT)
+ */
+static inline void transformPoint(const double aadTransformation[3][4], double& dX, double& dY, double& dZ)
+{
+	const double dNewX = aadTransformation[0][0] * dX + aadTransformation[0][1] * dY + aadTransformation[0][2] * dZ + aadTransformation[0][3];
+	const double dNewY = aadTransformation[1][0] * dX + aadTransformation[1][1] * dY + aadTransformation[1][2] * dZ + aadTransformation[1][3];
+	const double dNewZ = aadTransformation[2][0] * dX + aadTransformation[2][1] * dY + aadTransformation[2][2] * dZ + aadTransformation[2][3];
+
+	dX = dNewX;
+	dY = dNewY;
+	dZ = dNewZ;
+}
+
+
+/* Step of central differences for the gradient of higher order overlap. */
+static const double dGRADIENT_DIFFERENCE_STEP = 1e-5;
+
+
+/**
+ * Description: Get the derivatives of the rotation matrix of Euler angles, see CMathematics::eulerAnglesToRotationMatrix(), with
+ *	respect to the rotation angles along X, Y and Z axis.
+ * @param adSines: (IN) Sines of rotation angles along X, Y and Z axis.
+ * @param adCosines: (IN) Cosines of rotation angles along X, Y and Z axis.
+ * @param aadDerivatives: (OUT) aadDerivatives[k][i][j] is the derivative of matrix element (i, j) with respect to angle k.
+ */
+static inline void getRotationDerivatives(const double adSines[3], const double adCosines[3], double aadDerivatives[3][3][3])
+{
+	const double dSA = adSines[0], dSB = adSines[1], dSG = adSines[2];
+	const double dCA = adCosines[0], dCB = adCosines[1], dCG = adCosines[2];
+
+	/* Along X axis. */
+	aadDerivatives[0][0][0] = 0;
+	aadDerivatives[0][0][1] = dCA * dSB * dCG + dSA * dSG;
+	aadDerivatives[0][0][2] = -dSA * dSB * dCG + dCA * dSG;
+	aadDerivatives[0][1][0] = 0;
+	aadDerivatives[0][1][1] = dCA * dSB * dSG - dSA * dCG;
+	aadDerivatives[0][1][2] = -dSA * dSB * dSG - dCA * dCG;
+	aadDerivatives[0][2][0] = 0;
+	aadDerivatives[0][2][1] = dCA * dCB;
+	aadDerivatives[0][2][2] = -dSA * dCB;
+
+	/* Along Y axis. */
+	aadDerivatives[1][0][0] = -dSB * dCG;
+	aadDerivatives[1][0][1] = dSA * dCB * dCG;
+	aadDerivatives[1][0][2] = dCA * dCB * dCG;
+	aadDerivatives[1][1][0] = -dSB * dSG;
+	aadDerivatives[1][1][1] = dSA * dCB * dSG;
+	aadDerivatives[1][1][2] = dCA * dCB * dSG;
+	aadDerivatives[1][2][0] = -dCB;
+	aadDerivatives[1][2][1] = -dSA * dSB;
+	aadDerivatives[1][2][2] = -dCA * dSB;
+
+	/* Along Z axis. */
+	aadDerivatives[2][0][0] = -dCB * dSG;
+	aadDerivatives[2][0][1] = -dSA * dSB * dSG - dCA * dCG;
+	aadDerivatives[2][0][2] = -dCA * dSB * dSG + dSA * dCG;
+	aadDerivatives[2][1][0] = dCB * dCG;
+	aadDerivatives[2][1][1] = dSA * dSB * dCG - dCA * dSG;
+	aadDerivatives[2][1][2] = dCA * dSB * dCG + dSA * dSG;
+	aadDerivatives[2][2][0] = 0;
+	aadDerivatives[2][2][1] = 0;
+	aadDerivatives[2][2][2] = 0;
+}
+
+
+/**
+ * Description: Get the derivatives of the rotation matrix of a rotation vector, see CMathematics::rotationVectorToRotationMatrix(),
+ *	with respect to each component of the vector, chaining the derivatives of the matrix with respect to the unit quaternion
+ *	[W, X, Y, Z] = [cos(angle / 2), sin(angle / 2) / angle * vector] through the derivatives of the quaternion.
+ * @param adRotationVector: (IN)
+ * @param aadDerivatives: (OUT) aadDerivatives[k][i][j] is the derivative of matrix element (i, j) with respect to component k.
+ */
+static inline void getRotationVectorDerivatives(const double adRotationVector[3], double aadDerivatives[3][3][3])
+{
+	const double dANGLE = sqrt(adRotationVector[0] * adRotationVector[0] + adRotationVector[1] * adRotationVector[1] + adRotationVector[2] * adRotationVector[2]);
+	// S = sin(angle / 2) / angle, and dS / dAngle / angle, by their series for tiny angles
+	double dScale = 0;
+	double dScaleSlope = 0;
+	// If tiny angle:
+	if (dANGLE < 1e-4)
+	{
+		dScale = 0.5 - dANGLE * dANGLE / 48;
+		dScaleSlope = -1.0 / 24 + dANGLE * dANGLE / 960;
+	}
+	// If finite angle:
+	else
+	{
+		dScale = sin(dANGLE / 2) / dANGLE;
+		dScaleSlope = (dANGLE / 2 * cos(dANGLE / 2) - sin(dANGLE / 2)) / (dANGLE * dANGLE * dANGLE);
+	}
+	const double dW = cos(dANGLE / 2);
+	const double dX = dScale * adRotationVector[0];
+	const double dY = dScale * adRotationVector[1];
+	const double dZ = dScale * adRotationVector[2];
+
+	/* Derivatives of the matrix with respect to W, X, Y and Z. */
+	const double aaadQUATERNION_DERIVATIVES[4][3][3] = {
+		{{0, -2 * dZ, 2 * dY}, {2 * dZ, 0, -2 * dX}, {-2 * dY, 2 * dX, 0}},
+		{{0, 2 * dY, 2 * dZ}, {2 * dY, -4 * dX, -2 * dW}, {2 * dZ, 2 * dW, -4 * dX}},
+		{{-4 * dY, 2 * dX, 2 * dW}, {2 * dX, 0, 2 * dZ}, {-2 * dW, 2 * dZ, -4 * dY}},
+		{{-4 * dZ, -2 * dW, 2 * dX}, {2 * dW, -4 * dZ, 2 * dY}, {2 * dX, 2 * dY, 0}}
+		};
+
+	// For each component of rotation vector:
+	for (int k = 0; k < 3; ++ k)
+	{
+		/* Derivatives of the quaternion with respect to the component. */
+		double adQuaternionDerivatives[4];
+		adQuaternionDerivatives[0] = -dScale / 2 * adRotationVector[k];
+		for (int i = 0; i < 3; ++ i)
+		{
+			adQuaternionDerivatives[i + 1] = (i == k ? dScale : 0) + dScaleSlope * adRotationVector[i] * adRotationVector[k];
+		}
+
+		for (int i = 0; i < 3; ++ i)
+		{
+			for (int j = 0; j < 3; ++ j)
+			{
+				aadDerivatives[k][i][j] = 0;
+				for (int m = 0; m < 4; ++ m)
+				{
+					aadDerivatives[k][i][j] += aaadQUATERNION_DERIVATIVES[m][i][j] * adQuaternionDerivatives[m];
+				}
+			}
+		}
+	}
+}
+
+
 /* Implementation for CGaussianVolumeFitnessEvaluator class: */
 
 /* Static Members: */
+const int CGaussianVolumeOverlapEvaluator::PoseParameterizations::nEULER_ANGLES = 0;
+const int CGaussianVolumeOverlapEvaluator::PoseParameterizations::nROTATION_VECTOR = 1;
+
 const int CGaussianVolumeOverlapEvaluator::ErrorCodes::nNORMAL = 0;
 
 const bool CGaussianVolumeOverlapEvaluator::DefaultValues::bNEGATIVE_OVERLAP = false;
 const double CGaussianVolumeOverlapEvaluator::DefaultValues::dGAUSSIAN_CUTOFF = 0;
+const double CGaussianVolumeOverlapEvaluator::DefaultValues::dINTERSECTION_VOLUME_EPSILON = 0;
 const int CGaussianVolumeOverlapEvaluator::DefaultValues::nMAX_INTERSECTION_ORDER = 1;
+const double CGaussianVolumeOverlapEvaluator::DefaultValues::dNEIGHBOR_LIST_SKIN = 0;
+const int CGaussianVolumeOverlapEvaluator::DefaultValues::nPOSE_PARAMETERIZATION = CGaussianVolumeOverlapEvaluator::PoseParameterizations::nEULER_ANGLES;
+const int CGaussianVolumeOverlapEvaluator::DefaultValues::nTHREADS_COUNT = 1;
 
 
 /**
@@ -53,15 +199,32 @@ const int CGaussianVolumeOverlapEvaluator::DefaultValues::nMAX_INTERSECTION_ORDE
 CGaussianVolumeOverlapEvaluator::CGaussianVolumeOverlapEvaluator(const IMolecule& refMolecule, const IMolecule& fitMolecule) :
 	_bInitForGaussianVolumeBuilder(false),
 	_bNegativeOverlap(DefaultValues::bNEGATIVE_OVERLAP),
+	_bOwnRefMolecule(true),
+	_cullingCounters(),
 	_dGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF),
+	_dIntersectionVolumeEpsilon(DefaultValues::dINTERSECTION_VOLUME_EPSILON),
+	_dNeighborListSkin(DefaultValues::dNEIGHBOR_LIST_SKIN),
 	_gVolumeBuilder(&refMolecule, &fitMolecule),
+	_kernelSettings(),
 	_nMaxIntersectionOrder(DefaultValues::nMAX_INTERSECTION_ORDER),
+	_nPoseParameterization(DefaultValues::nPOSE_PARAMETERIZATION),
+	_nThreadsCount(DefaultValues::nTHREADS_COUNT),
+	_pDensityGrid(NULL),
 	_pFitMolecule(dynamic_cast<IMolecule*>(fitMolecule.clone())),
-	_pRefMolecule(dynamic_cast<IMolecule*>(refMolecule.clone()))
+	_pRefMolecule(dynamic_cast<IMolecule*>(refMolecule.clone())),
+	_pRefPrecalculation(NULL),
+	_pRefPreparedMolecule(&_refPreparedMolecule)
 {
 	// If type cast success:
 	if (_pFitMolecule && _pRefMolecule)
 	{
+		/* Prepare molecules once, so that evaluations need not to touch any molecule. */
+		CGaussianVolume::prepareMolecule(*_pRefMolecule, _refPreparedMolecule);
+		CGaussianVolume::prepareMolecule(*_pFitMolecule, _fitPreparedMolecule);
+		_fitPreparedMoleculeBuffer = _fitPreparedMolecule;
+		_fitXGradients.resize(_fitPreparedMolecule.radii.size());
+		_fitYGradients.resize(_fitPreparedMolecule.radii.size());
+		_fitZGradients.resize(_fitPreparedMolecule.radii.size());
 	}
 	// If type cast failure:
 	else
@@ -76,13 +239,76 @@ CGaussianVolumeOverlapEvaluator::CGaussianVolumeOverlapEvaluator(const IMolecule
 }
 
 
+/**
+ * Description: Ctor, sharing the prepared data of reference molecule instead of cloning and preparing it again,
+ *	e.g. for a query molecule used against many fit molecules.
+ * @param refMolecule: Reference molecule, which will be fixed. Not cloned, must live longer than this evaluator.
+ * @param refPreparedMolecule: Prepared reference molecule. Not copied, must live longer than this evaluator.
+ * @param refPrecalculation: Precalculation result of reference molecule. Not copied, must live longer than this evaluator.
+ * @param fitMolecule: Fit molecule, which will be transformed.
+ */
+CGaussianVolumeOverlapEvaluator::CGaussianVolumeOverlapEvaluator(
+	const IMolecule& refMolecule,
+	const CGaussianVolume::PreparedMolecule& refPreparedMolecule,
+	const CGaussianVolume::MoleculePrecalculation& refPrecalculation,
+	const IMolecule& fitMolecule
+	) :
+	_bInitForGaussianVolumeBuilder(false),
+	_bNegativeOverlap(DefaultValues::bNEGATIVE_OVERLAP),
+	_bOwnRefMolecule(false),
+	_cullingCounters(),
+	_dGaussianCutoff(DefaultValues::dGAUSSIAN_CUTOFF),
+	_dIntersectionVolumeEpsilon(DefaultValues::dINTERSECTION_VOLUME_EPSILON),
+	_dNeighborListSkin(DefaultValues::dNEIGHBOR_LIST_SKIN),
+	_gVolumeBuilder(&refMolecule, &refPrecalculation, &fitMolecule),
+	_kernelSettings(),
+	_nMaxIntersectionOrder(DefaultValues::nMAX_INTERSECTION_ORDER),
+	_nPoseParameterization(DefaultValues::nPOSE_PARAMETERIZATION),
+	_nThreadsCount(DefaultValues::nTHREADS_COUNT),
+	_pDensityGrid(NULL),
+	_pFitMolecule(dynamic_cast<IMolecule*>(fitMolecule.clone())),
+	_pRefMolecule(&refMolecule),
+	_pRefPrecalculation(&refPrecalculation),
+	_pRefPreparedMolecule(&refPreparedMolecule)
+{
+	// If type cast success:
+	if (_pFitMolecule)
+	{
+		/* Prepare fit molecule once, so that evaluations need not to touch any molecule. */
+		CGaussianVolume::prepareMolecule(*_pFitMolecule, _fitPreparedMolecule);
+		_fitPreparedMoleculeBuffer = _fitPreparedMolecule;
+		_fitXGradients.resize(_fitPreparedMolecule.radii.size());
+		_fitYGradients.resize(_fitPreparedMolecule.radii.size());
+		_fitZGradients.resize(_fitPreparedMolecule.radii.size());
+	}
+	// If type cast failure:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Bad cast! "
+			<< "Parameter fitMol can not be clone to IMolecule interface! ";
+		throw CBadCastException(msgStream.str());
+	}
+}
+
+
 /**
  * Description: Dtor.
  */
 CGaussianVolumeOverlapEvaluator::~CGaussianVolumeOverlapEvaluator()
 {
+	FOREACH(iterWorker, _workerEvaluators, vector<CGaussianVolumeOverlapEvaluator*>::iterator)
+	{
+		delete *iterWorker;
+	}
 	delete _pFitMolecule;
-	delete _pRefMolecule;
+	// If reference molecule is cloned by this evaluator:
+	if (_bOwnRefMolecule)
+	{
+		delete _pRefMolecule;
+	}
 }
 
 
@@ -96,8 +322,31 @@ int CGaussianVolumeOverlapEvaluator::attemptInitialize()
 	if (!_bInitForGaussianVolumeBuilder)
 	{
 		_gVolumeBuilder.setGaussianCutoff(getGaussianCutoff());
+		_gVolumeBuilder.setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
 		_gVolumeBuilder.setMaxIntersectionOrder(getMaxIntersectionOrder());
 
+		// If neighbor list enabled:
+		if (getNeighborListSkin() > 0)
+		{
+			_neighborListPtr.reset(new CCrossNeighborList(getNeighborListSkin()));
+		}
+		// If neighbor list disabled:
+		else
+		{
+			_neighborListPtr.reset();
+		}
+
+		// If density grid in use:
+		if (_pDensityGrid)
+		{
+			const int nFIT_CLASSES_COUNT = _fitPreparedMolecule.classRadii.size();
+			_densityGridChannelIds.resize(nFIT_CLASSES_COUNT);
+			for (int iClass = 0; iClass < nFIT_CLASSES_COUNT; ++ iClass)
+			{
+				_densityGridChannelIds[iClass] = _pDensityGrid->getChannelId(_fitPreparedMolecule.classRadii[iClass], _fitPreparedMolecule.classAlphaValues[iClass]);
+			}
+		}
+
 		_bInitForGaussianVolumeBuilder = true;
 	}
 
@@ -105,60 +354,429 @@ int CGaussianVolumeOverlapEvaluator::attemptInitialize()
 }
 
 
+/**
+ * Description: Clone the evaluator with the same settings, sharing the reference data shared by the caller of this evaluator if any,
+ *	and the density grid. The clone is initialized at once, so that channels of the density grid it uses are sampled here rather
+ *	than on the first evaluation, and evaluations on distinct clones never write shared data and may run concurrently.
+ *	Culling counters of the clone start from zero, and the clone evaluates batches on one thread, as it is meant for one thread.
+ * @return: A pointer to the clone evaluator, owned by the caller.
+ */
+ICloneable* CGaussianVolumeOverlapEvaluator::clone() const
+{
+	CGaussianVolumeOverlapEvaluator* const pClone = _bOwnRefMolecule
+		? new CGaussianVolumeOverlapEvaluator(*_pRefMolecule, *_pFitMolecule)
+		: new CGaussianVolumeOverlapEvaluator(*_pRefMolecule, *_pRefPreparedMolecule, *_pRefPrecalculation, *_pFitMolecule);
+	pClone->setDensityGrid(getDensityGrid());
+	pClone->setGaussianCutoff(getGaussianCutoff());
+	pClone->setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
+	pClone->setKernelSettings(getKernelSettings());
+	pClone->setMaxIntersectionOrder(getMaxIntersectionOrder());
+	pClone->setNegativeOverlapFlag(getNegativeOverlapFlag());
+	pClone->setNeighborListSkin(getNeighborListSkin());
+	pClone->setPoseParameterization(getPoseParameterization());
+	pClone->attemptInitialize();
+
+	return pClone;
+}
+
+
 /**
  * Description: Keep the reference molecule fixed and make transformation to fit molecule, calculating the Gaussian volume overlap as fitness.
+ *	No molecule is cloned: the transformation is applied to a preallocated coordinates buffer.
+ *	First order overlap is calculated by the overlap kernel without any heap allocation. Higher order overlap is expanded on the
+ *	intramolecular information precalculated once by the Gaussian volume builder, only cross terms are calculated for each pose.
+ *	With a positive neighbor list skin, cross terms are only tested for pairs of a Verlet neighbor list, which is rebuilt only when
+ *	the fit molecule has moved beyond the skin since the last build.
+ *	Fit molecules whose bounding sphere is out of contact with that of the reference molecule are given zero overlap directly, and
+ *	blocks of fit atoms out of contact with a reference atom are skipped by the first order kernel, see getCullingCounters().
+ *	With a density grid set, first order overlap is interpolated from the grid instead, at a cost linear in fit atoms.
  * @param params: Transformation (Translation and rotation) parameters applied to fit molecule. params[0], params[1] and params[2] correspond to translation amount
- *		along X, Y and Z axis respectively, params[3], params[4] and params[5] correspond to rotation angles along X, Y and Z axis respectively.
+ *		along X, Y and Z axis respectively, params[3], params[4] and params[5] correspond to rotation angles along X, Y and Z axis respectively,
+ *		or to a rotation vector, see setPoseParameterization().
  * @return: Gaussian volume overlap of the reference molecule and fit molecule.
- * @exception:
- *		CBadCastException:
  */
 double CGaussianVolumeOverlapEvaluator::getFunctionValue(const std::vector<double>& params)
 {
 	attemptInitialize();
 
-	// auto pointer for the clone of fit molecule
-	auto_ptr<IMolecule> fitMoleculeClonePtr(dynamic_cast<IMolecule*>(_pFitMolecule->clone()));
-	// If type cast success:
-	if (fitMoleculeClonePtr.get())
+	/* Apply transformation. */
+	transformFitAtomCoordinates(params);
+
+	/* Keep neighbor list valid for the new pose. */
+	CCrossNeighborList* const pNeighborList = _neighborListPtr.get();
+	// If neighbor list enabled:
+	if (pNeighborList)
 	{
-		/* Apply transformation. */
-		/**
-		 * Note: Pay attention to the transformation sequence: translation first or rotation first.
-		 */
-		IMolecule& fitMolecule = *fitMoleculeClonePtr;
-		fitMolecule.rotateXYZ(params[3], params[4], params[5]);
-		fitMolecule.move(params[0], params[1], params[2]);
+		pNeighborList->update(*_pRefPreparedMolecule, _fitPreparedMoleculeBuffer, getGaussianCutoff());
+	}
 
-		/* Extract fit atoms. */
-		const list<IAtom*> fitAtomsList = fitMolecule.getAtomsList();
-		vector<IAtom*> fitAtoms;
-		fitAtoms.reserve(fitAtomsList.size());
-		std::copy(fitAtomsList.begin(), fitAtomsList.end(), std::back_inserter(fitAtoms));
+	/* Get overlap volume. */
+	double dOverlap = 0;
+	// If first order overlap on density grid:
+	if (getMaxIntersectionOrder() == 1 && _pDensityGrid)
+	{
+		dOverlap = _pDensityGrid->calculateOverlapVolume(_fitPreparedMoleculeBuffer, _densityGridChannelIds);
+	}
+	// If first order overlap with neighbor list:
+	else if (getMaxIntersectionOrder() == 1 && pNeighborList)
+	{
+		dOverlap = CGaussianOverlapKernel::calculateOverlapVolume(*_pRefPreparedMolecule, _fitPreparedMoleculeBuffer, getGaussianCutoff(), _kernelSettings, *pNeighborList);
+	}
+	// If first order overlap:
+	else if (getMaxIntersectionOrder() == 1)
+	{
+		dOverlap = CGaussianOverlapKernel::calculateOverlapVolume(*_pRefPreparedMolecule, _fitPreparedMoleculeBuffer, getGaussianCutoff(), _kernelSettings, _cullingCounters);
+	}
+	// If higher order overlap of molecules far apart, no cross term at all:
+	else if (CGaussianVolume::areBoundingSpheresApart(*_pRefPreparedMolecule, _fitPreparedMoleculeBuffer, getGaussianCutoff()))
+	{
+		const long long nPAIRS_COUNT = static_cast<long long>(_pRefPreparedMolecule->radii.size()) * _fitPreparedMoleculeBuffer.radii.size();
+		_cullingCounters.nCulledPairsCount += nPAIRS_COUNT;
+		_cullingCounters.nPairsCount += nPAIRS_COUNT;
+	}
+	// If higher order overlap:
+	else
+	{
+		_cullingCounters.nPairsCount += static_cast<long long>(_pRefPreparedMolecule->radii.size()) * _fitPreparedMoleculeBuffer.radii.size();
 
-		/* Get overlap volume. */
-//		CGaussianVolume gVolume(&_refAtoms, &fitAtoms, &_precalculationResult);
-//		const double dOverlap = gVolume.getOverlapVolume();
+		const CGaussianVolume gaussianVolume = _gVolumeBuilder.build(_pRefPreparedMolecule, &_fitPreparedMoleculeBuffer, pNeighborList);
+		dOverlap = gaussianVolume.getOverlapVolume();
+	}
+
+	return _bNegativeOverlap ? -1 * dOverlap : dOverlap;
+}
 
-		CGaussianVolume gaussianVolume;
-		gaussianVolume.setGaussianCutoff(getGaussianCutoff());
-		double dOverlap = gaussianVolume.getOverlapVolume(*_pRefMolecule, fitMolecule);
 
-		return _bNegativeOverlap ? -1 * dOverlap : dOverlap;
+/**
+ * Description: Evaluate a batch of points across threads, see setThreadsCount(). With n threads, this evaluator takes points 0, n,
+ *	2n... and the clone kept for each extra thread the points following those, each point being evaluated exactly as by
+ *	getFunctionValue(). Clones are made on the first batch needing them, all settings are passed on to them on each batch, and
+ *	their culling counters are merged into those of this evaluator.
+ *	Exceptions do not leave threads: the first failed point is evaluated again by this evaluator after all threads, to throw.
+ * @param points: (IN) Transformation parameters of each point, see getFunctionValue().
+ * @param values: (OUT)
+ */
+void CGaussianVolumeOverlapEvaluator::getFunctionValues(const std::vector<std::vector<double> >& points, std::vector<double>& values)
+{
+	attemptInitialize();
+
+	const int nPOINTS_COUNT = points.size();
+	values.resize(nPOINTS_COUNT);
+	const int nWORKERS_COUNT = getWorkersCount(nPOINTS_COUNT);
+
+	// If one thread:
+	if (nWORKERS_COUNT <= 1)
+	{
+		for (int iPoint = 0; iPoint < nPOINTS_COUNT; ++ iPoint)
+		{
+			values[iPoint] = getFunctionValue(points[iPoint]);
+		}
+		return;
 	}
-	// If type cast failure:
+
+	/* Clone workers before starting threads, as cloning samples the density grid lazily. */
+	while (static_cast<int>(_workerEvaluators.size()) < nWORKERS_COUNT - 1)
+	{
+		_workerEvaluators.push_back(static_cast<CGaussianVolumeOverlapEvaluator*>(clone()));
+	}
+	/* Pass settings on to workers, initializing them again here if changed. */
+	FOREACH(iterWorker, _workerEvaluators, vector<CGaussianVolumeOverlapEvaluator*>::iterator)
+	{
+		(*iterWorker)->setDensityGrid(getDensityGrid());
+		(*iterWorker)->setGaussianCutoff(getGaussianCutoff());
+		(*iterWorker)->setIntersectionVolumeEpsilon(getIntersectionVolumeEpsilon());
+		(*iterWorker)->setKernelSettings(getKernelSettings());
+		(*iterWorker)->setMaxIntersectionOrder(getMaxIntersectionOrder());
+		(*iterWorker)->setNegativeOverlapFlag(getNegativeOverlapFlag());
+		(*iterWorker)->setNeighborListSkin(getNeighborListSkin());
+		(*iterWorker)->setPoseParameterization(getPoseParameterization());
+		(*iterWorker)->attemptInitialize();
+	}
+
+	/* Exceptions must not leave threads: remember the first failed point, and evaluate it again afterwards to throw. */
+	int nFailedPointId = nPOINTS_COUNT;
+	#pragma omp parallel for num_threads(nWORKERS_COUNT) schedule(static, 1)
+	for (int iWorker = 0; iWorker < nWORKERS_COUNT; ++ iWorker)
+	{
+		CGaussianVolumeOverlapEvaluator& evaluator = iWorker == 0 ? *this : *_workerEvaluators[iWorker - 1];
+		for (int iPoint = iWorker; iPoint < nPOINTS_COUNT; iPoint += nWORKERS_COUNT)
+		{
+			try
+			{
+				values[iPoint] = evaluator.getFunctionValue(points[iPoint]);
+			}
+			catch (...)
+			{
+				#pragma omp critical
+				nFailedPointId = std::min(nFailedPointId, iPoint);
+			}
+		}
+	}
+
+	/* Merge culling counters. */
+	FOREACH(iterWorker, _workerEvaluators, vector<CGaussianVolumeOverlapEvaluator*>::iterator)
+	{
+		_cullingCounters.nCulledPairsCount += (*iterWorker)->_cullingCounters.nCulledPairsCount;
+		_cullingCounters.nPairsCount += (*iterWorker)->_cullingCounters.nPairsCount;
+		(*iterWorker)->_cullingCounters = CGaussianOverlapKernel::CullingCounters();
+	}
+
+	// If any point failed:
+	if (nFailedPointId < nPOINTS_COUNT)
+	{
+		values[nFailedPointId] = getFunctionValue(points[nFailedPointId]);
+	}
+}
+
+
+/**
+ * Description: Calculate the Gaussian volume overlap together with its gradient with respect to the transformation parameters.
+ *	First order overlap and the derivatives with respect to each fit atom come from one pass of the gradient kernel, sharing the exp()
+ *	terms, then are chained through the rigid transformation: translation derivatives are the sums of atom derivatives, and rotation
+ *	derivatives contract the atom derivatives with the derivatives of rotation matrix applied to the original fit coordinates, with
+ *	respect to the Euler angles or to the rotation vector.
+ *	The analytic kernel is used even when a density grid is set, since interpolated overlap is not differentiable at cell faces, and
+ *	culling counters are not updated. Higher order overlap is differentiated by central differences of getFunctionValue().
+ * @param params: (IN) Transformation parameters, see getFunctionValue().
+ * @param gradient: (OUT) Derivatives of the returned value with respect to each parameter.
+ * @return: Same value as getFunctionValue() of the analytic kernel.
+ */
+double CGaussianVolumeOverlapEvaluator::getFunctionValueAndGradient(const std::vector<double>& params, std::vector<double>& gradient)
+{
+	gradient.assign(params.size(), 0.0);
+
+	// If higher order overlap:
+	if (getMaxIntersectionOrder() > 1)
+	{
+		vector<double> shiftedParams(params);
+		for (int iDimension = 0; iDimension < static_cast<int>(params.size()); ++ iDimension)
+		{
+			shiftedParams[iDimension] = params[iDimension] + dGRADIENT_DIFFERENCE_STEP;
+			const double dForwardValue = getFunctionValue(shiftedParams);
+			shiftedParams[iDimension] = params[iDimension] - dGRADIENT_DIFFERENCE_STEP;
+			const double dBackwardValue = getFunctionValue(shiftedParams);
+			shiftedParams[iDimension] = params[iDimension];
+
+			gradient[iDimension] = (dForwardValue - dBackwardValue) / (2 * dGRADIENT_DIFFERENCE_STEP);
+		}
+
+		return getFunctionValue(params);
+	}
+
+	attemptInitialize();
+
+	/* Apply transformation. */
+	transformFitAtomCoordinates(params);
+
+	/* Get overlap volume and derivatives with respect to each fit atom. */
+	const int nFIT_ATOMS_COUNT = _fitPreparedMolecule.radii.size();
+	double* const pXGradients = nFIT_ATOMS_COUNT > 0 ? &_fitXGradients[0] : NULL;
+	double* const pYGradients = nFIT_ATOMS_COUNT > 0 ? &_fitYGradients[0] : NULL;
+	double* const pZGradients = nFIT_ATOMS_COUNT > 0 ? &_fitZGradients[0] : NULL;
+	const double dOverlap = CGaussianOverlapKernel::calculateOverlapVolumeAndGradients(
+		*_pRefPreparedMolecule, _fitPreparedMoleculeBuffer, getGaussianCutoff(), pXGradients, pYGradients, pZGradients);
+
+	/* Chain through the transformation. */
+	// sums of atom derivatives along each axis times original fit coordinates along each axis
+	double aadMoments[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+	for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+	{
+		const double adGradients[3] = {pXGradients[iFitAtom], pYGradients[iFitAtom], pZGradients[iFitAtom]};
+		const double adCoordinates[3] = {
+			_fitPreparedMolecule.xCoordinates[iFitAtom],
+			_fitPreparedMolecule.yCoordinates[iFitAtom],
+			_fitPreparedMolecule.zCoordinates[iFitAtom]
+			};
+		for (int i = 0; i < 3; ++ i)
+		{
+			gradient[i] += adGradients[i];
+			for (int j = 0; j < 3; ++ j)
+			{
+				aadMoments[i][j] += adGradients[i] * adCoordinates[j];
+			}
+		}
+	}
+
+	double aaadRotationDerivatives[3][3][3];
+	// If rotation vector:
+	if (getPoseParameterization() == PoseParameterizations::nROTATION_VECTOR)
+	{
+		getRotationVectorDerivatives(&params[3], aaadRotationDerivatives);
+	}
+	// If Euler angles:
 	else
 	{
-		std::stringstream msgStream;
-		msgStream 
-			<< LOCATION_STREAM_INSERTION
-			<< "Bad cast! "
-			<< "Member variable _pFitMolecule can not be clone to IMolecule interface! ";
-		throw CBadCastException(msgStream.str());
+		const double adSINES[3] = {sin(params[3]), sin(params[4]), sin(params[5])};
+		const double adCOSINES[3] = {cos(params[3]), cos(params[4]), cos(params[5])};
+		getRotationDerivatives(adSINES, adCOSINES, aaadRotationDerivatives);
+	}
+	for (int iAngle = 0; iAngle < 3; ++ iAngle)
+	{
+		for (int i = 0; i < 3; ++ i)
+		{
+			for (int j = 0; j < 3; ++ j)
+			{
+				gradient[3 + iAngle] += aaadRotationDerivatives[iAngle][i][j] * aadMoments[i][j];
+			}
+		}
+	}
+
+	// If negative overlap:
+	if (_bNegativeOverlap)
+	{
+		for (int iDimension = 0; iDimension < static_cast<int>(gradient.size()); ++ iDimension)
+		{
+			gradient[iDimension] = -gradient[iDimension];
+		}
+		return -1 * dOverlap;
+	}
+	// If positive overlap:
+	else
+	{
+		return dOverlap;
 	}
 }
 
 
+/**
+ * Description: Get the number of threads to evaluate a batch on: the threads count, or the number of processors for 0, no more than
+ *	the number of points. One thread if built without OpenMP or if already running in a parallel region, e.g. on a clone.
+ * @param nPointsCount: (IN)
+ * @return:
+ */
+int CGaussianVolumeOverlapEvaluator::getWorkersCount(const int nPointsCount) const
+{
+	int nWorkersCount = 1;
+#ifdef _OPENMP
+	// If not nested in threads:
+	if (!omp_in_parallel())
+	{
+		nWorkersCount = _nThreadsCount > 0 ? _nThreadsCount : omp_get_num_procs();
+	}
+#endif
+
+	return std::max(1, std::min(nWorkersCount, nPointsCount));
+}
+
+
+/**
+ * Description: Get the rigid transformation of the parameters as one 3 x 4 matrix, rotation first, translation then.
+ * @param params: (IN) Transformation parameters, see getFunctionValue().
+ * @param aadTransformation: (OUT) Rotation matrix in the first three columns, translation in the last column.
+ */
+void CGaussianVolumeOverlapEvaluator::getRigidTransformation(const std::vector<double>& params, double aadTransformation[3][4]) const
+{
+	double aadRotation[3][3];
+	// If rotation vector:
+	if (getPoseParameterization() == PoseParameterizations::nROTATION_VECTOR)
+	{
+		CMathematics::rotationVectorToRotationMatrix(&params[3], aadRotation);
+	}
+	// If Euler angles:
+	else
+	{
+		CMathematics::eulerAnglesToRotationMatrix(&params[3], aadRotation);
+	}
+
+	for (int i = 0; i < 3; ++ i)
+	{
+		for (int j = 0; j < 3; ++ j)
+		{
+			aadTransformation[i][j] = aadRotation[i][j];
+		}
+		aadTransformation[i][3] = params[i];
+	}
+}
+
+
+/**
+ * Description: Apply the rigid transformation to the original fit coordinates and store the result in the prepared molecule buffer.
+ *	The transformation is fused into one 3 x 4 matrix once per pose, so that each atom and block center costs 9 multiplications and
+ *	9 additions. Results agree with transforming a molecule clone by IMolecule::rotateXYZ() and IMolecule::move() up to rounding.
+ * @param params: (IN) Transformation parameters, see getFunctionValue().
+ */
+int CGaussianVolumeOverlapEvaluator::transformFitAtomCoordinates(const std::vector<double>& params)
+{
+	double aadTransformation[3][4];
+	getRigidTransformation(params, aadTransformation);
+
+	const int nFIT_ATOMS_COUNT = _fitPreparedMolecule.radii.size();
+	const double* const pX = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMolecule.xCoordinates[0] : NULL;
+	const double* const pY = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMolecule.yCoordinates[0] : NULL;
+	const double* const pZ = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMolecule.zCoordinates[0] : NULL;
+	double* const pNewX = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.xCoordinates[0] : NULL;
+	double* const pNewY = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.yCoordinates[0] : NULL;
+	double* const pNewZ = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.zCoordinates[0] : NULL;
+	for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+	{
+		double dX = pX[iFitAtom];
+		double dY = pY[iFitAtom];
+		double dZ = pZ[iFitAtom];
+		transformPoint(aadTransformation, dX, dY, dZ);
+
+		pNewX[iFitAtom] = dX;
+		pNewY[iFitAtom] = dY;
+		pNewZ[iFitAtom] = dZ;
+	}
+
+	/* Bounding spheres move along with atoms, radii are invariant. */
+	_fitPreparedMoleculeBuffer.dBoundingXCenter = _fitPreparedMolecule.dBoundingXCenter;
+	_fitPreparedMoleculeBuffer.dBoundingYCenter = _fitPreparedMolecule.dBoundingYCenter;
+	_fitPreparedMoleculeBuffer.dBoundingZCenter = _fitPreparedMolecule.dBoundingZCenter;
+	transformPoint(aadTransformation,
+		_fitPreparedMoleculeBuffer.dBoundingXCenter, _fitPreparedMoleculeBuffer.dBoundingYCenter, _fitPreparedMoleculeBuffer.dBoundingZCenter);
+	const int nFIT_BLOCKS_COUNT = _fitPreparedMolecule.blockRadii.size();
+	for (int iFitBlock = 0; iFitBlock < nFIT_BLOCKS_COUNT; ++ iFitBlock)
+	{
+		double dX = _fitPreparedMolecule.blockXCenters[iFitBlock];
+		double dY = _fitPreparedMolecule.blockYCenters[iFitBlock];
+		double dZ = _fitPreparedMolecule.blockZCenters[iFitBlock];
+		transformPoint(aadTransformation, dX, dY, dZ);
+
+		_fitPreparedMoleculeBuffer.blockXCenters[iFitBlock] = dX;
+		_fitPreparedMoleculeBuffer.blockYCenters[iFitBlock] = dY;
+		_fitPreparedMoleculeBuffer.blockZCenters[iFitBlock] = dZ;
+	}
+
+	/* Refresh single precision copies for float kernels. */
+	// If single precision:
+	if (_kernelSettings.getPrecision() == CGaussianOverlapKernel::Precisions::nFLOAT)
+	{
+		float* const pNewFloatX = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.floatXCoordinates[0] : NULL;
+		float* const pNewFloatY = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.floatYCoordinates[0] : NULL;
+		float* const pNewFloatZ = nFIT_ATOMS_COUNT > 0 ? &_fitPreparedMoleculeBuffer.floatZCoordinates[0] : NULL;
+		for (int iFitAtom = 0; iFitAtom < nFIT_ATOMS_COUNT; ++ iFitAtom)
+		{
+			pNewFloatX[iFitAtom] = static_cast<float>(pNewX[iFitAtom]);
+			pNewFloatY[iFitAtom] = static_cast<float>(pNewY[iFitAtom]);
+			pNewFloatZ[iFitAtom] = static_cast<float>(pNewZ[iFitAtom]);
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description:
+ * @return: Counters of atom pairs skipped by bounding sphere culling, over all evaluations so far.
+ */
+const CGaussianOverlapKernel::CullingCounters& CGaussianVolumeOverlapEvaluator::getCullingCounters() const
+{
+	return _cullingCounters;
+}
+
+
+/**
+ * Description:
+ * @return: Density grid in use, NULL pointer for the analytic kernel.
+ */
+const CGaussianDensityGrid* CGaussianVolumeOverlapEvaluator::getDensityGrid() const
+{
+	return _pDensityGrid;
+}
+
+
 /**
  * Description:
  */
@@ -168,6 +786,25 @@ double CGaussianVolumeOverlapEvaluator::getGaussianCutoff() const
 }
 
 
+/**
+ * Description:
+ */
+double CGaussianVolumeOverlapEvaluator::getIntersectionVolumeEpsilon() const
+{
+	return _dIntersectionVolumeEpsilon;
+}
+
+
+/**
+ * Description:
+ * @return: Accuracy and precision mode of the first order overlap kernel.
+ */
+const CGaussianOverlapKernel::CSettings& CGaussianVolumeOverlapEvaluator::getKernelSettings() const
+{
+	return _kernelSettings;
+}
+
+
 /**
  * Description:
  */
@@ -186,6 +823,61 @@ bool CGaussianVolumeOverlapEvaluator::getNegativeOverlapFlag() const
 }
 
 
+/**
+ * Description:
+ * @return: Cross neighbor list in use, NULL pointer if disabled or before the first evaluation.
+ */
+const CCrossNeighborList* CGaussianVolumeOverlapEvaluator::getNeighborList() const
+{
+	return _neighborListPtr.get();
+}
+
+
+/**
+ * Description:
+ */
+double CGaussianVolumeOverlapEvaluator::getNeighborListSkin() const
+{
+	return _dNeighborListSkin;
+}
+
+
+/**
+ * Description:
+ * @return: Parameterization of rotation in transformation parameters, see PoseParameterizations.
+ */
+int CGaussianVolumeOverlapEvaluator::getPoseParameterization() const
+{
+	return _nPoseParameterization;
+}
+
+
+/**
+ * Description:
+ * @return: Number of threads evaluating a batch of points, 0 for one per processor.
+ */
+int CGaussianVolumeOverlapEvaluator::getThreadsCount() const
+{
+	return _nThreadsCount;
+}
+
+
+/**
+ * Description: Set density grid of reference molecule as first order overlap backend, taking effect on the next evaluation.
+ *	The grid must be sampled from the same reference molecule with the same Gaussian cutoff.
+ * @param pDensityGrid: (IN) Not copied, must live longer than this evaluator. NULL pointer for the analytic kernel.
+ */
+void CGaussianVolumeOverlapEvaluator::setDensityGrid(const CGaussianDensityGrid* pDensityGrid)
+{
+	// If changed:
+	if (pDensityGrid != _pDensityGrid)
+	{
+		_pDensityGrid = pDensityGrid;
+		_bInitForGaussianVolumeBuilder = false;
+	}
+}
+
+
 /**
  * Description:
  */
@@ -194,7 +886,12 @@ void CGaussianVolumeOverlapEvaluator::setGaussianCutoff(const double dCutoff)
 	// If valid parameter:
 	if (dCutoff >= 0)
 	{
-		_dGaussianCutoff = dCutoff;
+		// If changed:
+		if (dCutoff != _dGaussianCutoff)
+		{
+			_dGaussianCutoff = dCutoff;
+			_bInitForGaussianVolumeBuilder = false;
+		}
 	}
 	// If invalid parameter:
 	else
@@ -209,6 +906,45 @@ void CGaussianVolumeOverlapEvaluator::setGaussianCutoff(const double dCutoff)
 }
 
 
+/**
+ * Description:
+ */
+void CGaussianVolumeOverlapEvaluator::setIntersectionVolumeEpsilon(const double dEpsilon)
+{
+	// If valid parameter:
+	if (dEpsilon >= 0)
+	{
+		// If changed:
+		if (dEpsilon != _dIntersectionVolumeEpsilon)
+		{
+			_dIntersectionVolumeEpsilon = dEpsilon;
+			_bInitForGaussianVolumeBuilder = false;
+		}
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dEpsilon = " << dEpsilon;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set accuracy and precision mode of the first order overlap kernel, taking effect at once. Gradients and higher order
+ *	overlap always run in exact double precision.
+ * @param kernelSettings: (IN)
+ */
+void CGaussianVolumeOverlapEvaluator::setKernelSettings(const CGaussianOverlapKernel::CSettings& kernelSettings)
+{
+	_kernelSettings = kernelSettings;
+}
+
+
 /**
  * Description:
  */
@@ -217,7 +953,12 @@ void CGaussianVolumeOverlapEvaluator::setMaxIntersectionOrder(const int nOrders)
 	// If valid parameter:
 	if (nOrders > 0)
 	{
-		_nMaxIntersectionOrder = nOrders;
+		// If changed:
+		if (nOrders != _nMaxIntersectionOrder)
+		{
+			_nMaxIntersectionOrder = nOrders;
+			_bInitForGaussianVolumeBuilder = false;
+		}
 	}
 	// If invalid parameter:
 	else
@@ -239,3 +980,82 @@ void CGaussianVolumeOverlapEvaluator::setNegativeOverlapFlag(const bool bFlag)
 {
 	_bNegativeOverlap = bFlag;
 }
+
+
+/**
+ * Description: Set skin distance of the cross neighbor list, taking effect on the next evaluation.
+ * @param dSkin: (IN) 0 to test all atom pairs on each evaluation.
+ */
+void CGaussianVolumeOverlapEvaluator::setNeighborListSkin(const double dSkin)
+{
+	// If valid parameter:
+	if (dSkin >= 0)
+	{
+		// If changed:
+		if (dSkin != _dNeighborListSkin)
+		{
+			_dNeighborListSkin = dSkin;
+			_bInitForGaussianVolumeBuilder = false;
+		}
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dSkin = " << dSkin;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set how params[3], params[4] and params[5] of transformation parameters encode rotation, taking effect at once.
+ *	Rotation vectors have no gimbal lock, and a rotation of small angle about any axis is a small step in each component.
+ * @param nPoseParameterization: (IN) See PoseParameterizations.
+ */
+void CGaussianVolumeOverlapEvaluator::setPoseParameterization(const int nPoseParameterization)
+{
+	// If valid parameter:
+	if (nPoseParameterization == PoseParameterizations::nEULER_ANGLES || nPoseParameterization == PoseParameterizations::nROTATION_VECTOR)
+	{
+		_nPoseParameterization = nPoseParameterization;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nPoseParameterization = " << nPoseParameterization;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description: Set the number of threads evaluating a batch of points by getFunctionValues(), each extra thread on a clone of this
+ *	evaluator kept until destruction. Has no effect if built without OpenMP.
+ * @param nThreadsCount: (IN) 0 for one per processor.
+ */
+void CGaussianVolumeOverlapEvaluator::setThreadsCount(const int nThreadsCount)
+{
+	// If valid parameter:
+	if (nThreadsCount >= 0)
+	{
+		_nThreadsCount = nThreadsCount;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nThreadsCount = " << nThreadsCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
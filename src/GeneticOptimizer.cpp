@@ -16,15 +16,22 @@
 #include "Exception.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
 #include <limits>
 #include <cmath>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using std::abs;
+using std::auto_ptr;
 using std::string;
 using std::numeric_limits;
 using std::vector;
@@ -43,8 +50,10 @@ const string CGeneticOptimizer::MessageTexts::sINVALID_PROBABILITY("Invalid prob
 
 const double CGeneticOptimizer::DefaultValues::dCROSSOVER_PROBABILITY = 0.75;
 const double CGeneticOptimizer::DefaultValues::dDEFAULT_MUTATION_MAGNITUDE_PERCENTAGE = 0.3;
+const int CGeneticOptimizer::DefaultValues::nELITES_COUNT = 0;
 const int CGeneticOptimizer::DefaultValues::nMAX_ITERATIONS = 200;
 const double CGeneticOptimizer::DefaultValues::dMUTATION_PROBABILITY = 0.05;
+const int CGeneticOptimizer::DefaultValues::nTHREADS_COUNT = 1;
 
 
 /**
@@ -60,7 +69,10 @@ CGeneticOptimizer::CGeneticOptimizer(IFunctionValueEvaluator& fitnessEvaluator,
 	_fitnessEvaluator(fitnessEvaluator),
 	_nGENE_AMOUNT_PER_CHROMOSOME(initialPopulation.front().size()),
 	_nPOPULATION_SIZE(initialPopulation.size()),
-	_newPopulation(_newPopulation)
+	_newPopulation(initialPopulation),
+	_nElitesCount(DefaultValues::nELITES_COUNT),
+	_nRandomState(0),
+	_nThreadsCount(DefaultValues::nTHREADS_COUNT)
 {
 	/* Validate dimensions of the initial population. */
 	FOREACH(iterChromosome, initialPopulation, vector<vector<double> >::const_iterator)
@@ -84,8 +96,7 @@ CGeneticOptimizer::CGeneticOptimizer(IFunctionValueEvaluator& fitnessEvaluator,
 	setMaxIterations(DefaultValues::nMAX_ITERATIONS);
 	setMutationProbability(DefaultValues::dMUTATION_PROBABILITY);
 	setMutationMagnitudeByPercentage(DefaultValues::dDEFAULT_MUTATION_MAGNITUDE_PERCENTAGE);
-
-	srand(static_cast<unsigned int>(time(NULL)));
+	setRandomSeed(static_cast<unsigned int>(time(NULL)));
 }
 
 
@@ -94,6 +105,10 @@ CGeneticOptimizer::CGeneticOptimizer(IFunctionValueEvaluator& fitnessEvaluator,
  */
 CGeneticOptimizer::~CGeneticOptimizer()
 {
+	FOREACH(iterClone, _workerClones, vector<ICloneable*>::iterator)
+	{
+		delete *iterClone;
+	}
 }
 
 
@@ -105,6 +120,8 @@ CGeneticOptimizer::~CGeneticOptimizer()
  */
 int CGeneticOptimizer::runOptimization(std::vector<double>& resultants, double& dBestFitness)
 {
+	_nRandomState = _nRandomSeed;
+
 	// For each generation:
 	for (int iGeneration = 0; iGeneration < _nMaxIterations; iGeneration++)
 	{
@@ -118,7 +135,7 @@ int CGeneticOptimizer::runOptimization(std::vector<double>& resultants, double&
 			int nParentIdB = randomCompetitionSelectIndividual();
 
 			/* Crossover takes place by probability. */
-			double dProbability = rand() / static_cast<double>(RAND_MAX);
+			double dProbability = getRandomNumber();
 			if (dProbability <= _dCrossoverProbability)
 			{
 				crossover(_currentPopulation[nParentIdA], _currentPopulation[nParentIdB], _newPopulation[2 * iCouple], _newPopulation[2 * iCouple + 1]);
@@ -135,7 +152,7 @@ int CGeneticOptimizer::runOptimization(std::vector<double>& resultants, double&
 			int nParentIdA = randomCompetitionSelectIndividual();
 			int nParentIdB = randomCompetitionSelectIndividual();
 
-			double dProbability = rand() / static_cast<double>(RAND_MAX);
+			double dProbability = getRandomNumber();
 			if (dProbability <= _dCrossoverProbability)
 			{
 				crossover(_currentPopulation[nParentIdA], _currentPopulation[nParentIdB], _newPopulation[_nPOPULATION_SIZE - 1], _newPopulation[_nPOPULATION_SIZE - 1]);
@@ -169,6 +186,8 @@ int CGeneticOptimizer::runOptimization(std::vector<double>& resultants, double&
  */
 int CGeneticOptimizer::traceOptimization(std::vector<std::vector<double> >& trajectory)
 {
+	_nRandomState = _nRandomSeed;
+
 	// For each generation:
 	for (int iGeneration = 0; iGeneration < _nMaxIterations; iGeneration++)
 	{
@@ -195,7 +214,7 @@ int CGeneticOptimizer::traceOptimization(std::vector<std::vector<double> >& traj
 			int nParentIdB = randomCompetitionSelectIndividual();
 
 			/* Crossover takes place by probability. */
-			double dProbability = rand() / static_cast<double>(RAND_MAX);
+			double dProbability = getRandomNumber();
 			if (dProbability <= _dCrossoverProbability)
 			{
 				crossover(_currentPopulation[nParentIdA], _currentPopulation[nParentIdB], _newPopulation[2 * iCouple], _newPopulation[2 * iCouple + 1]);
@@ -212,7 +231,7 @@ int CGeneticOptimizer::traceOptimization(std::vector<std::vector<double> >& traj
 			int nParentIdA = randomCompetitionSelectIndividual();
 			int nParentIdB = randomCompetitionSelectIndividual();
 
-			double dProbability = rand() / static_cast<double>(RAND_MAX);
+			double dProbability = getRandomNumber();
 			if (dProbability <= _dCrossoverProbability)
 			{
 				crossover(_currentPopulation[nParentIdA], _currentPopulation[nParentIdB], _newPopulation[_nPOPULATION_SIZE - 1], _newPopulation[_nPOPULATION_SIZE - 1]);
@@ -242,11 +261,11 @@ int CGeneticOptimizer::traceOptimization(std::vector<std::vector<double> >& traj
  */
 int CGeneticOptimizer::crossover(const std::vector<double>& oldChromosome1, const std::vector<double>& oldChromosome2, std::vector<double>& newChromosome1, std::vector<double>& newChromosome2)
 {
-	double dRandom = rand()  / static_cast<double>(RAND_MAX);
+	double dRandom = getRandomNumber();
 	// crossover position, range [0, _nGENE_AMOUNT_PER_CHROMOSOME - 1]
 	const int nCROSSOVER_POSITION = static_cast<int>(floor(dRandom * (_nGENE_AMOUNT_PER_CHROMOSOME - 1)));
 	// crossover factor
-	const double dRANDOM_FACTOR = rand() / static_cast<double>(RAND_MAX);
+	const double dRANDOM_FACTOR = getRandomNumber();
 
 	// For genes crossed:
 	for (int i = nCROSSOVER_POSITION; i < _nGENE_AMOUNT_PER_CHROMOSOME; i++)
@@ -287,6 +306,50 @@ int CGeneticOptimizer::getBestIndividualId() const
 }
 
 
+/**
+ * Description: Draw the next number of the random numbers stream, by the SplitMix64 generator.
+ * @return: Uniform random number in range [0, 1].
+ */
+double CGeneticOptimizer::getRandomNumber()
+{
+	_nRandomState += 0x9E3779B97F4A7C15ULL;
+	unsigned long long nMixed = _nRandomState;
+	nMixed = (nMixed ^ (nMixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	nMixed = (nMixed ^ (nMixed >> 27)) * 0x94D049BB133111EBULL;
+	nMixed ^= nMixed >> 31;
+
+	// 53 high bits, as many as a double holds exactly
+	return (nMixed >> 11) / 9007199254740991.0;
+}
+
+
+/**
+ * Description: Get the number of threads to evaluate fitness on: the threads count, or the number of processors for 0, no more than
+ *	the population size. Fitness is evaluated by the batch of the evaluator itself if built without OpenMP, if already running in a
+ *	parallel region, or if the evaluator can not be cloned.
+ * @return:
+ */
+int CGeneticOptimizer::getWorkersCount() const
+{
+	// If evaluator can not be cloned:
+	if (!dynamic_cast<const ICloneable*>(&_fitnessEvaluator))
+	{
+		return 1;
+	}
+
+	int nWorkersCount = 1;
+#ifdef _OPENMP
+	// If not nested in threads:
+	if (!omp_in_parallel())
+	{
+		nWorkersCount = _nThreadsCount > 0 ? _nThreadsCount : omp_get_num_procs();
+	}
+#endif
+
+	return std::max(1, std::min(nWorkersCount, _nPOPULATION_SIZE));
+}
+
+
 /**
  * Description:
  * @param dAttenuation:
@@ -307,11 +370,11 @@ int CGeneticOptimizer::mutateNewPopulation(double dAttenuation)
 		for (int i = 0; i < _nGENE_AMOUNT_PER_CHROMOSOME; i++)
 		{
 			/* Mutation takes place by probability. */
-			double dProbability = rand() / static_cast<double>(RAND_MAX);
+			double dProbability = getRandomNumber();
 			if (dProbability <= _dMutationProbability)
 			{
 				// range [-1, +1]
-				double dPerturbation = 2 * (rand() / static_cast<double>(RAND_MAX));
+				double dPerturbation = 2 * getRandomNumber() - 1;
 				// range [-|magnitude|, +|magnitude|]
 				dPerturbation *= _mutationMagnitude[i];
 
@@ -328,11 +391,11 @@ int CGeneticOptimizer::mutateNewPopulation(double dAttenuation)
  * Description: Select a single chromosome by roulette method based on their fitness.
  * @return: ID of the chromosome been selected.
  */
-int CGeneticOptimizer::rouletteSelectIndividual() const
+int CGeneticOptimizer::rouletteSelectIndividual()
 {
 	static const string sLOCATION("CGeneticOptimizer::rouletteSelectIndividual(): ");
 
-	double dRandom = rand() / static_cast<double>(RAND_MAX);
+	double dRandom = getRandomNumber();
 	dRandom *= _dTotalFitness;
 
 	/* Calculate accumulated sum. */
@@ -357,28 +420,45 @@ int CGeneticOptimizer::rouletteSelectIndividual() const
 
 
 /**
- * Description: Select a single chromosome by ramdom competition method which is based on roulette selection.
+ * Description: Select a single chromosome by ramdom competition method which is based on roulette selection. Fitness of current
+ *	population is already up to date, so that no evaluation is needed.
  * @return: ID of the chromosome been selected.
  */
-int CGeneticOptimizer::randomCompetitionSelectIndividual() const
+int CGeneticOptimizer::randomCompetitionSelectIndividual()
 {
 	int nIndividualId1 = rouletteSelectIndividual();
 	int nIndividualId2 = rouletteSelectIndividual();
 
-	const vector<double>& chromosome1 = _currentPopulation[nIndividualId1];
-	const vector<double>& chromosome2 = _currentPopulation[nIndividualId2];
-	double dFitness1 = _fitnessEvaluator.getFunctionValue(chromosome1);
-	double dFitness2 = _fitnessEvaluator.getFunctionValue(chromosome2);
+	double dFitness1 = _populationFitness[nIndividualId1];
+	double dFitness2 = _populationFitness[nIndividualId2];
 
 	return (dFitness1 > dFitness2) ? nIndividualId1 : nIndividualId2;
 }
 
 
 /**
- * Description:
+ * Description: Replace current population with new population, except that the fittest individuals of current population, as
+ *	evaluated last, survive unchanged in place of the last individuals of new population.
  */
 int CGeneticOptimizer::replaceCurrentPopulation()
 {
+	/* Keep elites. */
+	// If elites kept:
+	if (_nElitesCount > 0)
+	{
+		vector<std::pair<double, int> > rankedIndividuals;
+		for (int i = 0; i < _nPOPULATION_SIZE; i++)
+		{
+			rankedIndividuals.push_back(std::make_pair(-_populationFitness[i], i));
+		}
+		std::stable_sort(rankedIndividuals.begin(), rankedIndividuals.end());
+
+		for (int iElite = 0; iElite < _nElitesCount; iElite++)
+		{
+			_newPopulation[_nPOPULATION_SIZE - 1 - iElite] = _currentPopulation[rankedIndividuals[iElite].second];
+		}
+	}
+
 	_currentPopulation = _newPopulation;
 
 	return ErrorCodes::nNORMAL;
@@ -386,24 +466,117 @@ int CGeneticOptimizer::replaceCurrentPopulation()
 
 
 /**
- * Description: Calculate current population's individual fitness and fitness sum.
+ * Description: Calculate current population's individual fitness and fitness sum. With several threads, the evaluator takes
+ *	individuals 0, n, 2n... and the clone of each extra thread the individuals following those; clones are made on first use and
+ *	kept until destruction. Exceptions do not leave threads: the first failed individual is evaluated again by the evaluator after
+ *	all threads, to throw.
+ * @exception:
+ *	CBadCastException:
  */
 int CGeneticOptimizer::updatePopulationFitness()
 {
-	// Calculate and store fitness for each chromosome.
+	const int nWORKERS_COUNT = getWorkersCount();
+	// If one thread:
+	if (nWORKERS_COUNT <= 1)
+	{
+		// Calculate and store fitness for each chromosome in one batch.
+		_fitnessEvaluator.getFunctionValues(_currentPopulation, _populationFitness);
+	}
+	// If several threads:
+	else
+	{
+		/* Clone one evaluator per extra thread before starting threads. */
+		const ICloneable& cloneableEvaluator = dynamic_cast<const ICloneable&>(_fitnessEvaluator);
+		while (static_cast<int>(_workerEvaluators.size()) < nWORKERS_COUNT - 1)
+		{
+			auto_ptr<ICloneable> clonePtr(cloneableEvaluator.clone());
+			IFunctionValueEvaluator* const pEvaluator = dynamic_cast<IFunctionValueEvaluator*>(clonePtr.get());
+			// If type cast failure:
+			if (!pEvaluator)
+			{
+				std::stringstream msgStream;
+				msgStream
+					<< LOCATION_STREAM_INSERTION
+					<< "Bad cast! "
+					<< "The clone of evaluator is not an instance of IFunctionValueEvaluator interface! ";
+				throw CBadCastException(msgStream.str());
+			}
+			_workerClones.push_back(clonePtr.release());
+			_workerEvaluators.push_back(pEvaluator);
+		}
+
+		/* Exceptions must not leave threads: remember the first failed individual, and evaluate it again afterwards to throw. */
+		int nFailedId = _nPOPULATION_SIZE;
+		#pragma omp parallel for num_threads(nWORKERS_COUNT) schedule(static, 1)
+		for (int iWorker = 0; iWorker < nWORKERS_COUNT; ++ iWorker)
+		{
+			IFunctionValueEvaluator& evaluator = iWorker == 0 ? _fitnessEvaluator : *_workerEvaluators[iWorker - 1];
+			for (int i = iWorker; i < _nPOPULATION_SIZE; i += nWORKERS_COUNT)
+			{
+				try
+				{
+					_populationFitness[i] = evaluator.getFunctionValue(_currentPopulation[i]);
+				}
+				catch (...)
+				{
+					#pragma omp critical
+					nFailedId = std::min(nFailedId, i);
+				}
+			}
+		}
+		// If any individual failed:
+		if (nFailedId < _nPOPULATION_SIZE)
+		{
+			_populationFitness[nFailedId] = _fitnessEvaluator.getFunctionValue(_currentPopulation[nFailedId]);
+		}
+	}
+
+	// Sum in order, so that the total does not depend on how the batch is evaluated.
 	_dTotalFitness = 0.0;
 	for (int i = 0; i < _nPOPULATION_SIZE; i++)
 	{
-		const vector<double>& chromosome = _currentPopulation[i];
-		double dFitness = _fitnessEvaluator.getFunctionValue(chromosome);
-		_populationFitness[i] = dFitness;
-		_dTotalFitness += dFitness;
+		_dTotalFitness += _populationFitness[i];
 	}
 
 	return ErrorCodes::nNORMAL;
 }
 
 
+/**
+ * Description: Get the fittest distinct individuals of the final population of the last run, e.g. to refine them with a local
+ *	optimizer. Copies of an individual, common as selection clones parents, count once.
+ * @param nCount: (IN) Max number of individuals to get.
+ * @param individuals: (OUT) Individuals in descending order of fitness.
+ * @param fitness: (OUT) Fitness of each individual.
+ * @return: Number of individuals got.
+ */
+int CGeneticOptimizer::getBestIndividuals(const int nCount, std::vector<std::vector<double> >& individuals, std::vector<double>& fitness) const
+{
+	/* Sort individuals by fitness, best first. */
+	vector<std::pair<double, int> > rankedIndividuals;
+	for (int i = 0; i < static_cast<int>(_populationFitness.size()); i++)
+	{
+		rankedIndividuals.push_back(std::make_pair(-_populationFitness[i], i));
+	}
+	std::stable_sort(rankedIndividuals.begin(), rankedIndividuals.end());
+
+	individuals.clear();
+	fitness.clear();
+	for (int iRank = 0; iRank < static_cast<int>(rankedIndividuals.size()) && static_cast<int>(individuals.size()) < nCount; iRank++)
+	{
+		const vector<double>& individual = _currentPopulation[rankedIndividuals[iRank].second];
+		// If not a copy of a got individual:
+		if (std::find(individuals.begin(), individuals.end(), individual) == individuals.end())
+		{
+			individuals.push_back(individual);
+			fitness.push_back(-rankedIndividuals[iRank].first);
+		}
+	}
+
+	return individuals.size();
+}
+
+
 /**
  * Description:
  */
@@ -413,6 +586,16 @@ double CGeneticOptimizer::getCrossoverProbability() const
 }
 
 
+/**
+ * Description:
+ * @return: Number of fittest individuals surviving unchanged to the next generation.
+ */
+int CGeneticOptimizer::getElitesCount() const
+{
+	return _nElitesCount;
+}
+
+
 /**
  * Description:
  */
@@ -440,6 +623,26 @@ double CGeneticOptimizer::getMutationProbability() const
 }
 
 
+/**
+ * Description:
+ * @return: Seed each run restarts the random numbers stream from.
+ */
+unsigned int CGeneticOptimizer::getRandomSeed() const
+{
+	return _nRandomSeed;
+}
+
+
+/**
+ * Description:
+ * @return: Number of threads evaluating fitness of a population, 0 for one per processor.
+ */
+int CGeneticOptimizer::getThreadsCount() const
+{
+	return _nThreadsCount;
+}
+
+
 /**
  * Description:
  * @param dProbability:
@@ -512,6 +715,31 @@ void CGeneticOptimizer::setMutationMagnitudeByPercentage(double dPercentage)
 }
 
 
+/**
+ * Description:
+ * @param nElitesCount: (IN) Number of fittest individuals surviving unchanged to the next generation, 0 for none.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGeneticOptimizer::setElitesCount(int nElitesCount)
+{
+	// If valid parameter:
+	if (nElitesCount >= 0 && nElitesCount <= _nPOPULATION_SIZE)
+	{
+		_nElitesCount = nElitesCount;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_PARAMETER
+			<< "Detail: nElitesCount = " << nElitesCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
 /**
  * Description:
  */
@@ -555,3 +783,39 @@ void CGeneticOptimizer::setMutationProbability(double dProbability)
 		throw CInvalidArgumentException(msgStream.str());
 	}
 }
+
+
+/**
+ * Description: Set the seed of random numbers stream, each run restarting from it, so that runs with the same seed and population
+ *	give the same result. Defaults to the time of construction.
+ * @param nSeed: (IN)
+ */
+void CGeneticOptimizer::setRandomSeed(unsigned int nSeed)
+{
+	_nRandomSeed = nSeed;
+	_nRandomState = nSeed;
+}
+
+
+/**
+ * Description: Set the number of threads evaluating fitness of a population, each extra thread on a clone of the evaluator. Fitness
+ *	is evaluated by the batch of the evaluator itself if built without OpenMP or if the evaluator is not an ICloneable.
+ * @param nThreadsCount: (IN) 0 for one per processor.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CGeneticOptimizer::setThreadsCount(int nThreadsCount)
+{
+	/* Check parameters. */
+	if (nThreadsCount < 0)
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sINVALID_PARAMETER
+			<< "Detail: nThreadsCount = " << nThreadsCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+
+	_nThreadsCount = nThreadsCount;
+}
@@ -13,6 +13,7 @@
 
 #include "Mathematics.h"
 
+#include <algorithm>
 #include <math.h>
 
 
@@ -32,6 +33,157 @@ const std::string CMathematics::MessageTexts::sNOT_IN_3D_SPACE("Not in 3D space!
 
 /* Public Methods: */
 
+/**
+ * Description: Diagonalize a real symmetric matrix by cyclic Jacobi rotations.
+ * @param matrix: (IN) Square symmetric matrix, only its upper triangle is read.
+ * @param eigenValues: (OUT) Eigenvalues in descending order.
+ * @param eigenVectors: (OUT) Unit eigenvectors, eigenVectors[i] corresponding to eigenValues[i].
+ * @return:
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+int CMathematics::diagonalizeSymmetricMatrix(const std::vector<std::vector<double> >& matrix, std::vector<double>& eigenValues, std::vector<std::vector<double> >& eigenVectors)
+{
+	const int nDIMENSION = matrix.size();
+	// For each row:
+	for (int iRow = 0; iRow < nDIMENSION; ++ iRow)
+	{
+		// If not square:
+		if (static_cast<int>(matrix[iRow].size()) != nDIMENSION)
+		{
+			std::stringstream msgStream;
+			msgStream
+				<< LOCATION_STREAM_INSERTION
+				<< MessageTexts::sDIMENSION_NOT_MATCH;
+			throw CInvalidArgumentException(msgStream.str());
+		}
+	}
+
+	/* Symmetric working copy, and rotations accumulated in columns of identity. */
+	std::vector<std::vector<double> > workMatrix(matrix);
+	std::vector<std::vector<double> > rotations(nDIMENSION, std::vector<double>(nDIMENSION, 0.0));
+	for (int iRow = 0; iRow < nDIMENSION; ++ iRow)
+	{
+		rotations[iRow][iRow] = 1.0;
+		for (int iColumn = 0; iColumn < iRow; ++ iColumn)
+		{
+			workMatrix[iRow][iColumn] = workMatrix[iColumn][iRow];
+		}
+	}
+
+	/* Sweep off-diagonal elements until negligible. */
+	static const int nMAX_SWEEPS = 50;
+	for (int iSweep = 0; iSweep < nMAX_SWEEPS; ++ iSweep)
+	{
+		double dOffDiagonal = 0.0;
+		double dDiagonal = 0.0;
+		for (int iRow = 0; iRow < nDIMENSION; ++ iRow)
+		{
+			dDiagonal += fabs(workMatrix[iRow][iRow]);
+			for (int iColumn = iRow + 1; iColumn < nDIMENSION; ++ iColumn)
+			{
+				dOffDiagonal += fabs(workMatrix[iRow][iColumn]);
+			}
+		}
+		// If diagonal:
+		if (dOffDiagonal <= 1e-15 * dDiagonal || dOffDiagonal == 0.0)
+		{
+			break;
+		}
+
+		for (int p = 0; p < nDIMENSION; ++ p)
+		{
+			for (int q = p + 1; q < nDIMENSION; ++ q)
+			{
+				// If already zero:
+				if (workMatrix[p][q] == 0.0)
+				{
+					continue;
+				}
+
+				/* Rotation angle zeroing element (p, q). */
+				const double dTheta = (workMatrix[q][q] - workMatrix[p][p]) / (2 * workMatrix[p][q]);
+				const double dT = (dTheta >= 0 ? 1.0 : -1.0) / (fabs(dTheta) + sqrt(dTheta * dTheta + 1));
+				const double dC = 1 / sqrt(dT * dT + 1);
+				const double dS = dT * dC;
+
+				for (int k = 0; k < nDIMENSION; ++ k)
+				{
+					const double dKP = workMatrix[k][p];
+					const double dKQ = workMatrix[k][q];
+					workMatrix[k][p] = dC * dKP - dS * dKQ;
+					workMatrix[k][q] = dS * dKP + dC * dKQ;
+				}
+				for (int k = 0; k < nDIMENSION; ++ k)
+				{
+					const double dPK = workMatrix[p][k];
+					const double dQK = workMatrix[q][k];
+					workMatrix[p][k] = dC * dPK - dS * dQK;
+					workMatrix[q][k] = dS * dPK + dC * dQK;
+				}
+				for (int k = 0; k < nDIMENSION; ++ k)
+				{
+					const double dKP = rotations[k][p];
+					const double dKQ = rotations[k][q];
+					rotations[k][p] = dC * dKP - dS * dKQ;
+					rotations[k][q] = dS * dKP + dC * dKQ;
+				}
+			}
+		}
+	}
+
+	/* Sort by descending eigenvalue. */
+	std::vector<int> order(nDIMENSION);
+	for (int i = 0; i < nDIMENSION; ++ i)
+	{
+		order[i] = i;
+		for (int j = i; j > 0 && workMatrix[order[j]][order[j]] > workMatrix[order[j - 1]][order[j - 1]]; -- j)
+		{
+			std::swap(order[j], order[j - 1]);
+		}
+	}
+	eigenValues.resize(nDIMENSION);
+	eigenVectors.assign(nDIMENSION, std::vector<double>(nDIMENSION));
+	for (int i = 0; i < nDIMENSION; ++ i)
+	{
+		eigenValues[i] = workMatrix[order[i]][order[i]];
+		for (int k = 0; k < nDIMENSION; ++ k)
+		{
+			eigenVectors[i][k] = rotations[k][order[i]];
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Rotation matrix of rotations about X, then Y, then Z axis: R = Rz * Ry * Rx, the rotation applied by
+ *	IMolecule::rotateXYZ().
+ * @param adAngles: (IN) Rotation angles about X, Y and Z axis, in radians.
+ * @param aadRotation: (OUT)
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ */
+int CMathematics::eulerAnglesToRotationMatrix(const double adAngles[3], double aadRotation[3][3])
+{
+	const double dSA = sin(adAngles[0]), dSB = sin(adAngles[1]), dSG = sin(adAngles[2]);
+	const double dCA = cos(adAngles[0]), dCB = cos(adAngles[1]), dCG = cos(adAngles[2]);
+
+	aadRotation[0][0] = dCB * dCG;
+	aadRotation[0][1] = dSA * dSB * dCG - dCA * dSG;
+	aadRotation[0][2] = dCA * dSB * dCG + dSA * dSG;
+	aadRotation[1][0] = dCB * dSG;
+	aadRotation[1][1] = dSA * dSB * dSG + dCA * dCG;
+	aadRotation[1][2] = dCA * dSB * dSG - dSA * dCG;
+	aadRotation[2][0] = -dSB;
+	aadRotation[2][1] = dSA * dCB;
+	aadRotation[2][2] = dCA * dCB;
+
+	return ErrorCodes::nNORMAL;
+}
+
+
 /**
  * Description: Calculate factorical of n.
  * @param n: Variable, non-negative integer.
@@ -170,6 +322,102 @@ int CMathematics::rectangularToSphericalCoordinate(const std::vector<double>& sr
 }
 
 
+/**
+ * Description: Rotation vector of a rotation matrix, i.e. the rotation axis scaled by the rotation angle, by way of the unit
+ *	quaternion, which stays accurate for angles near 0 and near PI.
+ * @param aadRotation: (IN) Proper rotation matrix.
+ * @param adRotationVector: (OUT) Length in [0, PI].
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ */
+int CMathematics::rotationMatrixToRotationVector(const double aadRotation[3][3], double adRotationVector[3])
+{
+	/* Quaternion [W, X, Y, Z], taking the square root of its largest component for stability. */
+	const double dTRACE = aadRotation[0][0] + aadRotation[1][1] + aadRotation[2][2];
+	double adQuaternion[4];
+	// If W largest:
+	if (dTRACE >= aadRotation[0][0] && dTRACE >= aadRotation[1][1] && dTRACE >= aadRotation[2][2])
+	{
+		const double dFACTOR = 2 * sqrt(1 + dTRACE);
+		adQuaternion[0] = dFACTOR / 4;
+		adQuaternion[1] = (aadRotation[2][1] - aadRotation[1][2]) / dFACTOR;
+		adQuaternion[2] = (aadRotation[0][2] - aadRotation[2][0]) / dFACTOR;
+		adQuaternion[3] = (aadRotation[1][0] - aadRotation[0][1]) / dFACTOR;
+	}
+	// If X largest:
+	else if (aadRotation[0][0] >= aadRotation[1][1] && aadRotation[0][0] >= aadRotation[2][2])
+	{
+		const double dFACTOR = 2 * sqrt(1 + aadRotation[0][0] - aadRotation[1][1] - aadRotation[2][2]);
+		adQuaternion[0] = (aadRotation[2][1] - aadRotation[1][2]) / dFACTOR;
+		adQuaternion[1] = dFACTOR / 4;
+		adQuaternion[2] = (aadRotation[0][1] + aadRotation[1][0]) / dFACTOR;
+		adQuaternion[3] = (aadRotation[0][2] + aadRotation[2][0]) / dFACTOR;
+	}
+	// If Y largest:
+	else if (aadRotation[1][1] >= aadRotation[2][2])
+	{
+		const double dFACTOR = 2 * sqrt(1 + aadRotation[1][1] - aadRotation[0][0] - aadRotation[2][2]);
+		adQuaternion[0] = (aadRotation[0][2] - aadRotation[2][0]) / dFACTOR;
+		adQuaternion[1] = (aadRotation[0][1] + aadRotation[1][0]) / dFACTOR;
+		adQuaternion[2] = dFACTOR / 4;
+		adQuaternion[3] = (aadRotation[1][2] + aadRotation[2][1]) / dFACTOR;
+	}
+	// If Z largest:
+	else
+	{
+		const double dFACTOR = 2 * sqrt(1 + aadRotation[2][2] - aadRotation[0][0] - aadRotation[1][1]);
+		adQuaternion[0] = (aadRotation[1][0] - aadRotation[0][1]) / dFACTOR;
+		adQuaternion[1] = (aadRotation[0][2] + aadRotation[2][0]) / dFACTOR;
+		adQuaternion[2] = (aadRotation[1][2] + aadRotation[2][1]) / dFACTOR;
+		adQuaternion[3] = dFACTOR / 4;
+	}
+
+	/* Angle from the half angle, taking the quaternion with W >= 0 for an angle no more than PI. */
+	const double dSIGN = adQuaternion[0] < 0 ? -1 : 1;
+	const double dHALF_SINE = sqrt(adQuaternion[1] * adQuaternion[1] + adQuaternion[2] * adQuaternion[2] + adQuaternion[3] * adQuaternion[3]);
+	const double dANGLE = 2 * atan2(dHALF_SINE, dSIGN * adQuaternion[0]);
+	const double dSCALE = dHALF_SINE > 0 ? dSIGN * dANGLE / dHALF_SINE : 2;
+	for (int i = 0; i < 3; ++ i)
+	{
+		adRotationVector[i] = dSCALE * adQuaternion[i + 1];
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Rotation matrix of a rotation vector, by way of the unit quaternion, which is smooth in the vector everywhere,
+ *	including the zero vector.
+ * @param adRotationVector: (IN) Rotation axis scaled by the rotation angle in radians, counterclockwise looking down the axis.
+ * @param aadRotation: (OUT)
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ */
+int CMathematics::rotationVectorToRotationMatrix(const double adRotationVector[3], double aadRotation[3][3])
+{
+	const double dANGLE = sqrt(adRotationVector[0] * adRotationVector[0] + adRotationVector[1] * adRotationVector[1] + adRotationVector[2] * adRotationVector[2]);
+	// sin(angle / 2) / angle, by its series for tiny angles
+	const double dSCALE = dANGLE < 1e-4 ? 0.5 - dANGLE * dANGLE / 48 : sin(dANGLE / 2) / dANGLE;
+	const double dW = cos(dANGLE / 2);
+	const double dX = dSCALE * adRotationVector[0];
+	const double dY = dSCALE * adRotationVector[1];
+	const double dZ = dSCALE * adRotationVector[2];
+
+	aadRotation[0][0] = 1 - 2 * (dY * dY + dZ * dZ);
+	aadRotation[0][1] = 2 * (dX * dY - dW * dZ);
+	aadRotation[0][2] = 2 * (dX * dZ + dW * dY);
+	aadRotation[1][0] = 2 * (dX * dY + dW * dZ);
+	aadRotation[1][1] = 1 - 2 * (dX * dX + dZ * dZ);
+	aadRotation[1][2] = 2 * (dY * dZ - dW * dX);
+	aadRotation[2][0] = 2 * (dX * dZ - dW * dY);
+	aadRotation[2][1] = 2 * (dY * dZ + dW * dX);
+	aadRotation[2][2] = 1 - 2 * (dX * dX + dY * dY);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
 /**
  * Description:
  * @param srcVector: (IN) Source spherical coordinate. Each point is represented as an vector, [Theta, Phi, R]. Theta denotes the polar angle from z-axis, range [0..PI]; 
@@ -30,6 +30,10 @@
 #include <sstream>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using std::auto_ptr;
 using std::list;
@@ -50,7 +54,8 @@ CPocketComboSimilarityEvaluator::CPocketComboSimilarityEvaluator(
 	_pocketFitPtr(dynamic_cast<IMolecule*>(pocketFit.clone())),
 	_pocketRefPtr(dynamic_cast<IMolecule*>(pocketRef.clone())),
 	_pocketVolumeFitPtr(dynamic_cast<IMolecule*>(pocketVolumeFit.clone())),
-	_pocketVolumeRefPtr(dynamic_cast<IMolecule*>(pocketVolumeRef.clone()))
+	_pocketVolumeRefPtr(dynamic_cast<IMolecule*>(pocketVolumeRef.clone())),
+	_nThreadsCount(1)
 {
 	// If clone OK:
 	if (_pocketFitPtr.get())
@@ -177,3 +182,94 @@ double CPocketComboSimilarityEvaluator::getFunctionValue(const std::vector<doubl
 		throw CBadCastException(msgStream.str());
 	}
 }
+
+
+/**
+ * Description: Evaluate a batch of points across threads, see setThreadsCount(). Each point is evaluated exactly as by
+ *	getFunctionValue(), on its own clones of fit molecules.
+ * @param points: (IN) Transformation parameters of each point, see getFunctionValue().
+ * @param values: (OUT)
+ * @exception:
+ * 	CBadCastException:
+ */
+void CPocketComboSimilarityEvaluator::getFunctionValues(const std::vector<std::vector<double> >& points, std::vector<double>& values)
+{
+	const int nPOINTS_COUNT = points.size();
+	values.resize(nPOINTS_COUNT);
+
+	int nThreadsCount = 1;
+#ifdef _OPENMP
+	// If not nested in threads:
+	if (!omp_in_parallel())
+	{
+		nThreadsCount = getThreadsCount() > 0 ? getThreadsCount() : omp_get_num_procs();
+	}
+#endif
+
+	// If one thread, or molecules not valid so that getFunctionValue() throws:
+	if (nThreadsCount <= 1 || !(_pocketFitPtr.get() && _pocketRefPtr.get() && _pocketVolumeFitPtr.get() && _pocketVolumeRefPtr.get()))
+	{
+		for (int iPoint = 0; iPoint < nPOINTS_COUNT; ++ iPoint)
+		{
+			values[iPoint] = getFunctionValue(points[iPoint]);
+		}
+		return;
+	}
+
+	/* Exceptions must not leave threads: remember the first failed point, and evaluate it again afterwards to throw. */
+	int nFailedPointId = nPOINTS_COUNT;
+	#pragma omp parallel for num_threads(nThreadsCount) schedule(dynamic)
+	for (int iPoint = 0; iPoint < nPOINTS_COUNT; ++ iPoint)
+	{
+		try
+		{
+			values[iPoint] = getFunctionValue(points[iPoint]);
+		}
+		catch (...)
+		{
+			#pragma omp critical
+			nFailedPointId = std::min(nFailedPointId, iPoint);
+		}
+	}
+	// If any point failed:
+	if (nFailedPointId < nPOINTS_COUNT)
+	{
+		values[nFailedPointId] = getFunctionValue(points[nFailedPointId]);
+	}
+}
+
+
+/**
+ * Description:
+ * @return: Number of threads evaluating a batch of points, 0 for one per processor.
+ */
+int CPocketComboSimilarityEvaluator::getThreadsCount() const
+{
+	return _nThreadsCount;
+}
+
+
+/**
+ * Description: Set the number of threads evaluating a batch of points by getFunctionValues(). Has no effect if built without OpenMP.
+ * @param nThreadsCount: (IN) 0 for one per processor.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CPocketComboSimilarityEvaluator::setThreadsCount(const int nThreadsCount)
+{
+	// If valid parameter:
+	if (nThreadsCount >= 0)
+	{
+		_nThreadsCount = nThreadsCount;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nThreadsCount = " << nThreadsCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
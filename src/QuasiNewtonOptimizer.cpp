@@ -0,0 +1,460 @@
+/**
+ * Quasi-Newton Optimizer Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file QuasiNewtonOptimizer.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-16
+ */
+
+
+#include "QuasiNewtonOptimizer.h"
+
+#include "Exception.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+
+using std::numeric_limits;
+using std::string;
+using std::vector;
+
+
+/**
+ * Description:
+ * @param a: (IN)
+ * @param b: (IN)
+ * @return: Dot product of two vectors of the same dimension.
+ */
+static inline double dotProduct(const std::vector<double>& a, const std::vector<double>& b)
+{
+	double dProduct = 0.0;
+	for (int i = 0; i < static_cast<int>(a.size()); ++ i)
+	{
+		dProduct += a[i] * b[i];
+	}
+	return dProduct;
+}
+
+
+/* Implementation for CQuasiNewtonOptimizer class: */
+
+/* Static members: */
+const int CQuasiNewtonOptimizer::ErrorCodes::nNORMAL = 0;
+
+const double CQuasiNewtonOptimizer::DefaultValues::dGRADIENT_TOLERANCE = 1e-3;
+const double CQuasiNewtonOptimizer::DefaultValues::dIMPROVEMENT_TOLERANCE = 1e-5;
+const double CQuasiNewtonOptimizer::DefaultValues::dMAX_STEP_LENGTH = 1.0;
+const int CQuasiNewtonOptimizer::DefaultValues::nHISTORY_SIZE = 6;
+
+const string CQuasiNewtonOptimizer::MessageTexts::sDIMENSION_NOT_MATCH = string("Dimension not match. ");
+const string CQuasiNewtonOptimizer::MessageTexts::sPARAMETER_OUT_OF_RANGE = string("Parameter out of range. ");
+
+const int CQuasiNewtonOptimizer::_nMAX_BACKTRACKING_STEPS = 20;
+const double CQuasiNewtonOptimizer::_dSUFFICIENT_DECREASE_FACTOR = 1e-4;
+
+
+/**
+ * Description: Ctor.
+ * @param gradientEvaluator: (IN) Evaluator of the function to minimize. Not copied, must live longer than this optimizer.
+ * @param initialFeasibleSolutions: (IN) One solution per start, all of the same dimension.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+CQuasiNewtonOptimizer::CQuasiNewtonOptimizer(IGradientEvaluator& gradientEvaluator, const std::vector<std::vector<double> >& initialFeasibleSolutions)
+	:
+	_INITIAL_FEASIBLE_SOLUTIONS(initialFeasibleSolutions),
+	_dGradientTolerance(DefaultValues::dGRADIENT_TOLERANCE),
+	_dImprovementTolerance(DefaultValues::dIMPROVEMENT_TOLERANCE),
+	_dMaxStepLength(DefaultValues::dMAX_STEP_LENGTH),
+	_gradientEvaluator(gradientEvaluator),
+	_nEvaluationsCount(0),
+	_nHistorySize(DefaultValues::nHISTORY_SIZE),
+	_nPROBLEM_DIMENSION(initialFeasibleSolutions.empty() ? 0 : initialFeasibleSolutions[0].size())
+{
+	/* Validate dimensions of the initial feasible solutions. */
+	// For each solution:
+	FOREACH(iterSolution, initialFeasibleSolutions, vector<vector<double> >::const_iterator)
+	{
+		if (static_cast<int>(iterSolution->size()) != _nPROBLEM_DIMENSION)
+		{
+			std::stringstream msgStream;
+			msgStream
+				<< LOCATION_STREAM_INSERTION
+				<< MessageTexts::sDIMENSION_NOT_MATCH;
+			throw CInvalidArgumentException(msgStream.str());
+		}
+	}
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CQuasiNewtonOptimizer::~CQuasiNewtonOptimizer()
+{
+}
+
+
+/**
+ * Description: Minimize from each initial solution and keep the lowest result.
+ * @param minSolution: (OUT)
+ * @param dMinValue: (OUT)
+ * @param nMaxIterations: (IN) Max iterations per start, each costing one evaluation unless the line search backtracks.
+ */
+int CQuasiNewtonOptimizer::runOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations)
+{
+	_nEvaluationsCount = 0;
+
+	// best solution been found so far
+	vector<double> bestSolution;
+	// function value corresponding to the best solution
+	double dBestValue = numeric_limits<double>::max();
+	// For each initial solution:
+	FOREACH(iterSolution, _INITIAL_FEASIBLE_SOLUTIONS, vector<vector<double> >::const_iterator)
+	{
+		vector<double> solution = *iterSolution;
+		double dValue = 0.0;
+		minimize(solution, dValue, nMaxIterations);
+
+		/* Record the best solution and value. */
+		if (dValue < dBestValue)
+		{
+			bestSolution.swap(solution);
+			dBestValue = dValue;
+		}
+	}
+
+	/* Return result. */
+	minSolution = bestSolution;
+	dMinValue = dBestValue;
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Run one start of L-BFGS. The search direction comes from the two-loop recursion over the history, scaled by the
+ *	curvature of the latest pair, and falls back to steepest descent when it is not a descent direction. Trial steps are shortened to
+ *	the max step length, then backtracked by safeguarded quadratic interpolation until the Armijo condition holds. Pairs violating
+ *	the curvature condition are not kept, so the approximated inverse Hessian stays positive definite.
+ * @param solution: (IN, OUT) Initial solution in, local minimum out.
+ * @param dValue: (OUT) Function value at the local minimum.
+ * @param nMaxIterations: (IN)
+ */
+int CQuasiNewtonOptimizer::minimize(std::vector<double>& solution, double& dValue, int nMaxIterations)
+{
+	vector<double> gradient;
+	dValue = _gradientEvaluator.getFunctionValueAndGradient(solution, gradient);
+	++ _nEvaluationsCount;
+
+	// history, oldest first
+	vector<vector<double> > steps;
+	vector<vector<double> > gradientChanges;
+	vector<double> curvatureReciprocals;
+
+	vector<double> direction(_nPROBLEM_DIMENSION);
+	vector<double> trialSolution(_nPROBLEM_DIMENSION);
+	vector<double> trialGradient;
+	vector<double> historyCoefficients;
+	// Main iteration:
+	for (int iIteration = 0; iIteration < nMaxIterations; ++ iIteration)
+	{
+		/* Test convergence on gradient. */
+		double dMaxGradient = 0.0;
+		for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+		{
+			dMaxGradient = std::max(dMaxGradient, std::abs(gradient[iDimension]));
+		}
+		if (dMaxGradient < _dGradientTolerance)
+		{
+			break;
+		}
+
+		/* Two-loop recursion, direction = -H * gradient. */
+		const int nHISTORY_COUNT = steps.size();
+		historyCoefficients.assign(nHISTORY_COUNT, 0.0);
+		direction = gradient;
+		for (int iHistory = nHISTORY_COUNT - 1; iHistory >= 0; -- iHistory)
+		{
+			historyCoefficients[iHistory] = curvatureReciprocals[iHistory] * dotProduct(steps[iHistory], direction);
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				direction[iDimension] -= historyCoefficients[iHistory] * gradientChanges[iHistory][iDimension];
+			}
+		}
+		// If any history:
+		if (nHISTORY_COUNT > 0)
+		{
+			const double dSCALE = 1.0 / (curvatureReciprocals.back() * dotProduct(gradientChanges.back(), gradientChanges.back()));
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				direction[iDimension] *= dSCALE;
+			}
+		}
+		for (int iHistory = 0; iHistory < nHISTORY_COUNT; ++ iHistory)
+		{
+			const double dBETA = curvatureReciprocals[iHistory] * dotProduct(gradientChanges[iHistory], direction);
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				direction[iDimension] += steps[iHistory][iDimension] * (historyCoefficients[iHistory] - dBETA);
+			}
+		}
+		for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+		{
+			direction[iDimension] = -direction[iDimension];
+		}
+
+		double dSlope = dotProduct(gradient, direction);
+		// If not a descent direction:
+		if (dSlope >= 0)
+		{
+			steps.clear();
+			gradientChanges.clear();
+			curvatureReciprocals.clear();
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				direction[iDimension] = -gradient[iDimension];
+			}
+			dSlope = dotProduct(gradient, direction);
+		}
+
+		/* Shorten long steps. */
+		const double dDIRECTION_LENGTH = sqrt(dotProduct(direction, direction));
+		// If longer than max step:
+		if (dDIRECTION_LENGTH > _dMaxStepLength)
+		{
+			const double dSCALE = _dMaxStepLength / dDIRECTION_LENGTH;
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				direction[iDimension] *= dSCALE;
+			}
+			dSlope *= dSCALE;
+		}
+
+		/* Backtracking line search. */
+		double dStep = 1.0;
+		double dTrialValue = 0.0;
+		bool bAccepted = false;
+		for (int iBacktracking = 0; iBacktracking < _nMAX_BACKTRACKING_STEPS; ++ iBacktracking)
+		{
+			for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+			{
+				trialSolution[iDimension] = solution[iDimension] + dStep * direction[iDimension];
+			}
+			dTrialValue = _gradientEvaluator.getFunctionValueAndGradient(trialSolution, trialGradient);
+			++ _nEvaluationsCount;
+
+			// If sufficient decrease:
+			if (dTrialValue <= dValue + _dSUFFICIENT_DECREASE_FACTOR * dStep * dSlope)
+			{
+				bAccepted = true;
+				break;
+			}
+
+			/* Minimum of the quadratic through value and slope at 0 and value at current step, kept in [0.1, 0.5] of it. */
+			const double dCURVATURE = dTrialValue - dValue - dStep * dSlope;
+			const double dINTERPOLATED_STEP = dCURVATURE > 0 ? -dSlope * dStep * dStep / (2 * dCURVATURE) : 0.5 * dStep;
+			dStep = std::max(0.1 * dStep, std::min(0.5 * dStep, dINTERPOLATED_STEP));
+		}
+		// If no acceptable step:
+		if (!bAccepted)
+		{
+			break;
+		}
+
+		/* Update history. */
+		vector<double> step(_nPROBLEM_DIMENSION);
+		vector<double> gradientChange(_nPROBLEM_DIMENSION);
+		for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+		{
+			step[iDimension] = trialSolution[iDimension] - solution[iDimension];
+			gradientChange[iDimension] = trialGradient[iDimension] - gradient[iDimension];
+		}
+		const double dCURVATURE = dotProduct(step, gradientChange);
+		// If curvature condition holds:
+		if (dCURVATURE > numeric_limits<double>::epsilon() * dotProduct(gradientChange, gradientChange))
+		{
+			// If history full:
+			if (static_cast<int>(steps.size()) >= _nHistorySize)
+			{
+				steps.erase(steps.begin());
+				gradientChanges.erase(gradientChanges.begin());
+				curvatureReciprocals.erase(curvatureReciprocals.begin());
+			}
+			steps.push_back(step);
+			gradientChanges.push_back(gradientChange);
+			curvatureReciprocals.push_back(1.0 / dCURVATURE);
+		}
+
+		/* Move and test convergence on improvement. */
+		const double dIMPROVEMENT = dValue - dTrialValue;
+		const double dMAGNITUDE = std::max(1.0, std::max(std::abs(dValue), std::abs(dTrialValue)));
+		solution.swap(trialSolution);
+		gradient.swap(trialGradient);
+		dValue = dTrialValue;
+		if (dIMPROVEMENT <= _dImprovementTolerance * dMAGNITUDE)
+		{
+			break;
+		}
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description:
+ * @return: Number of evaluations of the last call to runOptimization(), each one value and gradient.
+ */
+int CQuasiNewtonOptimizer::getEvaluationsCount() const
+{
+	return _nEvaluationsCount;
+}
+
+
+/**
+ * Description:
+ */
+double CQuasiNewtonOptimizer::getGradientTolerance() const
+{
+	return _dGradientTolerance;
+}
+
+
+/**
+ * Description:
+ */
+int CQuasiNewtonOptimizer::getHistorySize() const
+{
+	return _nHistorySize;
+}
+
+
+/**
+ * Description:
+ */
+double CQuasiNewtonOptimizer::getImprovementTolerance() const
+{
+	return _dImprovementTolerance;
+}
+
+
+/**
+ * Description:
+ */
+double CQuasiNewtonOptimizer::getMaxStepLength() const
+{
+	return _dMaxStepLength;
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Largest gradient component below which a start is converged.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CQuasiNewtonOptimizer::setGradientTolerance(double dTolerance)
+{
+	// If valid parameter:
+	if (dTolerance >= 0)
+	{
+		_dGradientTolerance = dTolerance;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sPARAMETER_OUT_OF_RANGE
+			<< "dTolerance = " << dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nSize: (IN) Number of pairs of steps and gradient changes kept, no less than the dimension for plain BFGS.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CQuasiNewtonOptimizer::setHistorySize(int nSize)
+{
+	// If valid parameter:
+	if (nSize > 0)
+	{
+		_nHistorySize = nSize;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sPARAMETER_OUT_OF_RANGE
+			<< "nSize = " << nSize;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Relative improvement of one iteration below which a start is converged.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CQuasiNewtonOptimizer::setImprovementTolerance(double dTolerance)
+{
+	// If valid parameter:
+	if (dTolerance >= 0)
+	{
+		_dImprovementTolerance = dTolerance;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sPARAMETER_OUT_OF_RANGE
+			<< "dTolerance = " << dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param dLength: (IN) Max length of one step.
+ * @exception:
+ *	CInvalidArgumentException:
+ */
+void CQuasiNewtonOptimizer::setMaxStepLength(double dLength)
+{
+	// If valid parameter:
+	if (dLength > 0)
+	{
+		_dMaxStepLength = dLength;
+	}
+	// If invalid parameter:
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< MessageTexts::sPARAMETER_OUT_OF_RANGE
+			<< "dLength = " << dLength;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
@@ -0,0 +1,276 @@
+/**
+ * Self Volume Cache Module
+ *
+ * Copyright(c) 2010 ECUST.
+ * All Rights Reserved.
+ *
+ * @file SelfVolumeCache.cpp
+ * @author Chaoqian Cai
+ * @version v1.0
+ * @date 2011-03-02
+ */
+
+
+#include "SelfVolumeCache.h"
+
+#include "InterfaceAtom.h"
+#include "InterfaceMolecule.h"
+#include "Utility.h"
+
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+
+/* Implementation for CSelfVolumeCache class: */
+
+/* Static members: */
+const int CSelfVolumeCache::ErrorCodes::nBAD_FORMAT = 3;
+const int CSelfVolumeCache::ErrorCodes::nCAN_NOT_OPEN_FILE = 1;
+const int CSelfVolumeCache::ErrorCodes::nNORMAL = 0;
+const int CSelfVolumeCache::ErrorCodes::nPARAMETERS_MISMATCH = 2;
+
+const std::string CSelfVolumeCache::TagTexts::sHEADER("# GaussianShape self volume cache v1");
+const std::string CSelfVolumeCache::TagTexts::sPARAMETERS("@PARAMETERS");
+
+
+/* FNV-1a constants of 64 bits. */
+static const unsigned long long nFNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const unsigned long long nFNV_PRIME = 1099511628211ULL;
+
+
+/**
+ * Description: Mix bytes into a FNV-1a hash.
+ * @param pBytes: (IN)
+ * @param nBytesCount: (IN)
+ * @param nHash: (IN, OUT)
+ */
+static inline void hashBytes(const void* pBytes, const int nBytesCount, unsigned long long& nHash)
+{
+	const unsigned char* const pCHARS = static_cast<const unsigned char*>(pBytes);
+	for (int iByte = 0; iByte < nBytesCount; ++ iByte)
+	{
+		nHash ^= pCHARS[iByte];
+		nHash *= nFNV_PRIME;
+	}
+}
+
+
+/**
+ * Description: Ctor. The cache starts empty, call load() to read the file.
+ * @param sFileName: (IN) Cache file name.
+ * @param sParametersKey: (IN) Text identifying the parameters self volumes are calculated with, in one line.
+ */
+CSelfVolumeCache::CSelfVolumeCache(const std::string& sFileName, const std::string& sParametersKey) :
+	_bModified(false),
+	_sFileName(sFileName),
+	_sParametersKey(sParametersKey)
+{
+}
+
+
+/**
+ * Description: Dtor.
+ */
+CSelfVolumeCache::~CSelfVolumeCache()
+{
+}
+
+
+/**
+ * Description: Hash the content relevant to Gaussian volume of a molecule: element, radius and position of each atom, in order.
+ * @param molecule: (IN)
+ * @return: Content hash.
+ */
+unsigned long long CSelfVolumeCache::hashMolecule(const IMolecule& molecule)
+{
+	unsigned long long nHash = nFNV_OFFSET_BASIS;
+
+	const list<IAtom*> atomsList = molecule.getAtomsList();
+	FOREACH(iterAtom, atomsList, list<IAtom*>::const_iterator)
+	{
+		const IAtom& atom = **iterAtom;
+		const string& sElementName = atom.getElementName();
+		const double dRadius = atom.getAtomRadius();
+		const vector<double>& position = atom.getPosition();
+
+		hashBytes(sElementName.data(), sElementName.size(), nHash);
+		hashBytes(&dRadius, sizeof(dRadius), nHash);
+		hashBytes(&position[0], position.size() * sizeof(double), nHash);
+	}
+
+	return nHash;
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+int CSelfVolumeCache::getEntriesCount() const
+{
+	return _entries.size();
+}
+
+
+/**
+ * Description:
+ * @return:
+ */
+const std::string& CSelfVolumeCache::getFileName() const
+{
+	return _sFileName;
+}
+
+
+/**
+ * Description:
+ * @return: Whether entries changed since loading, i.e. whether the file should be saved.
+ */
+bool CSelfVolumeCache::isModified() const
+{
+	return _bModified;
+}
+
+
+/**
+ * Description: Read entries from the cache file, replacing current ones. Nothing is kept unless the whole file is valid and was
+ *	written with the same parameters key.
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ *	ErrorCodes::nCAN_NOT_OPEN_FILE: No cache file yet.
+ *	ErrorCodes::nPARAMETERS_MISMATCH:
+ *	ErrorCodes::nBAD_FORMAT:
+ */
+int CSelfVolumeCache::load()
+{
+	_entries.clear();
+	_bModified = false;
+
+	std::ifstream inputStream(_sFileName.c_str());
+	// If file can not be opened:
+	if (!inputStream.good())
+	{
+		return ErrorCodes::nCAN_NOT_OPEN_FILE;
+	}
+
+	/* Check header and parameters key. */
+	string sLine;
+	std::getline(inputStream, sLine);
+	if (sLine != TagTexts::sHEADER)
+	{
+		return ErrorCodes::nBAD_FORMAT;
+	}
+	std::getline(inputStream, sLine);
+	if (sLine != TagTexts::sPARAMETERS + " " + _sParametersKey)
+	{
+		return ErrorCodes::nPARAMETERS_MISMATCH;
+	}
+
+	/* Read entries, one per line: molecule ID, content hash, self volume. */
+	map<int, Entry> entries;
+	while (std::getline(inputStream, sLine))
+	{
+		// If empty line:
+		if (sLine.empty())
+		{
+			continue;
+		}
+
+		std::istringstream lineStream(sLine);
+		int nMoleculeId = 0;
+		Entry entry;
+		// If bad line:
+		if (!(lineStream >> nMoleculeId >> entry.nContentHash >> entry.dSelfVolume))
+		{
+			return ErrorCodes::nBAD_FORMAT;
+		}
+		entries[nMoleculeId] = entry;
+	}
+
+	_entries.swap(entries);
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Look up the self volume of a molecule.
+ * @param nMoleculeId: (IN) Molecule ID in database.
+ * @param nContentHash: (IN) Content hash of the molecule, see hashMolecule().
+ * @param dSelfVolume: (OUT) Cached self volume, untouched on miss.
+ * @return: Whether a cached volume of the same content is found.
+ */
+bool CSelfVolumeCache::lookUp(const int nMoleculeId, const unsigned long long nContentHash, double& dSelfVolume) const
+{
+	const map<int, Entry>::const_iterator iterEntry = _entries.find(nMoleculeId);
+	// If hit:
+	if (iterEntry != _entries.end() && iterEntry->second.nContentHash == nContentHash)
+	{
+		dSelfVolume = iterEntry->second.dSelfVolume;
+		return true;
+	}
+	// If miss or stale entry:
+	else
+	{
+		return false;
+	}
+}
+
+
+/**
+ * Description: Write all entries to the cache file, with full precision of volumes.
+ * @return:
+ *	ErrorCodes::nNORMAL:
+ *	ErrorCodes::nCAN_NOT_OPEN_FILE:
+ */
+int CSelfVolumeCache::save()
+{
+	std::ofstream outputStream(_sFileName.c_str());
+	// If file can not be opened:
+	if (!outputStream.good())
+	{
+		return ErrorCodes::nCAN_NOT_OPEN_FILE;
+	}
+
+	outputStream.precision(17);
+	outputStream << TagTexts::sHEADER << std::endl;
+	outputStream << TagTexts::sPARAMETERS << " " << _sParametersKey << std::endl;
+	for (map<int, Entry>::const_iterator iterEntry = _entries.begin(); iterEntry != _entries.end(); ++ iterEntry)
+	{
+		outputStream << iterEntry->first << " " << iterEntry->second.nContentHash << " " << iterEntry->second.dSelfVolume << "\n";
+	}
+	outputStream.flush();
+
+	// If write failure:
+	if (!outputStream.good())
+	{
+		return ErrorCodes::nCAN_NOT_OPEN_FILE;
+	}
+
+	_bModified = false;
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Add or replace the self volume of a molecule.
+ * @param nMoleculeId: (IN) Molecule ID in database.
+ * @param nContentHash: (IN) Content hash of the molecule, see hashMolecule().
+ * @param dSelfVolume: (IN)
+ */
+void CSelfVolumeCache::store(const int nMoleculeId, const unsigned long long nContentHash, const double dSelfVolume)
+{
+	Entry& entry = _entries[nMoleculeId];
+	entry.nContentHash = nContentHash;
+	entry.dSelfVolume = dSelfVolume;
+	_bModified = true;
+}
@@ -11,14 +11,23 @@
  */
 
 
+#include "InterfaceCloneable.h"
 #include "Mathematics.h"
 #include "SimplexOptimizer.h"
 #include "Utility.h"
 
+#include <algorithm>
 #include <climits>
+#include <cmath>
 #include <limits>
+#include <memory>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
+
+using std::auto_ptr;
 using std::numeric_limits;
 using std::vector;
 
@@ -28,10 +37,15 @@ using std::vector;
 /* Static members: */
 const int CSimplexOptimizer::ErrorCodes::nNORMAL = 0;
 
+const double CSimplexOptimizer::DefaultValues::dABSOLUTE_VALUE_TOLERANCE = 0.0;
 const double CSimplexOptimizer::DefaultValues::dCONTRACTION_FACTOR = 0.5;
 const double CSimplexOptimizer::DefaultValues::dEXTENSION_FACTOR = 2.0;
 const double CSimplexOptimizer::DefaultValues::dREDUCTION_FACTOR = 0.5;
 const double CSimplexOptimizer::DefaultValues::dREFLECTION_FACTOR = 1.0;
+const double CSimplexOptimizer::DefaultValues::dPRUNING_FRACTION = 0.0;
+const double CSimplexOptimizer::DefaultValues::dRELATIVE_VALUE_TOLERANCE = 0.0;
+const int CSimplexOptimizer::DefaultValues::nPRUNING_INTERVAL = 10;
+const int CSimplexOptimizer::DefaultValues::nTHREADS_COUNT = 1;
 
 const string CSimplexOptimizer::MessageTexts::sDIMENSION_NOT_MATCH = string("Dimension not match. ");
 const string CSimplexOptimizer::MessageTexts::sPARAMETER_OUT_OF_RANGE = string("Parameter out of range. ");
@@ -43,14 +57,21 @@ const string CSimplexOptimizer::MessageTexts::sPARAMETER_OUT_OF_RANGE = string("
 CSimplexOptimizer::CSimplexOptimizer(IFunctionValueEvaluator& functionValueEvaluator, const std::vector<std::vector< std::vector<double> > >& initialFeasibleSolutions)
 	:
 	_INITIAL_FEASIBLE_SOLUTIONS(initialFeasibleSolutions),
+	_dAbsoluteValueTolerance(DefaultValues::dABSOLUTE_VALUE_TOLERANCE),
 	_dHighestSolutionValue(-numeric_limits<double>::max()),
 	_dLowestSolutionValue(numeric_limits<double>::max()),
+	_dPruningFraction(DefaultValues::dPRUNING_FRACTION),
+	_dRelativeValueTolerance(DefaultValues::dRELATIVE_VALUE_TOLERANCE),
 	_dSecondHighestSolutionValue(-numeric_limits<double>::max()),
 	_functionValueEvaluator(functionValueEvaluator),
+	_nEvaluationsCount(0),
 	_nHighestSolutionId(-1),
 	_nLowestSolutionId(-1),
 	_nPROBLEM_DIMENSION(initialFeasibleSolutions[0].size() - 1),
-	_nSecondHighestSolutionId(-1)
+	_nPrunedStartsCount(0),
+	_nSavedEvaluationsCount(0),
+	_nSecondHighestSolutionId(-1),
+	_nThreadsCount(DefaultValues::nTHREADS_COUNT)
 {
 	/* Validate dimensions of the initial feasible solutions. */
 	const int nPROBLEM_DIMENSION = initialFeasibleSolutions[0].size() - 1;
@@ -118,10 +139,27 @@ CSimplexOptimizer::~CSimplexOptimizer()
 
 
 /**
- * Description:
+ * Description: Minimize from each initial simplex and keep the lowest result. Iterations used by each start are reported by
+ *	getIterationsCounts(), function evaluations by getEvaluationsCount(). Starts run in parallel if possible, see getWorkersCount(),
+ *	and are interleaved if pruning is set, see runInterleavedOptimization().
+ * @param minSolution: (OUT)
+ * @param dMinValue: (OUT)
+ * @param nMaxIterations: (IN) Max iterations per start, reached only by starts not converged or pruned before.
  */
 int CSimplexOptimizer::runOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations)
 {
+	const int nWORKERS_COUNT = getWorkersCount();
+	// If parallel or pruning:
+	if (nWORKERS_COUNT > 1 || getPruningFraction() > 0)
+	{
+		return runInterleavedOptimization(minSolution, dMinValue, nMaxIterations, nWORKERS_COUNT);
+	}
+
+	_iterationsCounts.clear();
+	_nEvaluationsCount = 0;
+	_nPrunedStartsCount = 0;
+	_nSavedEvaluationsCount = 0;
+
 	// best solution been found so far
 	vector<double> bestSolution;
 	// function value corresponding to the best solution
@@ -132,44 +170,282 @@ int CSimplexOptimizer::runOptimization(std::vector<double>& minSolution, double&
 		_currentFeasibleSolutions = *iterSolutionsGroup;
 
 		evaluateAllCurrentSolutions();
-		// Main iteration:
-		for (int iIteration = 0; iIteration < nMaxIterations; iIteration++)
+		_iterationsCounts.push_back(iterate(nMaxIterations));
+
+		/* Record the best solution and value. */
+		if (_currentFunctionValues[_nLowestSolutionId] < dBestValue)
 		{
-			/* Calculate three special vertices and one centroid. */
-			updateSpecialVertices();
-			updateReflectionCentroid();
+			bestSolution = _currentFeasibleSolutions[_nLowestSolutionId];
+			dBestValue = _currentFunctionValues[_nLowestSolutionId];
+		}
+	} // FOREACH
 
-			/* Reflection operation. */
-			doReflection();
+	/* Return result. */
+	minSolution = bestSolution;
+	dMinValue = dBestValue;
 
-			// Reflection result 1:
-			if (_dReflectedPointValue < _dLowestSolutionValue)
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Run each start by an optimizer of that start only, with the settings of this optimizer, see
+ *	runInterleavedRounds(). Starts are dealt to workers in turn, each worker evaluating on its own evaluator clone. Evaluators are
+ *	cloned before starting threads, as cloning may read shared data lazily built. Clones and optimizers of starts are released
+ *	whether the run returns or throws.
+ * @param minSolution: (OUT)
+ * @param dMinValue: (OUT)
+ * @param nMaxIterations: (IN) Max iterations per start.
+ * @param nWorkersCount: (IN) Number of threads, one evaluator clone each if more than one.
+ * @exception:
+ *	CBadCastException:
+ */
+int CSimplexOptimizer::runInterleavedOptimization(std::vector<double>& minSolution, double& dMinValue, int nMaxIterations, int nWorkersCount)
+{
+	const int nGROUPS_COUNT = _INITIAL_FEASIBLE_SOLUTIONS.size();
+
+	// evaluator clones, one per thread if parallel
+	vector<ICloneable*> clones;
+	// optimizers, one per start
+	vector<CSimplexOptimizer*> groupOptimizers;
+	try
+	{
+		/* Clone one evaluator per thread if parallel. */
+		vector<IFunctionValueEvaluator*> workerEvaluators(1, &_functionValueEvaluator);
+		// If parallel:
+		if (nWorkersCount > 1)
+		{
+			const ICloneable& cloneableEvaluator = dynamic_cast<const ICloneable&>(_functionValueEvaluator);
+			workerEvaluators.clear();
+			for (int iWorker = 0; iWorker < nWorkersCount; ++ iWorker)
 			{
-				/* Extension operation. */
-				doExtention();
+				auto_ptr<ICloneable> clonePtr(cloneableEvaluator.clone());
+				IFunctionValueEvaluator* const pEvaluator = dynamic_cast<IFunctionValueEvaluator*>(clonePtr.get());
+				// If type cast failure:
+				if (!pEvaluator)
+				{
+					std::stringstream msgStream;
+					msgStream
+						<< LOCATION_STREAM_INSERTION
+						<< "Bad cast! "
+						<< "The clone of evaluator is not an instance of IFunctionValueEvaluator interface! ";
+					throw CBadCastException(msgStream.str());
+				}
+				clones.push_back(clonePtr.release());
+				workerEvaluators.push_back(pEvaluator);
 			}
-			// Reflection result 2:
-			else if (_dReflectedPointValue >= _dLowestSolutionValue && _dReflectedPointValue <= _dSecondHighestSolutionValue)
+		}
+
+		/* One optimizer per start, on the evaluator of the worker it is dealt to. */
+		for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+		{
+			auto_ptr<CSimplexOptimizer> groupOptimizerPtr(new CSimplexOptimizer(
+				*workerEvaluators[iGroup % nWorkersCount], vector<vector<vector<double> > >(1, _INITIAL_FEASIBLE_SOLUTIONS[iGroup])));
+			groupOptimizerPtr->setAbsoluteValueTolerance(getAbsoluteValueTolerance());
+			groupOptimizerPtr->setContractionFactor(getContractionFactor());
+			groupOptimizerPtr->setExtensionFactor(getExtensionFactor());
+			groupOptimizerPtr->setReductionFactor(getReductionFactor());
+			groupOptimizerPtr->setReflectionFactor(getReflectionFactor());
+			groupOptimizerPtr->setRelativeValueTolerance(getRelativeValueTolerance());
+			groupOptimizerPtr->setVertexTolerances(getVertexTolerances());
+			groupOptimizerPtr->_currentFeasibleSolutions = _INITIAL_FEASIBLE_SOLUTIONS[iGroup];
+			groupOptimizers.push_back(groupOptimizerPtr.get());
+			groupOptimizerPtr.release();
+		}
+
+		runInterleavedRounds(groupOptimizers, minSolution, dMinValue, nMaxIterations, nWorkersCount);
+	}
+	catch (...)
+	{
+		FOREACH(iterGroupOptimizer, groupOptimizers, vector<CSimplexOptimizer*>::iterator)
+		{
+			delete *iterGroupOptimizer;
+		}
+		FOREACH(iterClone, clones, vector<ICloneable*>::iterator)
+		{
+			delete *iterClone;
+		}
+		throw;
+	}
+
+	FOREACH(iterGroupOptimizer, groupOptimizers, vector<CSimplexOptimizer*>::iterator)
+	{
+		delete *iterGroupOptimizer;
+	}
+	FOREACH(iterClone, clones, vector<ICloneable*>::iterator)
+	{
+		delete *iterClone;
+	}
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Run the optimizers of starts in rounds of DefaultValues::nPRUNING_INTERVAL iterations if pruning is set, or in one
+ *	round of all iterations otherwise, each worker running its starts one after another in each round.
+ *	Pruning is decided between rounds against the lowest value of all starts, and results are reduced in start order as in the
+ *	serial loop, so the result does not depend on the threads count or scheduling, and without pruning it is the serial result.
+ *	The evaluations a pruned start would have used are estimated by its evaluations per iteration so far, initial vertices aside.
+ *	Exceptions do not leave threads: the step of the first failed start is run again after all threads, to throw.
+ * @param groupOptimizers: (IN) Optimizer of each start, start i being run by worker i modulo the number of workers.
+ * @param minSolution: (OUT)
+ * @param dMinValue: (OUT)
+ * @param nMaxIterations: (IN) Max iterations per start.
+ * @param nWorkersCount: (IN) Number of threads.
+ * @exception:
+ *	CRuntimeException: The first failed start does not fail again when run after all threads.
+ */
+int CSimplexOptimizer::runInterleavedRounds(
+	const std::vector<CSimplexOptimizer*>& groupOptimizers,
+	std::vector<double>& minSolution,
+	double& dMinValue,
+	int nMaxIterations,
+	int nWorkersCount
+	)
+{
+	const int nGROUPS_COUNT = groupOptimizers.size();
+
+	/* Run rounds until every start has converged, reached max iterations or been pruned. */
+	const int nROUND_ITERATIONS = getPruningFraction() > 0 ? DefaultValues::nPRUNING_INTERVAL : nMaxIterations;
+	// a flag for each start indicating whether it is still running, not vector<bool> as flags are written concurrently
+	vector<char> activeFlags(nGROUPS_COUNT, 1);
+	// lowest value of each start at the last round
+	vector<double> checkpointValues(nGROUPS_COUNT);
+	_iterationsCounts.assign(nGROUPS_COUNT, 0);
+	_nPrunedStartsCount = 0;
+	_nSavedEvaluationsCount = 0;
+	for (bool bFirstRound = true; std::find(activeFlags.begin(), activeFlags.end(), 1) != activeFlags.end(); bFirstRound = false)
+	{
+		/* Exceptions must not leave threads: remember the first failed start and its step, and run that step again afterwards to throw. */
+		int nFailedGroupId = nGROUPS_COUNT;
+		bool bFailedOnEvaluation = false;
+		#pragma omp parallel for num_threads(nWorkersCount) schedule(static, 1)
+		for (int iWorker = 0; iWorker < nWorkersCount; ++ iWorker)
+		{
+			for (int iGroup = iWorker; iGroup < nGROUPS_COUNT; iGroup += nWorkersCount)
 			{
-				/* Replace the highest point with the reflected point. */
-				_currentFeasibleSolutions[_nHighestSolutionId] = _reflectedPoint;
-				_currentFunctionValues[_nHighestSolutionId] = _dReflectedPointValue;
+				CSimplexOptimizer& groupOptimizer = *groupOptimizers[iGroup];
+				// a flag indicating whether the initial vertices are being evaluated
+				bool bEvaluating = bFirstRound;
+				try
+				{
+					// If first round:
+					if (bFirstRound)
+					{
+						groupOptimizer.evaluateAllCurrentSolutions();
+						checkpointValues[iGroup] = *std::min_element(groupOptimizer._currentFunctionValues.begin(), groupOptimizer._currentFunctionValues.end());
+						bEvaluating = false;
+					}
+					// If start stopped:
+					if (!activeFlags[iGroup])
+					{
+						continue;
+					}
+
+					const int nROUND_MAX_ITERATIONS = std::min(nROUND_ITERATIONS, nMaxIterations - _iterationsCounts[iGroup]);
+					const int nIterationsCount = groupOptimizer.iterate(nROUND_MAX_ITERATIONS);
+					_iterationsCounts[iGroup] += nIterationsCount;
+					// If converged or max iterations reached:
+					if (nIterationsCount < nROUND_MAX_ITERATIONS || _iterationsCounts[iGroup] >= nMaxIterations)
+					{
+						activeFlags[iGroup] = 0;
+					}
+				}
+				catch (...)
+				{
+					#pragma omp critical
+					{
+						// If first failed start so far:
+						if (iGroup < nFailedGroupId)
+						{
+							nFailedGroupId = iGroup;
+							bFailedOnEvaluation = bEvaluating;
+						}
+					}
+					// Stop the failed start, so that the worker goes on with its other starts.
+					activeFlags[iGroup] = 0;
+				}
 			}
-			// Reflection result 3:
+		}
+		// If any start failed:
+		if (nFailedGroupId < nGROUPS_COUNT)
+		{
+			CSimplexOptimizer& groupOptimizer = *groupOptimizers[nFailedGroupId];
+			// If failed on initial vertices:
+			if (bFailedOnEvaluation)
+			{
+				groupOptimizer.evaluateAllCurrentSolutions();
+			}
+			// If failed on iterations:
 			else
 			{
-				/* Contraction operation. */
-				doContraction();
+				groupOptimizer.iterate(std::min(nROUND_ITERATIONS, nMaxIterations - _iterationsCounts[nFailedGroupId]));
+			}
+
+			std::stringstream msgStream;
+			msgStream
+				<< LOCATION_STREAM_INSERTION
+				<< "Start " << nFailedGroupId << " failed on a thread, but not when run again! ";
+			throw CRuntimeException(msgStream.str());
+		}
+
+		// If no pruning:
+		if (getPruningFraction() <= 0)
+		{
+			continue;
+		}
+
+		/* Prune starts that can not plausibly reach the incumbent. */
+		// lowest values of each start and of all starts
+		vector<double> lowestValues(nGROUPS_COUNT);
+		for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+		{
+			const vector<double>& functionValues = groupOptimizers[iGroup]->_currentFunctionValues;
+			lowestValues[iGroup] = *std::min_element(functionValues.begin(), functionValues.end());
+		}
+		const double dIncumbentValue = *std::min_element(lowestValues.begin(), lowestValues.end());
+		for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+		{
+			// If start stopped:
+			if (!activeFlags[iGroup])
+			{
+				continue;
+			}
+
+			const double dGap = lowestValues[iGroup] - dIncumbentValue;
+			const double dImprovement = checkpointValues[iGroup] - lowestValues[iGroup];
+			const int nREMAINING_ITERATIONS = nMaxIterations - _iterationsCounts[iGroup];
+			checkpointValues[iGroup] = lowestValues[iGroup];
+			// If short of the fraction of incumbent, and not improving fast enough to reach it:
+			if (dGap > (1 - getPruningFraction()) * std::abs(dIncumbentValue)
+				&& dImprovement * nREMAINING_ITERATIONS < dGap * nROUND_ITERATIONS)
+			{
+				activeFlags[iGroup] = 0;
+				++ _nPrunedStartsCount;
+				const int nITERATION_EVALUATIONS_COUNT = groupOptimizers[iGroup]->_nEvaluationsCount - (_nPROBLEM_DIMENSION + 1);
+				_nSavedEvaluationsCount += static_cast<int>(
+					static_cast<double>(nITERATION_EVALUATIONS_COUNT) / _iterationsCounts[iGroup] * nREMAINING_ITERATIONS);
 			}
 		}
+	}
 
-		/* Record the best solution and value. */
-		if (_currentFunctionValues[_nLowestSolutionId] < dBestValue)
+	/* Reduce in start order. */
+	// best solution been found so far
+	vector<double> bestSolution;
+	// function value corresponding to the best solution
+	double dBestValue = numeric_limits<double>::max();
+	_nEvaluationsCount = 0;
+	for (int iGroup = 0; iGroup < nGROUPS_COUNT; ++ iGroup)
+	{
+		const CSimplexOptimizer& groupOptimizer = *groupOptimizers[iGroup];
+		if (groupOptimizer._currentFunctionValues[groupOptimizer._nLowestSolutionId] < dBestValue)
 		{
-			bestSolution = _currentFeasibleSolutions[_nLowestSolutionId];
-			dBestValue = _currentFunctionValues[_nLowestSolutionId];
+			bestSolution = groupOptimizer._currentFeasibleSolutions[groupOptimizer._nLowestSolutionId];
+			dBestValue = groupOptimizer._currentFunctionValues[groupOptimizer._nLowestSolutionId];
 		}
-	} // FOREACH
+		_nEvaluationsCount += groupOptimizer._nEvaluationsCount;
+	}
 
 	/* Return result. */
 	minSolution = bestSolution;
@@ -188,6 +464,10 @@ int CSimplexOptimizer::traceOptimization(std::vector<std::vector<CSimplexOptimiz
 {
 	// clear output
 	trajectories.clear();
+	_iterationsCounts.clear();
+	_nEvaluationsCount = 0;
+	_nPrunedStartsCount = 0;
+	_nSavedEvaluationsCount = 0;
 
 	// For each group of feasible solutions:
 	FOREACH(iterSolutionsGroup, _INITIAL_FEASIBLE_SOLUTIONS, vector<vector<vector<double> > >::const_iterator)
@@ -206,6 +486,11 @@ int CSimplexOptimizer::traceOptimization(std::vector<std::vector<CSimplexOptimiz
 
 			/* Calculate three special vertices and one centroid. */
 			updateSpecialVertices();
+			// If converged:
+			if (isConverged())
+			{
+				break;
+			}
 			updateReflectionCentroid();
 
 			/* Reflection operation. */
@@ -249,6 +534,7 @@ int CSimplexOptimizer::traceOptimization(std::vector<std::vector<CSimplexOptimiz
 
 		/* Record the information of current trajectory. */
 		trajectories.push_back(currentTrajectory);
+		_iterationsCounts.push_back(currentTrajectory.size());
 	} // FOREACH
 
 	return ErrorCodes::nNORMAL;
@@ -282,6 +568,7 @@ int CSimplexOptimizer::doContraction()
 	CMathematics::add(contractedPoint, _reflectionCentroid);
 	// function value at the contracted point
 	const double dContractedPointValue = _functionValueEvaluator.getFunctionValue(contractedPoint);
+	++ _nEvaluationsCount;
 
 	/* Assess the contraction operation. */
 	// If contraction success:
@@ -317,6 +604,7 @@ int CSimplexOptimizer::doExtention()
 	CMathematics::add(extendedPoint, _reflectionCentroid);
 	// function value at the extended point
 	const double dExtendedPointValue = _functionValueEvaluator.getFunctionValue(extendedPoint);
+	++ _nEvaluationsCount;
 
 	/* Assess the extension operation. */
 	// If extension success:
@@ -376,6 +664,7 @@ int CSimplexOptimizer::doReflection()
 	CMathematics::add(_reflectedPoint, _reflectionCentroid);
 	// function value at reflected point
 	_dReflectedPointValue = _functionValueEvaluator.getFunctionValue(_reflectedPoint);
+	++ _nEvaluationsCount;
 
 	return ErrorCodes::nNORMAL;
 }
@@ -386,13 +675,134 @@ int CSimplexOptimizer::doReflection()
  */
 int CSimplexOptimizer::evaluateAllCurrentSolutions()
 {
-	// Evaluate all current feasible solutions.
-	for (int i = 0; i < static_cast<int>(_currentFeasibleSolutions.size()); i++)
+	// Evaluate all current feasible solutions in one batch.
+	_functionValueEvaluator.getFunctionValues(_currentFeasibleSolutions, _currentFunctionValues);
+	_nEvaluationsCount += _currentFeasibleSolutions.size();
+
+	return ErrorCodes::nNORMAL;
+}
+
+
+/**
+ * Description: Get the number of threads to run starts on: the threads count, or the number of processors for 0, no more than the
+ *	number of starts. Starts run serially on the evaluator itself if built without OpenMP, if already running in a parallel region,
+ *	or if the evaluator can not be cloned.
+ * @return:
+ */
+int CSimplexOptimizer::getWorkersCount() const
+{
+	// If evaluator can not be cloned:
+	if (!dynamic_cast<const ICloneable*>(&_functionValueEvaluator))
 	{
-		_currentFunctionValues[i] = _functionValueEvaluator.getFunctionValue(_currentFeasibleSolutions[i]);
+		return 1;
 	}
 
-	return ErrorCodes::nNORMAL;
+	int nWorkersCount = 1;
+#ifdef _OPENMP
+	// If not nested in threads:
+	if (!omp_in_parallel())
+	{
+		nWorkersCount = _nThreadsCount > 0 ? _nThreadsCount : omp_get_num_procs();
+	}
+#endif
+
+	return std::max(1, std::min(nWorkersCount, static_cast<int>(_INITIAL_FEASIBLE_SOLUTIONS.size())));
+}
+
+
+/**
+ * Description: Iterate on current simplex, whose vertices have been evaluated, until it converges or max iterations are reached.
+ *	Iterating again later resumes the same simplex, so that starts may be run in several steps.
+ * @param nMaxIterations: (IN)
+ * @return: Number of iterations done, less than nMaxIterations only if converged.
+ */
+int CSimplexOptimizer::iterate(int nMaxIterations)
+{
+	// Main iteration:
+	int iIteration = 0;
+	for (; iIteration < nMaxIterations; iIteration++)
+	{
+		/* Calculate three special vertices and one centroid. */
+		updateSpecialVertices();
+		// If converged:
+		if (isConverged())
+		{
+			break;
+		}
+		updateReflectionCentroid();
+
+		/* Reflection operation. */
+		doReflection();
+
+		// Reflection result 1:
+		if (_dReflectedPointValue < _dLowestSolutionValue)
+		{
+			/* Extension operation. */
+			doExtention();
+		}
+		// Reflection result 2:
+		else if (_dReflectedPointValue >= _dLowestSolutionValue && _dReflectedPointValue <= _dSecondHighestSolutionValue)
+		{
+			/* Replace the highest point with the reflected point. */
+			_currentFeasibleSolutions[_nHighestSolutionId] = _reflectedPoint;
+			_currentFunctionValues[_nHighestSolutionId] = _dReflectedPointValue;
+		}
+		// Reflection result 3:
+		else
+		{
+			/* Contraction operation. */
+			doContraction();
+		}
+	}
+
+	return iIteration;
+}
+
+
+/**
+ * Description: Test whether current simplex has converged, see class description.
+ * @Note: Before calling this method, the highest and lowest verticies must be calculated.
+ * @return:
+ */
+bool CSimplexOptimizer::isConverged() const
+{
+	const bool bTEST_VALUES = _dAbsoluteValueTolerance > 0 || _dRelativeValueTolerance > 0;
+	const bool bTEST_VERTICES = !_vertexTolerances.empty();
+	// If no test:
+	if (!bTEST_VALUES && !bTEST_VERTICES)
+	{
+		return false;
+	}
+
+	/* Spread of function values. */
+	// If values spread too much:
+	if (bTEST_VALUES
+		&& _dHighestSolutionValue - _dLowestSolutionValue > _dAbsoluteValueTolerance + _dRelativeValueTolerance * std::abs(_dLowestSolutionValue))
+	{
+		return false;
+	}
+
+	/* Spread of vertices along each dimension. */
+	if (bTEST_VERTICES)
+	{
+		for (int iDimension = 0; iDimension < _nPROBLEM_DIMENSION; ++ iDimension)
+		{
+			double dMinCoordinate = numeric_limits<double>::max();
+			double dMaxCoordinate = -numeric_limits<double>::max();
+			FOREACH(iterSolution, _currentFeasibleSolutions, vector<vector<double> >::const_iterator)
+			{
+				dMinCoordinate = std::min(dMinCoordinate, (*iterSolution)[iDimension]);
+				dMaxCoordinate = std::max(dMaxCoordinate, (*iterSolution)[iDimension]);
+			}
+			// If vertices spread too much:
+			if (dMaxCoordinate - dMinCoordinate > _vertexTolerances[iDimension])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
 }
 
 
@@ -460,6 +870,15 @@ int CSimplexOptimizer::updateReflectionCentroid()
 }
 
 
+/**
+ * Description:
+ */
+double CSimplexOptimizer::getAbsoluteValueTolerance() const
+{
+	return _dAbsoluteValueTolerance;
+}
+
+
 /**
  * Description:
  */
@@ -469,6 +888,16 @@ double CSimplexOptimizer::getContractionFactor() const
 }
 
 
+/**
+ * Description:
+ * @return: Number of function evaluations of the last optimization or trace.
+ */
+int CSimplexOptimizer::getEvaluationsCount() const
+{
+	return _nEvaluationsCount;
+}
+
+
 /**
  * Description:
  */
@@ -478,6 +907,36 @@ double CSimplexOptimizer::getExtensionFactor() const
 }
 
 
+/**
+ * Description:
+ * @return: Iterations used by each start of the last optimization or trace, the max iterations for starts not converged.
+ */
+const std::vector<int>& CSimplexOptimizer::getIterationsCounts() const
+{
+	return _iterationsCounts;
+}
+
+
+/**
+ * Description:
+ * @return: Number of starts pruned in the last optimization.
+ */
+int CSimplexOptimizer::getPrunedStartsCount() const
+{
+	return _nPrunedStartsCount;
+}
+
+
+/**
+ * Description:
+ * @return: Fraction of the incumbent a start must reach not to be pruned, 0 for no pruning.
+ */
+double CSimplexOptimizer::getPruningFraction() const
+{
+	return _dPruningFraction;
+}
+
+
 /**
  * Description:
  */
@@ -496,6 +955,68 @@ double CSimplexOptimizer::getReflectionFactor() const
 }
 
 
+/**
+ * Description:
+ */
+double CSimplexOptimizer::getRelativeValueTolerance() const
+{
+	return _dRelativeValueTolerance;
+}
+
+
+/**
+ * Description:
+ * @return: Estimated number of function evaluations saved by pruning in the last optimization, from the evaluations per iteration
+ *	of each pruned start before pruning.
+ */
+int CSimplexOptimizer::getSavedEvaluationsCount() const
+{
+	return _nSavedEvaluationsCount;
+}
+
+
+/**
+ * Description:
+ * @return: Number of threads running starts, 0 for one per processor.
+ */
+int CSimplexOptimizer::getThreadsCount() const
+{
+	return _nThreadsCount;
+}
+
+
+/**
+ * Description:
+ */
+const std::vector<double>& CSimplexOptimizer::getVertexTolerances() const
+{
+	return _vertexTolerances;
+}
+
+
+/**
+ * Description:
+ * @param dTolerance: (IN) Absolute spread of function values within which a simplex converges, 0 for none.
+ */
+void CSimplexOptimizer::setAbsoluteValueTolerance(double dTolerance)
+{
+	// Check parameter:
+	if (dTolerance >= 0)
+	{
+		_dAbsoluteValueTolerance = dTolerance;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dTolerance = " << dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
 /**
  * Description:
  */
@@ -540,6 +1061,29 @@ void CSimplexOptimizer::setExtensionFactor(double dFactor)
 }
 
 
+/**
+ * Description: Set how aggressively starts are pruned, see class description.
+ * @param dFraction: (IN) Between 0 and 1, 0 for no pruning, higher to prune more starts.
+ */
+void CSimplexOptimizer::setPruningFraction(double dFraction)
+{
+	// Check parameter:
+	if (dFraction >= 0 && dFraction <= 1)
+	{
+		_dPruningFraction = dFraction;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dFraction = " << dFraction;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
 /**
  * Description:
  */
@@ -571,6 +1115,77 @@ void CSimplexOptimizer::setReflectionFactor(double dFactor)
 }
 
 
+/**
+ * Description:
+ * @param dTolerance: (IN) Spread of function values relative to the lowest one within which a simplex converges, 0 for none.
+ */
+void CSimplexOptimizer::setRelativeValueTolerance(double dTolerance)
+{
+	// Check parameter:
+	if (dTolerance >= 0)
+	{
+		_dRelativeValueTolerance = dTolerance;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "dTolerance = " << dTolerance;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param nThreadsCount: (IN) Number of threads running starts, 0 for one per processor.
+ */
+void CSimplexOptimizer::setThreadsCount(int nThreadsCount)
+{
+	// Check parameter:
+	if (nThreadsCount >= 0)
+	{
+		_nThreadsCount = nThreadsCount;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< "nThreadsCount = " << nThreadsCount;
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
+/**
+ * Description:
+ * @param tolerances: (IN) Spread of vertices along each dimension within which a simplex converges, empty for no vertex test.
+ */
+void CSimplexOptimizer::setVertexTolerances(const std::vector<double>& tolerances)
+{
+	// Check parameter:
+	if (tolerances.empty()
+		|| (static_cast<int>(tolerances.size()) == _nPROBLEM_DIMENSION && *std::min_element(tolerances.begin(), tolerances.end()) >= 0))
+	{
+		_vertexTolerances = tolerances;
+	}
+	else
+	{
+		std::stringstream msgStream;
+		msgStream
+			<< LOCATION_STREAM_INSERTION
+			<< "Invalid parameter: "
+			<< MessageTexts::sDIMENSION_NOT_MATCH
+			<< "tolerances.size() = " << tolerances.size();
+		throw CInvalidArgumentException(msgStream.str());
+	}
+}
+
+
 /* Implementation for CSimplexOptimizer::CourseNode struct: */
 
 /**